@@ -6,6 +6,7 @@ import copy
 from building_map.building import Building
 from building_map.coordinate_system import CoordinateSystem
 from building_map.level import Level
+from building_map.utils import open_building_file
 
 
 class LevelWithHumanLanes (Level):
@@ -53,7 +54,7 @@ class BuildingYamlParse:
             raise FileNotFoundError(f'input file {map_path} not found')
         self.building_file = map_path
 
-        with open(self.building_file) as f:
+        with open_building_file(self.building_file) as f:
             self.yaml_node = yaml.load(f, yaml.SafeLoader)
 
         if 'coordinate_system' in self.yaml_node:
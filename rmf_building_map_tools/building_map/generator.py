@@ -3,6 +3,7 @@ import yaml
 from xml.etree.ElementTree import tostring as ElementToString
 from .building import Building
 from .etree_utils import indent_etree
+from .utils import open_building_file
 
 
 class Generator:
@@ -13,7 +14,7 @@ class Generator:
         if not os.path.isfile(input_filename):
             raise FileNotFoundError(f'input file {input_filename} not found')
 
-        with open(input_filename, 'r') as f:
+        with open_building_file(input_filename) as f:
             y = yaml.load(f, Loader=yaml.CLoader)
             return Building(y)
 
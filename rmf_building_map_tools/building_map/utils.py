@@ -1,3 +1,4 @@
+import gzip
 import yaml
 from xml.etree.ElementTree import ElementTree, Element, SubElement
 
@@ -157,3 +158,10 @@ def joint(
         joint.append(pose)
 
     return joint
+
+
+def open_building_file(filename):
+    # .building.yaml.gz files are decompressed as they are parsed
+    if filename.endswith('.gz'):
+        return gzip.open(filename, 'rt')
+    return open(filename, 'r')
@@ -4,6 +4,7 @@ import os
 import yaml
 
 from building_map.building import Building
+from building_map.utils import open_building_file
 
 
 def main():
@@ -22,7 +23,7 @@ def main():
     if not os.path.isfile(args.INPUT_YAML):
         raise FileNotFoundError(f'input file {args.INPUT_YAML} not found')
 
-    with open(args.INPUT_YAML, 'r') as f:
+    with open_building_file(args.INPUT_YAML) as f:
         y = yaml.load(f, Loader=yaml.CLoader)
 
     b = Building(y)
@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 from building_map.generator import Generator
+from building_map.utils import open_building_file
 import pit_crew
 
 from pprint import pprint
@@ -66,7 +67,7 @@ def get_crowdsim_models(input_filename):
         raise FileNotFoundError(f'input file {input_filename} not found')
 
     actor_names = []
-    with open(input_filename, 'r') as f:
+    with open_building_file(input_filename) as f:
         y = yaml.safe_load(f)
         try:
             model_types = y["crowd_sim"]["model_types"]
@@ -32,6 +32,7 @@ from rmf_site_map_msgs.msg import SiteMap
 from building_map.building import Building
 
 from building_map.transform import Transform
+from building_map.utils import open_building_file
 
 
 class BuildingMapServer(Node):
@@ -45,7 +46,8 @@ class BuildingMapServer(Node):
                 errno.ENOENT, os.strerror(errno.ENOENT), map_path)
         self.map_dir = os.path.dirname(map_path)  # for calculating image paths
 
-        if map_path.endswith('.building.yaml'):
+        if map_path.endswith('.building.yaml') or \
+                map_path.endswith('.building.yaml.gz'):
             self.load_building_yaml(map_path)
         elif map_path.endswith('.gpkg'):
             self.load_geopackage(map_path)
@@ -81,7 +83,7 @@ class BuildingMapServer(Node):
                 self.map_msg.name))
 
     def load_building_yaml(self, map_path):
-        with open(map_path, 'r') as f:
+        with open_building_file(map_path) as f:
             building = Building(yaml.load(f, Loader=yaml.CLoader), 'yaml')
 
         self.create_map_msg(building)
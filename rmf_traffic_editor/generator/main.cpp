@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QGuiApplication>
+
+#include "building.h"
+#include "world_generator.h"
+
+
+int main(int argc, char* argv[])
+{
+  // level drawings are loaded into QPixmaps, which need a GUI application
+  // even though nothing is ever shown. Don't require a display for that.
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QGuiApplication app(argc, argv);
+  app.setApplicationName("building-world-generator");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+    "Generate wall and floor meshes for each level of a building");
+  parser.addHelpOption();
+  parser.addPositionalArgument("building", "Building YAML file to read");
+  parser.addPositionalArgument("output", "Output models directory");
+  QCommandLineOption incremental_option(
+    QStringList() << "i" << "incremental",
+    "Only regenerate levels which changed since the previous run");
+  parser.addOption(incremental_option);
+  parser.process(app);
+
+  const QStringList args = parser.positionalArguments();
+  if (args.size() != 2)
+    parser.showHelp(1);
+
+  // Building::load() changes the working directory, so resolve the
+  // output path first
+  WorldGenerator generator;
+  generator.output_path =
+    QDir(args.at(1)).absolutePath().toStdString();
+  generator.incremental = parser.isSet(incremental_option);
+
+  Building building;
+  if (!building.load(args.at(0).toStdString()))
+    return 1;
+
+  return generator.generate(building) ? 0 : 1;
+}
@@ -0,0 +1,858 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
+
+#include "ament_index_cpp/get_package_share_directory.hpp"
+
+#include "world_generator.h"
+
+using std::string;
+using std::vector;
+
+typedef Triangulation::Point Point;
+typedef Triangulation::Ring Ring;
+
+
+static double param_double(
+  const std::map<string, Param>& params,
+  const string& name,
+  const double default_value)
+{
+  auto it = params.find(name);
+  if (it == params.end())
+    return default_value;
+  if (it->second.type == Param::DOUBLE)
+    return it->second.value_double;
+  if (it->second.type == Param::INT)
+    return it->second.value_int;
+  return default_value;
+}
+
+static string param_string(
+  const std::map<string, Param>& params,
+  const string& name,
+  const string& default_value)
+{
+  auto it = params.find(name);
+  if (it == params.end() || it->second.type != Param::STRING)
+    return default_value;
+  return it->second.value_string;
+}
+
+WorldGenerator::WorldGenerator()
+{
+}
+
+WorldGenerator::~WorldGenerator()
+{
+}
+
+bool WorldGenerator::generate(Building& building)
+{
+  if (output_path.empty())
+  {
+    printf("WorldGenerator: no output path specified\n");
+    return false;
+  }
+  if (building.levels.empty())
+  {
+    printf("WorldGenerator: building has no levels\n");
+    return false;
+  }
+  if (!QDir().mkpath(QString::fromStdString(output_path)))
+  {
+    printf("couldn't create output directory %s\n", output_path.c_str());
+    return false;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  level_hashes.clear();
+  if (incremental)
+    load_cache();
+
+  // Everything below the parallel section only reads the Building, so
+  // fill in the (lazily-computed) level transforms up front.
+  building.calculate_all_transforms();
+
+  const int ref_idx = building.get_reference_level_idx();
+  const double ref_meters_per_pixel =
+    building.levels[ref_idx].drawing_meters_per_pixel;
+  const bool y_flip = building.coordinate_system.is_y_flipped();
+
+  vector<LevelJob> jobs(building.levels.size());
+  for (std::size_t i = 0; i < building.levels.size(); i++)
+  {
+    const Level& level = building.levels[i];
+    LevelJob& job = jobs[i];
+    job.level_idx = static_cast<int>(i);
+    job.model_name = building.name + "_" + level.name;
+
+    if (y_flip)
+    {
+      const Building::Transform t =
+        building.get_transform(job.level_idx, ref_idx);
+      job.scale = t.scale;
+      job.dx = t.dx;
+      job.dy = t.dy;
+      job.meters_per_pixel = ref_meters_per_pixel;
+      job.y_sign = -1.0;
+    }
+
+    job.vertices.reserve(level.vertices.size());
+    for (const Vertex& v : level.vertices)
+      job.vertices.push_back(job.to_meters(Point(v.x, v.y)));
+  }
+
+  // cut the lift shafts out of the floors of every level they serve
+  for (const Lift& lift : building.lifts)
+  {
+    if (lift.level_doors.empty())
+      continue;
+
+    int lift_level_idx = ref_idx;
+    for (std::size_t j = 0; j < building.levels.size(); j++)
+    {
+      if (building.levels[j].name == lift.reference_floor_name)
+      {
+        lift_level_idx = static_cast<int>(j);
+        break;
+      }
+    }
+
+    const Point c = jobs[lift_level_idx].to_meters(Point(lift.x, lift.y));
+    const double d = lift.depth / 2.0 + lift_shaft_gap;
+    const double w = lift.width / 2.0 + lift_shaft_gap;
+    const double sy = std::sin(lift.yaw);
+    const double cy = std::cos(lift.yaw);
+    const Ring shaft =
+    {
+      Point(c.x - d * sy - w * cy, c.y + d * cy - w * sy),
+      Point(c.x + d * sy - w * cy, c.y - d * cy - w * sy),
+      Point(c.x + d * sy + w * cy, c.y - d * cy + w * sy),
+      Point(c.x - d * sy + w * cy, c.y + d * cy + w * sy)
+    };
+
+    for (LevelJob& job : jobs)
+    {
+      const double elevation = building.levels[job.level_idx].elevation;
+      if (elevation >= lift.lowest_elevation &&
+        elevation <= lift.highest_elevation)
+        job.lift_shafts.push_back(shaft);
+    }
+  }
+
+  // the level YAML of a global building goes through the coordinate
+  // system's PROJ transform, which only one thread can use at a time
+  for (LevelJob& job : jobs)
+    compute_hash(
+      building.levels[job.level_idx],
+      building.coordinate_system,
+      job);
+
+  QtConcurrent::blockingMap(
+    jobs,
+    [&](LevelJob& job)
+    {
+      const Level& level = building.levels[job.level_idx];
+      if (incremental)
+      {
+        auto it = level_hashes.find(level.name);
+        const QString sdf_path = QString::fromStdString(
+          output_path + "/" + job.model_name + "/model.sdf");
+        if (it != level_hashes.end() &&
+        it->second == job.hash &&
+        QFileInfo::exists(sdf_path))
+        {
+          job.skipped = true;
+          job.ok = true;
+          return;
+        }
+      }
+
+      job.ok = generate_level(level, job);
+    });
+
+  // only remember the hashes of levels which were successfully written,
+  // and forget about levels which no longer exist.
+  std::map<string, string> new_hashes;
+  bool all_ok = true;
+  int num_generated = 0;
+  int num_skipped = 0;
+  for (const LevelJob& job : jobs)
+  {
+    const string& level_name = building.levels[job.level_idx].name;
+    if (job.ok)
+      new_hashes[level_name] = job.hash;
+    else
+      all_ok = false;
+
+    if (job.skipped)
+      num_skipped++;
+    else if (job.ok)
+      num_generated++;
+  }
+  level_hashes = new_hashes;
+  save_cache();
+
+  printf("generated %d levels (%d unchanged) in %.3f seconds\n",
+    num_generated,
+    num_skipped,
+    static_cast<double>(timer.elapsed()) / 1000.0);
+
+  return all_ok;
+}
+
+Point WorldGenerator::LevelJob::to_meters(const Point& p) const
+{
+  return Point(
+    (scale * p.x + dx) * meters_per_pixel,
+    y_sign * (scale * p.y + dy) * meters_per_pixel);
+}
+
+Point WorldGenerator::LevelJob::from_meters(const Point& p) const
+{
+  return Point(
+    (p.x / meters_per_pixel - dx) / scale,
+    (y_sign * p.y / meters_per_pixel - dy) / scale);
+}
+
+bool WorldGenerator::load_cache()
+{
+  const string cache_path = output_path + "/" + cache_filename;
+  if (!QFileInfo::exists(QString::fromStdString(cache_path)))
+    return false;
+
+  try
+  {
+    const YAML::Node y = YAML::LoadFile(cache_path);
+    if (y["levels"] && y["levels"].IsMap())
+    {
+      for (YAML::const_iterator it = y["levels"].begin();
+        it != y["levels"].end(); ++it)
+        level_hashes[it->first.as<string>()] = it->second.as<string>();
+    }
+  }
+  catch (const std::exception& e)
+  {
+    printf("couldn't parse %s: %s\n", cache_path.c_str(), e.what());
+    level_hashes.clear();
+    return false;
+  }
+  return true;
+}
+
+bool WorldGenerator::save_cache() const
+{
+  YAML::Node y;
+  y["levels"] = YAML::Node(YAML::NodeType::Map);
+  for (const auto& level_hash : level_hashes)
+    y["levels"][level_hash.first] = level_hash.second;
+
+  YAML::Emitter emitter;
+  emitter << y;
+
+  const string cache_path = output_path + "/" + cache_filename;
+  std::ofstream fout(cache_path);
+  if (!fout)
+  {
+    printf("unable to open %s\n", cache_path.c_str());
+    return false;
+  }
+  fout << emitter.c_str() << std::endl;
+  return true;
+}
+
+void WorldGenerator::compute_hash(
+  const Level& level,
+  const CoordinateSystem& coordinate_system,
+  LevelJob& job) const
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  YAML::Emitter emitter;
+  emitter << level.to_yaml(coordinate_system);
+  hash.addData(emitter.c_str(), static_cast<int>(emitter.size()));
+
+  // the level YAML doesn't capture the inter-level transform, lift shafts,
+  // or generator settings, so mix those in as well
+  hash.addData(
+    reinterpret_cast<const char*>(job.vertices.data()),
+    static_cast<int>(job.vertices.size() * sizeof(Point)));
+  for (const Ring& shaft : job.lift_shafts)
+    hash.addData(
+      reinterpret_cast<const char*>(shaft.data()),
+      static_cast<int>(shaft.size() * sizeof(Point)));
+
+  const double settings[] =
+  {
+    wall_height,
+    wall_thickness,
+    floor_thickness,
+    lift_shaft_gap
+  };
+  hash.addData(reinterpret_cast<const char*>(settings), sizeof(settings));
+  hash.addData(job.model_name.c_str(), static_cast<int>(job.model_name.size()));
+
+  job.hash = hash.result().toHex().toStdString();
+}
+
+bool WorldGenerator::generate_level(const Level& level, LevelJob& job) const
+{
+  const string model_path = output_path + "/" + job.model_name;
+  if (!QDir().mkpath(QString::fromStdString(model_path + "/meshes")))
+  {
+    printf("couldn't create %s/meshes\n", model_path.c_str());
+    return false;
+  }
+
+  string sdf_links;
+  if (!generate_floors(level, job, model_path, sdf_links))
+    return false;
+  if (!generate_walls(level, job, model_path, sdf_links))
+    return false;
+
+  if (!write_model_config(model_path, job.model_name))
+    return false;
+  if (!write_model_sdf(model_path, job.model_name, sdf_links))
+    return false;
+
+  printf("  generated level %s in %s\n", level.name.c_str(),
+    model_path.c_str());
+  return true;
+}
+
+bool WorldGenerator::generate_walls(
+  const Level& level,
+  const LevelJob& job,
+  const string& model_path,
+  string& sdf_links) const
+{
+  // walls with identical parameters share a mesh, like the Python generator
+  struct WallGroup
+  {
+    std::map<string, Param> params;
+    vector<const Edge*> edges;
+  };
+  vector<WallGroup> groups;
+
+  const int num_vertices = static_cast<int>(job.vertices.size());
+  for (const Edge& edge : level.edges)
+  {
+    if (edge.type != Edge::WALL)
+      continue;
+    if (edge.start_idx < 0 || edge.start_idx >= num_vertices ||
+      edge.end_idx < 0 || edge.end_idx >= num_vertices)
+    {
+      printf("level %s: skipping wall with invalid vertex index\n",
+        level.name.c_str());
+      continue;
+    }
+
+    auto group_it = std::find_if(
+      groups.begin(),
+      groups.end(),
+      [&edge](const WallGroup& group)
+      {
+        if (group.params.size() != edge.params.size())
+          return false;
+        for (const auto& param : edge.params)
+        {
+          auto it = group.params.find(param.first);
+          if (it == group.params.end() ||
+          it->second.to_qstring() != param.second.to_qstring())
+            return false;
+        }
+        return true;
+      });
+
+    if (group_it == groups.end())
+    {
+      WallGroup group;
+      group.params = edge.params;
+      groups.push_back(group);
+      group_it = groups.end() - 1;
+    }
+    group_it->edges.push_back(&edge);
+  }
+
+  const string meshes_path = model_path + "/meshes";
+  const double h = wall_height;
+  const double t = wall_thickness;
+  const double t2 = wall_thickness / 2.0;
+
+  for (std::size_t group_idx = 0; group_idx < groups.size(); group_idx++)
+  {
+    const WallGroup& group = groups[group_idx];
+    const string wall_name = "wall_" + std::to_string(group_idx + 1);
+
+    const string texture_name =
+      param_string(group.params, "texture_name", "default");
+    const double alpha = param_double(group.params, "alpha", 1.0);
+    const double texture_height =
+      param_double(group.params, "texture_height", wall_height);
+    const double texture_width =
+      param_double(group.params, "texture_width", 1.0);
+    double texture_scale = param_double(group.params, "texture_scale", 1.0);
+
+    // four footprint corners and four side normals per wall segment
+    vector<Point> footprint;
+    vector<Point> normals;
+    vector<double> lengths;
+    footprint.reserve(4 * group.edges.size());
+    normals.reserve(4 * group.edges.size());
+    lengths.reserve(group.edges.size());
+
+    for (const Edge* edge : group.edges)
+    {
+      const Point& v1 = job.vertices[edge->start_idx];
+      const Point& v2 = job.vertices[edge->end_idx];
+      const double dx = v2.x - v1.x;
+      const double dy = v2.y - v1.y;
+      const double len = std::sqrt(dx * dx + dy * dy);
+      const double cx = (v1.x + v2.x) / 2.0;
+      const double cy = (v1.y + v2.y) / 2.0;
+      const double yaw = std::atan2(dy, dx);
+      const double c = std::cos(yaw);
+      const double s = std::sin(yaw);
+
+      const Point corners[4] =
+      {
+        Point(-len / 2.0 - t2, t2),
+        Point(len / 2.0 + t2, t2),
+        Point(len / 2.0 + t2, -t2),
+        Point(-len / 2.0 - t2, -t2)
+      };
+      const Point side_normals[4] =
+      {
+        Point(0, 1),
+        Point(-1, 0),
+        Point(0, -1),
+        Point(1, 0)
+      };
+
+      for (int i = 0; i < 4; i++)
+      {
+        const Point& p = corners[i];
+        footprint.push_back(
+          Point(p.x * c - p.y * s + cx, p.x * s + p.y * c + cy));
+        const Point& n = side_normals[i];
+        normals.push_back(Point(n.x * c - n.y * s, n.x * s + n.y * c));
+      }
+      lengths.push_back(len);
+    }
+
+    // keep the mesh coordinates small and move the link to its location
+    // instead, so that the simulator's "move to" tools behave nicely.
+    double offset_x = std::numeric_limits<double>::max();
+    double offset_y = std::numeric_limits<double>::max();
+    for (const Point& p : footprint)
+    {
+      offset_x = std::min(offset_x, p.x);
+      offset_y = std::min(offset_y, p.y);
+    }
+
+    const string obj_path = meshes_path + "/" + wall_name + ".obj";
+    FILE* f = fopen(obj_path.c_str(), "w");
+    if (!f)
+    {
+      printf("couldn't open %s\n", obj_path.c_str());
+      return false;
+    }
+
+    fprintf(f, "# The Great Editor v0.0.1\n");
+    fprintf(f, "mtllib %s.mtl\n", wall_name.c_str());
+    fprintf(f, "o walls\n");
+
+    for (const Point& p : footprint)
+    {
+      fprintf(f, "v %.4f %.4f 0.000\n", p.x - offset_x, p.y - offset_y);
+      fprintf(f, "v %.4f %.4f %.4f\n", p.x - offset_x, p.y - offset_y, h);
+    }
+
+    const double vt_h = h / (texture_height / texture_width);
+    if (texture_scale == 0)  // full wall (by height)
+      texture_scale = vt_h;
+    const double s = texture_scale;
+    for (const double len : lengths)
+    {
+      fprintf(f, "vt 0.000 0.000\n");
+      fprintf(f, "vt 0.000 %.4f\n", vt_h / s);
+      fprintf(f, "vt %.4f 0.000\n", len / s);
+      fprintf(f, "vt %.4f %.4f\n", len / s, vt_h / s);
+      fprintf(f, "vt %.4f 0.000\n", (len + t) / s);
+      fprintf(f, "vt %.4f %.4f\n", (len + t) / s, vt_h / s);
+      fprintf(f, "vt %.4f 0.000\n", (2 * len + t) / s);
+      fprintf(f, "vt %.4f %.4f\n", (2 * len + t) / s, vt_h / s);
+    }
+
+    // normal #1 is the vertical normal for the wall "caps"
+    fprintf(f, "vn 0.0000 0.0000 1.0000\n");
+    for (const Point& n : normals)
+      fprintf(f, "vn %.4f %.4f 0.0000\n", n.x, n.y);
+
+    fprintf(f, "usemtl %s\n", wall_name.c_str());
+    fprintf(f, "s off\n");
+    fprintf(f, "g walls\n");
+
+    // wind the 8 side triangles and 2 cap triangles of each segment
+    auto face = [f](int a, int b, int c, int n)
+      {
+        fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, n, b, b, n, c, c, n);
+      };
+    for (int w = 0; w < static_cast<int>(group.edges.size()); w++)
+    {
+      const int v = w * 8;
+      const int n = w * 4;
+      face(v + 1, v + 2, v + 3, n + 2);  // 'north' side (before rotation)
+      face(v + 4, v + 3, v + 2, n + 2);
+      face(v + 3, v + 4, v + 5, n + 3);  // 'east' side
+      face(v + 6, v + 5, v + 4, n + 3);
+      face(v + 5, v + 6, v + 7, n + 4);  // 'south' side
+      face(v + 8, v + 7, v + 6, n + 4);
+      face(v + 7, v + 8, v + 1, n + 5);  // 'west' side
+      face(v + 2, v + 1, v + 8, n + 5);
+      fprintf(f, "f %d/1/1 %d/1/1 %d/1/1\n", v + 2, v + 6, v + 4);  // top
+      fprintf(f, "f %d/1/1 %d/1/1 %d/1/1\n", v + 2, v + 8, v + 6);
+    }
+    fclose(f);
+
+    const string texture_filename = copy_texture(texture_name, meshes_path);
+    if (!write_material(
+        meshes_path + "/" + wall_name + ".mtl",
+        wall_name,
+        alpha,
+        texture_filename))
+      return false;
+
+    sdf_links += mesh_link_sdf(
+      job.model_name,
+      wall_name,
+      wall_name + ".obj",
+      texture_filename,
+      alpha,
+      offset_x,
+      offset_y);
+  }
+
+  return true;
+}
+
+bool WorldGenerator::generate_floors(
+  const Level& level,
+  const LevelJob& job,
+  const string& model_path,
+  string& sdf_links) const
+{
+  // the level caches its floor triangulations in level coordinates, so
+  // hand it the lift shafts in that frame and convert the result to meters
+  vector<Ring> lift_shafts;
+  for (const Ring& shaft : job.lift_shafts)
+  {
+    Ring ring;
+    for (const Point& p : shaft)
+      ring.push_back(job.from_meters(p));
+    lift_shafts.push_back(ring);
+  }
+
+  const string meshes_path = model_path + "/meshes";
+  int floor_cnt = 0;
+  const std::vector<Level::HoleRing> hole_rings = level.hole_rings();
+  for (std::size_t polygon_idx = 0; polygon_idx < level.polygons.size();
+    polygon_idx++)
+  {
+    const Polygon& polygon = level.polygons[polygon_idx];
+    if (polygon.type != Polygon::FLOOR)
+      continue;
+    floor_cnt++;
+
+    const Triangulation& triangulation = level.polygon_triangulation(
+      static_cast<int>(polygon_idx),
+      hole_rings,
+      lift_shafts);
+    if (triangulation.empty())
+    {
+      printf("level %s: couldn't triangulate floor polygon %d\n",
+        level.name.c_str(),
+        floor_cnt);
+      continue;
+    }
+
+    // hole bridges, and triangles split around holes which cross the
+    // outline, duplicate some points; merge them for the mesh
+    std::map<std::pair<double, double>, int> point_indices;
+    vector<Point> points;
+    vector<int> triangles;
+    triangles.reserve(triangulation.triangles.size());
+    for (const int idx : triangulation.triangles)
+    {
+      const Point p = job.to_meters(triangulation.points[idx]);
+      auto result = point_indices.insert(
+        std::make_pair(
+          std::make_pair(p.x, p.y),
+          static_cast<int>(points.size())));
+      if (result.second)
+        points.push_back(p);
+      triangles.push_back(result.first->second);
+    }
+
+    // flipping the y axis also flips the winding of every triangle
+    if (job.y_sign < 0)
+    {
+      for (std::size_t i = 0; i + 2 < triangles.size(); i += 3)
+        std::swap(triangles[i + 1], triangles[i + 2]);
+    }
+
+    const string floor_name = "floor_" + std::to_string(floor_cnt);
+    const string obj_path = meshes_path + "/" + floor_name + ".obj";
+    FILE* f = fopen(obj_path.c_str(), "w");
+    if (!f)
+    {
+      printf("couldn't open %s\n", obj_path.c_str());
+      return false;
+    }
+
+    fprintf(f, "# The Great Editor v0.0.1\n");
+    fprintf(f, "mtllib %s.mtl\n", floor_name.c_str());
+    fprintf(f, "o %s\n", floor_name.c_str());
+
+    // a second set of vertices "below" the floor lets it be seen from below
+    for (const Point& p : points)
+    {
+      fprintf(f, "v %.6f %.6f 0\n", p.x, p.y);
+      fprintf(f, "v %.6f %.6f %.6f\n", p.x, p.y, -floor_thickness);
+    }
+
+    const double texture_scale =
+      param_double(polygon.params, "texture_scale", 1.0);
+    for (const Point& p : points)
+      fprintf(f, "vt %.6f %.6f 0\n", p.x / texture_scale, p.y / texture_scale);
+
+    // floors are always flat (for now), so normals are up or down
+    fprintf(f, "vn 0 0 1\n");
+    fprintf(f, "vn 0 0 -1\n");
+
+    fprintf(f, "usemtl %s\n", floor_name.c_str());
+    fprintf(f, "s off\n");
+
+    for (std::size_t i = 0; i + 2 < triangles.size(); i += 3)
+    {
+      const int a = triangles[i];
+      const int b = triangles[i + 1];
+      const int c = triangles[i + 2];
+      fprintf(f, "f %d/%d/1 %d/%d/1 %d/%d/1\n",
+        2 * a + 1, a + 1, 2 * b + 1, b + 1, 2 * c + 1, c + 1);
+      fprintf(f, "f %d/%d/2 %d/%d/2 %d/%d/2\n",
+        2 * c + 2, c + 1, 2 * b + 2, b + 1, 2 * a + 2, a + 1);
+    }
+    fclose(f);
+
+    const string texture_filename = copy_texture(
+      param_string(polygon.params, "texture_name", "blue_linoleum"),
+      meshes_path);
+    if (!write_material(
+        meshes_path + "/" + floor_name + ".mtl",
+        floor_name,
+        1.0,
+        texture_filename))
+      return false;
+
+    sdf_links += mesh_link_sdf(
+      job.model_name,
+      floor_name,
+      floor_name + ".obj",
+      texture_filename,
+      1.0,
+      0.0,
+      0.0);
+  }
+
+  return true;
+}
+
+bool WorldGenerator::write_material(
+  const string& mtl_path,
+  const string& material_name,
+  const double alpha,
+  const string& texture_filename) const
+{
+  FILE* f = fopen(mtl_path.c_str(), "w");
+  if (!f)
+  {
+    printf("couldn't open %s\n", mtl_path.c_str());
+    return false;
+  }
+  fprintf(f, "# The Great Editor v0.0.1\n");
+  fprintf(f, "newmtl %s\n", material_name.c_str());
+  fprintf(f, "Ka 1.0 1.0 1.0\n");  // ambient
+  fprintf(f, "Kd 1.0 1.0 1.0\n");  // diffuse
+  fprintf(f, "Ke 0.0 0.0 0.0\n");  // emissive
+  fprintf(f, "Ns 50.0\n");  // specular highlight, 0..100
+  fprintf(f, "Ni 1.0\n");  // optical density
+  fprintf(f, "d %g\n", alpha);
+  fprintf(f, "illum 2\n");  // illumination model (enum)
+  fprintf(f, "map_Kd %s\n", texture_filename.c_str());
+  fclose(f);
+  return true;
+}
+
+string WorldGenerator::copy_texture(
+  const string& texture_name,
+  const string& meshes_path) const
+{
+  // textures given as URLs are referenced by their file name; they are
+  // expected to be fetched by the world launch tooling, as before.
+  if (texture_name.find("://") != string::npos)
+    return texture_name.substr(texture_name.find_last_of('/') + 1);
+
+  const string texture_filename = texture_name + ".png";
+  const QString dest_path =
+    QString::fromStdString(meshes_path + "/" + texture_filename);
+  if (QFileInfo::exists(dest_path))
+    return texture_filename;
+
+  try
+  {
+    const string share_path =
+      ament_index_cpp::get_package_share_directory("rmf_building_map_tools");
+    const QString source_path =
+      QString::fromStdString(share_path + "/textures/" + texture_filename);
+    if (!QFile::copy(source_path, dest_path))
+      printf("couldn't copy texture %s\n", qUtf8Printable(source_path));
+  }
+  catch (const ament_index_cpp::PackageNotFoundError&)
+  {
+    printf("rmf_building_map_tools not found; texture %s not copied\n",
+      texture_filename.c_str());
+  }
+  return texture_filename;
+}
+
+string WorldGenerator::mesh_link_sdf(
+  const string& model_name,
+  const string& link_name,
+  const string& mesh_filename,
+  const string& texture_filename,
+  const double alpha,
+  const double pose_x,
+  const double pose_y) const
+{
+  const string uri = "model://" + model_name + "/meshes/" + mesh_filename;
+  const QString sdf = QString(
+    "    <link name=\"%1\">\n"
+    "      <pose>%2 %3 0 0 0 0</pose>\n"
+    "      <visual name=\"%1\">\n"
+    "        <geometry>\n"
+    "          <mesh>\n"
+    "            <uri>%4</uri>\n"
+    "          </mesh>\n"
+    "        </geometry>\n"
+    "        <transparency>%5</transparency>\n"
+    "        <material>\n"
+    "          <diffuse>1.0 1.0 1.0</diffuse>\n"
+    "          <specular>0.1 0.1 0.1</specular>\n"
+    "          <pbr>\n"
+    "            <metal>\n"
+    "              <metalness>0.0</metalness>\n"
+    "              <albedo_map>model://%6/meshes/%7</albedo_map>\n"
+    "            </metal>\n"
+    "          </pbr>\n"
+    "        </material>\n"
+    "      </visual>\n"
+    "      <collision name=\"collision\">\n"
+    "        <geometry>\n"
+    "          <mesh>\n"
+    "            <uri>%4</uri>\n"
+    "          </mesh>\n"
+    "        </geometry>\n"
+    "        <surface>\n"
+    "          <contact>\n"
+    "            <collide_bitmask>0x01</collide_bitmask>\n"
+    "          </contact>\n"
+    "        </surface>\n"
+    "      </collision>\n"
+    "    </link>\n")
+    .arg(QString::fromStdString(link_name))
+    .arg(pose_x, 0, 'f', 6)
+    .arg(pose_y, 0, 'f', 6)
+    .arg(QString::fromStdString(uri))
+    .arg(1.0 - alpha)
+    .arg(QString::fromStdString(model_name))
+    .arg(QString::fromStdString(texture_filename));
+  return sdf.toStdString();
+}
+
+bool WorldGenerator::write_model_config(
+  const string& model_path,
+  const string& model_name) const
+{
+  const string path = model_path + "/model.config";
+  std::ofstream fout(path);
+  if (!fout)
+  {
+    printf("unable to open %s\n", path.c_str());
+    return false;
+  }
+  fout << "<?xml version='1.0' encoding='utf-8'?>\n"
+       << "<model>\n"
+       << "  <name>" << model_name << "</name>\n"
+       << "  <version>1.0.0</version>\n"
+       << "  <sdf version=\"1.6\">model.sdf</sdf>\n"
+       << "  <author>\n"
+       << "    <name>automatically generated from the Great Editor</name>\n"
+       << "    <email>info@openrobotics.org</email>\n"
+       << "  </author>\n"
+       << "  <description>level " << model_name
+       << " (automatically generated)</description>\n"
+       << "</model>\n";
+  return true;
+}
+
+bool WorldGenerator::write_model_sdf(
+  const string& model_path,
+  const string& model_name,
+  const string& sdf_links) const
+{
+  const string path = model_path + "/model.sdf";
+  std::ofstream fout(path);
+  if (!fout)
+  {
+    printf("unable to open %s\n", path.c_str());
+    return false;
+  }
+  fout << "<?xml version='1.0' encoding='utf-8'?>\n"
+       << "<sdf version=\"1.7\">\n"
+       << "  <model name=\"" << model_name << "\">\n"
+       << "    <static>true</static>\n"
+       << sdf_links
+       << "  </model>\n"
+       << "</sdf>\n";
+  return true;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef WORLD_GENERATOR_H
+#define WORLD_GENERATOR_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "building.h"
+#include "triangulation.h"
+
+/*
+ * Generates the static world geometry of each level of a Building: the
+ * extruded walls and the (hole-subtracted) floor slabs, written as OBJ
+ * meshes plus a model.sdf / model.config pair per level. The output
+ * layout and mesh conventions follow the Python building_map generator,
+ * so the resulting models can be dropped into the same world files.
+ *
+ * Levels are independent of each other once their vertices have been
+ * transformed into the reference frame, so they are generated in
+ * parallel. In incremental mode, a hash of each level's geometry inputs
+ * is kept in the output directory and levels whose hash has not changed
+ * since the previous run are skipped.
+ */
+
+class WorldGenerator
+{
+public:
+  WorldGenerator();
+  ~WorldGenerator();
+
+  std::string output_path;
+  bool incremental = false;
+
+  double wall_height = 2.5;  // meters
+  double wall_thickness = 0.1;  // meters
+  double floor_thickness = 0.1;  // meters
+  double lift_shaft_gap = 0.05;  // meters, around the lift cabin
+
+  // the Building is non-const because its transform cache is filled in
+  bool generate(Building& building);
+
+  static constexpr const char* cache_filename = ".world_generator_cache.yaml";
+
+private:
+  struct LevelJob
+  {
+    int level_idx = -1;
+    std::string model_name;
+
+    // level coordinates -> meters in the reference frame: first scale and
+    // translate into the reference level, then scale (and flip) to meters
+    double scale = 1.0;
+    double dx = 0.0;
+    double dy = 0.0;
+    double meters_per_pixel = 1.0;
+    double y_sign = 1.0;
+
+    Triangulation::Point to_meters(const Triangulation::Point& p) const;
+    Triangulation::Point from_meters(const Triangulation::Point& p) const;
+
+    std::vector<Triangulation::Point> vertices;  // meters, reference frame
+    std::vector<Triangulation::Ring> lift_shafts;
+    std::string hash;
+    bool skipped = false;
+    bool ok = false;
+  };
+
+  std::map<std::string, std::string> level_hashes;
+
+  bool load_cache();
+  bool save_cache() const;
+
+  void compute_hash(const Level& level, const CoordinateSystem& cs,
+    LevelJob& job) const;
+
+  bool generate_level(const Level& level, LevelJob& job) const;
+
+  bool generate_walls(
+    const Level& level,
+    const LevelJob& job,
+    const std::string& model_path,
+    std::string& sdf_links) const;
+
+  bool generate_floors(
+    const Level& level,
+    const LevelJob& job,
+    const std::string& model_path,
+    std::string& sdf_links) const;
+
+  bool write_material(
+    const std::string& mtl_path,
+    const std::string& material_name,
+    const double alpha,
+    const std::string& texture_filename) const;
+
+  std::string copy_texture(
+    const std::string& texture_name,
+    const std::string& meshes_path) const;
+
+  std::string mesh_link_sdf(
+    const std::string& model_name,
+    const std::string& link_name,
+    const std::string& mesh_filename,
+    const std::string& texture_filename,
+    const double alpha,
+    const double pose_x,
+    const double pose_y) const;
+
+  bool write_model_config(
+    const std::string& model_path,
+    const std::string& model_name) const;
+
+  bool write_model_sdf(
+    const std::string& model_path,
+    const std::string& model_name,
+    const std::string& sdf_links) const;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "add_edge_graph.h"
+
+AddEdgeGraphCommand::AddEdgeGraphCommand(
+  Building* building,
+  int level_idx,
+  Edge::Type type,
+  int graph_idx,
+  const std::vector<QPointF>& vertices,
+  const std::vector<std::pair<int, int>>& edges)
+: _building(building),
+  _level_idx(level_idx),
+  _type(type),
+  _graph_idx(graph_idx),
+  _vertices(vertices),
+  _edges(edges)
+{
+  setText(QString("Add %1 edges").arg(edges.size()));
+  _vert_snapshot = _building->levels[_level_idx].vertices;
+  _edge_snapshot = _building->levels[_level_idx].edges;
+}
+
+AddEdgeGraphCommand::~AddEdgeGraphCommand()
+{
+}
+
+void AddEdgeGraphCommand::redo()
+{
+  Level& level = _building->levels[_level_idx];
+
+  // after the first time, restore exactly what was added (same uuids)
+  if (_applied)
+  {
+    level.vertices = _final_vert_snapshot;
+    level.edges = _final_edge_snapshot;
+    return;
+  }
+
+  const int first_vertex_idx = static_cast<int>(level.vertices.size());
+  for (const QPointF& p : _vertices)
+    level.add_vertex(p.x(), p.y());
+
+  for (const auto& e : _edges)
+  {
+    Edge edge(first_vertex_idx + e.first, first_vertex_idx + e.second, _type);
+    if (_type == Edge::LANE)
+      edge.set_graph_idx(_graph_idx);
+    level.edges.push_back(edge);
+  }
+
+  _final_vert_snapshot = level.vertices;
+  _final_edge_snapshot = level.edges;
+  _applied = true;
+}
+
+void AddEdgeGraphCommand::undo()
+{
+  //Just use snapshots to keep things simpler
+  _building->levels[_level_idx].vertices = _vert_snapshot;
+  _building->levels[_level_idx].edges = _edge_snapshot;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _ADD_EDGE_GRAPH_H_
+#define _ADD_EDGE_GRAPH_H_
+
+#include <utility>
+#include <vector>
+
+#include <QPointF>
+#include <QUndoCommand>
+#include "building.h"
+
+/*
+ * Adds a whole batch of vertices and edges of one type (e.g. an
+ * automatically proposed lane graph, or proposed walls) as one undoable
+ * step. The graph index is only used for lanes.
+ */
+
+class AddEdgeGraphCommand : public QUndoCommand
+{
+public:
+  AddEdgeGraphCommand(
+    Building* building,
+    int level_idx,
+    Edge::Type type,
+    int graph_idx,
+    const std::vector<QPointF>& vertices,
+    const std::vector<std::pair<int, int>>& edges);
+  virtual ~AddEdgeGraphCommand();
+  void undo() override;
+  void redo() override;
+
+private:
+  Building* _building;
+  int _level_idx;
+  Edge::Type _type;
+  int _graph_idx;
+  std::vector<QPointF> _vertices;
+  std::vector<std::pair<int, int>> _edges;
+  std::vector<Vertex> _vert_snapshot, _final_vert_snapshot;
+  std::vector<Edge> _edge_snapshot, _final_edge_snapshot;
+  bool _applied = false;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "add_polygons.h"
+
+AddPolygonsCommand::AddPolygonsCommand(
+  Building* building,
+  int level_idx,
+  const std::vector<QPointF>& vertices,
+  const std::vector<Polygon>& polygons)
+: _building(building),
+  _level_idx(level_idx),
+  _vertices(vertices),
+  _polygons(polygons)
+{
+  setText(QString("Add %1 polygons").arg(polygons.size()));
+  _vert_snapshot = _building->levels[_level_idx].vertices;
+  _polygon_snapshot = _building->levels[_level_idx].polygons;
+}
+
+AddPolygonsCommand::~AddPolygonsCommand()
+{
+}
+
+void AddPolygonsCommand::redo()
+{
+  Level& level = _building->levels[_level_idx];
+
+  // after the first time, restore exactly what was added (same uuids)
+  if (_applied)
+    level.vertices = _final_vert_snapshot;
+  else
+  {
+    for (const QPointF& p : _vertices)
+      level.add_vertex(p.x(), p.y());
+    _final_vert_snapshot = level.vertices;
+    _applied = true;
+  }
+
+  level.polygons = _polygon_snapshot;
+  level.polygons.insert(
+    level.polygons.end(),
+    _polygons.begin(),
+    _polygons.end());
+}
+
+void AddPolygonsCommand::undo()
+{
+  //Just use snapshots to keep things simpler
+  _building->levels[_level_idx].vertices = _vert_snapshot;
+  _building->levels[_level_idx].polygons = _polygon_snapshot;
+}
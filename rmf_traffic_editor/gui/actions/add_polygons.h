@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef _ADD_POLYGONS_H_
+#define _ADD_POLYGONS_H_
+
+#include <vector>
+
+#include <QPointF>
+#include <QUndoCommand>
+#include "building.h"
+
+/*
+ * Adds a batch of polygons (e.g. automatically proposed floors and holes)
+ * as one undoable step, along with any new vertices they need. Polygon
+ * vertex indices past the end of the level's vertices refer to the new
+ * vertices, in order.
+ */
+
+class AddPolygonsCommand : public QUndoCommand
+{
+public:
+  AddPolygonsCommand(
+    Building* building,
+    int level_idx,
+    const std::vector<QPointF>& vertices,
+    const std::vector<Polygon>& polygons);
+  virtual ~AddPolygonsCommand();
+  void undo() override;
+  void redo() override;
+
+private:
+  Building* _building;
+  int _level_idx;
+  std::vector<QPointF> _vertices;
+  std::vector<Polygon> _polygons;
+  std::vector<Vertex> _vert_snapshot, _final_vert_snapshot;
+  std::vector<Polygon> _polygon_snapshot;
+  bool _applied = false;
+};
+
+#endif
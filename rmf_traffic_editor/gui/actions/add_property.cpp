@@ -28,11 +28,11 @@ AddPropertyCommand::AddPropertyCommand(
   _level_idx = level_idx;
   _vert_id = -1;
 
-  for (size_t i = 0; i < building->levels[level_idx].vertices.size(); i++)
-  {
-    if (building->levels[level_idx].vertices[i].selected)
-      _vert_id = i;
-  }
+  // the last selected vertex, as a scan over all of them used to find
+  const std::vector<int> selected_vertices =
+    building->levels[level_idx].selection().indices(SelectionSet::VERTEX);
+  if (!selected_vertices.empty())
+    _vert_id = selected_vertices.back();
 }
 
 AddPropertyCommand::~AddPropertyCommand()
@@ -30,44 +30,53 @@ DeleteCommand::~DeleteCommand()
 
 void DeleteCommand::undo()
 {
+  // the restored elements are selected again, so that redo() finds them
+  Level& level = _building->levels[_level_idx];
+  level.clear_selection();
+
   for (size_t i = 0; i < _vertices.size(); i++)
   {
-    _building->levels[_level_idx].vertices.insert(
-      _building->levels[_level_idx].vertices.begin() + _vertex_idx[i],
+    level.vertices.insert(
+      level.vertices.begin() + _vertex_idx[i],
       _vertices[i]);
+    level.select(SelectionSet::Item(SelectionSet::VERTEX, _vertex_idx[i]));
   }
 
   for (size_t i = 0; i < _edges.size(); i++)
   {
-    _building->levels[_level_idx].edges.insert(
-      _building->levels[_level_idx].edges.begin() + _edge_idx[i],
+    level.edges.insert(
+      level.edges.begin() + _edge_idx[i],
       _edges[i]);
+    level.select(SelectionSet::Item(SelectionSet::EDGE, _edge_idx[i]));
   }
 
   for (size_t i = 0; i < _models.size(); i++)
   {
-    _building->levels[_level_idx].models.insert(
-      _building->levels[_level_idx].models.begin() + _model_idx[i],
+    level.models.insert(
+      level.models.begin() + _model_idx[i],
       _models[i]);
+    level.select(SelectionSet::Item(SelectionSet::MODEL, _model_idx[i]));
   }
 
   for (size_t i = 0; i < _fiducials.size(); i++)
   {
-    _building->levels[_level_idx].fiducials.insert(
-      _building->levels[_level_idx].fiducials.begin() + _fiducial_idx[i],
+    level.fiducials.insert(
+      level.fiducials.begin() + _fiducial_idx[i],
       _fiducials[i]);
+    level.select(
+      SelectionSet::Item(SelectionSet::FIDUCIAL, _fiducial_idx[i]));
   }
 
   for (size_t i = 0; i < _polygons.size(); i++)
   {
-    _building->levels[_level_idx].polygons.insert(
-      _building->levels[_level_idx].polygons.begin() + _polygon_idx[i],
+    level.polygons.insert(
+      level.polygons.begin() + _polygon_idx[i],
       _polygons[i]);
+    level.select(SelectionSet::Item(SelectionSet::POLYGON, _polygon_idx[i]));
   }
 
   for (size_t i = 0; i < _features.size(); i++)
   {
-    Level& level = _building->levels[_level_idx];
     if (_feature_layer_idx[i] == 0)
     {
       level.floorplan_features.insert(
@@ -81,14 +90,20 @@ void DeleteCommand::undo()
         layer.features.begin() + _feature_idx[i],
         _features[i]);
     }
+    level.select(
+      SelectionSet::Item(
+        SelectionSet::FEATURE,
+        _feature_idx[i],
+        _feature_layer_idx[i]));
   }
 
   for (size_t i = 0; i < _constraints.size(); i++)
   {
-    Level& level = _building->levels[_level_idx];
     level.constraints.insert(
       level.constraints.begin() + _constraint_idx[i],
       _constraints[i]);
+    level.select(
+      SelectionSet::Item(SelectionSet::CONSTRAINT, _constraint_idx[i]));
   }
 
   _vertices.clear();
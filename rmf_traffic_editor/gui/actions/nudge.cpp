@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+
+#include "nudge.h"
+
+using std::vector;
+
+NudgeCommand::NudgeCommand(
+  Building* building,
+  int level_idx,
+  double dx,
+  double dy)
+: _building(building),
+  _level_idx(level_idx),
+  _dx(dx),
+  _dy(dy)
+{
+  setText("Nudge selection");
+
+  const Level& level = _building->levels[_level_idx];
+  const SelectionSet& selection = level.selection();
+
+  _vertices = selection.indices(SelectionSet::VERTEX);
+  for (const int edge_idx : selection.indices(SelectionSet::EDGE))
+  {
+    _vertices.push_back(level.edges[edge_idx].start_idx);
+    _vertices.push_back(level.edges[edge_idx].end_idx);
+  }
+  for (const int polygon_idx : selection.indices(SelectionSet::POLYGON))
+  {
+    const Polygon& polygon = level.polygons[polygon_idx];
+    _vertices.insert(
+      _vertices.end(),
+      polygon.vertices.begin(),
+      polygon.vertices.end());
+  }
+  std::sort(_vertices.begin(), _vertices.end());
+  _vertices.erase(
+    std::unique(_vertices.begin(), _vertices.end()),
+    _vertices.end());
+
+  _models = selection.indices(SelectionSet::MODEL);
+  _fiducials = selection.indices(SelectionSet::FIDUCIAL);
+
+  for (const SelectionSet::Item& item : selection.items())
+  {
+    if (item.type == SelectionSet::FEATURE)
+      _features.push_back(std::make_pair(item.layer_idx, item.idx));
+  }
+  std::sort(_features.begin(), _features.end());
+}
+
+NudgeCommand::~NudgeCommand()
+{
+}
+
+void NudgeCommand::undo()
+{
+  move(-_dx, -_dy);
+}
+
+void NudgeCommand::redo()
+{
+  move(_dx, _dy);
+}
+
+int NudgeCommand::id() const
+{
+  return 1;  // only nudges merge with each other
+}
+
+bool NudgeCommand::mergeWith(const QUndoCommand* other)
+{
+  const NudgeCommand* nudge = static_cast<const NudgeCommand*>(other);
+  if (nudge->_building != _building ||
+    nudge->_level_idx != _level_idx ||
+    nudge->_vertices != _vertices ||
+    nudge->_models != _models ||
+    nudge->_fiducials != _fiducials ||
+    nudge->_features != _features)
+    return false;
+  _dx += nudge->_dx;
+  _dy += nudge->_dy;
+  return true;
+}
+
+bool NudgeCommand::empty() const
+{
+  return _vertices.empty() &&
+    _models.empty() &&
+    _fiducials.empty() &&
+    _features.empty();
+}
+
+bool NudgeCommand::models_only() const
+{
+  return !_models.empty() &&
+    _vertices.empty() &&
+    _fiducials.empty() &&
+    _features.empty();
+}
+
+void NudgeCommand::move(const double dx, const double dy)
+{
+  Level& level = _building->levels[_level_idx];
+  const int num_vertices = static_cast<int>(level.vertices.size());
+
+  for (const int vertex_idx : _vertices)
+  {
+    if (vertex_idx < 0 || vertex_idx >= num_vertices)
+      continue;
+    level.vertices[vertex_idx].x += dx;
+    level.vertices[vertex_idx].y += dy;
+  }
+
+  for (const int model_idx : _models)
+  {
+    level.models[model_idx].state.x += dx;
+    level.models[model_idx].state.y += dy;
+  }
+
+  for (const int fiducial_idx : _fiducials)
+  {
+    level.fiducials[fiducial_idx].x += dx;
+    level.fiducials[fiducial_idx].y += dy;
+  }
+
+  // floorplan features are in level coordinates, but layer features are
+  // in the pixels of their layer image, so move them through its transform
+  const double mpp = level.drawing_meters_per_pixel;
+  for (const auto& it : _features)
+  {
+    if (it.first == 0)
+    {
+      Feature& feature = level.floorplan_features[it.second];
+      feature.set_x(feature.x() + dx);
+      feature.set_y(feature.y() + dy);
+      continue;
+    }
+    Layer& layer = level.layers[it.first - 1];
+    Feature& feature = layer.features[it.second];
+    const QPointF p_meters =
+      layer.transform.forwards(QPointF(feature.x(), feature.y())) +
+      QPointF(dx * mpp, dy * mpp);
+    const QPointF q = layer.transform.backwards(p_meters);
+    feature.set_x(q.x());
+    feature.set_y(q.y());
+  }
+}
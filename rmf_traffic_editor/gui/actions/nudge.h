@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef _NUDGE_H_
+#define _NUDGE_H_
+
+#include <utility>
+#include <vector>
+
+#include <QUndoCommand>
+#include "building.h"
+
+/*
+ * Moves everything selected on a level by a small offset, as with the
+ * arrow keys. Vertices of selected edges and polygons move along with
+ * them. Consecutive nudges of the same selection merge into a single
+ * undo step, however many times the key repeats.
+ */
+
+class NudgeCommand : public QUndoCommand
+{
+public:
+  // offset in level coordinates (pixels)
+  NudgeCommand(Building* building, int level_idx, double dx, double dy);
+  virtual ~NudgeCommand();
+
+  void undo() override;
+  void redo() override;
+  int id() const override;
+  bool mergeWith(const QUndoCommand* other) override;
+
+  bool empty() const;
+
+  // true if only models are moved, whose graphics items can simply be
+  // moved in place instead of redrawing the scene
+  bool models_only() const;
+  const std::vector<int>& models() const { return _models; }
+
+private:
+  Building* _building;
+  int _level_idx;
+  double _dx, _dy;
+
+  std::vector<int> _vertices;
+  std::vector<int> _models;
+  std::vector<int> _fiducials;
+  std::vector<std::pair<int, int>> _features;  // (layer number, index)
+
+  void move(const double dx, const double dy);
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <QtWidgets>
+
+#include "auto_lane_dialog.h"
+
+
+AutoLaneDialog::AutoLaneDialog(
+  QWidget* parent,
+  const Level& level,
+  LaneProposal& _proposal)
+: QDialog(parent), proposal(_proposal)
+{
+  setWindowTitle("Propose Lanes");
+  ok_button = new QPushButton("OK", this);  // first button = [enter] button
+  cancel_button = new QPushButton("Cancel", this);
+
+  QHBoxLayout* layer_hbox = new QHBoxLayout;
+  layer_hbox->addWidget(new QLabel("Occupancy layer:"));
+  layer_combo_box = new QComboBox(this);
+  for (const auto& layer : level.layers)
+    layer_combo_box->addItem(QString::fromStdString(layer.name));
+  if (proposal.layer_idx >= 0 &&
+    proposal.layer_idx < static_cast<int>(level.layers.size()))
+    layer_combo_box->setCurrentIndex(proposal.layer_idx);
+  layer_hbox->addWidget(layer_combo_box);
+
+  QHBoxLayout* free_threshold_hbox = new QHBoxLayout;
+  free_threshold_hbox->addWidget(new QLabel("Free space threshold:"));
+  free_threshold_spin_box = new QSpinBox(this);
+  free_threshold_spin_box->setRange(1, 255);
+  free_threshold_spin_box->setValue(proposal.free_threshold);
+  free_threshold_hbox->addWidget(free_threshold_spin_box);
+
+  QHBoxLayout* clearance_hbox = new QHBoxLayout;
+  clearance_hbox->addWidget(new QLabel("Minimum clearance (m):"));
+  clearance_spin_box = new QDoubleSpinBox(this);
+  clearance_spin_box->setDecimals(2);
+  clearance_spin_box->setRange(0.0, 10.0);
+  clearance_spin_box->setSingleStep(0.05);
+  clearance_spin_box->setValue(proposal.min_clearance);
+  clearance_hbox->addWidget(clearance_spin_box);
+
+  QHBoxLayout* branch_length_hbox = new QHBoxLayout;
+  branch_length_hbox->addWidget(new QLabel("Minimum dead end length (m):"));
+  branch_length_spin_box = new QDoubleSpinBox(this);
+  branch_length_spin_box->setDecimals(2);
+  branch_length_spin_box->setRange(0.0, 100.0);
+  branch_length_spin_box->setSingleStep(0.1);
+  branch_length_spin_box->setValue(proposal.min_branch_length);
+  branch_length_hbox->addWidget(branch_length_spin_box);
+
+  QHBoxLayout* tolerance_hbox = new QHBoxLayout;
+  tolerance_hbox->addWidget(new QLabel("Simplification tolerance (m):"));
+  tolerance_spin_box = new QDoubleSpinBox(this);
+  tolerance_spin_box->setDecimals(2);
+  tolerance_spin_box->setRange(0.0, 10.0);
+  tolerance_spin_box->setSingleStep(0.05);
+  tolerance_spin_box->setValue(proposal.simplify_tolerance);
+  tolerance_hbox->addWidget(tolerance_spin_box);
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(cancel_button);
+  bottom_buttons_hbox->addWidget(ok_button);
+  connect(
+    ok_button, &QAbstractButton::clicked,
+    this, &AutoLaneDialog::ok_button_clicked);
+  connect(
+    cancel_button, &QAbstractButton::clicked,
+    this, &QDialog::reject);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(layer_hbox);
+  top_vbox->addLayout(free_threshold_hbox);
+  top_vbox->addLayout(clearance_hbox);
+  top_vbox->addLayout(branch_length_hbox);
+  top_vbox->addLayout(tolerance_hbox);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+}
+
+AutoLaneDialog::~AutoLaneDialog()
+{
+}
+
+void AutoLaneDialog::ok_button_clicked()
+{
+  proposal.layer_idx = layer_combo_box->currentIndex();
+  proposal.free_threshold = free_threshold_spin_box->value();
+  proposal.min_clearance = clearance_spin_box->value();
+  proposal.min_branch_length = branch_length_spin_box->value();
+  proposal.simplify_tolerance = tolerance_spin_box->value();
+  accept();
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef AUTO_LANE_DIALOG_H
+#define AUTO_LANE_DIALOG_H
+
+#include <QDialog>
+
+#include "lane_proposal.h"
+#include "level.h"
+class QComboBox;
+class QDoubleSpinBox;
+class QSpinBox;
+
+
+class AutoLaneDialog : public QDialog
+{
+public:
+  AutoLaneDialog(QWidget* parent, const Level& level, LaneProposal& proposal);
+  ~AutoLaneDialog();
+
+private:
+  LaneProposal& proposal;
+
+  QComboBox* layer_combo_box;
+  QSpinBox* free_threshold_spin_box;
+  QDoubleSpinBox* clearance_spin_box;
+  QDoubleSpinBox* branch_length_spin_box;
+  QDoubleSpinBox* tolerance_spin_box;
+  QPushButton* ok_button, * cancel_button;
+
+private slots:
+  void ok_button_clicked();
+};
+
+#endif
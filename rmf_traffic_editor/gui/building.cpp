@@ -17,7 +17,9 @@
 
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <yaml-cpp/yaml.h>
 
@@ -28,6 +30,7 @@
 #include <QElapsedTimer>
 
 #include "building.h"
+#include "gzip_stream.h"
 #include "yaml_utils.h"
 
 using std::string;
@@ -51,7 +54,7 @@ Building::~Building()
 ///
 /// This function replaces the contents of this object with what is
 /// in the YAML file.
-bool Building::load(const string& _filename)
+bool Building::load(const string& _filename, const bool load_images)
 {
   printf("Building::load(%s)\n", _filename.c_str());
   filename = _filename;
@@ -68,7 +71,27 @@ bool Building::load(const string& _filename)
   YAML::Node y;
   try
   {
-    y = YAML::LoadFile(filename.c_str());
+    if (GzipStreamBuf::is_gzip_filename(filename))
+    {
+      // decompress straight into the parser
+      GzipIStream in(filename);
+      if (!in)
+      {
+        printf("couldn't open %s\n", filename.c_str());
+        return false;
+      }
+      y = YAML::Load(in);
+      if (!in.error().empty())
+      {
+        printf(
+          "couldn't read %s: %s\n",
+          filename.c_str(),
+          in.error().c_str());
+        return false;
+      }
+    }
+    else
+      y = YAML::LoadFile(filename.c_str());
   }
   catch (const std::exception& e)
   {
@@ -123,13 +146,18 @@ bool Building::load(const string& _filename)
   for (YAML::const_iterator it = yl.begin(); it != yl.end(); ++it)
   {
     Level level;
-    level.from_yaml(it->first.as<string>(), it->second, coordinate_system);
+    level.from_yaml(
+      it->first.as<string>(),
+      it->second,
+      coordinate_system,
+      load_images);
     levels.push_back(level);
   }
 
-  QtConcurrent::blockingMap(
-    levels,
-    [&](auto& level) { level.load_drawing(); });
+  if (load_images)
+    QtConcurrent::blockingMap(
+      levels,
+      [&](auto& level) { level.load_drawing(); });
 
   // now that all images are loaded, we can calculate scale for annotated
   // measurement lanes
@@ -143,7 +171,7 @@ bool Building::load(const string& _filename)
     for (YAML::const_iterator it = y_lifts.begin(); it != y_lifts.end(); ++it)
     {
       Lift lift;
-      lift.from_yaml(it->first.as<string>(), it->second, levels);
+      lift.from_yaml(it->first.as<string>(), it->second);
       lifts.push_back(lift);
     }
   }
@@ -159,6 +187,10 @@ bool Building::load(const string& _filename)
     }
   }
 
+  update_symbols();
+  for (auto& lift : lifts)
+    update_lift_elevations(lift);
+
   if (y["parameters"] && y["parameters"].IsMap())
   {
     const YAML::Node& gp = y["parameters"];
@@ -174,56 +206,250 @@ bool Building::load(const string& _filename)
   return true;
 }
 
-bool Building::save()
+bool Building::save(const bool parallel)
 {
   printf("Building::save_yaml(%s)\n", filename.c_str());
 
-  YAML::Node y;
-  y["name"] = name;
+  QElapsedTimer timer;
+  timer.start();
 
-  y["coordinate_system"] = coordinate_system.to_string();
+  // Every top-level entry, and every level and lift within theirs, is
+  // built and emitted as its own chunk of text, all concurrently. Block
+  // map entries are emitted independently of each other, so joining the
+  // chunks in sorted key order gives the same bytes as emitting the whole
+  // tree at once.
+  struct Chunk
+  {
+    string key;
+    bool nested = false;  // if so, it's the child_key entry under key
+    string child_key;
+    std::function<YAML::Node()> build;
+    string text;
+    YAML::Node node;  // nested entries keep theirs, for the fallback below
+  };
+  vector<Chunk> chunks;
+  auto add_chunk =
+    [&chunks](
+    const string& key,
+    const string* child_key,
+    std::function<YAML::Node()> build)
+    {
+      Chunk chunk;
+      chunk.key = key;
+      chunk.nested = child_key != nullptr;
+      if (child_key)
+        chunk.child_key = *child_key;
+      chunk.build = build;
+      chunks.push_back(chunk);
+    };
+
+  add_chunk("name", nullptr, [this]() { return YAML::Node(name); });
+
+  const string coordinate_system_name = coordinate_system.to_string();
+  add_chunk(
+    "coordinate_system",
+    nullptr,
+    [coordinate_system_name]() { return YAML::Node(coordinate_system_name); });
 
   if (!reference_level_name.empty())
-    y["reference_level_name"] = reference_level_name;
+    add_chunk(
+      "reference_level_name",
+      nullptr,
+      [this]() { return YAML::Node(reference_level_name); });
 
-  y["levels"] = YAML::Node(YAML::NodeType::Map);
+  // if a name is used twice, only the last one is saved
+  std::map<string, const Level*> levels_by_name;
   for (const auto& level : levels)
-    y["levels"][level.name] = level.to_yaml(coordinate_system);
+    levels_by_name[level.name] = &level;
+  if (levels_by_name.empty())
+    add_chunk(
+      "levels",
+      nullptr,
+      []() { return YAML::Node(YAML::NodeType::Map); });
+  for (const auto& it : levels_by_name)
+  {
+    const Level* level = it.second;
+    const CoordinateSystem* cs = &coordinate_system;
+    add_chunk(
+      "levels",
+      &it.first,
+      [level, cs]() { return level->to_yaml(*cs); });
+  }
 
-  y["lifts"] = YAML::Node(YAML::NodeType::Map);
+  std::map<string, const Lift*> lifts_by_name;
   for (const auto& lift : lifts)
-    y["lifts"][lift.name] = lift.to_yaml();
-  if (lifts.empty())
-    y["lifts"].SetStyle(YAML::EmitterStyle::Flow);
+    lifts_by_name[lift.name] = &lift;
+  if (lifts_by_name.empty())
+    add_chunk(
+      "lifts",
+      nullptr,
+      []()
+      {
+        YAML::Node y(YAML::NodeType::Map);
+        y.SetStyle(YAML::EmitterStyle::Flow);
+        return y;
+      });
+  for (const auto& it : lifts_by_name)
+  {
+    const Lift* lift = it.second;
+    add_chunk("lifts", &it.first, [lift]() { return lift->to_yaml(); });
+  }
 
   if (crowd_sim_impl)
-    y["crowd_sim"] = crowd_sim_impl->to_yaml();
+  {
+    crowd_sim::CrowdSimImplPtr impl = crowd_sim_impl;
+    add_chunk("crowd_sim", nullptr, [impl]() { return impl->to_yaml(); });
+  }
 
-  y["graphs"] = YAML::Node(YAML::NodeType::Map);
-  for (const auto& graph : graphs)
-    y["graphs"][graph.idx] = graph.to_yaml();
+  add_chunk(
+    "graphs",
+    nullptr,
+    [this]()
+    {
+      YAML::Node y(YAML::NodeType::Map);
+      for (const auto& graph : graphs)
+        y[graph.idx] = graph.to_yaml();
+      return y;
+    });
 
   if (!params.empty())
   {
-    YAML::Node params_node(YAML::NodeType::Map);
-    for (const auto& param : params)
-      params_node[param.first] = param.second.to_yaml();
-    y["parameters"] = params_node;
+    add_chunk(
+      "parameters",
+      nullptr,
+      [this]()
+      {
+        YAML::Node y(YAML::NodeType::Map);
+        for (const auto& param : params)
+          y[param.first] = param.second.to_yaml();
+        return y;
+      });
   }
 
-  YAML::Emitter emitter;
-  yaml_utils::write_node(y, emitter);
-  std::ofstream fout(filename);
+  auto emit_chunk = [](Chunk& chunk)
+    {
+      const YAML::Node value = chunk.build();
+      if (!chunk.nested)
+        chunk.text = yaml_utils::write_entry(chunk.key, value);
+      else
+      {
+        chunk.text =
+          yaml_utils::write_nested_entry(chunk.key, chunk.child_key, value);
+        chunk.node = value;
+      }
+    };
+
+  // converting to WGS84 goes through a single PJ, which can only be used
+  // by one thread at a time
+  if (parallel && !coordinate_system.is_global())
+    QtConcurrent::blockingMap(chunks, emit_chunk);
+  else
+    std::for_each(chunks.begin(), chunks.end(), emit_chunk);
+
+  std::stable_sort(
+    chunks.begin(),
+    chunks.end(),
+    [](const Chunk& a, const Chunk& b)
+    {
+      if (a.key != b.key)
+        return a.key < b.key;
+      return a.child_key < b.child_key;
+    });
+
+  // the chunks are written out one by one, rather than joined first, so
+  // a compressed file never has the whole text in memory
+  const bool compressed = GzipStreamBuf::is_gzip_filename(filename);
+  std::ofstream plain_out;
+  GzipOStream compressed_out;
+  if (compressed)
+    compressed_out.open(filename);
+  else
+    plain_out.open(filename);
+  std::ostream& fout =
+    compressed ?
+    static_cast<std::ostream&>(compressed_out) :
+    static_cast<std::ostream&>(plain_out);
   if (!fout)
   {
     printf("unable to open %s\n", filename.c_str());
     return false;
   }
-  fout << emitter.c_str() << std::endl;
 
+  for (std::size_t i = 0; i < chunks.size(); )
+  {
+    if (i > 0)
+      fout << "\n";
+
+    const Chunk& chunk = chunks[i];
+    if (!chunk.nested)
+    {
+      fout << chunk.text;
+      i++;
+      continue;
+    }
+
+    std::size_t end = i;
+    bool nested_ok = true;
+    while (end < chunks.size() && chunks[end].key == chunk.key)
+      nested_ok = nested_ok && !chunks[end++].text.empty();
+
+    if (nested_ok)
+    {
+      fout << chunk.key << ":";
+      for (std::size_t j = i; j < end; j++)
+        fout << "\n" << chunks[j].text;
+    }
+    else
+    {
+      // not emitted as a block map, so emit the whole map in one piece
+      YAML::Node map(YAML::NodeType::Map);
+      for (std::size_t j = i; j < end; j++)
+        map[chunks[j].child_key] = chunks[j].node;
+      fout << yaml_utils::write_entry(chunk.key, map);
+    }
+    i = end;
+  }
+
+  fout << std::endl;
+
+  if (compressed)
+    compressed_out.close();
+  else
+    plain_out.close();
+  if (!fout)
+  {
+    printf("error while writing %s\n", filename.c_str());
+    return false;
+  }
+
+  printf("saved %d levels in %.3f seconds\n",
+    static_cast<int>(levels.size()),
+    static_cast<double>(timer.elapsed()) / 1000.0);
   return true;
 }
 
+std::shared_ptr<Building> Building::snapshot() const
+{
+  // not a copy constructor, since the coordinate system owns PROJ handles
+  auto building = std::make_shared<Building>();
+  building->name = name;
+  building->reference_level_name = reference_level_name;
+  building->levels.reserve(levels.size());
+  for (const auto& level : levels)
+    building->levels.push_back(level.snapshot());
+  building->lifts = lifts;
+  building->graphs = graphs;
+  building->params = params;
+  building->coordinate_system.value = coordinate_system.value;
+  if (crowd_sim_impl)
+    building->crowd_sim_impl =
+      std::make_shared<crowd_sim::CrowdSimImplementation>(*crowd_sim_impl);
+  building->transforms = transforms;
+  building->filename = filename;
+  building->update_symbols();
+  return building;
+}
+
 bool Building::export_features(
   int level_index,
   const std::string& dest_filename) const
@@ -385,18 +611,18 @@ void Building::clear()
   reference_level_name.clear();
   levels.clear();
   lifts.clear();
+  graphs.clear();
+  update_symbols();
   clear_transform_cache();
 }
 
 void Building::add_level(const Level& new_level)
 {
   // make sure we don't have this level already
-  for (const auto& level : levels)
-  {
-    if (level.name == new_level.name)
-      return;
-  }
+  if (find_level(new_level.name) >= 0)
+    return;
   levels.push_back(new_level);
+  update_symbols();
 }
 
 void Building::draw_lifts(QGraphicsScene* scene, const int level_idx)
@@ -404,17 +630,7 @@ void Building::draw_lifts(QGraphicsScene* scene, const int level_idx)
   const Level& level = levels[level_idx];
   for (const auto& lift : lifts)
   {
-    // find the level index referenced by the lift
-    int reference_floor_idx = -1;
-    for (std::size_t i = 0; i < levels.size(); i++)
-    {
-      if (levels[i].name == lift.reference_floor_name)
-      {
-        reference_floor_idx = static_cast<int>(i);
-        break;
-      }
-    }
-
+    const int reference_floor_idx = find_level(lift.reference_floor_name);
     Transform t;
     if (reference_floor_idx >= 0)
       t = get_transform(reference_floor_idx, level_idx);
@@ -437,15 +653,8 @@ bool Building::transform_between_levels(
   const std::string& to_level_name,
   QPointF& to_point)
 {
-  int from_level_idx = -1;
-  int to_level_idx = -1;
-  for (std::size_t i = 0; i < levels.size(); i++)
-  {
-    if (levels[i].name == from_level_name)
-      from_level_idx = i;
-    if (levels[i].name == to_level_name)
-      to_level_idx = i;
-  }
+  const int from_level_idx = find_level(from_level_name);
+  const int to_level_idx = find_level(to_level_name);
   if (from_level_idx < 0 || to_level_idx < 0)
   {
     to_point = from_point;
@@ -481,11 +690,42 @@ bool Building::transform_between_levels(
   return true;
 }
 
+QTransform Building::meters_to_level(const int level_idx)
+{
+  // image-based maps are scaled and flipped into the reference level, and
+  // transformed into the other levels from there; others are in meters
+  if (!coordinate_system.is_y_flipped() ||
+    level_idx < 0 ||
+    level_idx >= static_cast<int>(levels.size()))
+    return QTransform();
+
+  int ref_idx = get_reference_level_idx();
+  if (ref_idx < 0 || ref_idx >= static_cast<int>(levels.size()))
+    ref_idx = level_idx;
+  const double scale = levels[ref_idx].drawing_meters_per_pixel;
+  if (scale <= 0.0)
+    return QTransform();
+
+  const Transform t = get_transform(ref_idx, level_idx);
+  return QTransform(
+    t.scale / scale, 0.0,
+    0.0, -t.scale / scale,
+    t.dx, t.dy);
+}
+
 void Building::clear_transform_cache()
 {
   transforms.clear();
 }
 
+std::size_t Building::transform_cache_bytes() const
+{
+  // roughly a std::map node: three pointers and a color, then the pair
+  const std::size_t node_bytes =
+    4 * sizeof(void*) + sizeof(TransformMap::value_type);
+  return transforms.size() * node_bytes;
+}
+
 Building::Transform Building::compute_transform(
   const int from_level_idx,
   const int to_level_idx)
@@ -504,15 +744,16 @@ Building::Transform Building::compute_transform(
   const Level& from_level = levels[from_level_idx];
   const Level& to_level = levels[to_level_idx];
 
-  // assemble a vector of fudicials in common to these levels
-  vector<std::pair<Fiducial, Fiducial>> fiducials;
+  // assemble a vector of fudicials in common to these levels, pointing at
+  // them rather than copying them (and their names)
+  vector<std::pair<const Fiducial*, const Fiducial*>> fiducials;
   for (const Fiducial& f0 : from_level.fiducials)
   {
     for (const Fiducial& f1 : to_level.fiducials)
     {
       if (f0.name == f1.name)
       {
-        fiducials.push_back(make_pair(f0, f1));
+        fiducials.push_back(make_pair(&f0, &f1));
         break;
       }
     }
@@ -520,14 +761,15 @@ Building::Transform Building::compute_transform(
 
   // calculate the distances between each fiducial on their levels
   vector<std::pair<double, double>> distances;
+  distances.reserve(fiducials.size() * (fiducials.size() - 1) / 2);
   for (std::size_t f0_idx = 0; f0_idx < fiducials.size(); f0_idx++)
   {
     for (std::size_t f1_idx = f0_idx + 1; f1_idx < fiducials.size(); f1_idx++)
     {
       distances.push_back(
         make_pair(
-          fiducials[f0_idx].first.distance(fiducials[f1_idx].first),
-          fiducials[f0_idx].second.distance(fiducials[f1_idx].second)));
+          fiducials[f0_idx].first->distance(*fiducials[f1_idx].first),
+          fiducials[f0_idx].second->distance(*fiducials[f1_idx].second)));
     }
   }
 
@@ -547,8 +789,8 @@ Building::Transform Building::compute_transform(
   double trans_y_sum = 0;
   for (const auto& fiducial : fiducials)
   {
-    trans_x_sum += fiducial.second.x - fiducial.first.x * scale;
-    trans_y_sum += fiducial.second.y - fiducial.first.y * scale;
+    trans_x_sum += fiducial.second->x - fiducial.first->x * scale;
+    trans_y_sum += fiducial.second->y - fiducial.first->y * scale;
   }
   const double trans_x = trans_x_sum / fiducials.size();
   const double trans_y = trans_y_sum / fiducials.size();
@@ -625,12 +867,8 @@ int Building::get_reference_level_idx()
 {
   if (reference_level_name.empty())
     return 0;
-  for (std::size_t i = 0; i < levels.size(); i++)
-  {
-    if (levels[i].name == reference_level_name)
-      return static_cast<int>(i);
-  }
-  return 0;
+  const int idx = find_level(reference_level_name);
+  return idx >= 0 ? idx : 0;
 }
 
 void Building::clear_scene()
@@ -641,12 +879,102 @@ void Building::clear_scene()
 
 double Building::level_meters_per_pixel(const string& level_name) const
 {
-  for (const auto& level : levels)
+  const int idx = find_level(level_name);
+  if (idx >= 0)
+    return levels[idx].drawing_meters_per_pixel;
+  return 0.05;  // just a somewhat sane default
+}
+
+int Building::find_level(const string& level_name) const
+{
+  if (symbols_stale())
+    rebuild_symbols();
+  int idx = symbols.level(level_name);
+  if (idx >= 0 && levels[idx].name != level_name)
   {
-    if (level.name == level_name)
-      return level.drawing_meters_per_pixel;
+    // something was renamed behind our back
+    rebuild_symbols();
+    idx = symbols.level(level_name);
   }
-  return 0.05;  // just a somewhat sane default
+  return idx;
+}
+
+int Building::find_lift(const string& lift_name) const
+{
+  if (symbols_stale())
+    rebuild_symbols();
+  int idx = symbols.lift(lift_name);
+  if (idx >= 0 && lifts[idx].name != lift_name)
+  {
+    rebuild_symbols();
+    idx = symbols.lift(lift_name);
+  }
+  return idx;
+}
+
+const Graph* Building::find_graph(const int graph_idx) const
+{
+  if (symbols_stale())
+    rebuild_symbols();
+  int idx = symbols.graph(graph_idx);
+  if (idx >= 0 && graphs[idx].idx != graph_idx)
+  {
+    rebuild_symbols();
+    idx = symbols.graph(graph_idx);
+  }
+  return idx >= 0 ? &graphs[idx] : nullptr;
+}
+
+bool Building::lift_door_opens(
+  const Lift& lift,
+  const int level_idx,
+  const string& door_name) const
+{
+  const Level& level = levels[level_idx];
+  const int lift_idx = find_lift(lift.name);
+  if (lift_idx < 0 || &lifts[lift_idx] != &lift)
+  {
+    // a lift which hasn't been added to the building yet
+    return lift.level_door_opens(level.name, door_name, level.elevation);
+  }
+  if (level.elevation < lift.lowest_elevation ||
+    level.elevation > lift.highest_elevation)
+    return false;
+  return symbols.lift_door_opens(lift_idx, level_idx, door_name);
+}
+
+void Building::update_symbols()
+{
+  rebuild_symbols();
+}
+
+void Building::rebuild_symbols() const
+{
+  symbols.rebuild(levels, lifts, graphs);
+  symbols_num_levels = levels.size();
+  symbols_num_lifts = lifts.size();
+  symbols_num_graphs = graphs.size();
+}
+
+bool Building::symbols_stale() const
+{
+  // catches additions and deletions which didn't call update_symbols().
+  // Renames can't be detected this cheaply, which is why they must.
+  return symbols_num_levels != levels.size() ||
+    symbols_num_lifts != lifts.size() ||
+    symbols_num_graphs != graphs.size();
+}
+
+void Building::update_lift_elevations(Lift& lift) const
+{
+  lift.highest_elevation = DBL_MAX;
+  lift.lowest_elevation = -DBL_MAX;
+  const int highest_idx = find_level(lift.highest_floor);
+  if (highest_idx >= 0)
+    lift.highest_elevation = levels[highest_idx].elevation;
+  const int lowest_idx = find_level(lift.lowest_floor);
+  if (lowest_idx >= 0)
+    lift.lowest_elevation = levels[lowest_idx].elevation;
 }
 
 void Building::rotate_all_models(const double rotation)
@@ -662,7 +990,11 @@ void Building::rotate_all_models(const double rotation)
 
 bool Building::set_filename(const std::string& _fn)
 {
-  const string suffix(".building.yaml");
+  // gzip-compressed building files are saved compressed
+  const string suffix(
+    GzipStreamBuf::is_gzip_filename(_fn) ?
+    ".building.yaml.gz" :
+    ".building.yaml");
 
   // ensure there is at least one character in addition to the suffix length
   if (_fn.size() <= suffix.size())
@@ -671,7 +1003,7 @@ bool Building::set_filename(const std::string& _fn)
     return false;
   }
 
-  // ensure the filename ends in .building.yaml
+  // ensure the filename ends in .building.yaml (or .building.yaml.gz)
   // it should, because the "save as" dialog appends it, but...
   if (_fn.compare(_fn.size() - suffix.size(), suffix.size(), suffix))
   {
@@ -748,12 +1080,11 @@ void Building::draw(
 
 Polygon* Building::get_selected_polygon(const int level_idx)
 {
-  for (std::size_t i = 0; i < levels[level_idx].polygons.size(); i++)
-  {
-    if (levels[level_idx].polygons[i].selected)
-      return &levels[level_idx].polygons[i];// abomination
-  }
-  return nullptr;
+  const int polygon_idx =
+    levels[level_idx].first_selected(SelectionSet::POLYGON);
+  if (polygon_idx < 0)
+    return nullptr;
+  return &levels[level_idx].polygons[polygon_idx];// abomination
 }
 
 Polygon::EdgeDragPolygon Building::polygon_edge_drag_press(
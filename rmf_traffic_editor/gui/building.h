@@ -28,6 +28,7 @@ class QGraphicsScene;
 
 #include <QGraphicsLineItem>
 #include <QPointF>
+#include <QTransform>
 
 #include "coordinate_system.h"
 #include "graph.h"
@@ -36,6 +37,7 @@ class QGraphicsScene;
 #include "param.h"
 #include <traffic_editor/crowd_sim/crowd_sim_impl.h>
 #include "rendering_options.h"
+#include "symbol_table.h"
 
 class Building
 {
@@ -56,10 +58,18 @@ public:
   bool set_filename(const std::string& _filename);
   std::string get_filename() { return filename; }
 
-  bool load(const std::string& filename);
-  bool save();
+  // images (drawings and layers) can be skipped when only the annotations
+  // are wanted, which also means that loading doesn't need a display
+  bool load(const std::string& filename, const bool load_images = true);
+  // levels and lifts are emitted concurrently unless parallel is false
+  // (or the coordinate system is global, since PROJ isn't thread safe)
+  bool save(const bool parallel = true);
   void clear();  // clear all internal data structures
 
+  // a copy which can be saved on another thread while this one is edited;
+  // like Level::snapshot(), it has no images
+  std::shared_ptr<Building> snapshot() const;
+
   bool export_features(
     int level_index,
     const std::string& dest_filename) const;
@@ -128,7 +138,12 @@ public:
     const int to_level_idx,
     QPointF& to_point);
 
+  // maps the meters that the editor shows vertex coordinates in (which
+  // are in the frame of the reference level) to a level's coordinates
+  QTransform meters_to_level(const int level_idx);
+
   void clear_transform_cache();
+  std::size_t transform_cache_bytes() const;
 
   struct LevelPair
   {
@@ -167,6 +182,27 @@ public:
 
   double level_meters_per_pixel(const std::string& level_name) const;
 
+  // O(1) lookups by name (or by graph index); these return -1 or nullptr
+  // if there is no such level, lift or graph
+  int find_level(const std::string& level_name) const;
+  int find_lift(const std::string& lift_name) const;
+  const Graph* find_graph(const int graph_idx) const;
+
+  // whether the lift's door opens on the level, looked up in the symbol
+  // table rather than the lift's door lists
+  bool lift_door_opens(
+    const Lift& lift,
+    const int level_idx,
+    const std::string& door_name) const;
+
+  // must be called after renaming a level or lift, after editing a lift's
+  // level doors, or after adding to or erasing from levels, lifts or graphs
+  // other than through this class
+  void update_symbols();
+
+  // resolve the lift's highest and lowest floor names to elevations
+  void update_lift_elevations(Lift& lift) const;
+
   void rotate_all_models(const double rotation);
 
   void get_selected_items(const int level_idx,
@@ -197,6 +233,15 @@ public:
 
 private:
   std::string filename;
+
+  // mutable so that lookups can repair it if it turns out to be stale
+  mutable SymbolTable symbols;
+  mutable std::size_t symbols_num_levels = 0;
+  mutable std::size_t symbols_num_lifts = 0;
+  mutable std::size_t symbols_num_graphs = 0;
+
+  void rebuild_symbols() const;
+  bool symbols_stale() const;
 };
 
 #endif
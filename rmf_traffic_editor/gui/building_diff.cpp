@@ -0,0 +1,1007 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+#include <QPainterPath>
+#include <QPen>
+
+#include "building_diff.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// A spatial hash which is just a sorted array of (cell, point) pairs, so
+// building it is one sort and the points of a cell are contiguous.
+class PointGrid
+{
+public:
+  PointGrid(const vector<QPointF>& _points, const double _cell_size)
+  : points(_points),
+    cell_size(_cell_size)
+  {
+    cells.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); i++)
+      cells.emplace_back(
+        key(cell(points[i].x()), cell(points[i].y())),
+        static_cast<int>(i));
+    std::sort(cells.begin(), cells.end());
+  }
+
+  // calls f(idx) for the points within radius of p (radius <= cell size)
+  template<typename F>
+  void for_each_near(const QPointF& p, const double radius, F f) const
+  {
+    const double radius_squared = radius * radius;
+    const int64_t x0 = cell(p.x() - radius), x1 = cell(p.x() + radius);
+    const int64_t y0 = cell(p.y() - radius), y1 = cell(p.y() + radius);
+    for (int64_t cx = x0; cx <= x1; cx++)
+    {
+      for (int64_t cy = y0; cy <= y1; cy++)
+      {
+        const uint64_t k = key(cx, cy);
+        auto it = std::lower_bound(
+          cells.begin(),
+          cells.end(),
+          std::make_pair(k, std::numeric_limits<int>::min()));
+        for (; it != cells.end() && it->first == k; ++it)
+        {
+          const QPointF d = points[it->second] - p;
+          if (d.x() * d.x() + d.y() * d.y() <= radius_squared)
+            f(it->second);
+        }
+      }
+    }
+  }
+
+private:
+  const vector<QPointF>& points;
+  const double cell_size;
+  vector<std::pair<uint64_t, int>> cells;
+
+  int64_t cell(const double v) const
+  {
+    const double c = std::floor(v / cell_size);
+    return static_cast<int64_t>(std::max(-2e9, std::min(2e9, c)));
+  }
+
+  static uint64_t key(const int64_t cx, const int64_t cy)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+           static_cast<uint32_t>(cy);
+  }
+};
+
+double squared_distance(const QPointF& a, const QPointF& b)
+{
+  const QPointF d = a - b;
+  return d.x() * d.x() + d.y() * d.y();
+}
+
+bool same_param(const Param& a, const Param& b)
+{
+  if (a.type != b.type)
+    return false;
+  switch (a.type)
+  {
+    case Param::STRING: return a.value_string == b.value_string;
+    case Param::INT: return a.value_int == b.value_int;
+    case Param::DOUBLE: return a.value_double == b.value_double;
+    case Param::BOOL: return a.value_bool == b.value_bool;
+    default: return true;
+  }
+}
+
+bool same_params(
+  const std::map<string, Param>& a,
+  const std::map<string, Param>& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (auto ait = a.begin(), bit = b.begin(); ait != a.end(); ++ait, ++bit)
+    if (ait->first != bit->first || !same_param(ait->second, bit->second))
+      return false;
+  return true;
+}
+
+// appends the names of the parameters which differ, as "params a, b"
+void describe_params(
+  const std::map<string, Param>& a,
+  const std::map<string, Param>& b,
+  vector<string>& differences)
+{
+  string names;
+  auto ait = a.begin();
+  auto bit = b.begin();
+  while (ait != a.end() || bit != b.end())
+  {
+    string name;
+    if (bit == b.end() || (ait != a.end() && ait->first < bit->first))
+      name = (ait++)->first;
+    else if (ait == a.end() || bit->first < ait->first)
+      name = (bit++)->first;
+    else
+    {
+      if (!same_param(ait->second, bit->second))
+        name = ait->first;
+      ++ait;
+      ++bit;
+    }
+    if (!name.empty())
+      names += (names.empty() ? "params " : ", ") + name;
+  }
+  if (!names.empty())
+    differences.push_back(names);
+}
+
+string join(const vector<string>& strings)
+{
+  string s;
+  for (const string& str : strings)
+    s += (s.empty() ? "" : "; ") + str;
+  return s;
+}
+
+string polygon_type_name(const Polygon::Type type)
+{
+  switch (type)
+  {
+    case Polygon::FLOOR: return "floor";
+    case Polygon::ZONE: return "zone";
+    case Polygon::ROI: return "roi";
+    case Polygon::HOLE: return "hole";
+    default: return "polygon";
+  }
+}
+
+/*
+ * Matches elements which are points: first those in the same place, then
+ * those with the same name, then the nearest identical ones within the
+ * move radius. Returns the index in "after" of each element of "before",
+ * or -1 if it has no match.
+ */
+template<typename T, typename PositionFn, typename NameFn, typename SameFn>
+vector<int> match_points(
+  const vector<T>& before,
+  const vector<T>& after,
+  PositionFn position,
+  NameFn name,
+  SameFn same,  // everything but the position
+  const double tolerance,
+  const double move_radius,
+  vector<QPointF>& before_points,
+  vector<QPointF>& after_points)
+{
+  before_points.resize(before.size());
+  for (std::size_t i = 0; i < before.size(); i++)
+    before_points[i] = position(before[i]);
+  after_points.resize(after.size());
+  for (std::size_t i = 0; i < after.size(); i++)
+    after_points[i] = position(after[i]);
+
+  vector<int> before_to_after(before.size(), -1);
+  vector<int> after_to_before(after.size(), -1);
+  auto match = [&](const int b, const int a)
+    {
+      before_to_after[b] = a;
+      after_to_before[a] = b;
+    };
+
+  // in the same place, preferring identical, then same-named elements
+  const PointGrid near_grid(before_points, tolerance);
+  for (std::size_t a = 0; a < after.size(); a++)
+  {
+    int best = -1;
+    std::pair<int, double> best_score(3, 0.0);
+    near_grid.for_each_near(
+      after_points[a],
+      tolerance,
+      [&](const int b)
+      {
+        if (before_to_after[b] >= 0)
+          return;
+        int tier = 2;
+        if (same(before[b], after[a]))
+          tier = 0;
+        else if (name(before[b]) == name(after[a]))
+          tier = 1;
+        const std::pair<int, double> score(
+          tier,
+          squared_distance(before_points[b], after_points[a]));
+        if (score < best_score)
+        {
+          best = b;
+          best_score = score;
+        }
+      });
+    if (best >= 0)
+      match(best, static_cast<int>(a));
+  }
+
+  // by name, if it's unique
+  std::unordered_map<string, int> named;
+  for (std::size_t b = 0; b < before.size(); b++)
+  {
+    if (before_to_after[b] >= 0 || name(before[b]).empty())
+      continue;
+    auto result = named.emplace(name(before[b]), static_cast<int>(b));
+    if (!result.second)
+      result.first->second = -1;
+  }
+  if (!named.empty())
+  {
+    for (std::size_t a = 0; a < after.size(); a++)
+    {
+      if (after_to_before[a] >= 0 || name(after[a]).empty())
+        continue;
+      auto it = named.find(name(after[a]));
+      if (it == named.end() || it->second < 0)
+        continue;
+      match(it->second, static_cast<int>(a));
+      it->second = -1;
+    }
+  }
+
+  // the nearest identical element within the move radius
+  const PointGrid move_grid(before_points, move_radius);
+  for (std::size_t a = 0; a < after.size(); a++)
+  {
+    if (after_to_before[a] >= 0)
+      continue;
+    int best = -1;
+    double best_distance = std::numeric_limits<double>::max();
+    move_grid.for_each_near(
+      after_points[a],
+      move_radius,
+      [&](const int b)
+      {
+        if (before_to_after[b] >= 0 || !same(before[b], after[a]))
+          return;
+        const double d = squared_distance(before_points[b], after_points[a]);
+        if (d < best_distance)
+        {
+          best = b;
+          best_distance = d;
+        }
+      });
+    if (best >= 0)
+      match(best, static_cast<int>(a));
+  }
+
+  return before_to_after;
+}
+
+class LevelComparison
+{
+public:
+  LevelComparison(
+    const Level& _before,
+    const Level& _after,
+    BuildingDiff::LevelDiff& _diff,
+    const double tolerance_meters,
+    const double move_radius_meters)
+  : before(_before),
+    after(_after),
+    diff(_diff)
+  {
+    const double mpp = after.drawing_meters_per_pixel > 0.0 ?
+      after.drawing_meters_per_pixel : 1.0;
+    tolerance = std::max(tolerance_meters / mpp, 1e-9);
+    move_radius = std::max(move_radius_meters / mpp, tolerance);
+  }
+
+  void compare()
+  {
+    compare_vertices();
+    compare_edges();
+    compare_polygons();
+    compare_models();
+    compare_fiducials();
+  }
+
+private:
+  const Level& before;
+  const Level& after;
+  BuildingDiff::LevelDiff& diff;
+  double tolerance = 0.0;
+  double move_radius = 0.0;
+
+  vector<int> vertex_map;  // before index to after index, or -1
+  vector<char> vertex_moved;  // by before index
+
+  void add(
+    const BuildingDiff::Kind kind,
+    const BuildingDiff::Change change,
+    const string& label,
+    const int before_idx,
+    const int after_idx,
+    QPolygonF before_shape,
+    QPolygonF after_shape,
+    const vector<string>& differences = vector<string>())
+  {
+    BuildingDiff::Element element;
+    element.kind = kind;
+    element.change = change;
+    element.label = label;
+    element.details = join(differences);
+    element.before_idx = before_idx;
+    element.after_idx = after_idx;
+    element.before_shape = std::move(before_shape);
+    element.after_shape = std::move(after_shape);
+    diff.elements.push_back(std::move(element));
+    diff.num_changes[change]++;
+  }
+
+  // reports each pair of matched points which differ, and the rest
+  template<typename T, typename LabelFn, typename DescribeFn>
+  void add_point_changes(
+    const BuildingDiff::Kind kind,
+    const vector<T>& before_elements,
+    const vector<T>& after_elements,
+    const vector<int>& before_to_after,
+    const vector<QPointF>& before_points,
+    const vector<QPointF>& after_points,
+    LabelFn label,
+    DescribeFn describe,  // appends what differs, besides the position
+    vector<char>* moved = nullptr)
+  {
+    const double tolerance_squared = tolerance * tolerance;
+    vector<char> after_matched(after_elements.size(), 0);
+    vector<string> differences;
+    for (std::size_t b = 0; b < before_elements.size(); b++)
+    {
+      const int a = before_to_after[b];
+      const QPolygonF before_shape(1, before_points[b]);
+      if (a < 0)
+      {
+        add(
+          kind,
+          BuildingDiff::REMOVED,
+          label(before_elements[b]),
+          b,
+          -1,
+          before_shape,
+          QPolygonF());
+        continue;
+      }
+      after_matched[a] = 1;
+
+      differences.clear();
+      describe(before_elements[b], after_elements[a], differences);
+      const bool is_moved = squared_distance(
+        before_points[b], after_points[a]) > tolerance_squared;
+      if (moved)
+        (*moved)[b] = is_moved;
+      if (is_moved || !differences.empty())
+        add(
+          kind,
+          is_moved ? BuildingDiff::MOVED : BuildingDiff::MODIFIED,
+          label(after_elements[a]),
+          b,
+          a,
+          before_shape,
+          QPolygonF(1, after_points[a]),
+          differences);
+    }
+    for (std::size_t a = 0; a < after_elements.size(); a++)
+    {
+      if (!after_matched[a])
+        add(
+          kind,
+          BuildingDiff::ADDED,
+          label(after_elements[a]),
+          -1,
+          a,
+          QPolygonF(),
+          QPolygonF(1, after_points[a]));
+    }
+  }
+
+  void compare_vertices()
+  {
+    vector<QPointF> before_points, after_points;
+    vertex_map = match_points(
+      before.vertices,
+      after.vertices,
+      [](const Vertex& v) { return QPointF(v.x, v.y); },
+      [](const Vertex& v) -> const string& { return v.name; },
+      [](const Vertex& b, const Vertex& a)
+      {
+        return b.name == a.name && same_params(b.params, a.params);
+      },
+      tolerance,
+      move_radius,
+      before_points,
+      after_points);
+
+    vertex_moved.assign(before.vertices.size(), 0);
+    add_point_changes(
+      BuildingDiff::VERTEX,
+      before.vertices,
+      after.vertices,
+      vertex_map,
+      before_points,
+      after_points,
+      [](const Vertex& v) { return v.name; },
+      [](const Vertex& b, const Vertex& a, vector<string>& differences)
+      {
+        if (b.name != a.name)
+          differences.push_back("name was \"" + b.name + "\"");
+        describe_params(b.params, a.params, differences);
+      },
+      &vertex_moved);
+  }
+
+  QPolygonF edge_shape(const Level& level, const Edge& edge) const
+  {
+    QPolygonF shape;
+    shape << QPointF(
+      level.vertices[edge.start_idx].x,
+      level.vertices[edge.start_idx].y);
+    shape << QPointF(
+      level.vertices[edge.end_idx].x,
+      level.vertices[edge.end_idx].y);
+    return shape;
+  }
+
+  static uint64_t edge_key(const int type, int v0, int v1)
+  {
+    if (v0 > v1)
+      std::swap(v0, v1);
+    return (static_cast<uint64_t>(type) << 58) |
+           (static_cast<uint64_t>(v0) << 29) |
+           static_cast<uint64_t>(v1);
+  }
+
+  bool valid_edge(const Level& level, const Edge& edge) const
+  {
+    const int n = static_cast<int>(level.vertices.size());
+    return edge.start_idx >= 0 && edge.start_idx < n &&
+           edge.end_idx >= 0 && edge.end_idx < n;
+  }
+
+  void compare_edges()
+  {
+    // after edges by their (unordered) vertices
+    vector<std::pair<uint64_t, int>> after_keys;
+    after_keys.reserve(after.edges.size());
+    for (std::size_t i = 0; i < after.edges.size(); i++)
+    {
+      const Edge& edge = after.edges[i];
+      if (valid_edge(after, edge))
+        after_keys.emplace_back(
+          edge_key(edge.type, edge.start_idx, edge.end_idx),
+          static_cast<int>(i));
+    }
+    std::sort(after_keys.begin(), after_keys.end());
+
+    vector<char> after_matched(after.edges.size(), 0);
+    vector<string> differences;
+    for (std::size_t b = 0; b < before.edges.size(); b++)
+    {
+      const Edge& edge = before.edges[b];
+      if (!valid_edge(before, edge))
+        continue;
+      const int v0 = vertex_map[edge.start_idx];
+      const int v1 = vertex_map[edge.end_idx];
+      int a = -1;
+      if (v0 >= 0 && v1 >= 0)
+      {
+        auto it = std::lower_bound(
+          after_keys.begin(),
+          after_keys.end(),
+          std::make_pair(edge_key(edge.type, v0, v1), -1));
+        for (; it != after_keys.end() &&
+          it->first == edge_key(edge.type, v0, v1); ++it)
+        {
+          if (!after_matched[it->second])
+          {
+            a = it->second;
+            break;
+          }
+        }
+      }
+      if (a < 0)
+      {
+        add(
+          BuildingDiff::EDGE,
+          BuildingDiff::REMOVED,
+          edge.type_to_string(),
+          b,
+          -1,
+          edge_shape(before, edge),
+          QPolygonF());
+        continue;
+      }
+      after_matched[a] = 1;
+
+      const Edge& after_edge = after.edges[a];
+      differences.clear();
+      if (after_edge.start_idx != v0 &&
+        !(edge.is_bidirectional() && after_edge.is_bidirectional()))
+        differences.push_back("reversed");
+      describe_params(edge.params, after_edge.params, differences);
+      const bool moved =
+        vertex_moved[edge.start_idx] || vertex_moved[edge.end_idx];
+      if (moved || !differences.empty())
+        add(
+          BuildingDiff::EDGE,
+          moved ? BuildingDiff::MOVED : BuildingDiff::MODIFIED,
+          after_edge.type_to_string(),
+          b,
+          a,
+          edge_shape(before, edge),
+          edge_shape(after, after_edge),
+          differences);
+    }
+
+    for (std::size_t a = 0; a < after.edges.size(); a++)
+    {
+      if (!after_matched[a] && valid_edge(after, after.edges[a]))
+        add(
+          BuildingDiff::EDGE,
+          BuildingDiff::ADDED,
+          after.edges[a].type_to_string(),
+          -1,
+          a,
+          QPolygonF(),
+          edge_shape(after, after.edges[a]));
+    }
+  }
+
+  QPolygonF polygon_shape(const Level& level, const Polygon& polygon) const
+  {
+    QPolygonF shape;
+    for (const int v : polygon.vertices)
+      if (v >= 0 && v < static_cast<int>(level.vertices.size()))
+        shape << QPointF(level.vertices[v].x, level.vertices[v].y);
+    return shape;
+  }
+
+  static string polygon_key(const int type, vector<int> vertices)
+  {
+    std::sort(vertices.begin(), vertices.end());
+    string key(1, static_cast<char>(type));
+    key.append(
+      reinterpret_cast<const char*>(vertices.data()),
+      vertices.size() * sizeof(int));
+    return key;
+  }
+
+  void compare_polygons()
+  {
+    std::unordered_multimap<string, int> after_keys;
+    for (std::size_t i = 0; i < after.polygons.size(); i++)
+      after_keys.emplace(
+        polygon_key(after.polygons[i].type, after.polygons[i].vertices),
+        static_cast<int>(i));
+
+    vector<char> after_matched(after.polygons.size(), 0);
+    vector<int> mapped;
+    vector<string> differences;
+    for (std::size_t b = 0; b < before.polygons.size(); b++)
+    {
+      const Polygon& polygon = before.polygons[b];
+      mapped.clear();
+      bool moved = false;
+      for (const int v : polygon.vertices)
+      {
+        if (v < 0 || v >= static_cast<int>(vertex_map.size()) ||
+          vertex_map[v] < 0)
+        {
+          mapped.clear();
+          break;
+        }
+        mapped.push_back(vertex_map[v]);
+        moved = moved || vertex_moved[v];
+      }
+
+      int a = -1;
+      if (!mapped.empty())
+      {
+        auto range = after_keys.equal_range(polygon_key(polygon.type, mapped));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+          if (!after_matched[it->second])
+          {
+            a = it->second;
+            break;
+          }
+        }
+      }
+      if (a < 0)
+      {
+        add(
+          BuildingDiff::POLYGON,
+          BuildingDiff::REMOVED,
+          polygon_type_name(polygon.type),
+          b,
+          -1,
+          polygon_shape(before, polygon),
+          QPolygonF());
+        continue;
+      }
+      after_matched[a] = 1;
+
+      const Polygon& after_polygon = after.polygons[a];
+      differences.clear();
+      if (mapped != after_polygon.vertices)
+        differences.push_back("vertex order");
+      describe_params(polygon.params, after_polygon.params, differences);
+      if (moved || !differences.empty())
+        add(
+          BuildingDiff::POLYGON,
+          moved ? BuildingDiff::MOVED : BuildingDiff::MODIFIED,
+          polygon_type_name(after_polygon.type),
+          b,
+          a,
+          polygon_shape(before, polygon),
+          polygon_shape(after, after_polygon),
+          differences);
+    }
+
+    for (std::size_t a = 0; a < after.polygons.size(); a++)
+    {
+      if (!after_matched[a])
+        add(
+          BuildingDiff::POLYGON,
+          BuildingDiff::ADDED,
+          polygon_type_name(after.polygons[a].type),
+          -1,
+          a,
+          QPolygonF(),
+          polygon_shape(after, after.polygons[a]));
+    }
+  }
+
+  void compare_models()
+  {
+    vector<QPointF> before_points, after_points;
+    const vector<int> model_map = match_points(
+      before.models,
+      after.models,
+      [](const Model& m) { return QPointF(m.state.x, m.state.y); },
+      [](const Model& m) -> const string& { return m.instance_name; },
+      [](const Model& b, const Model& a)
+      {
+        return b.model_name == a.model_name &&
+        b.instance_name == a.instance_name &&
+        b.state.yaw == a.state.yaw &&
+        b.state.z == a.state.z &&
+        b.is_static == a.is_static &&
+        b.is_dispensable == a.is_dispensable;
+      },
+      tolerance,
+      move_radius,
+      before_points,
+      after_points);
+
+    add_point_changes(
+      BuildingDiff::MODEL,
+      before.models,
+      after.models,
+      model_map,
+      before_points,
+      after_points,
+      [](const Model& m)
+      {
+        return m.instance_name.empty() ? m.model_name : m.instance_name;
+      },
+      [](const Model& b, const Model& a, vector<string>& differences)
+      {
+        if (b.model_name != a.model_name)
+          differences.push_back("model was " + b.model_name);
+        if (b.instance_name != a.instance_name)
+          differences.push_back("name was \"" + b.instance_name + "\"");
+        if (b.state.yaw != a.state.yaw)
+          differences.push_back("yaw");
+        if (b.state.z != a.state.z)
+          differences.push_back("elevation");
+        if (b.is_static != a.is_static)
+          differences.push_back("static");
+        if (b.is_dispensable != a.is_dispensable)
+          differences.push_back("dispensable");
+      });
+  }
+
+  void compare_fiducials()
+  {
+    vector<QPointF> before_points, after_points;
+    const vector<int> fiducial_map = match_points(
+      before.fiducials,
+      after.fiducials,
+      [](const Fiducial& f) { return QPointF(f.x, f.y); },
+      [](const Fiducial& f) -> const string& { return f.name; },
+      [](const Fiducial& b, const Fiducial& a) { return b.name == a.name; },
+      tolerance,
+      move_radius,
+      before_points,
+      after_points);
+
+    add_point_changes(
+      BuildingDiff::FIDUCIAL,
+      before.fiducials,
+      after.fiducials,
+      fiducial_map,
+      before_points,
+      after_points,
+      [](const Fiducial& f) { return f.name; },
+      [](const Fiducial& b, const Fiducial& a, vector<string>& differences)
+      {
+        if (b.name != a.name)
+          differences.push_back("name was \"" + b.name + "\"");
+      });
+  }
+};
+
+}  // namespace
+
+
+BuildingDiff::BuildingDiff()
+{
+}
+
+BuildingDiff::~BuildingDiff()
+{
+}
+
+QPointF BuildingDiff::Element::position() const
+{
+  const QPolygonF& shape = after_shape.isEmpty() ? before_shape : after_shape;
+  if (shape.isEmpty())
+    return QPointF();
+  QPointF sum;
+  for (const QPointF& p : shape)
+    sum += p;
+  return sum / shape.size();
+}
+
+void BuildingDiff::clear()
+{
+  levels.clear();
+  before_filename.clear();
+  num_compared = 0;
+  elapsed_seconds = 0.0;
+  computed = false;
+}
+
+void BuildingDiff::compute(const Building& before, const Building& after)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  levels.clear();
+  num_compared = 0;
+
+  auto count = [](const Level& level)
+    {
+      return level.vertices.size() + level.edges.size() +
+             level.polygons.size() + level.models.size() +
+             level.fiducials.size();
+    };
+
+  std::unordered_map<string, const Level*> before_levels;
+  for (const Level& level : before.levels)
+    before_levels[level.name] = &level;
+
+  for (const Level& after_level : after.levels)
+  {
+    LevelDiff level_diff;
+    level_diff.name = after_level.name;
+    num_compared += count(after_level);
+
+    auto it = before_levels.find(after_level.name);
+    if (it == before_levels.end())
+    {
+      level_diff.change = ADDED;
+      levels.push_back(std::move(level_diff));
+      continue;
+    }
+    const Level& before_level = *it->second;
+    before_levels.erase(it);
+    num_compared += count(before_level);
+
+    LevelComparison(
+      before_level,
+      after_level,
+      level_diff,
+      tolerance,
+      move_radius).compare();
+    if (!level_diff.elements.empty())
+      levels.push_back(std::move(level_diff));
+  }
+
+  for (const Level& before_level : before.levels)
+  {
+    if (before_levels.find(before_level.name) == before_levels.end())
+      continue;
+    LevelDiff level_diff;
+    level_diff.name = before_level.name;
+    level_diff.change = REMOVED;
+    num_compared += count(before_level);
+    levels.push_back(std::move(level_diff));
+  }
+
+  computed = true;
+  elapsed_seconds = timer.elapsed() / 1000.0;
+  printf(
+    "compared %zu elements in %.3f seconds\n",
+    num_compared,
+    elapsed_seconds);
+}
+
+const BuildingDiff::LevelDiff* BuildingDiff::find_level(
+  const string& level_name) const
+{
+  for (const LevelDiff& level_diff : levels)
+    if (level_diff.name == level_name)
+      return &level_diff;
+  return nullptr;
+}
+
+void BuildingDiff::print(FILE* file) const
+{
+  for (const LevelDiff& level_diff : levels)
+  {
+    if (level_diff.change != MODIFIED)
+    {
+      fprintf(
+        file,
+        "level %s: %s\n",
+        level_diff.name.c_str(),
+        change_name(level_diff.change));
+      continue;
+    }
+
+    fprintf(
+      file,
+      "level %s: %d added, %d removed, %d moved, %d modified\n",
+      level_diff.name.c_str(),
+      level_diff.num_changes[ADDED],
+      level_diff.num_changes[REMOVED],
+      level_diff.num_changes[MOVED],
+      level_diff.num_changes[MODIFIED]);
+
+    for (const Element& element : level_diff.elements)
+    {
+      const QPointF p = element.position();
+      fprintf(file, "  %-8s ", change_name(element.change));
+      if (element.kind == EDGE || element.kind == POLYGON)
+        fprintf(file, "%s", element.label.c_str());  // its type
+      else if (element.label.empty())
+        fprintf(file, "%s", kind_name(element.kind));
+      else
+        fprintf(
+          file,
+          "%s \"%s\"",
+          kind_name(element.kind),
+          element.label.c_str());
+      if (element.change == MOVED)
+      {
+        QPointF from;
+        for (const QPointF& b : element.before_shape)
+          from += b;
+        from /= std::max(element.before_shape.size(), 1);
+        fprintf(
+          file,
+          " from (%.2f, %.2f) to (%.2f, %.2f)",
+          from.x(),
+          from.y(),
+          p.x(),
+          p.y());
+      }
+      else
+        fprintf(file, " at (%.2f, %.2f)", p.x(), p.y());
+      if (!element.details.empty())
+        fprintf(file, ": %s", element.details.c_str());
+      fprintf(file, "\n");
+    }
+  }
+}
+
+void BuildingDiff::draw(QGraphicsScene* scene, const Level& level) const
+{
+  const LevelDiff* level_diff = find_level(level.name);
+  if (!level_diff)
+    return;
+
+  // one path per kind of change, however many elements there are
+  const double mpp = level.drawing_meters_per_pixel > 0.0 ?
+    level.drawing_meters_per_pixel : 1.0;
+  const double radius = 0.4 / mpp;
+  QPainterPath paths[4];
+  QPainterPath moves;  // from where moved elements were
+  for (const Element& element : level_diff->elements)
+  {
+    QPainterPath& path = paths[element.change];
+    const QPolygonF& shape = element.change == REMOVED ?
+      element.before_shape : element.after_shape;
+    if (shape.size() == 1)
+      path.addEllipse(shape.front(), radius, radius);
+    else if (element.kind == EDGE)
+      path.addPolygon(shape);
+    else
+    {
+      path.addPolygon(shape);
+      path.closeSubpath();
+    }
+
+    if (element.change == MOVED && element.kind != EDGE &&
+      element.kind != POLYGON)
+    {
+      moves.moveTo(element.before_shape.front());
+      moves.lineTo(element.after_shape.front());
+    }
+  }
+
+  const QColor colors[4] =
+  {
+    QColor::fromRgbF(0.0, 0.8, 0.0, 0.8),  // added
+    QColor::fromRgbF(1.0, 0.0, 0.0, 0.8),  // removed
+    QColor::fromRgbF(1.0, 0.6, 0.0, 0.8),  // moved
+    QColor::fromRgbF(0.0, 0.5, 1.0, 0.8)  // modified
+  };
+  for (int i = 0; i < 4; i++)
+  {
+    if (paths[i].isEmpty())
+      continue;
+    QPen pen(colors[i], 0.15 / mpp);
+    pen.setCapStyle(Qt::RoundCap);
+    pen.setJoinStyle(Qt::RoundJoin);
+    scene->addPath(paths[i], pen)->setZValue(240.0);
+  }
+  if (!moves.isEmpty())
+  {
+    QPen pen(colors[MOVED], 0.05 / mpp, Qt::DashLine);
+    scene->addPath(moves, pen)->setZValue(240.0);
+  }
+}
+
+const char* BuildingDiff::change_name(const Change change)
+{
+  switch (change)
+  {
+    case ADDED: return "added";
+    case REMOVED: return "removed";
+    case MOVED: return "moved";
+    case MODIFIED: return "modified";
+    default: return "unknown";
+  }
+}
+
+const char* BuildingDiff::kind_name(const Kind kind)
+{
+  switch (kind)
+  {
+    case VERTEX: return "vertex";
+    case EDGE: return "edge";
+    case POLYGON: return "polygon";
+    case MODEL: return "model";
+    case FIDUCIAL: return "fiducial";
+    default: return "unknown";
+  }
+}
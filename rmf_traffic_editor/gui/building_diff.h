@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef BUILDING_DIFF_H
+#define BUILDING_DIFF_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <QPointF>
+#include <QPolygonF>
+
+#include "building.h"
+
+class QGraphicsScene;
+
+/*
+ * Compares two revisions of a building by what is where, rather than by
+ * the text of their YAML, in which deleting one vertex renumbers every
+ * edge after it. Levels are paired up by name.
+ *
+ * Vertices, models and fiducials are matched through a spatial hash of the
+ * "before" revision: an element within the tolerance of an unmatched one
+ * (preferring one with the same name and parameters) is the same element,
+ * and it was modified if anything else about it differs. What's left is
+ * paired up by name, then with the nearest identical element within the
+ * move radius, and those were moved. Edges and polygons are matched by
+ * their vertices, through the vertex matches, so they follow their
+ * vertices around. Anything still unmatched was added or removed.
+ */
+
+class BuildingDiff
+{
+public:
+  BuildingDiff();
+  ~BuildingDiff();
+
+  double tolerance = 0.01;  // meters; anything closer than this is in place
+  double move_radius = 1.0;  // meters; unnamed elements moved further are
+                             // reported as removed and added instead
+
+  enum Change
+  {
+    ADDED = 0,
+    REMOVED,
+    MOVED,
+    MODIFIED
+  };
+
+  enum Kind
+  {
+    VERTEX = 0,
+    EDGE,
+    POLYGON,
+    MODEL,
+    FIDUCIAL
+  };
+
+  struct Element
+  {
+    Kind kind = VERTEX;
+    Change change = ADDED;
+    std::string label;  // name, or the type of an edge or polygon
+    std::string details;  // what else was modified, if anything
+    int before_idx = -1;  // in the level's vector of this kind
+    int after_idx = -1;
+    QPolygonF before_shape;  // level coordinates: a single point, unless
+    QPolygonF after_shape;  // it's an edge or a polygon
+
+    QPointF position() const;  // where it is now, or was if it's removed
+  };
+
+  struct LevelDiff
+  {
+    std::string name;
+    Change change = MODIFIED;  // or ADDED or REMOVED, for the whole level
+    std::vector<Element> elements;
+    int num_changes[4] = {0, 0, 0, 0};  // by Change
+  };
+
+  std::vector<LevelDiff> levels;  // only those with differences
+  std::string before_filename;
+  std::size_t num_compared = 0;  // elements in either revision
+  double elapsed_seconds = 0.0;
+  bool computed = false;
+
+  void compute(const Building& before, const Building& after);
+  void clear();
+
+  bool identical() const { return levels.empty(); }
+  const LevelDiff* find_level(const std::string& level_name) const;
+
+  void print(FILE* file) const;
+
+  // highlights the differences on the level with this one's name
+  void draw(QGraphicsScene* scene, const Level& level) const;
+
+  static const char* change_name(const Change change);
+  static const char* kind_name(const Kind kind);
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <QtWidgets>
+
+#include "building_diff_dialog.h"
+
+// a table of a hundred thousand rows takes longer to fill than the diff
+static const int MAX_TABLE_ROWS = 2000;
+
+
+BuildingDiffDialog::BuildingDiffDialog(
+  QWidget* parent,
+  Building& _building,
+  BuildingDiff& _diff,
+  const int _level_idx)
+: QDialog(parent),
+  building(_building),
+  diff(_diff),
+  level_idx(_level_idx)
+{
+  setWindowTitle("Compare Revisions");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  compare_button = new QPushButton("Compare", this);  // first = [enter]
+  close_button = new QPushButton("Close", this);
+
+  QHBoxLayout* before_hbox = new QHBoxLayout;
+  before_hbox->addWidget(new QLabel("Earlier revision:"));
+  before_line_edit = new QLineEdit(
+    QString::fromStdString(diff.before_filename),
+    this);
+  before_hbox->addWidget(before_line_edit, 1);
+  QPushButton* browse_button = new QPushButton("Browse...", this);
+  before_hbox->addWidget(browse_button);
+  connect(
+    browse_button, &QAbstractButton::clicked,
+    this, &BuildingDiffDialog::browse_button_clicked);
+
+  QHBoxLayout* tolerance_hbox = new QHBoxLayout;
+  tolerance_hbox->addWidget(new QLabel("Tolerance (m):"));
+  tolerance_spin_box = new QDoubleSpinBox(this);
+  tolerance_spin_box->setDecimals(3);
+  tolerance_spin_box->setRange(0.0, 1.0);
+  tolerance_spin_box->setSingleStep(0.005);
+  tolerance_spin_box->setValue(diff.tolerance);
+  tolerance_hbox->addWidget(tolerance_spin_box);
+
+  QHBoxLayout* move_radius_hbox = new QHBoxLayout;
+  move_radius_hbox->addWidget(new QLabel("Move radius (m):"));
+  move_radius_spin_box = new QDoubleSpinBox(this);
+  move_radius_spin_box->setDecimals(2);
+  move_radius_spin_box->setRange(0.0, 100.0);
+  move_radius_spin_box->setSingleStep(0.5);
+  move_radius_spin_box->setValue(diff.move_radius);
+  move_radius_hbox->addWidget(move_radius_spin_box);
+
+  change_table = new QTableWidget(this);
+  change_table->setColumnCount(3);
+  change_table->setHorizontalHeaderLabels(
+    QStringList() << "Change" << "Element" << "Details");
+  change_table->verticalHeader()->setVisible(false);
+  change_table->horizontalHeader()->setSectionResizeMode(
+    QHeaderView::ResizeToContents);
+  change_table->horizontalHeader()->setStretchLastSection(true);
+  change_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  change_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  connect(
+    change_table, &QTableWidget::cellClicked,
+    this, &BuildingDiffDialog::change_cell_clicked);
+
+  status_label = new QLabel(this);
+  status_label->setWordWrap(true);
+  populate_change_table();
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(close_button);
+  bottom_buttons_hbox->addWidget(compare_button);
+  connect(
+    compare_button, &QAbstractButton::clicked,
+    this, &BuildingDiffDialog::compare_button_clicked);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(before_hbox);
+  top_vbox->addLayout(tolerance_hbox);
+  top_vbox->addLayout(move_radius_hbox);
+  top_vbox->addWidget(new QLabel("Changes on this level:"));
+  top_vbox->addWidget(change_table, 1);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+  resize(550, 550);
+}
+
+BuildingDiffDialog::~BuildingDiffDialog()
+{
+}
+
+void BuildingDiffDialog::populate_change_table()
+{
+  change_table->setRowCount(0);
+  if (!diff.computed)
+  {
+    status_label->setText("Not compared yet");
+    return;
+  }
+
+  const std::string& level_name = building.levels[level_idx].name;
+  const BuildingDiff::LevelDiff* level_diff = diff.find_level(level_name);
+  const int num_elements =
+    level_diff ? static_cast<int>(level_diff->elements.size()) : 0;
+  const int num_rows = std::min(num_elements, MAX_TABLE_ROWS);
+
+  change_table->setRowCount(num_rows);
+  for (int row = 0; row < num_rows; row++)
+  {
+    const BuildingDiff::Element& e = level_diff->elements[row];
+    std::string element = BuildingDiff::kind_name(e.kind);
+    if (!e.label.empty())
+      element += " " + e.label;
+    change_table->setItem(
+      row, 0, new QTableWidgetItem(BuildingDiff::change_name(e.change)));
+    change_table->setItem(
+      row, 1, new QTableWidgetItem(QString::fromStdString(element)));
+    change_table->setItem(
+      row, 2, new QTableWidgetItem(QString::fromStdString(e.details)));
+  }
+
+  QString status;
+  if (diff.identical())
+    status = "The revisions are the same.";
+  else if (level_diff && level_diff->change != BuildingDiff::MODIFIED)
+    status = QString("This level was %1.")
+      .arg(BuildingDiff::change_name(level_diff->change));
+  else if (level_diff)
+    status = QString("This level: %1 added, %2 removed, %3 moved, "
+        "%4 modified%5.")
+      .arg(level_diff->num_changes[BuildingDiff::ADDED])
+      .arg(level_diff->num_changes[BuildingDiff::REMOVED])
+      .arg(level_diff->num_changes[BuildingDiff::MOVED])
+      .arg(level_diff->num_changes[BuildingDiff::MODIFIED])
+      .arg(num_rows < num_elements ?
+        QString(" (the first %1 are listed)").arg(num_rows) : QString());
+  else
+    status = "This level is the same.";
+  status_label->setText(
+    status + QString(" %1 levels differ; compared %2 elements in %3 s.")
+    .arg(diff.levels.size())
+    .arg(diff.num_compared)
+    .arg(diff.elapsed_seconds, 0, 'f', 3));
+}
+
+void BuildingDiffDialog::browse_button_clicked()
+{
+  const QString filename = QFileDialog::getOpenFileName(
+    this,
+    "Open Earlier Revision",
+    QFileInfo(before_line_edit->text()).path(),
+    "Building files (*.building.yaml *.building.yaml.gz);;All files (*)");
+  if (!filename.isEmpty())
+    before_line_edit->setText(filename);
+}
+
+void BuildingDiffDialog::compare_button_clicked()
+{
+  const QString filename =
+    QFileInfo(before_line_edit->text()).absoluteFilePath();
+
+  // loading changes the working directory, which the building being
+  // edited relies on for its relative paths
+  const QString working_directory = QDir::currentPath();
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  Building before;
+  const bool loaded = before.load(filename.toStdString(), false);
+  QDir::setCurrent(working_directory);
+  QApplication::restoreOverrideCursor();
+  if (!loaded)
+  {
+    QMessageBox::warning(
+      this,
+      "Compare Revisions",
+      "Unable to load " + filename);
+    return;
+  }
+
+  diff.tolerance = tolerance_spin_box->value();
+  diff.move_radius = move_radius_spin_box->value();
+  diff.compute(before, building);
+  diff.before_filename = filename.toStdString();
+
+  populate_change_table();
+  emit redraw();
+}
+
+void BuildingDiffDialog::change_cell_clicked(int row, int /*column*/)
+{
+  const BuildingDiff::LevelDiff* level_diff =
+    diff.find_level(building.levels[level_idx].name);
+  if (!level_diff || row < 0 ||
+    row >= static_cast<int>(level_diff->elements.size()))
+    return;
+  emit center_on(level_diff->elements[row].position());
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef BUILDING_DIFF_DIALOG_H
+#define BUILDING_DIFF_DIALOG_H
+
+#include <QDialog>
+#include <QObject>
+#include <QPointF>
+
+#include "building.h"
+#include "building_diff.h"
+class QDoubleSpinBox;
+class QLabel;
+class QLineEdit;
+class QTableWidget;
+
+
+class BuildingDiffDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  BuildingDiffDialog(
+    QWidget* parent,
+    Building& building,
+    BuildingDiff& diff,
+    const int level_idx);
+  ~BuildingDiffDialog();
+
+private:
+  Building& building;
+  BuildingDiff& diff;
+  int level_idx = 0;
+
+  QLineEdit* before_line_edit;
+  QDoubleSpinBox* tolerance_spin_box;
+  QDoubleSpinBox* move_radius_spin_box;
+  QTableWidget* change_table;
+  QLabel* status_label;
+  QPushButton* compare_button, * close_button;
+
+  void populate_change_table();
+
+private slots:
+  void browse_button_clicked();
+  void compare_button_clicked();
+  void change_cell_clicked(int row, int column);
+
+signals:
+  void redraw();
+  void center_on(const QPointF& p);
+};
+
+#endif
@@ -0,0 +1,526 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include <QElapsedTimer>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsScene>
+#include <QtConcurrent/QtConcurrent>
+
+#include "clearance_analysis.h"
+#include "distance_transform.h"
+
+using std::vector;
+
+// tile size in grid cells (not counting the halo). Must be a power of two
+// so that overlay pixels never straddle two tiles.
+static const int TILE_SIZE = 512;
+
+// the overlay image is downsampled so it stays a reasonable size
+static const int MAX_OVERLAY_SIZE = 4096;
+
+
+ClearanceAnalysis::ClearanceAnalysis()
+{
+}
+
+ClearanceAnalysis::~ClearanceAnalysis()
+{
+}
+
+void ClearanceAnalysis::clear()
+{
+  violations.clear();
+  lane_clearance.clear();
+  level_idx = -1;
+  elapsed_seconds = 0.0;
+  overlay_image = QImage();
+  overlay_pixmap = QPixmap();
+}
+
+double ClearanceAnalysis::footprint_radius(
+  const vector<Graph>& graphs,
+  const int graph_idx,
+  const double default_radius)
+{
+  for (const auto& graph : graphs)
+  {
+    if (graph.idx == graph_idx && graph.footprint_radius > 0.0)
+      return graph.footprint_radius;
+  }
+  return default_radius;
+}
+
+bool ClearanceAnalysis::run(
+  const Level& level,
+  const int _level_idx,
+  const vector<Graph>& graphs,
+  JobContext* job)
+{
+  clear();
+
+  const double mpp = level.drawing_meters_per_pixel;
+  if (mpp <= 0.0 || resolution <= 0.0)
+    return false;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  const double cell = resolution / mpp;  // level units per cell
+  const int num_vertices = static_cast<int>(level.vertices.size());
+  auto valid_edge = [num_vertices](const Edge& edge)
+    {
+      return edge.start_idx >= 0 && edge.start_idx < num_vertices &&
+        edge.end_idx >= 0 && edge.end_idx < num_vertices;
+    };
+
+  struct Lane
+  {
+    int edge_idx;
+    int graph_idx;
+    double radius;
+    QPointF a, b;  // level coordinates
+  };
+  vector<Lane> lanes;
+  double max_radius = 0.0;
+  for (std::size_t i = 0; i < level.edges.size(); i++)
+  {
+    const Edge& edge = level.edges[i];
+    if (edge.type != Edge::LANE || !valid_edge(edge))
+      continue;
+    Lane lane;
+    lane.edge_idx = static_cast<int>(i);
+    lane.graph_idx = edge.get_graph_idx();
+    lane.radius = footprint_radius(
+      graphs,
+      lane.graph_idx,
+      default_footprint_radius);
+    const Vertex& v0 = level.vertices[edge.start_idx];
+    const Vertex& v1 = level.vertices[edge.end_idx];
+    lane.a = QPointF(v0.x, v0.y);
+    lane.b = QPointF(v1.x, v1.y);
+    lanes.push_back(lane);
+    max_radius = std::max(max_radius, lane.radius);
+  }
+
+  lane_clearance.assign(level.edges.size(), -1.0);
+  level_idx = _level_idx;
+  if (lanes.empty())
+    return true;
+
+  // distances are only exact (and only shown) out to this range
+  const double range = max_radius + 0.5;
+  const int halo = static_cast<int>(std::ceil(range / resolution)) + 1;
+
+  // the grid only needs to cover the lanes, plus the range around them
+  double min_x = 1e100, min_y = 1e100, max_x = -1e100, max_y = -1e100;
+  for (const Lane& lane : lanes)
+  {
+    min_x = std::min({min_x, lane.a.x(), lane.b.x()});
+    min_y = std::min({min_y, lane.a.y(), lane.b.y()});
+    max_x = std::max({max_x, lane.a.x(), lane.b.x()});
+    max_y = std::max({max_y, lane.a.y(), lane.b.y()});
+  }
+  const double margin = range / mpp + cell;
+  const QPointF origin(min_x - margin, min_y - margin);
+  const int width =
+    static_cast<int>(std::ceil((max_x - min_x + 2 * margin) / cell));
+  const int height =
+    static_cast<int>(std::ceil((max_y - min_y + 2 * margin) / cell));
+
+  const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+  const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+  auto to_cell = [&origin, cell](const QPointF& p)
+    {
+      return QPointF((p.x() - origin.x()) / cell, (p.y() - origin.y()) / cell);
+    };
+
+  // obstacles: walls and the outlines of holes, in cell coordinates
+  vector<QLineF> obstacles;
+  for (const Edge& edge : level.edges)
+  {
+    if (edge.type != Edge::WALL || !valid_edge(edge))
+      continue;
+    const Vertex& v0 = level.vertices[edge.start_idx];
+    const Vertex& v1 = level.vertices[edge.end_idx];
+    obstacles.push_back(
+      QLineF(to_cell(QPointF(v0.x, v0.y)), to_cell(QPointF(v1.x, v1.y))));
+  }
+  for (const Polygon& polygon : level.polygons)
+  {
+    if (polygon.type != Polygon::HOLE)
+      continue;
+    for (std::size_t i = 0; i < polygon.vertices.size(); i++)
+    {
+      const int i0 = polygon.vertices[i];
+      const int i1 = polygon.vertices[(i + 1) % polygon.vertices.size()];
+      if (i0 < 0 || i0 >= num_vertices || i1 < 0 || i1 >= num_vertices)
+        continue;
+      const Vertex& v0 = level.vertices[i0];
+      const Vertex& v1 = level.vertices[i1];
+      obstacles.push_back(
+        QLineF(to_cell(QPointF(v0.x, v0.y)), to_cell(QPointF(v1.x, v1.y))));
+    }
+  }
+
+  // bin lanes and obstacles into the tiles they can affect
+  struct Tile
+  {
+    int tx = 0;
+    int ty = 0;
+    vector<int> lanes;
+    vector<int> obstacles;
+
+    struct Hit
+    {
+      int lane = -1;
+      double clearance = 1e100;
+      QPointF location;
+    };
+    vector<Hit> hits;
+  };
+  vector<Tile> tiles(static_cast<std::size_t>(tiles_x) * tiles_y);
+  for (int ty = 0; ty < tiles_y; ty++)
+  {
+    for (int tx = 0; tx < tiles_x; tx++)
+    {
+      tiles[ty * tiles_x + tx].tx = tx;
+      tiles[ty * tiles_x + tx].ty = ty;
+    }
+  }
+
+  auto bin = [&](const QLineF& line, const int pad, const bool is_lane,
+      const int idx)
+    {
+      const double x0 = std::min(line.x1(), line.x2()) - pad;
+      const double x1 = std::max(line.x1(), line.x2()) + pad;
+      const double y0 = std::min(line.y1(), line.y2()) - pad;
+      const double y1 = std::max(line.y1(), line.y2()) + pad;
+      const int tx0 = std::max(0, static_cast<int>(std::floor(x0 / TILE_SIZE)));
+      const int tx1 =
+        std::min(tiles_x - 1, static_cast<int>(std::floor(x1 / TILE_SIZE)));
+      const int ty0 = std::max(0, static_cast<int>(std::floor(y0 / TILE_SIZE)));
+      const int ty1 =
+        std::min(tiles_y - 1, static_cast<int>(std::floor(y1 / TILE_SIZE)));
+      for (int ty = ty0; ty <= ty1; ty++)
+      {
+        for (int tx = tx0; tx <= tx1; tx++)
+        {
+          Tile& tile = tiles[ty * tiles_x + tx];
+          (is_lane ? tile.lanes : tile.obstacles).push_back(idx);
+        }
+      }
+    };
+
+  for (std::size_t i = 0; i < lanes.size(); i++)
+    bin(
+      QLineF(to_cell(lanes[i].a), to_cell(lanes[i].b)),
+      1,
+      true,
+      static_cast<int>(i));
+  for (std::size_t i = 0; i < obstacles.size(); i++)
+    bin(obstacles[i], halo, false, static_cast<int>(i));
+
+  // only tiles which some lane passes through need any work
+  tiles.erase(
+    std::remove_if(
+      tiles.begin(),
+      tiles.end(),
+      [](const Tile& tile) { return tile.lanes.empty(); }),
+    tiles.end());
+
+  // downsample the overlay by a power of two so it isn't enormous
+  int overlay_step = 1;
+  while (overlay_step < TILE_SIZE &&
+    std::max(width, height) / overlay_step > MAX_OVERLAY_SIZE)
+    overlay_step *= 2;
+  overlay_image = QImage(
+    (width + overlay_step - 1) / overlay_step,
+    (height + overlay_step - 1) / overlay_step,
+    QImage::Format_ARGB32);
+  overlay_image.fill(Qt::transparent);
+  uchar* overlay_bits = overlay_image.bits();
+  const int overlay_stride = overlay_image.bytesPerLine();
+  const int overlay_width = overlay_image.width();
+  const int overlay_height = overlay_image.height();
+  overlay_origin = origin;
+  overlay_pixel_size = cell * overlay_step;
+
+  // optional occupancy layer: layer pixel coordinates are an affine
+  // function of the grid cell coordinates, so precompute that function
+  const Layer* layer = nullptr;
+  if (layer_idx >= 0 && layer_idx < static_cast<int>(level.layers.size()) &&
+    !level.layers[layer_idx].image.isNull())
+    layer = &level.layers[layer_idx];
+
+  QPointF layer_p0, layer_du, layer_dv;
+  if (layer)
+  {
+    auto cell_to_layer = [&](const double gx, const double gy)
+      {
+        return layer->transform.backwards(
+          QPointF(
+            (origin.x() + gx * cell) * mpp,
+            (origin.y() + gy * cell) * mpp));
+      };
+    layer_p0 = cell_to_layer(0.5, 0.5);
+    layer_du = cell_to_layer(1.5, 0.5) - layer_p0;
+    layer_dv = cell_to_layer(0.5, 1.5) - layer_p0;
+  }
+
+  std::atomic<int> num_tiles_done {0};
+  QtConcurrent::blockingMap(
+    tiles,
+    [&](Tile& tile)
+    {
+      if (job && job->cancelled())
+        return;
+
+      // tile grid, including the halo, in global cell coordinates
+      const int gx0 = tile.tx * TILE_SIZE - halo;
+      const int gy0 = tile.ty * TILE_SIZE - halo;
+      const int core_w = std::min(TILE_SIZE, width - tile.tx * TILE_SIZE);
+      const int core_h = std::min(TILE_SIZE, height - tile.ty * TILE_SIZE);
+      const int w = core_w + 2 * halo;
+      const int h = core_h + 2 * halo;
+
+      vector<float> grid(
+        static_cast<std::size_t>(w) * h,
+        DistanceTransform::INF);
+
+      for (const int obstacle_idx : tile.obstacles)
+      {
+        const QLineF& line = obstacles[obstacle_idx];
+        DistanceTransform::mark_segment(
+          grid.data(),
+          w,
+          h,
+          line.x1() - gx0,
+          line.y1() - gy0,
+          line.x2() - gx0,
+          line.y2() - gy0);
+      }
+
+      if (layer)
+      {
+        const QImage& image = layer->image;
+        for (int y = 0; y < h; y++)
+        {
+          const QPointF row_p = layer_p0 + (gy0 + y) * layer_dv;
+          for (int x = 0; x < w; x++)
+          {
+            const QPointF p = row_p + (gx0 + x) * layer_du;
+            const int px = static_cast<int>(std::floor(p.x()));
+            const int py = static_cast<int>(std::floor(p.y()));
+            if (px < 0 || py < 0 || px >= image.width() ||
+              py >= image.height())
+              continue;
+            if (image.constScanLine(py)[px] < occupied_threshold)
+              grid[static_cast<std::size_t>(y) * w + x] = 0.0f;
+          }
+        }
+      }
+
+      DistanceTransform::squared_edt(grid.data(), w, h);
+
+      auto clearance_at = [&](const int x, const int y)
+        {
+          return std::sqrt(grid[static_cast<std::size_t>(y) * w + x]) *
+            resolution;
+        };
+
+      // color-code the core of the tile into the overlay, by block
+      const int ox0 = tile.tx * TILE_SIZE / overlay_step;
+      const int oy0 = tile.ty * TILE_SIZE / overlay_step;
+      const int blocks = TILE_SIZE / overlay_step;
+      for (int oy = oy0; oy < overlay_height && oy < oy0 + blocks; oy++)
+      {
+        QRgb* overlay_row =
+          reinterpret_cast<QRgb*>(overlay_bits + oy * overlay_stride);
+        for (int ox = ox0; ox < overlay_width && ox < ox0 + blocks; ox++)
+        {
+          double d_min = 1e100;
+          for (int by = 0; by < overlay_step; by++)
+          {
+            const int y = oy * overlay_step + by - gy0;
+            if (y >= h - halo)
+              break;
+            for (int bx = 0; bx < overlay_step; bx++)
+            {
+              const int x = ox * overlay_step + bx - gx0;
+              if (x >= w - halo)
+                break;
+              d_min = std::min(d_min, clearance_at(x, y));
+            }
+          }
+          if (d_min > range)
+            continue;
+
+          // red at the obstacle through yellow at the largest footprint
+          // radius, then green fading out over the rest of the range
+          if (d_min <= max_radius)
+          {
+            const int g = static_cast<int>(255 * d_min / max_radius);
+            overlay_row[ox] = qRgba(255, g, 0, 140);
+          }
+          else
+          {
+            const int alpha = static_cast<int>(
+              140 * (range - d_min) / (range - max_radius));
+            overlay_row[ox] = qRgba(0, 200, 0, alpha);
+          }
+        }
+      }
+
+      // sample every lane through this tile at half-cell spacing
+      for (const int lane_idx : tile.lanes)
+      {
+        const Lane& lane = lanes[lane_idx];
+        const QPointF a = to_cell(lane.a);
+        const QPointF b = to_cell(lane.b);
+        const QPointF ab = b - a;
+        const int steps = std::max(
+          1,
+          static_cast<int>(std::ceil(2.0 * std::hypot(ab.x(), ab.y()))));
+
+        Tile::Hit hit;
+        hit.lane = lane_idx;
+        for (int i = 0; i <= steps; i++)
+        {
+          const QPointF p = a + ab * (static_cast<double>(i) / steps);
+          const int x = static_cast<int>(std::floor(p.x())) - gx0;
+          const int y = static_cast<int>(std::floor(p.y())) - gy0;
+          if (x < halo || y < halo || x >= halo + core_w || y >= halo + core_h)
+            continue;  // not in the core of this tile
+          const double d = clearance_at(x, y);
+          if (d < hit.clearance)
+          {
+            hit.clearance = d;
+            hit.location = origin + p * cell;
+          }
+        }
+        if (hit.clearance < 1e100)
+          tile.hits.push_back(hit);
+      }
+
+      if (job)
+        job->set_progress(
+          static_cast<double>(++num_tiles_done) / tiles.size());
+    });
+
+  if (job && job->cancelled())
+  {
+    clear();
+    return false;
+  }
+
+  // merge the per-tile results, keeping the tightest spot of each lane
+  vector<Tile::Hit> lane_hits(lanes.size());
+  for (const Tile& tile : tiles)
+  {
+    for (const Tile::Hit& hit : tile.hits)
+    {
+      if (hit.clearance < lane_hits[hit.lane].clearance)
+        lane_hits[hit.lane] = hit;
+    }
+  }
+
+  for (std::size_t i = 0; i < lanes.size(); i++)
+  {
+    const Lane& lane = lanes[i];
+    const Tile::Hit& hit = lane_hits[i];
+    // anything beyond the range is simply "far enough away"
+    const double clearance = std::min(hit.clearance, range);
+    lane_clearance[lane.edge_idx] = clearance;
+    if (clearance < lane.radius)
+    {
+      Violation v;
+      v.edge_idx = lane.edge_idx;
+      v.graph_idx = lane.graph_idx;
+      v.clearance = clearance;
+      v.required = lane.radius;
+      v.location = hit.lane >= 0 ? hit.location : lane.a;
+      violations.push_back(v);
+    }
+  }
+  std::sort(
+    violations.begin(),
+    violations.end(),
+    [](const Violation& a, const Violation& b)
+    {
+      return a.clearance - a.required < b.clearance - b.required;
+    });
+
+  elapsed_seconds = static_cast<double>(timer.elapsed()) / 1000.0;
+
+  printf("clearance analysis: %dx%d cells, %d tiles, %d lanes, "
+    "%d violations, %.3f seconds\n",
+    width,
+    height,
+    static_cast<int>(tiles.size()),
+    static_cast<int>(lanes.size()),
+    static_cast<int>(violations.size()),
+    elapsed_seconds);
+
+  return true;
+}
+
+void ClearanceAnalysis::draw(QGraphicsScene* scene, const Level& level) const
+{
+  if (overlay_image.isNull())
+    return;
+  if (overlay_pixmap.isNull())
+    overlay_pixmap = QPixmap::fromImage(overlay_image);
+
+  QGraphicsPixmapItem* item = scene->addPixmap(overlay_pixmap);
+  item->setPos(overlay_origin);
+  item->setScale(overlay_pixel_size);
+  item->setTransformationMode(Qt::FastTransformation);
+
+  // outline the offending lanes and the footprint at the tightest spot
+  const double mpp = level.drawing_meters_per_pixel;
+  QPen lane_pen(QColor::fromRgbF(1.0, 0.0, 0.0, 0.6));
+  lane_pen.setWidthF(0.2 / mpp);
+  lane_pen.setCapStyle(Qt::RoundCap);
+  QPen footprint_pen(QColor::fromRgbF(1.0, 0.0, 0.0, 0.9));
+  footprint_pen.setWidthF(0.03 / mpp);
+
+  for (const Violation& v : violations)
+  {
+    if (v.edge_idx < 0 || v.edge_idx >= static_cast<int>(level.edges.size()))
+      continue;
+    const Edge& edge = level.edges[v.edge_idx];
+    if (edge.start_idx >= static_cast<int>(level.vertices.size()) ||
+      edge.end_idx >= static_cast<int>(level.vertices.size()))
+      continue;
+    const Vertex& v0 = level.vertices[edge.start_idx];
+    const Vertex& v1 = level.vertices[edge.end_idx];
+    scene->addLine(v0.x, v0.y, v1.x, v1.y, lane_pen);
+
+    const double r = v.required / mpp;
+    scene->addEllipse(
+      v.location.x() - r,
+      v.location.y() - r,
+      2 * r,
+      2 * r,
+      footprint_pen);
+  }
+}
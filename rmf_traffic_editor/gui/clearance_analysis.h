@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef CLEARANCE_ANALYSIS_H
+#define CLEARANCE_ANALYSIS_H
+
+#include <vector>
+
+#include <QImage>
+#include <QPixmap>
+#include <QPointF>
+
+#include "graph.h"
+#include "job_scheduler.h"
+#include "level.h"
+
+class QGraphicsScene;
+
+/*
+ * Checks how close every lane of a level comes to an obstacle, compared to
+ * the footprint radius of the robots using that lane's graph.
+ *
+ * Walls, hole outlines and (optionally) the dark pixels of an occupancy
+ * layer are rasterized into a grid, and its Euclidean distance transform
+ * is sampled along every lane. To keep memory bounded on very large sites
+ * the grid is split into square tiles which are processed in parallel;
+ * each tile carries a halo wide enough that every obstacle which could be
+ * within the footprint of a cell is inside the tile, so the distances are
+ * exact up to that range. Tiles that no lane passes through are skipped.
+ */
+
+class ClearanceAnalysis
+{
+public:
+  ClearanceAnalysis();
+  ~ClearanceAnalysis();
+
+  double resolution = 0.05;  // meters per grid cell
+  double default_footprint_radius = 0.5;  // for graphs without a radius
+  int layer_idx = -1;  // if valid, dark layer pixels are obstacles too
+  int occupied_threshold = 100;  // layer pixels darker than this are occupied
+
+  struct Violation
+  {
+    int edge_idx = -1;
+    int graph_idx = 0;
+    double clearance = 0.0;  // meters
+    double required = 0.0;  // meters
+    QPointF location;  // level coordinates of the tightest spot
+  };
+
+  std::vector<Violation> violations;  // tightest first
+
+  // minimum clearance (meters) along each edge of the level, or a negative
+  // number for edges which aren't lanes
+  std::vector<double> lane_clearance;
+
+  int level_idx = -1;  // level of the last run, or -1 if there isn't one
+  double elapsed_seconds = 0.0;
+
+  // doesn't touch any pixmaps, so it can run on a worker thread; if a job
+  // is given, it reports progress to it and stops early if it's cancelled
+  bool run(
+    const Level& level,
+    const int level_idx,
+    const std::vector<Graph>& graphs,
+    JobContext* job = nullptr);
+
+  void clear();
+
+  void draw(QGraphicsScene* scene, const Level& level) const;
+
+  static double footprint_radius(
+    const std::vector<Graph>& graphs,
+    const int graph_idx,
+    const double default_radius);
+
+private:
+  QImage overlay_image;
+  mutable QPixmap overlay_pixmap;  // made from the image on the first draw
+  QPointF overlay_origin;  // level coordinates
+  double overlay_pixel_size = 1.0;  // level units per overlay pixel
+};
+
+#endif
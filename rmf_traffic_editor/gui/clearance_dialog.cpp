@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <set>
+
+#include <QtWidgets>
+
+#include "clearance_dialog.h"
+
+
+ClearanceDialog::ClearanceDialog(
+  QWidget* parent,
+  Building& _building,
+  ClearanceAnalysis& _analysis,
+  JobScheduler& _jobs,
+  const int _level_idx)
+: QDialog(parent),
+  building(_building),
+  analysis(_analysis),
+  jobs(_jobs),
+  level_idx(_level_idx)
+{
+  setWindowTitle("Lane Clearance");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  const Level& level = building.levels[level_idx];
+
+  run_button = new QPushButton("Run", this);  // first button = [enter] button
+  close_button = new QPushButton("Close", this);
+
+  QHBoxLayout* resolution_hbox = new QHBoxLayout;
+  resolution_hbox->addWidget(new QLabel("Grid resolution (m):"));
+  resolution_spin_box = new QDoubleSpinBox(this);
+  resolution_spin_box->setDecimals(3);
+  resolution_spin_box->setRange(0.005, 1.0);
+  resolution_spin_box->setSingleStep(0.01);
+  resolution_spin_box->setValue(analysis.resolution);
+  resolution_hbox->addWidget(resolution_spin_box);
+
+  QHBoxLayout* default_radius_hbox = new QHBoxLayout;
+  default_radius_hbox->addWidget(new QLabel("Default footprint radius (m):"));
+  default_radius_spin_box = new QDoubleSpinBox(this);
+  default_radius_spin_box->setDecimals(2);
+  default_radius_spin_box->setRange(0.05, 10.0);
+  default_radius_spin_box->setSingleStep(0.05);
+  default_radius_spin_box->setValue(analysis.default_footprint_radius);
+  default_radius_hbox->addWidget(default_radius_spin_box);
+
+  QHBoxLayout* layer_hbox = new QHBoxLayout;
+  layer_hbox->addWidget(new QLabel("Occupancy layer:"));
+  layer_combo_box = new QComboBox(this);
+  layer_combo_box->addItem("(none)");
+  for (const auto& layer : level.layers)
+    layer_combo_box->addItem(QString::fromStdString(layer.name));
+  if (analysis.layer_idx >= 0 &&
+    analysis.layer_idx < static_cast<int>(level.layers.size()))
+    layer_combo_box->setCurrentIndex(analysis.layer_idx + 1);
+  layer_hbox->addWidget(layer_combo_box);
+
+  radius_table = new QTableWidget(this);
+  radius_table->setColumnCount(2);
+  radius_table->setHorizontalHeaderLabels(
+    QStringList() << "Graph" << "Footprint radius (m)");
+  radius_table->verticalHeader()->setVisible(false);
+  radius_table->horizontalHeader()->setSectionResizeMode(
+    QHeaderView::Stretch);
+  populate_radius_table();
+
+  violation_table = new QTableWidget(this);
+  violation_table->setColumnCount(4);
+  violation_table->setHorizontalHeaderLabels(
+    QStringList() << "Edge" << "Graph" << "Clearance (m)" << "Required (m)");
+  violation_table->verticalHeader()->setVisible(false);
+  violation_table->horizontalHeader()->setSectionResizeMode(
+    QHeaderView::Stretch);
+  violation_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  violation_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  connect(
+    violation_table, &QTableWidget::cellClicked,
+    this, &ClearanceDialog::violation_cell_clicked);
+
+  status_label = new QLabel(this);
+  populate_violation_table();
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(close_button);
+  bottom_buttons_hbox->addWidget(run_button);
+  connect(
+    run_button, &QAbstractButton::clicked,
+    this, &ClearanceDialog::run_button_clicked);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(resolution_hbox);
+  top_vbox->addLayout(default_radius_hbox);
+  top_vbox->addLayout(layer_hbox);
+  top_vbox->addWidget(radius_table);
+  top_vbox->addWidget(new QLabel("Violations:"));
+  top_vbox->addWidget(violation_table, 1);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+  resize(500, 600);
+}
+
+ClearanceDialog::~ClearanceDialog()
+{
+  jobs.cancel(job_id);
+}
+
+void ClearanceDialog::populate_radius_table()
+{
+  // list every graph which has lanes on this level
+  std::set<int> graph_idxs;
+  for (const auto& edge : building.levels[level_idx].edges)
+  {
+    if (edge.type == Edge::LANE)
+      graph_idxs.insert(edge.get_graph_idx());
+  }
+  radius_table_graphs.assign(graph_idxs.begin(), graph_idxs.end());
+
+  radius_table->blockSignals(true);
+  radius_table->setRowCount(static_cast<int>(radius_table_graphs.size()));
+  for (std::size_t row = 0; row < radius_table_graphs.size(); row++)
+  {
+    const int graph_idx = radius_table_graphs[row];
+    QString label = QString::number(graph_idx);
+    double radius = 0.0;
+    const Graph* graph = building.find_graph(graph_idx);
+    if (graph)
+    {
+      if (!graph->name.empty())
+        label += QString(" (%1)").arg(QString::fromStdString(graph->name));
+      radius = graph->footprint_radius;
+    }
+
+    QTableWidgetItem* label_item = new QTableWidgetItem(label);
+    label_item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+    radius_table->setItem(row, 0, label_item);
+
+    // an empty cell means "use the default radius"
+    radius_table->setItem(
+      row,
+      1,
+      new QTableWidgetItem(
+        radius > 0.0 ? QString::number(radius, 'f', 2) : QString()));
+  }
+  radius_table->blockSignals(false);
+}
+
+bool ClearanceDialog::apply_radii()
+{
+  bool modified = false;
+  for (std::size_t row = 0; row < radius_table_graphs.size(); row++)
+  {
+    const int graph_idx = radius_table_graphs[row];
+    const QString text = radius_table->item(row, 1)->text().trimmed();
+    bool ok = true;
+    double radius = text.isEmpty() ? 0.0 : text.toDouble(&ok);
+    if (!ok || radius < 0.0)
+      radius = 0.0;
+
+    auto it = std::find_if(
+      building.graphs.begin(),
+      building.graphs.end(),
+      [graph_idx](const Graph& g) { return g.idx == graph_idx; });
+    if (it == building.graphs.end())
+    {
+      if (radius <= 0.0)
+        continue;
+      Graph graph;
+      graph.idx = graph_idx;
+      building.graphs.push_back(graph);
+      building.update_symbols();
+      it = building.graphs.end() - 1;
+    }
+
+    if (it->footprint_radius != radius)
+    {
+      it->footprint_radius = radius;
+      modified = true;
+    }
+  }
+  return modified;
+}
+
+void ClearanceDialog::populate_violation_table()
+{
+  violation_table->setRowCount(
+    static_cast<int>(analysis.violations.size()));
+  for (std::size_t row = 0; row < analysis.violations.size(); row++)
+  {
+    const ClearanceAnalysis::Violation& v = analysis.violations[row];
+    violation_table->setItem(
+      row, 0, new QTableWidgetItem(QString::number(v.edge_idx)));
+    violation_table->setItem(
+      row, 1, new QTableWidgetItem(QString::number(v.graph_idx)));
+    violation_table->setItem(
+      row, 2, new QTableWidgetItem(QString::number(v.clearance, 'f', 3)));
+    violation_table->setItem(
+      row, 3, new QTableWidgetItem(QString::number(v.required, 'f', 3)));
+  }
+
+  if (analysis.level_idx != level_idx)
+    status_label->setText("Not run yet");
+  else
+    status_label->setText(
+      QString("%1 violations (%2 seconds)")
+      .arg(analysis.violations.size())
+      .arg(analysis.elapsed_seconds, 0, 'f', 2));
+}
+
+void ClearanceDialog::run_button_clicked()
+{
+  if (apply_radii())
+    emit building_modified();
+
+  analysis.resolution = resolution_spin_box->value();
+  analysis.default_footprint_radius = default_radius_spin_box->value();
+  analysis.layer_idx = layer_combo_box->currentIndex() - 1;
+
+  // run on copies, and only replace the results shown once it's done
+  auto result = std::make_shared<ClearanceAnalysis>();
+  result->resolution = analysis.resolution;
+  result->default_footprint_radius = analysis.default_footprint_radius;
+  result->layer_idx = analysis.layer_idx;
+  result->occupied_threshold = analysis.occupied_threshold;
+  auto level =
+    std::make_shared<Level>(building.levels[level_idx].snapshot());
+  auto graphs = std::make_shared<std::vector<Graph>>(building.graphs);
+  const int result_level_idx = level_idx;
+
+  run_button->setEnabled(false);
+  status_label->setText("Running...");
+
+  QPointer<ClearanceDialog> dialog(this);
+  job_id = jobs.submit(
+    "Lane clearance",
+    JobScheduler::INTERACTIVE,
+    [result, level, graphs, result_level_idx](JobContext& context)
+    {
+      return result->run(*level, result_level_idx, *graphs, &context);
+    },
+    [dialog, result](const JobScheduler::Outcome outcome)
+    {
+      if (!dialog)
+        return;
+      dialog->run_button->setEnabled(true);
+      if (outcome == JobScheduler::SUCCEEDED)
+        dialog->analysis = *result;
+      else if (outcome == JobScheduler::FAILED)
+        QMessageBox::warning(
+          dialog,
+          "Lane Clearance",
+          "Unable to run the clearance analysis. Is the level scale set?");
+
+      dialog->populate_violation_table();
+      emit dialog->redraw();
+    });
+}
+
+void ClearanceDialog::violation_cell_clicked(int row, int /*column*/)
+{
+  if (row < 0 || row >= static_cast<int>(analysis.violations.size()))
+    return;
+  emit center_on(analysis.violations[row].location);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef CLEARANCE_DIALOG_H
+#define CLEARANCE_DIALOG_H
+
+#include <vector>
+
+#include <QDialog>
+#include <QObject>
+#include <QPointF>
+
+#include "building.h"
+#include "clearance_analysis.h"
+#include "job_scheduler.h"
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QTableWidget;
+
+
+class ClearanceDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  ClearanceDialog(
+    QWidget* parent,
+    Building& building,
+    ClearanceAnalysis& analysis,
+    JobScheduler& jobs,
+    const int level_idx);
+  ~ClearanceDialog();  // cancels the analysis, if it's still running
+
+private:
+  Building& building;
+  ClearanceAnalysis& analysis;
+  JobScheduler& jobs;
+  JobScheduler::JobId job_id = 0;
+  int level_idx = 0;
+
+  QDoubleSpinBox* resolution_spin_box;
+  QDoubleSpinBox* default_radius_spin_box;
+  QComboBox* layer_combo_box;
+  QTableWidget* radius_table;
+  QTableWidget* violation_table;
+  QLabel* status_label;
+  QPushButton* run_button, * close_button;
+
+  std::vector<int> radius_table_graphs;  // graph index of each table row
+
+  void populate_radius_table();
+  void populate_violation_table();
+  bool apply_radii();
+
+private slots:
+  void run_button_clicked();
+  void violation_cell_clicked(int row, int column);
+
+signals:
+  void redraw();
+  void building_modified();
+  void center_on(const QPointF& p);
+};
+
+#endif
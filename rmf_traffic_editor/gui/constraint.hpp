@@ -42,9 +42,6 @@ public:
   void add_id(const QUuid& id);
   bool includes_id(const QUuid& id) const;
 
-  bool selected() const { return _selected; }
-  void setSelected(const bool selected) { _selected = selected; }
-
   void from_yaml(const YAML::Node& data);
   YAML::Node to_yaml() const;
 
@@ -52,7 +49,6 @@ public:
 
 private:
   std::vector<QUuid> _ids;
-  bool _selected = false;
 };
 
 #endif  // TRAFFIC_EDITOR__CONSTRAINT_HPP
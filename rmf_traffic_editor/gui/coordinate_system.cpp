@@ -15,6 +15,8 @@
  *
 */
 
+#include <cmath>
+
 #include "coordinate_system.h"
 
 CoordinateSystem::CoordinateSystem()
@@ -172,3 +174,33 @@ CoordinateSystem::ProjectedPoint CoordinateSystem::to_epsg3857(
     return {0, 0};
   }
 }
+
+bool CoordinateSystem::to_epsg3857(
+  const std::string& crs,
+  const double x,
+  const double y,
+  ProjectedPoint& projected) const
+{
+  PJ* authority_order = proj_create_crs_to_crs(
+    proj_context,
+    crs.c_str(),
+    "EPSG:3857",
+    NULL);
+  if (!authority_order)
+    return false;
+  PJ* transform =
+    proj_normalize_for_visualization(proj_context, authority_order);
+  proj_destroy(authority_order);
+  if (!transform)
+    return false;
+
+  const PJ_COORD p_out = proj_trans(
+    transform,
+    PJ_FWD,
+    proj_coord(x, y, 0, 0));
+  proj_destroy(transform);
+  if (p_out.v[0] == HUGE_VAL || p_out.v[1] == HUGE_VAL)
+    return false;
+  projected = ProjectedPoint({p_out.v[0], p_out.v[1]});
+  return true;
+}
@@ -63,6 +63,14 @@ public:
   ProjectedPoint to_epsg3857(const WGS84Point& wgs84_point) const;
   WGS84Point to_wgs84(const ProjectedPoint& point) const;
 
+  // project a point given in any CRS known to PROJ (e.g. "EPSG:32610"),
+  // with easting/longitude first, into EPSG:3857
+  bool to_epsg3857(
+    const std::string& crs,
+    const double x,
+    const double y,
+    ProjectedPoint& projected) const;
+
   PJ_CONTEXT* proj_context = nullptr;
   PJ* epsg_3857_to_wgs84 = nullptr;
 
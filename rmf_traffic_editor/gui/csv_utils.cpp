@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#include "csv_utils.h"
+
+using std::string;
+using std::vector;
+
+
+static bool is_blank(const char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '"';
+}
+
+void csv_utils::trim(const char*& begin, const char*& end)
+{
+  while (begin < end && is_blank(*begin))
+    begin++;
+  while (end > begin && is_blank(end[-1]))
+    end--;
+}
+
+bool csv_utils::parse_number(const char* p, const char* end, double& value)
+{
+  static const double POW10[] =
+  {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  trim(p, end);
+  if (p == end)
+    return false;
+
+  bool negative = false;
+  if (*p == '-' || *p == '+')
+    negative = *p++ == '-';
+
+  double mantissa = 0.0;
+  int exponent = 0;
+  int num_digits = 0;
+  for (; p < end && *p >= '0' && *p <= '9'; p++, num_digits++)
+    mantissa = mantissa * 10.0 + (*p - '0');
+  if (p < end && *p == '.')
+  {
+    for (p++; p < end && *p >= '0' && *p <= '9'; p++, num_digits++)
+    {
+      mantissa = mantissa * 10.0 + (*p - '0');
+      exponent--;
+    }
+  }
+  if (num_digits == 0)
+    return false;
+
+  if (p < end && (*p == 'e' || *p == 'E'))
+  {
+    p++;
+    bool negative_exponent = false;
+    if (p < end && (*p == '-' || *p == '+'))
+      negative_exponent = *p++ == '-';
+    if (p == end || *p < '0' || *p > '9')
+      return false;
+    int e = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+      e = std::min(e * 10 + (*p - '0'), 1000);
+    exponent += negative_exponent ? -e : e;
+  }
+  if (p != end)
+    return false;
+
+  if (exponent == 0)
+    value = mantissa;
+  else if (exponent < 0 && exponent >= -22)
+    value = mantissa / POW10[-exponent];
+  else if (exponent > 0 && exponent <= 22)
+    value = mantissa * POW10[exponent];
+  else
+    value = mantissa * std::pow(10.0, exponent);
+  if (negative)
+    value = -value;
+  return true;
+}
+
+bool csv_utils::field_equals(const char* p, const char* end, const string& s)
+{
+  trim(p, end);
+  return static_cast<std::size_t>(end - p) == s.size() &&
+    std::memcmp(p, s.data(), s.size()) == 0;
+}
+
+vector<csv_utils::Field> csv_utils::split_line(const char* p, const char* end)
+{
+  vector<Field> fields;
+  while (true)
+  {
+    const char* field_end = static_cast<const char*>(
+      std::memchr(p, ',', end - p));
+    if (!field_end)
+      field_end = end;
+    fields.push_back(std::make_pair(p, field_end));
+    if (field_end == end)
+      break;
+    p = field_end + 1;
+  }
+  return fields;
+}
+
+bool csv_utils::is_header(const vector<Field>& fields)
+{
+  if (fields.empty())
+    return false;
+  const char* b = fields.front().first;
+  const char* e = fields.front().second;
+  trim(b, e);
+  double value = 0.0;
+  return b != e && !parse_number(b, e, value);
+}
+
+int csv_utils::find_column(
+  const vector<Field>& header,
+  const vector<string>& names)
+{
+  for (std::size_t i = 0; i < header.size(); i++)
+  {
+    const char* b = header[i].first;
+    const char* e = header[i].second;
+    trim(b, e);
+    string name(b, e);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (std::find(names.begin(), names.end(), name) != names.end())
+      return static_cast<int>(i);
+  }
+  return -1;
+}
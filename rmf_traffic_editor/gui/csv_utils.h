@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef CSV_UTILS_H
+#define CSV_UTILS_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Helpers for scanning CSV text in place, for example in a memory-mapped
+// file, which isn't null-terminated. Fields are [begin, end) ranges.
+
+namespace csv_utils {
+
+typedef std::pair<const char*, const char*> Field;
+
+// strips spaces, tabs, carriage returns and quotes from both ends
+void trim(const char*& begin, const char*& end);
+
+// plain decimal numbers with an optional exponent; unlike strtod() this
+// doesn't read past the end and doesn't depend on the locale
+bool parse_number(const char* begin, const char* end, double& value);
+
+bool field_equals(const char* begin, const char* end, const std::string& s);
+
+std::vector<Field> split_line(const char* begin, const char* end);
+
+// a line is a header if its first field isn't a number; the data lines
+// of a log start with a timestamp or a coordinate, but may have names
+// in later columns
+bool is_header(const std::vector<Field>& fields);
+
+// index of the first header field which is one of the (lowercase) names,
+// ignoring case, or -1 if there isn't one
+int find_column(
+  const std::vector<Field>& header,
+  const std::vector<std::string>& names);
+
+}
+
+#endif
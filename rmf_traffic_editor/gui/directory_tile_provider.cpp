@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <QDir>
+#include <QFile>
+#include <QtConcurrent/QtConcurrent>
+
+#include "directory_tile_provider.h"
+
+
+DirectoryTileProvider::DirectoryTileProvider(
+  QObject* parent,
+  const QString& _root)
+: TileProvider(parent),
+  root(_root)
+{
+}
+
+DirectoryTileProvider::~DirectoryTileProvider()
+{
+  stop_workers();
+}
+
+QString DirectoryTileProvider::description() const
+{
+  return root;
+}
+
+void DirectoryTileProvider::request(const int zoom, const int x, const int y)
+{
+  QtConcurrent::run(
+    &thread_pool,
+    [=]()
+    {
+      read_tile(zoom, x, y);
+    });
+}
+
+void DirectoryTileProvider::read_tile(const int zoom, const int x, const int y)
+{
+  const QString stem = root
+    + QDir::separator()
+    + QString::number(zoom)
+    + QDir::separator()
+    + QString::number(x)
+    + QDir::separator()
+    + QString::number(y);
+
+  for (const char* extension : {".png", ".jpg", ".jpeg", ".webp"})
+  {
+    QFile file(stem + extension);
+    if (!file.open(QIODevice::ReadOnly))
+      continue;
+
+    const qint64 size = file.size();
+    uchar* mapped = file.map(0, size);
+    if (mapped)
+    {
+      decode(
+        zoom,
+        x,
+        y,
+        QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), size));
+      file.unmap(mapped);
+    }
+    else
+      decode(zoom, x, y, file.readAll());
+    return;
+  }
+  emit tile_failed(zoom, x, y);
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef DIRECTORY_TILE_PROVIDER_H
+#define DIRECTORY_TILE_PROVIDER_H
+
+#include "tile_provider.h"
+
+/*
+ * Raster tiles from a local directory tree laid out as z/x/y.png (or
+ * .jpg, .jpeg or .webp), as written by most tile download tools. Tile
+ * files are memory-mapped and decoded in place.
+ */
+
+class DirectoryTileProvider : public TileProvider
+{
+  Q_OBJECT
+
+public:
+  DirectoryTileProvider(QObject* parent, const QString& root);
+  ~DirectoryTileProvider();
+
+  QString description() const override;
+  void request(const int zoom, const int x, const int y) override;
+
+private:
+  QString root;
+
+  void read_tile(const int zoom, const int x, const int y);
+};
+
+#endif
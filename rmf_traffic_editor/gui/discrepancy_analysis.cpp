@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include <QElapsedTimer>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsScene>
+#include <QtConcurrent/QtConcurrent>
+
+#include "discrepancy_analysis.h"
+#include "distance_transform.h"
+
+using std::vector;
+
+// tile size in grid cells (not counting the halo). Must be a power of two
+// so that overlay pixels never straddle two tiles.
+static const int TILE_SIZE = 512;
+
+static const int MAX_OVERLAY_SIZE = 4096;
+static const std::size_t MAX_REGIONS = 500;
+
+
+DiscrepancyAnalysis::DiscrepancyAnalysis()
+{
+}
+
+DiscrepancyAnalysis::~DiscrepancyAnalysis()
+{
+}
+
+void DiscrepancyAnalysis::clear()
+{
+  regions.clear();
+  level_idx = -1;
+  elapsed_seconds = 0.0;
+  overlay_image = QImage();
+  overlay_pixmap = QPixmap();
+}
+
+const char* DiscrepancyAnalysis::kind_name(const Kind kind)
+{
+  switch (kind)
+  {
+    case UNDRAWN_OBSTACLE: return "undrawn obstacle";
+    case UNOBSERVED_WALL: return "unobserved wall";
+    default: return "unknown";
+  }
+}
+
+bool DiscrepancyAnalysis::run(
+  const Level& level,
+  const int _level_idx,
+  JobContext* job)
+{
+  clear();
+
+  const double mpp = level.drawing_meters_per_pixel;
+  if (mpp <= 0.0 || resolution <= 0.0 || tolerance < 0.0)
+    return false;
+  if (layer_idx < 0 || layer_idx >= static_cast<int>(level.layers.size()))
+    return false;
+  const Layer& layer = level.layers[layer_idx];
+  const QImage& image = layer.image;
+  if (image.isNull())
+    return false;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  const double cell = resolution / mpp;  // level units per cell
+
+  // the grid covers the footprint of the layer image on the level
+  double min_x = 1e100, min_y = 1e100, max_x = -1e100, max_y = -1e100;
+  const QPointF corners[4] =
+  {
+    QPointF(0, 0),
+    QPointF(image.width(), 0),
+    QPointF(0, image.height()),
+    QPointF(image.width(), image.height())
+  };
+  for (const QPointF& corner : corners)
+  {
+    const QPointF p = layer.transform.forwards(corner) / mpp;
+    min_x = std::min(min_x, p.x());
+    min_y = std::min(min_y, p.y());
+    max_x = std::max(max_x, p.x());
+    max_y = std::max(max_y, p.y());
+  }
+  const QPointF origin(min_x, min_y);
+  const int width = static_cast<int>(std::ceil((max_x - min_x) / cell));
+  const int height = static_cast<int>(std::ceil((max_y - min_y) / cell));
+  if (width <= 0 || height <= 0)
+    return false;
+
+  const int halo = static_cast<int>(std::ceil(tolerance / resolution)) + 1;
+  const float tolerance_sq = static_cast<float>(
+    (tolerance / resolution) * (tolerance / resolution));
+
+  const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+  const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+  // walls, in cell coordinates, binned into the tiles they can affect
+  const int num_vertices = static_cast<int>(level.vertices.size());
+  vector<QLineF> walls;
+  for (const Edge& edge : level.edges)
+  {
+    if (edge.type != Edge::WALL ||
+      edge.start_idx < 0 || edge.start_idx >= num_vertices ||
+      edge.end_idx < 0 || edge.end_idx >= num_vertices)
+      continue;
+    const Vertex& v0 = level.vertices[edge.start_idx];
+    const Vertex& v1 = level.vertices[edge.end_idx];
+    walls.push_back(
+      QLineF(
+        (v0.x - origin.x()) / cell,
+        (v0.y - origin.y()) / cell,
+        (v1.x - origin.x()) / cell,
+        (v1.y - origin.y()) / cell));
+  }
+
+  struct Tile
+  {
+    int tx = 0;
+    int ty = 0;
+    vector<int> walls;
+  };
+  vector<Tile> tiles(static_cast<std::size_t>(tiles_x) * tiles_y);
+  for (int ty = 0; ty < tiles_y; ty++)
+  {
+    for (int tx = 0; tx < tiles_x; tx++)
+    {
+      tiles[ty * tiles_x + tx].tx = tx;
+      tiles[ty * tiles_x + tx].ty = ty;
+    }
+  }
+  auto tile_range = [halo](const double lo, const double hi, const int n)
+    {
+      return std::make_pair(
+        std::max(0, static_cast<int>(std::floor((lo - halo) / TILE_SIZE))),
+        std::min(n - 1, static_cast<int>(std::floor((hi + halo) / TILE_SIZE))));
+    };
+  for (std::size_t i = 0; i < walls.size(); i++)
+  {
+    const QLineF& w = walls[i];
+    const auto xr =
+      tile_range(std::min(w.x1(), w.x2()), std::max(w.x1(), w.x2()), tiles_x);
+    const auto yr =
+      tile_range(std::min(w.y1(), w.y2()), std::max(w.y1(), w.y2()), tiles_y);
+    for (int ty = yr.first; ty <= yr.second; ty++)
+    {
+      for (int tx = xr.first; tx <= xr.second; tx++)
+        tiles[ty * tiles_x + tx].walls.push_back(static_cast<int>(i));
+    }
+  }
+
+  // per-block counts of disagreeing cells, one block per overlay pixel
+  int step = 1;
+  while (step < TILE_SIZE && std::max(width, height) / step > MAX_OVERLAY_SIZE)
+    step *= 2;
+  const int blocks_x = (width + step - 1) / step;
+  const int blocks_y = (height + step - 1) / step;
+  vector<uint32_t> counts[2];
+  counts[UNDRAWN_OBSTACLE].assign(
+    static_cast<std::size_t>(blocks_x) * blocks_y, 0);
+  counts[UNOBSERVED_WALL].assign(
+    static_cast<std::size_t>(blocks_x) * blocks_y, 0);
+
+  // layer pixel coordinates are an affine function of the cell coordinates
+  auto cell_to_layer = [&](const double gx, const double gy)
+    {
+      return layer.transform.backwards(
+        QPointF(
+          (origin.x() + gx * cell) * mpp,
+          (origin.y() + gy * cell) * mpp));
+    };
+  const QPointF layer_p0 = cell_to_layer(0.5, 0.5);
+  const QPointF layer_du = cell_to_layer(1.5, 0.5) - layer_p0;
+  const QPointF layer_dv = cell_to_layer(0.5, 1.5) - layer_p0;
+
+  std::atomic<int> num_tiles_done {0};
+  QtConcurrent::blockingMap(
+    tiles,
+    [&](const Tile& tile)
+    {
+      if (job && job->cancelled())
+        return;
+
+      const int gx0 = tile.tx * TILE_SIZE - halo;
+      const int gy0 = tile.ty * TILE_SIZE - halo;
+      const int core_w = std::min(TILE_SIZE, width - tile.tx * TILE_SIZE);
+      const int core_h = std::min(TILE_SIZE, height - tile.ty * TILE_SIZE);
+      const int w = core_w + 2 * halo;
+      const int h = core_h + 2 * halo;
+      const std::size_t n = static_cast<std::size_t>(w) * h;
+
+      vector<uint8_t> known(n, 0);
+      vector<float> occupied(n, DistanceTransform::INF);
+      vector<float> drawn(n, DistanceTransform::INF);
+
+      for (int y = 0; y < h; y++)
+      {
+        const QPointF row_p = layer_p0 + (gy0 + y) * layer_dv;
+        for (int x = 0; x < w; x++)
+        {
+          const QPointF p = row_p + (gx0 + x) * layer_du;
+          const int px = static_cast<int>(std::floor(p.x()));
+          const int py = static_cast<int>(std::floor(p.y()));
+          if (px < 0 || py < 0 || px >= image.width() ||
+            py >= image.height())
+            continue;
+          const std::size_t i = static_cast<std::size_t>(y) * w + x;
+          known[i] = 1;
+          if (image.constScanLine(py)[px] < occupied_threshold)
+            occupied[i] = 0.0f;
+        }
+      }
+
+      for (const int wall_idx : tile.walls)
+      {
+        const QLineF& line = walls[wall_idx];
+        DistanceTransform::mark_segment(
+          drawn.data(),
+          w,
+          h,
+          line.x1() - gx0,
+          line.y1() - gy0,
+          line.x2() - gx0,
+          line.y2() - gy0);
+      }
+
+      // after the transforms, zero still means "this cell is occupied"
+      DistanceTransform::squared_edt(occupied.data(), w, h);
+      DistanceTransform::squared_edt(drawn.data(), w, h);
+
+      // blocks are aligned to tiles, so no other tile touches these counts
+      for (int y = halo; y < halo + core_h; y++)
+      {
+        const int block_row = ((gy0 + y) / step) * blocks_x;
+        for (int x = halo; x < halo + core_w; x++)
+        {
+          const std::size_t i = static_cast<std::size_t>(y) * w + x;
+          if (!known[i])
+            continue;
+          const int block = block_row + (gx0 + x) / step;
+          if (occupied[i] == 0.0f && drawn[i] > tolerance_sq)
+            counts[UNDRAWN_OBSTACLE][block]++;
+          else if (drawn[i] == 0.0f && occupied[i] > tolerance_sq)
+            counts[UNOBSERVED_WALL][block]++;
+        }
+      }
+
+      if (job)
+        job->set_progress(
+          static_cast<double>(++num_tiles_done) / tiles.size());
+    });
+
+  if (job && job->cancelled())
+  {
+    clear();
+    return false;
+  }
+
+  // group neighboring blocks (8-connected) into regions
+  const double cell_area = resolution * resolution;
+  const double block_size = cell * step;
+  vector<uint8_t> visited(counts[0].size());
+  vector<int> stack;
+  for (int kind = 0; kind < 2; kind++)
+  {
+    std::fill(visited.begin(), visited.end(), 0);
+    const vector<uint32_t>& c = counts[kind];
+    for (std::size_t seed = 0; seed < c.size(); seed++)
+    {
+      if (!c[seed] || visited[seed])
+        continue;
+
+      uint64_t num_cells = 0;
+      int bx0 = blocks_x, by0 = blocks_y, bx1 = -1, by1 = -1;
+      stack.push_back(static_cast<int>(seed));
+      visited[seed] = 1;
+      while (!stack.empty())
+      {
+        const int b = stack.back();
+        stack.pop_back();
+        const int bx = b % blocks_x;
+        const int by = b / blocks_x;
+        num_cells += c[b];
+        bx0 = std::min(bx0, bx);
+        by0 = std::min(by0, by);
+        bx1 = std::max(bx1, bx);
+        by1 = std::max(by1, by);
+        const int ny1 = std::min(blocks_y - 1, by + 1);
+        const int nx1 = std::min(blocks_x - 1, bx + 1);
+        for (int ny = std::max(0, by - 1); ny <= ny1; ny++)
+        {
+          for (int nx = std::max(0, bx - 1); nx <= nx1; nx++)
+          {
+            const int nb = ny * blocks_x + nx;
+            if (c[nb] && !visited[nb])
+            {
+              visited[nb] = 1;
+              stack.push_back(nb);
+            }
+          }
+        }
+      }
+
+      Region region;
+      region.kind = static_cast<Kind>(kind);
+      region.area = num_cells * cell_area;
+      if (region.area < min_region_area)
+        continue;
+      region.bounds = QRectF(
+        origin.x() + bx0 * block_size,
+        origin.y() + by0 * block_size,
+        (bx1 - bx0 + 1) * block_size,
+        (by1 - by0 + 1) * block_size);
+      region.center = region.bounds.center();
+      regions.push_back(region);
+    }
+  }
+  std::sort(
+    regions.begin(),
+    regions.end(),
+    [](const Region& a, const Region& b) { return a.area > b.area; });
+  if (regions.size() > MAX_REGIONS)
+    regions.resize(MAX_REGIONS);
+
+  // red where the drawing is missing something, blue where the map is
+  QImage overlay(blocks_x, blocks_y, QImage::Format_ARGB32);
+  overlay.fill(Qt::transparent);
+  const double cells_per_block = static_cast<double>(step) * step;
+  for (int by = 0; by < blocks_y; by++)
+  {
+    QRgb* row = reinterpret_cast<QRgb*>(overlay.scanLine(by));
+    for (int bx = 0; bx < blocks_x; bx++)
+    {
+      const int b = by * blocks_x + bx;
+      const uint32_t undrawn = counts[UNDRAWN_OBSTACLE][b];
+      const uint32_t unobserved = counts[UNOBSERVED_WALL][b];
+      if (!undrawn && !unobserved)
+        continue;
+      const double fraction =
+        std::max(undrawn, unobserved) / cells_per_block;
+      const int alpha = 80 + static_cast<int>(175 * fraction);
+      if (undrawn >= unobserved)
+        row[bx] = qRgba(255, 0, 0, alpha);
+      else
+        row[bx] = qRgba(0, 80, 255, alpha);
+    }
+  }
+  overlay_image = overlay;
+  overlay_origin = origin;
+  overlay_pixel_size = block_size;
+
+  level_idx = _level_idx;
+  elapsed_seconds = static_cast<double>(timer.elapsed()) / 1000.0;
+
+  printf("discrepancy analysis: %dx%d cells, %d tiles, %d regions, "
+    "%.3f seconds\n",
+    width,
+    height,
+    static_cast<int>(tiles.size()),
+    static_cast<int>(regions.size()),
+    elapsed_seconds);
+
+  return true;
+}
+
+void DiscrepancyAnalysis::draw(QGraphicsScene* scene) const
+{
+  if (overlay_image.isNull())
+    return;
+  if (overlay_pixmap.isNull())
+    overlay_pixmap = QPixmap::fromImage(overlay_image);
+
+  QGraphicsPixmapItem* item = scene->addPixmap(overlay_pixmap);
+  item->setPos(overlay_origin);
+  item->setScale(overlay_pixel_size);
+  item->setTransformationMode(Qt::FastTransformation);
+}
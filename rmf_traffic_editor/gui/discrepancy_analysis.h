@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef DISCREPANCY_ANALYSIS_H
+#define DISCREPANCY_ANALYSIS_H
+
+#include <vector>
+
+#include <QImage>
+#include <QPixmap>
+#include <QPointF>
+#include <QRectF>
+
+#include "job_scheduler.h"
+#include "level.h"
+
+class QGraphicsScene;
+
+/*
+ * Compares an occupancy layer (typically a SLAM map) against the walls
+ * drawn on its level, to find where they disagree.
+ *
+ * The layer image is resampled into level space on a regular grid and the
+ * walls are rasterized into the same grid. Occupied map cells further than
+ * the tolerance from any wall are "undrawn obstacles" (walls missing from
+ * the drawing, or furniture); wall cells further than the tolerance from
+ * any occupied map cell are "unobserved walls" (walls which were moved or
+ * never existed). Both tests use the exact distance transform of the other
+ * raster. The grid is processed in independent tiles (with a halo as wide
+ * as the tolerance) on the thread pool, then neighboring discrepancies are
+ * grouped into regions for review.
+ */
+
+class DiscrepancyAnalysis
+{
+public:
+  DiscrepancyAnalysis();
+  ~DiscrepancyAnalysis();
+
+  double resolution = 0.05;  // meters per grid cell
+  double tolerance = 0.15;  // meters of disagreement which are acceptable
+  double min_region_area = 0.05;  // square meters; smaller regions are noise
+  int layer_idx = 0;
+  int occupied_threshold = 100;  // layer pixels darker than this are occupied
+
+  enum Kind
+  {
+    UNDRAWN_OBSTACLE = 0,  // in the map, but not near a drawn wall
+    UNOBSERVED_WALL = 1  // drawn, but not near anything in the map
+  };
+
+  struct Region
+  {
+    Kind kind = UNDRAWN_OBSTACLE;
+    double area = 0.0;  // square meters of disagreeing cells
+    QRectF bounds;  // level coordinates
+    QPointF center;  // level coordinates
+  };
+
+  std::vector<Region> regions;  // largest first
+
+  int level_idx = -1;  // level of the last run, or -1 if there isn't one
+  double elapsed_seconds = 0.0;
+
+  // doesn't touch any pixmaps, so it can run on a worker thread; if a job
+  // is given, it reports progress to it and stops early if it's cancelled
+  bool run(
+    const Level& level,
+    const int level_idx,
+    JobContext* job = nullptr);
+
+  void clear();
+
+  void draw(QGraphicsScene* scene) const;
+
+  static const char* kind_name(const Kind kind);
+
+private:
+  QImage overlay_image;
+  mutable QPixmap overlay_pixmap;  // made from the image on the first draw
+  QPointF overlay_origin;  // level coordinates
+  double overlay_pixel_size = 1.0;  // level units per overlay pixel
+};
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <QtWidgets>
+
+#include "discrepancy_dialog.h"
+
+
+DiscrepancyDialog::DiscrepancyDialog(
+  QWidget* parent,
+  Building& _building,
+  DiscrepancyAnalysis& _analysis,
+  JobScheduler& _jobs,
+  const int _level_idx)
+: QDialog(parent),
+  building(_building),
+  analysis(_analysis),
+  jobs(_jobs),
+  level_idx(_level_idx)
+{
+  setWindowTitle("Map Discrepancies");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  const Level& level = building.levels[level_idx];
+
+  run_button = new QPushButton("Run", this);  // first button = [enter] button
+  close_button = new QPushButton("Close", this);
+
+  QHBoxLayout* layer_hbox = new QHBoxLayout;
+  layer_hbox->addWidget(new QLabel("Occupancy layer:"));
+  layer_combo_box = new QComboBox(this);
+  for (const auto& layer : level.layers)
+    layer_combo_box->addItem(QString::fromStdString(layer.name));
+  if (analysis.layer_idx >= 0 &&
+    analysis.layer_idx < static_cast<int>(level.layers.size()))
+    layer_combo_box->setCurrentIndex(analysis.layer_idx);
+  layer_hbox->addWidget(layer_combo_box);
+
+  QHBoxLayout* resolution_hbox = new QHBoxLayout;
+  resolution_hbox->addWidget(new QLabel("Grid resolution (m):"));
+  resolution_spin_box = new QDoubleSpinBox(this);
+  resolution_spin_box->setDecimals(3);
+  resolution_spin_box->setRange(0.005, 1.0);
+  resolution_spin_box->setSingleStep(0.01);
+  resolution_spin_box->setValue(analysis.resolution);
+  resolution_hbox->addWidget(resolution_spin_box);
+
+  QHBoxLayout* tolerance_hbox = new QHBoxLayout;
+  tolerance_hbox->addWidget(new QLabel("Tolerance (m):"));
+  tolerance_spin_box = new QDoubleSpinBox(this);
+  tolerance_spin_box->setDecimals(2);
+  tolerance_spin_box->setRange(0.0, 5.0);
+  tolerance_spin_box->setSingleStep(0.05);
+  tolerance_spin_box->setValue(analysis.tolerance);
+  tolerance_hbox->addWidget(tolerance_spin_box);
+
+  QHBoxLayout* min_area_hbox = new QHBoxLayout;
+  min_area_hbox->addWidget(new QLabel("Minimum region area (m^2):"));
+  min_area_spin_box = new QDoubleSpinBox(this);
+  min_area_spin_box->setDecimals(3);
+  min_area_spin_box->setRange(0.0, 1000.0);
+  min_area_spin_box->setSingleStep(0.01);
+  min_area_spin_box->setValue(analysis.min_region_area);
+  min_area_hbox->addWidget(min_area_spin_box);
+
+  region_table = new QTableWidget(this);
+  region_table->setColumnCount(4);
+  region_table->setHorizontalHeaderLabels(
+    QStringList() << "Kind" << "Area (m^2)" << "x" << "y");
+  region_table->verticalHeader()->setVisible(false);
+  region_table->horizontalHeader()->setSectionResizeMode(
+    QHeaderView::Stretch);
+  region_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  region_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  connect(
+    region_table, &QTableWidget::cellClicked,
+    this, &DiscrepancyDialog::region_cell_clicked);
+
+  status_label = new QLabel(this);
+  populate_region_table();
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(close_button);
+  bottom_buttons_hbox->addWidget(run_button);
+  connect(
+    run_button, &QAbstractButton::clicked,
+    this, &DiscrepancyDialog::run_button_clicked);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(layer_hbox);
+  top_vbox->addLayout(resolution_hbox);
+  top_vbox->addLayout(tolerance_hbox);
+  top_vbox->addLayout(min_area_hbox);
+  top_vbox->addWidget(new QLabel("Largest discrepancies:"));
+  top_vbox->addWidget(region_table, 1);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+  resize(450, 550);
+}
+
+DiscrepancyDialog::~DiscrepancyDialog()
+{
+  jobs.cancel(job_id);
+}
+
+void DiscrepancyDialog::populate_region_table()
+{
+  region_table->setRowCount(static_cast<int>(analysis.regions.size()));
+  for (std::size_t row = 0; row < analysis.regions.size(); row++)
+  {
+    const DiscrepancyAnalysis::Region& r = analysis.regions[row];
+    region_table->setItem(
+      row, 0, new QTableWidgetItem(DiscrepancyAnalysis::kind_name(r.kind)));
+    region_table->setItem(
+      row, 1, new QTableWidgetItem(QString::number(r.area, 'f', 3)));
+    region_table->setItem(
+      row, 2, new QTableWidgetItem(QString::number(r.center.x(), 'f', 1)));
+    region_table->setItem(
+      row, 3, new QTableWidgetItem(QString::number(r.center.y(), 'f', 1)));
+  }
+
+  if (analysis.level_idx != level_idx)
+    status_label->setText("Not run yet");
+  else
+    status_label->setText(
+      QString("%1 regions (%2 seconds)")
+      .arg(analysis.regions.size())
+      .arg(analysis.elapsed_seconds, 0, 'f', 2));
+}
+
+void DiscrepancyDialog::run_button_clicked()
+{
+  analysis.layer_idx = layer_combo_box->currentIndex();
+  analysis.resolution = resolution_spin_box->value();
+  analysis.tolerance = tolerance_spin_box->value();
+  analysis.min_region_area = min_area_spin_box->value();
+
+  // run on copies, and only replace the results shown once it's done
+  auto result = std::make_shared<DiscrepancyAnalysis>();
+  result->layer_idx = analysis.layer_idx;
+  result->resolution = analysis.resolution;
+  result->tolerance = analysis.tolerance;
+  result->min_region_area = analysis.min_region_area;
+  result->occupied_threshold = analysis.occupied_threshold;
+  auto level =
+    std::make_shared<Level>(building.levels[level_idx].snapshot());
+  const int result_level_idx = level_idx;
+
+  run_button->setEnabled(false);
+  status_label->setText("Running...");
+
+  QPointer<DiscrepancyDialog> dialog(this);
+  job_id = jobs.submit(
+    "Map discrepancies",
+    JobScheduler::INTERACTIVE,
+    [result, level, result_level_idx](JobContext& context)
+    {
+      return result->run(*level, result_level_idx, &context);
+    },
+    [dialog, result](const JobScheduler::Outcome outcome)
+    {
+      if (!dialog)
+        return;
+      dialog->run_button->setEnabled(true);
+      if (outcome == JobScheduler::SUCCEEDED)
+        dialog->analysis = *result;
+      else if (outcome == JobScheduler::FAILED)
+        QMessageBox::warning(
+          dialog,
+          "Map Discrepancies",
+          "Unable to compare. Does the level have a scale and a layer image?");
+
+      dialog->populate_region_table();
+      emit dialog->redraw();
+    });
+}
+
+void DiscrepancyDialog::region_cell_clicked(int row, int /*column*/)
+{
+  if (row < 0 || row >= static_cast<int>(analysis.regions.size()))
+    return;
+  emit center_on(analysis.regions[row].center);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef DISCREPANCY_DIALOG_H
+#define DISCREPANCY_DIALOG_H
+
+#include <QDialog>
+#include <QObject>
+#include <QPointF>
+
+#include "building.h"
+#include "discrepancy_analysis.h"
+#include "job_scheduler.h"
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QTableWidget;
+
+
+class DiscrepancyDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  DiscrepancyDialog(
+    QWidget* parent,
+    Building& building,
+    DiscrepancyAnalysis& analysis,
+    JobScheduler& jobs,
+    const int level_idx);
+  ~DiscrepancyDialog();  // cancels the comparison, if it's still running
+
+private:
+  Building& building;
+  DiscrepancyAnalysis& analysis;
+  JobScheduler& jobs;
+  JobScheduler::JobId job_id = 0;
+  int level_idx = 0;
+
+  QComboBox* layer_combo_box;
+  QDoubleSpinBox* resolution_spin_box;
+  QDoubleSpinBox* tolerance_spin_box;
+  QDoubleSpinBox* min_area_spin_box;
+  QTableWidget* region_table;
+  QLabel* status_label;
+  QPushButton* run_button, * close_button;
+
+  void populate_region_table();
+
+private slots:
+  void run_button_clicked();
+  void region_cell_clicked(int row, int column);
+
+signals:
+  void redraw();
+  void center_on(const QPointF& p);
+};
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "distance_transform.h"
+
+using std::vector;
+
+// number of columns or rows handed to a worker thread at a time
+static const int BAND_SIZE = 64;
+
+
+void DistanceTransform::Workspace::resize(const int n)
+{
+  f.resize(n);
+  d.resize(n);
+  v.resize(n);
+  z.resize(n + 1);
+}
+
+void DistanceTransform::edt_1d(Workspace& ws, const int n)
+{
+  const float* f = ws.f.data();
+  float* d = ws.d.data();
+  int* v = ws.v.data();
+  double* z = ws.z.data();
+
+  // build the lower envelope of the parabolas rooted at the obstacle
+  // cells. Free cells (INF) never contribute, so just skip them, which
+  // also avoids the usual INF - INF precision problems.
+  int k = -1;
+  for (int q = 0; q < n; q++)
+  {
+    if (f[q] >= INF)
+      continue;
+    const double fq = static_cast<double>(f[q]) + static_cast<double>(q) * q;
+    double s = -1e300;
+    while (k >= 0)
+    {
+      const int p = v[k];
+      s = (fq - (static_cast<double>(f[p]) + static_cast<double>(p) * p)) /
+        (2.0 * (q - p));
+      if (s > z[k])
+        break;
+      k--;
+    }
+    k++;
+    v[k] = q;
+    z[k] = k == 0 ? -1e300 : s;
+    z[k + 1] = 1e300;
+  }
+
+  if (k < 0)
+  {
+    std::fill(d, d + n, INF);
+    return;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; q++)
+  {
+    while (z[k + 1] < q)
+      k++;
+    const double dq = static_cast<double>(q - v[k]);
+    d[q] = static_cast<float>(dq * dq + f[v[k]]);
+  }
+}
+
+void DistanceTransform::columns(
+  float* grid,
+  const int width,
+  const int height,
+  const int col_begin,
+  const int col_end,
+  Workspace& ws)
+{
+  ws.resize(height);
+  for (int x = col_begin; x < col_end; x++)
+  {
+    for (int y = 0; y < height; y++)
+      ws.f[y] = grid[y * width + x];
+    edt_1d(ws, height);
+    for (int y = 0; y < height; y++)
+      grid[y * width + x] = ws.d[y];
+  }
+}
+
+void DistanceTransform::rows(
+  float* grid,
+  const int width,
+  const int row_begin,
+  const int row_end,
+  Workspace& ws)
+{
+  ws.resize(width);
+  for (int y = row_begin; y < row_end; y++)
+  {
+    float* row = grid + static_cast<std::size_t>(y) * width;
+    std::copy(row, row + width, ws.f.begin());
+    edt_1d(ws, width);
+    std::copy(ws.d.begin(), ws.d.begin() + width, row);
+  }
+}
+
+void DistanceTransform::squared_edt(
+  float* grid,
+  const int width,
+  const int height)
+{
+  if (width <= 0 || height <= 0)
+    return;
+  Workspace ws;
+  columns(grid, width, height, 0, width, ws);
+  rows(grid, width, 0, height, ws);
+}
+
+void DistanceTransform::squared_edt_parallel(
+  float* grid,
+  const int width,
+  const int height)
+{
+  if (width <= 0 || height <= 0)
+    return;
+
+  vector<int> col_bands;
+  for (int x = 0; x < width; x += BAND_SIZE)
+    col_bands.push_back(x);
+  QtConcurrent::blockingMap(
+    col_bands,
+    [=](const int col_begin)
+    {
+      Workspace ws;
+      columns(
+        grid,
+        width,
+        height,
+        col_begin,
+        std::min(col_begin + BAND_SIZE, width),
+        ws);
+    });
+
+  vector<int> row_bands;
+  for (int y = 0; y < height; y += BAND_SIZE)
+    row_bands.push_back(y);
+  QtConcurrent::blockingMap(
+    row_bands,
+    [=](const int row_begin)
+    {
+      Workspace ws;
+      rows(grid, width, row_begin, std::min(row_begin + BAND_SIZE, height), ws);
+    });
+}
+
+void DistanceTransform::mark_segment(
+  float* grid,
+  const int width,
+  const int height,
+  const double x0,
+  const double y0,
+  const double x1,
+  const double y1)
+{
+  // sample at half-cell spacing, which touches every cell the segment
+  // crosses (to within a corner clip or two, which doesn't matter here)
+  const double dx = x1 - x0;
+  const double dy = y1 - y0;
+  const int steps =
+    std::max(1, static_cast<int>(std::ceil(2.0 * std::hypot(dx, dy))));
+  for (int i = 0; i <= steps; i++)
+  {
+    const double t = static_cast<double>(i) / steps;
+    const int cx = static_cast<int>(std::floor(x0 + t * dx));
+    const int cy = static_cast<int>(std::floor(y0 + t * dy));
+    if (cx < 0 || cy < 0 || cx >= width || cy >= height)
+      continue;
+    grid[static_cast<std::size_t>(cy) * width + cx] = 0.0f;
+  }
+}
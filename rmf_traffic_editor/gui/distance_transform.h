@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef DISTANCE_TRANSFORM_H
+#define DISTANCE_TRANSFORM_H
+
+#include <vector>
+
+/*
+ * Exact Euclidean distance transform of a row-major float grid, using the
+ * separable lower-envelope-of-parabolas algorithm of Felzenszwalb and
+ * Huttenlocher: one 1-D pass down every column, then one along every row.
+ * Each 1-D pass is independent of the others, so the parallel variant
+ * simply splits the columns (then the rows) across the thread pool.
+ *
+ * On input, obstacle cells must be 0 and free cells must be INF. On
+ * output, every cell holds the squared distance (in cells) to the nearest
+ * obstacle cell, or INF if there are no obstacles at all.
+ */
+
+class DistanceTransform
+{
+public:
+  static constexpr float INF = 1e20f;
+
+  static void squared_edt(float* grid, const int width, const int height);
+
+  static void squared_edt_parallel(
+    float* grid,
+    const int width,
+    const int height);
+
+  // mark every cell touched by the segment (in fractional cell coordinates)
+  // as an obstacle, clipped to the grid
+  static void mark_segment(
+    float* grid,
+    const int width,
+    const int height,
+    const double x0,
+    const double y0,
+    const double x1,
+    const double y1);
+
+private:
+  struct Workspace
+  {
+    std::vector<float> f;
+    std::vector<float> d;
+    std::vector<int> v;
+    std::vector<double> z;
+
+    void resize(const int n);
+  };
+
+  static void edt_1d(Workspace& ws, const int n);
+
+  static void columns(
+    float* grid,
+    const int width,
+    const int height,
+    const int col_begin,
+    const int col_end,
+    Workspace& ws);
+
+  static void rows(
+    float* grid,
+    const int width,
+    const int row_begin,
+    const int row_end,
+    Workspace& ws);
+};
+
+#endif
@@ -22,16 +22,14 @@ using std::string;
 Edge::Edge()
 : start_idx(0),
   end_idx(0),
-  type(UNDEFINED),
-  selected(false)
+  type(UNDEFINED)
 {
 }
 
 Edge::Edge(const int _start_idx, const int _end_idx, const Type _type)
 : start_idx(_start_idx),
   end_idx(_end_idx),
-  type(_type),
-  selected(false)
+  type(_type)
 {
   create_required_parameters();
 }
@@ -75,14 +73,6 @@ YAML::Node Edge::to_yaml() const
   return y;
 }
 
-bool Edge::is_bidirectional() const
-{
-  auto it = params.find("bidirectional");
-  if (it == params.end() || it->second.type != Param::BOOL)
-    return false;
-  return it->second.value_bool;
-}
-
 void Edge::set_param(const std::string& name, const std::string& value)
 {
   auto it = params.find(name);
@@ -92,6 +82,40 @@ void Edge::set_param(const std::string& name, const std::string& value)
     return;  // unknown parameter
   }
   it->second.set(value);
+  update_cached_params();
+}
+
+void Edge::update_cached_params()
+{
+  auto it = params.find("bidirectional");
+  _bidirectional =
+    it != params.end() && it->second.type == Param::BOOL &&
+    it->second.value_bool;
+
+  _orientation = ORIENTATION_ANY;
+  it = params.find("orientation");
+  if (it != params.end() && it->second.type == Param::STRING)
+  {
+    if (it->second.value_string == "forward")
+      _orientation = ORIENTATION_FORWARD;
+    else if (it->second.value_string == "backward")
+      _orientation = ORIENTATION_BACKWARD;
+  }
+
+  it = params.find("graph_idx");
+  _graph_idx =
+    it != params.end() && it->second.type == Param::INT ?
+    it->second.value_int : 0;
+
+  it = params.find("width");
+  _width =
+    it != params.end() && it->second.type == Param::DOUBLE ?
+    it->second.value_double : -1.0;
+
+  it = params.find("distance");
+  _distance =
+    it != params.end() && it->second.type == Param::DOUBLE ?
+    it->second.value_double : 0.0;
 }
 
 template<typename T>
@@ -153,6 +177,8 @@ void Edge::create_required_parameters()
       std::string());
     create_param_if_needed("demo_mock_lift_name", Param::STRING, std::string());
   }
+
+  update_cached_params();
 }
 
 std::string Edge::type_to_string() const
@@ -180,24 +206,5 @@ void Edge::set_graph_idx(const int idx)
   if (type != LANE && type != HUMAN_LANE)
     return;// for now at least, only lanes have graph indices
   params["graph_idx"] = Param(idx);
-}
-
-int Edge::get_graph_idx() const
-{
-  if (type != LANE && type != HUMAN_LANE)
-    return 0;// for now, only lanes have indices defined
-  auto it = params.find("graph_idx");
-  if (it == params.end() || it->second.type != Param::INT)
-    return 0;// shouldn't get here
-  return it->second.value_int;
-}
-
-double Edge::get_width() const
-{
-  if (type != HUMAN_LANE)
-    return -1.0;
-  auto it = params.find("width");
-  if (it == params.end() || it->second.type != Param::DOUBLE)
-    return -1.0;// shouldn't get here
-  return it->second.value_double;
+  _graph_idx = idx;
 }
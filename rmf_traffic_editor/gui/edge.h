@@ -42,20 +42,34 @@ public:
     HUMAN_LANE,
   } type;
 
-  bool selected;  // only for visualization, not saved to YAML
-
   Edge();
   Edge(const int _start_idx, const int _end_idx, const Type _type);
   ~Edge();
 
+  // Generic parameters, as saved to YAML. The ones read on every redraw
+  // are also cached in typed members below, which from_yaml(), set_param()
+  // and set_graph_idx() keep in step; anything which changes params
+  // directly must call update_cached_params() afterwards.
   std::map<std::string, Param> params;
 
   void from_yaml(const YAML::Node& data, const Type edge_type);
   YAML::Node to_yaml() const;
 
   void set_param(const std::string& name, const std::string& value);
+  void update_cached_params();
+
+  bool is_bidirectional() const { return _bidirectional; }
+
+  enum Orientation
+  {
+    ORIENTATION_ANY = 0,
+    ORIENTATION_FORWARD,
+    ORIENTATION_BACKWARD
+  };
+  Orientation get_orientation() const { return _orientation; }
 
-  bool is_bidirectional() const;
+  // "distance" of a MEAS edge in meters, or 0 if it has none
+  double get_distance() const { return _distance; }
 
   void create_required_parameters();
 
@@ -68,9 +82,24 @@ public:
   std::string type_to_string() const;
   QString type_to_qstring() const;
   void set_graph_idx(const int idx);
-  int get_graph_idx() const;
 
-  double get_width() const;
+  int get_graph_idx() const
+  {
+    // for now, only lanes have graph indices
+    return type == LANE || type == HUMAN_LANE ? _graph_idx : 0;
+  }
+
+  double get_width() const
+  {
+    return type == HUMAN_LANE ? _width : -1.0;
+  }
+
+private:
+  bool _bidirectional = false;
+  Orientation _orientation = ORIENTATION_ANY;
+  int _graph_idx = 0;
+  double _width = -1.0;
+  double _distance = 0.0;
 };
 
 #endif
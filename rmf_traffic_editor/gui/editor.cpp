@@ -36,29 +36,43 @@
 #include "ament_index_cpp/get_resource.hpp"
 
 #include "actions/add_constraint.hpp"
+#include "actions/add_edge_graph.h"
 #include "actions/add_feature.h"
 #include "actions/add_fiducial.h"
 #include "actions/add_model.h"
 #include "actions/add_property.h"
 #include "actions/add_polygon.h"
+#include "actions/add_polygons.h"
 #include "actions/add_vertex.h"
 #include "actions/delete.h"
+#include "actions/nudge.h"
 #include "actions/polygon_add_vertex.h"
 #include "actions/polygon_remove_vertices.h"
 
 #include "add_param_dialog.h"
+#include "auto_lane_dialog.h"
 #include "building_dialog.h"
+#include "building_diff_dialog.h"
+#include "clearance_dialog.h"
+#include "discrepancy_dialog.h"
 #include "editor.h"
+#include "floor_proposal_dialog.h"
+#include "job_status_widget.h"
 #include "layer_dialog.h"
 #include "layer_table.h"
 #include "level_dialog.h"
 #include "level_table.h"
 #include "lift_table.h"
+#include "live_feed_dialog.h"
 #include "map_view.h"
+#include "memory_dialog.h"
 #include "model_dialog.h"
 #include "preferences_dialog.h"
 #include "preferences_keys.h"
+#include "replay_dialog.h"
+#include "traffic_heatmap_dialog.h"
 #include "traffic_table.h"
+#include "wall_proposal_dialog.h"
 #include "ui_new_building_dialog.h"
 #include "ui_transform_dialog.h"
 
@@ -361,10 +375,81 @@ Editor::Editor()
   view_tiles_action->setCheckable(true);
   view_tiles_action->setChecked(true);
 
+  view_clearance_action =
+    view_menu->addAction("&Clearance overlay", this, &Editor::view_clearance);
+  view_clearance_action->setCheckable(true);
+  view_clearance_action->setChecked(true);
+
+  view_discrepancy_action = view_menu->addAction(
+    "Map &discrepancy overlay",
+    this,
+    &Editor::view_discrepancy);
+  view_discrepancy_action->setCheckable(true);
+  view_discrepancy_action->setChecked(true);
+
+  view_traffic_heatmap_action = view_menu->addAction(
+    "Traffic &heatmap overlay",
+    this,
+    &Editor::view_traffic_heatmap);
+  view_traffic_heatmap_action->setCheckable(true);
+  view_traffic_heatmap_action->setChecked(true);
+
+  view_building_diff_action = view_menu->addAction(
+    "Revision &changes overlay",
+    this,
+    &Editor::view_building_diff);
+  view_building_diff_action->setCheckable(true);
+  view_building_diff_action->setChecked(true);
+
   view_menu->addSeparator();
 
   view_menu->addAction("&Reset zoom level", this, &Editor::zoom_reset);
 
+  // TOOLS MENU
+  QMenu* tools_menu = menuBar()->addMenu("&Tools");
+  tools_menu->addAction(
+    "Lane &clearance check...",
+    this,
+    &Editor::tools_lane_clearance);
+  tools_menu->addAction(
+    "Map &discrepancy check...",
+    this,
+    &Editor::tools_map_discrepancy);
+  tools_menu->addAction(
+    "Traffic &heatmap from pose log...",
+    this,
+    &Editor::tools_traffic_heatmap);
+  tools_menu->addAction(
+    "&Replay trajectories from pose log...",
+    this,
+    &Editor::tools_replay);
+  tools_menu->addAction(
+    "&Live robot poses from UDP...",
+    this,
+    &Editor::tools_live_feed);
+  tools_menu->addAction(
+    "Compare with &earlier revision...",
+    this,
+    &Editor::tools_building_diff);
+  tools_menu->addSeparator();
+  tools_menu->addAction(
+    "&Propose lanes from layer...",
+    this,
+    &Editor::tools_propose_lanes);
+  tools_menu->addAction(
+    "Propose &walls from layer...",
+    this,
+    &Editor::tools_propose_walls);
+  tools_menu->addAction(
+    "Propose &floors from walls...",
+    this,
+    &Editor::tools_propose_floors);
+  tools_menu->addSeparator();
+  tools_menu->addAction(
+    "&Memory usage...",
+    this,
+    &Editor::tools_memory_usage);
+
   // HELP MENU
   QMenu* help_menu = menuBar()->addMenu("&Help");
 
@@ -419,6 +504,8 @@ Editor::Editor()
   cache_size_label = new QLabel("cache size");
   statusBar()->addPermanentWidget(cache_size_label);
   map_view->update_cache_size_label(cache_size_label);
+  job_status_widget = new JobStatusWidget(this, jobs);
+  statusBar()->addPermanentWidget(job_status_widget);
 
   ///////////////////////////////////////////////////////////
   // SET SIZE
@@ -451,6 +538,22 @@ Editor::Editor()
   load_model_names();
   level_table->setCurrentCell(level_idx, 0);
 
+  register_memory_caches();
+  load_memory_budget();
+  load_nudge_steps();
+
+  nudge_redraw_timer = new QTimer(this);
+  nudge_redraw_timer->setSingleShot(true);
+  nudge_redraw_timer->setInterval(30);
+  connect(
+    nudge_redraw_timer,
+    &QTimer::timeout,
+    [this]()
+    {
+      create_scene();
+      update_property_editor();
+    });
+
   cache_size_update_timer = new QTimer;
   connect(
     cache_size_update_timer,
@@ -560,11 +663,24 @@ Editor* Editor::get_instance()
 
 bool Editor::load_building(const QString& filename)
 {
+  // let the previous building finish saving before it's replaced
+  jobs.wait(save_job);
+
   const QString absolute_path = QFileInfo(filename).absoluteFilePath();
   if (!building.load(absolute_path.toStdString()))
     return false;
 
+  // whatever is running was computed from the previous building
+  jobs.cancel_all();
+
   level_idx = 0;
+  clearance_analysis.clear();
+  discrepancy_analysis.clear();
+  traffic_heatmap.clear();
+  building_diff.clear();
+  replay_markers = RobotMarkers();
+  live_markers = RobotMarkers();
+  wall_proposal.clear();
 
   map_view->set_show_tiles(false);
 
@@ -611,15 +727,12 @@ void Editor::restore_previous_viewport()
   {
     const std::string level_name =
       settings.value(preferences_keys::level_name).toString().toStdString();
-    for (std::size_t i = 0; i < building.levels.size(); i++)
+    const int idx = building.find_level(level_name);
+    if (idx >= 0)
     {
-      if (building.levels[i].name == level_name)
-      {
-        level_idx = i;
-        create_scene();
-        level_table->setCurrentCell(i, 0);
-        break;
-      }
+      level_idx = idx;
+      create_scene();
+      level_table->setCurrentCell(idx, 0);
     }
   }
 
@@ -692,8 +805,19 @@ bool Editor::load_previous_building()
 void Editor::building_new()
 {
   QFileDialog file_dialog(this, "New Building");
-  file_dialog.setNameFilter("*.building.yaml");
+  file_dialog.setNameFilters(
+    QStringList()
+    << "Building files (*.building.yaml)"
+    << "Compressed building files (*.building.yaml.gz)");
   file_dialog.setDefaultSuffix(".building.yaml");
+  connect(
+    &file_dialog,
+    &QFileDialog::filterSelected,
+    [&file_dialog](const QString& filter)
+    {
+      file_dialog.setDefaultSuffix(
+        filter.contains(".gz") ? ".building.yaml.gz" : ".building.yaml");
+    });
   file_dialog.setAcceptMode(QFileDialog::AcceptMode::AcceptSave);
   file_dialog.setConfirmOverwrite(true);
 
@@ -716,6 +840,8 @@ void Editor::building_new()
   if (new_building_dialog.exec() != QDialog::Accepted)
     return;
 
+  jobs.wait(save_job);
+  jobs.cancel_all();
   building.clear();
   if (new_building_dialog_ui.geolocated_radio->isChecked())
     building.coordinate_system.value = CoordinateSystem::Value::WGS84;
@@ -741,7 +867,8 @@ void Editor::building_open()
 {
   QFileDialog file_dialog(this, "Open Building");
   file_dialog.setFileMode(QFileDialog::ExistingFile);
-  file_dialog.setNameFilter("*.building.yaml");
+  file_dialog.setNameFilter(
+    "Building files (*.building.yaml *.building.yaml.gz)");
 
   if (file_dialog.exec() != QDialog::Accepted)
     return;
@@ -758,18 +885,41 @@ void Editor::building_open()
   load_building(file_info.filePath());
 }
 
-bool Editor::building_save()
+void Editor::building_save()
 {
-  if (!building.save())
-  {
-    QMessageBox::critical(
-      this,
-      "Unable to save",
-      "Save failed! Maybe a bad path?");
-    return false;
-  }
+  submit_save();
+}
+
+JobScheduler::JobId Editor::submit_save()
+{
+  std::shared_ptr<Building> snapshot = building.snapshot();
+  std::vector<JobScheduler::JobId> after;
+  if (jobs.pending(save_job))
+    after.push_back(save_job);
+
+  // edits made while it's saving will mark the window as modified again
   setWindowModified(false);
-  return true;
+
+  save_job = jobs.submit(
+    "Saving",
+    JobScheduler::INTERACTIVE,
+    [snapshot](JobContext&)
+    {
+      return snapshot->save();
+    },
+    [this](const JobScheduler::Outcome outcome)
+    {
+      if (outcome == JobScheduler::SUCCEEDED)
+        return;
+      setWindowModified(true);
+      if (outcome == JobScheduler::FAILED)
+        QMessageBox::critical(
+          this,
+          "Unable to save",
+          "Save failed! Maybe a bad path?");
+    },
+    after);
+  return save_job;
 }
 
 bool Editor::building_export_features()
@@ -823,7 +973,14 @@ void Editor::edit_preferences()
   PreferencesDialog preferences_dialog(this);
 
   if (preferences_dialog.exec() == QDialog::Accepted)
+  {
     load_model_names();
+    QSettings settings;
+    map_view->set_tile_source(
+      settings.value(preferences_keys::tile_source).toString());
+    load_memory_budget();
+    load_nudge_steps();
+  }
 }
 
 void Editor::edit_building_properties()
@@ -851,9 +1008,39 @@ void Editor::edit_rotate_all_models()
 void Editor::edit_optimize_layer_transforms()
 {
   printf("Editor::edit_optimize_layer_transforms()\n");
-  if (level_idx < static_cast<int>(building.levels.size()))
-    building.levels[level_idx].optimize_layer_transforms();
-  create_scene();
+  if (level_idx >= static_cast<int>(building.levels.size()))
+    return;
+
+  // the layers may be moved or renamed while the solver runs, so the
+  // results are matched back up by name
+  auto snapshot =
+    std::make_shared<Level>(building.levels[level_idx].snapshot());
+
+  jobs.submit(
+    "Optimizing layer transforms",
+    JobScheduler::INTERACTIVE,
+    [snapshot](JobContext& context)
+    {
+      return snapshot->optimize_layer_transforms(&context);
+    },
+    [this, snapshot](const JobScheduler::Outcome outcome)
+    {
+      if (outcome != JobScheduler::SUCCEEDED)
+        return;
+      const int result_level_idx = building.find_level(snapshot->name);
+      if (result_level_idx < 0)
+        return;
+      Level& level = building.levels[result_level_idx];
+      for (const Layer& result : snapshot->layers)
+      {
+        for (Layer& layer : level.layers)
+        {
+          if (layer.name == result.name)
+            layer.transform = result.transform;
+        }
+      }
+      create_scene();
+    });
 }
 
 void Editor::edit_align_colinear()
@@ -878,6 +1065,391 @@ void Editor::view_tiles()
   create_scene();
 }
 
+void Editor::view_clearance()
+{
+  create_scene();
+}
+
+void Editor::view_discrepancy()
+{
+  create_scene();
+}
+
+void Editor::view_traffic_heatmap()
+{
+  create_scene();
+}
+
+void Editor::view_building_diff()
+{
+  create_scene();
+}
+
+void Editor::tools_lane_clearance()
+{
+  if (building.levels.empty())
+    return;
+
+  ClearanceDialog* dialog =
+    new ClearanceDialog(this, building, clearance_analysis, jobs, level_idx);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+  connect(
+    dialog,
+    &ClearanceDialog::redraw,
+    [=]()
+    {
+      view_clearance_action->setChecked(true);
+      create_scene();
+    }
+  );
+  connect(
+    dialog,
+    &ClearanceDialog::building_modified,
+    [=]()
+    {
+      setWindowModified(true);
+    }
+  );
+  connect(
+    dialog,
+    &ClearanceDialog::center_on,
+    [=](const QPointF& p)
+    {
+      map_view->centerOn(p);
+    }
+  );
+}
+
+void Editor::tools_map_discrepancy()
+{
+  if (building.levels.empty())
+    return;
+
+  DiscrepancyDialog* dialog =
+    new DiscrepancyDialog(
+    this,
+    building,
+    discrepancy_analysis,
+    jobs,
+    level_idx);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+  connect(
+    dialog,
+    &DiscrepancyDialog::redraw,
+    [=]()
+    {
+      view_discrepancy_action->setChecked(true);
+      create_scene();
+    }
+  );
+  connect(
+    dialog,
+    &DiscrepancyDialog::center_on,
+    [=](const QPointF& p)
+    {
+      map_view->centerOn(p);
+    }
+  );
+}
+
+void Editor::tools_traffic_heatmap()
+{
+  if (building.levels.empty())
+    return;
+
+  TrafficHeatmapDialog* dialog =
+    new TrafficHeatmapDialog(
+    this,
+    building,
+    traffic_heatmap,
+    jobs,
+    level_idx);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+  connect(
+    dialog,
+    &TrafficHeatmapDialog::redraw,
+    [=]()
+    {
+      view_traffic_heatmap_action->setChecked(true);
+      create_scene();
+    }
+  );
+  connect(
+    dialog,
+    &TrafficHeatmapDialog::center_on,
+    [=](const QPointF& p)
+    {
+      map_view->centerOn(p);
+    }
+  );
+}
+
+void Editor::tools_building_diff()
+{
+  if (building.levels.empty())
+    return;
+
+  BuildingDiffDialog* dialog =
+    new BuildingDiffDialog(this, building, building_diff, level_idx);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+  connect(
+    dialog,
+    &BuildingDiffDialog::redraw,
+    [=]()
+    {
+      view_building_diff_action->setChecked(true);
+      create_scene();
+    }
+  );
+  connect(
+    dialog,
+    &BuildingDiffDialog::center_on,
+    [=](const QPointF& p)
+    {
+      map_view->centerOn(p);
+    }
+  );
+}
+
+void Editor::tools_replay()
+{
+  if (building.levels.empty())
+    return;
+
+  ReplayDialog* dialog = new ReplayDialog(this, building, jobs, level_idx);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+  connect(
+    dialog,
+    &ReplayDialog::markers_changed,
+    [=](
+      const int _level_idx,
+      const std::vector<RobotMarkersItem::Marker>& markers)
+    {
+      set_robot_markers(replay_markers, _level_idx, markers);
+    }
+  );
+}
+
+void Editor::tools_live_feed()
+{
+  if (building.levels.empty())
+    return;
+
+  LiveFeedDialog* dialog = new LiveFeedDialog(this, building, level_idx);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+  connect(
+    dialog,
+    &LiveFeedDialog::markers_changed,
+    [=](
+      const int _level_idx,
+      const std::vector<RobotMarkersItem::Marker>& markers)
+    {
+      set_robot_markers(live_markers, _level_idx, markers);
+    }
+  );
+}
+
+void Editor::set_robot_markers(
+  RobotMarkers& robot_markers,
+  const int _level_idx,
+  const std::vector<RobotMarkersItem::Marker>& markers)
+{
+  robot_markers.level_idx = _level_idx;
+  robot_markers.markers = markers;
+  if (robot_markers.markers.empty() || robot_markers.level_idx != level_idx)
+  {
+    if (robot_markers.item)
+    {
+      scene->removeItem(robot_markers.item);
+      delete robot_markers.item;
+      robot_markers.item = nullptr;
+    }
+    return;
+  }
+
+  // only this one item changes, so the rest of the scene isn't redrawn
+  if (!robot_markers.item)
+  {
+    robot_markers.item = new RobotMarkersItem;
+    scene->addItem(robot_markers.item);
+  }
+  robot_markers.item->set_markers(robot_markers.markers);
+}
+
+void Editor::draw_robot_markers(RobotMarkers& robot_markers)
+{
+  if (robot_markers.level_idx != level_idx || robot_markers.markers.empty())
+    return;
+  robot_markers.item = new RobotMarkersItem;
+  robot_markers.item->set_markers(robot_markers.markers);
+  scene->addItem(robot_markers.item);
+}
+
+void Editor::tools_propose_lanes()
+{
+  if (building.levels.empty())
+    return;
+  const Level& level = building.levels[level_idx];
+  if (level.layers.empty())
+  {
+    QMessageBox::warning(
+      this,
+      "Propose lanes",
+      "This level doesn't have any layers to propose lanes from.");
+    return;
+  }
+
+  AutoLaneDialog dialog(this, level, lane_proposal);
+  if (dialog.exec() != QDialog::Accepted)
+    return;
+
+  // the proposal runs on a copy of the settings and of the level, so
+  // editing can carry on while it's thinking
+  auto proposal = std::make_shared<LaneProposal>(lane_proposal);
+  auto snapshot = std::make_shared<Level>(level.snapshot());
+  const int proposal_level_idx = level_idx;
+  const int graph_idx = rendering_options.active_traffic_map_idx;
+
+  jobs.submit(
+    "Proposing lanes",
+    JobScheduler::INTERACTIVE,
+    [proposal, snapshot](JobContext&)
+    {
+      return proposal->run(*snapshot);
+    },
+    [this, proposal, proposal_level_idx, graph_idx](
+      const JobScheduler::Outcome outcome)
+    {
+      if (outcome == JobScheduler::CANCELLED)
+        return;
+      if (outcome == JobScheduler::FAILED || proposal->lanes.empty())
+      {
+        QMessageBox::warning(
+          this,
+          "Propose lanes",
+          "No lanes found. Is the layer image loaded, and the scale set?");
+        return;
+      }
+      if (proposal_level_idx >= static_cast<int>(building.levels.size()))
+        return;
+
+      undo_stack.push(
+        new AddEdgeGraphCommand(
+          &building,
+          proposal_level_idx,
+          Edge::LANE,
+          graph_idx,
+          proposal->vertices,
+          proposal->lanes));
+      setWindowModified(true);
+      create_scene();
+    });
+}
+
+void Editor::tools_propose_walls()
+{
+  if (building.levels.empty())
+    return;
+  if (building.levels[level_idx].layers.empty())
+  {
+    QMessageBox::warning(
+      this,
+      "Propose walls",
+      "This level doesn't have any layers to propose walls from.");
+    return;
+  }
+
+  WallProposalDialog* dialog =
+    new WallProposalDialog(this, building, wall_proposal, jobs, level_idx);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+  connect(
+    dialog,
+    &WallProposalDialog::redraw,
+    [=]()
+    {
+      create_scene();
+    }
+  );
+  connect(
+    dialog,
+    &WallProposalDialog::add_walls,
+    [=]()
+    {
+      if (wall_proposal.level_idx < 0)
+        return;
+      undo_stack.push(
+        new AddEdgeGraphCommand(
+          &building,
+          wall_proposal.level_idx,
+          Edge::WALL,
+          0,
+          wall_proposal.vertices,
+          wall_proposal.walls));
+      setWindowModified(true);
+    }
+  );
+  connect(
+    dialog,
+    &QDialog::finished,
+    [=]()
+    {
+      wall_proposal.clear();
+      create_scene();
+    }
+  );
+}
+
+void Editor::tools_propose_floors()
+{
+  if (building.levels.empty())
+    return;
+
+  FloorProposalDialog dialog(this, floor_proposal);
+  if (dialog.exec() != QDialog::Accepted)
+    return;
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  floor_proposal.run(building.levels[level_idx]);
+  QApplication::restoreOverrideCursor();
+
+  if (floor_proposal.polygons.empty())
+  {
+    QMessageBox::information(
+      this,
+      "Propose floors",
+      "No new rooms found. Are they fully enclosed by walls?");
+    return;
+  }
+
+  undo_stack.push(
+    new AddPolygonsCommand(
+      &building,
+      level_idx,
+      floor_proposal.vertices,
+      floor_proposal.polygons));
+  setWindowModified(true);
+  create_scene();
+  statusBar()->showMessage(
+    QString("Added %1 floors and %2 holes")
+    .arg(floor_proposal.num_floors)
+    .arg(floor_proposal.num_holes),
+    5000);
+}
+
 void Editor::zoom_reset()
 {
   map_view->zoom_fit(level_idx);
@@ -1029,9 +1601,12 @@ void Editor::keyPressEvent(QKeyEvent* e)
       tool_button_group->button(TOOL_ADD_DOOR)->click();
       break;
     case Qt::Key_B:
-      for (auto& edge : building.levels[level_idx].edges)
+    {
+      Level& level = building.levels[level_idx];
+      for (const int edge_idx : level.selection().indices(SelectionSet::EDGE))
       {
-        if (edge.type == Edge::LANE && edge.selected)
+        Edge& edge = level.edges[edge_idx];
+        if (edge.type == Edge::LANE)
         {
           // toggle bidirectional flag
           edge.set_param("bidirectional",
@@ -1040,6 +1615,13 @@ void Editor::keyPressEvent(QKeyEvent* e)
         }
       }
       break;
+    }
+    case Qt::Key_Left:
+    case Qt::Key_Right:
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+      arrow_key_pressed(e);
+      break;
     case Qt::Key_0: number_key_pressed(0); break;
     case Qt::Key_1: number_key_pressed(1); break;
     case Qt::Key_2: number_key_pressed(2); break;
@@ -1055,6 +1637,81 @@ void Editor::keyPressEvent(QKeyEvent* e)
   }
 }
 
+void Editor::arrow_key_pressed(QKeyEvent* e)
+{
+  int x = 0, y = 0;  // in screen directions
+  switch (e->key())
+  {
+    case Qt::Key_Left: x = -1; break;
+    case Qt::Key_Right: x = 1; break;
+    case Qt::Key_Up: y = -1; break;
+    case Qt::Key_Down: y = 1; break;
+    default: return;
+  }
+
+  if (building.levels.empty() ||
+    building.levels[level_idx].selection().empty())
+  {
+    // nothing to nudge, so scroll like the view would have
+    QScrollBar* scroll_bar = x ?
+      map_view->horizontalScrollBar() : map_view->verticalScrollBar();
+    scroll_bar->triggerAction(
+      x + y < 0 ?
+      QAbstractSlider::SliderSingleStepSub :
+      QAbstractSlider::SliderSingleStepAdd);
+    return;
+  }
+
+  Level& level = building.levels[level_idx];
+  if (level.drawing_meters_per_pixel <= 0.0)
+    return;
+  const double step_meters =
+    (e->modifiers() & Qt::ShiftModifier) ? nudge_large_step : nudge_step;
+  const double step = step_meters / level.drawing_meters_per_pixel;
+
+  // screen up is scene -y, unless the view is flipped
+  const double y_flip = map_view->transform().m22() < 0.0 ? -1.0 : 1.0;
+
+  NudgeCommand* command =
+    new NudgeCommand(&building, level_idx, x * step, y * y_flip * step);
+  if (command->empty())
+  {
+    delete command;
+    return;
+  }
+  const bool models_only = command->models_only();
+  const std::vector<int> model_idxs = command->models();
+
+  // consecutive nudges merge into the command on top of the stack
+  undo_stack.push(command);
+  setWindowModified(true);
+
+  if (models_only)
+  {
+    // as when dragging a model, just move its pixmap
+    for (const int model_idx : model_idxs)
+    {
+      const Model& model = level.models[model_idx];
+      if (model.pixmap_item)
+        model.pixmap_item->setPos(model.state.x, model.state.y);
+    }
+    return;
+  }
+
+  // vertices drag their edges and polygons along, so those are redrawn,
+  // but only once however many key repeats arrive in the meantime
+  if (!nudge_redraw_timer->isActive())
+    nudge_redraw_timer->start();
+}
+
+void Editor::load_nudge_steps()
+{
+  QSettings settings;
+  nudge_step = settings.value(preferences_keys::nudge_step, 0.01).toDouble();
+  nudge_large_step =
+    settings.value(preferences_keys::nudge_large_step, 0.1).toDouble();
+}
+
 const QString Editor::tool_id_to_string(const int id)
 {
   switch (id)
@@ -1163,71 +1820,61 @@ void Editor::update_property_editor()
   if (building.levels.empty())
     return;
 
-  for (const auto& p : building.levels[level_idx].polygons)
+  // in each case, show the first (lowest-index) selected one
+  const Level& level = building.levels[level_idx];
+
+  const int polygon_idx = level.first_selected(SelectionSet::POLYGON);
+  if (polygon_idx >= 0)
   {
-    if (p.selected)
-    {
-      populate_property_editor(p);
-      return;
-    }
+    populate_property_editor(level.polygons[polygon_idx], polygon_idx);
+    return;
   }
 
-  for (const auto& e : building.levels[level_idx].edges)
+  const int edge_idx = level.first_selected(SelectionSet::EDGE);
+  if (edge_idx >= 0)
   {
-    if (e.selected)
-    {
-      populate_property_editor(e);
-      return;  // stop after finding the first one
-    }
+    populate_property_editor(level.edges[edge_idx]);
+    return;
   }
 
-  for (const auto& m : building.levels[level_idx].models)
+  const int model_idx = level.first_selected(SelectionSet::MODEL);
+  if (model_idx >= 0)
   {
-    if (m.selected)
-    {
-      populate_property_editor(m);
-      return;  // stop after finding the first one
-    }
+    populate_property_editor(level.models[model_idx]);
+    return;
   }
 
-  for (size_t i = 0; i < building.levels[level_idx].vertices.size(); i++)
+  const int vertex_idx = level.first_selected(SelectionSet::VERTEX);
+  if (vertex_idx >= 0)
   {
-    const Vertex& v = building.levels[level_idx].vertices[i];
-    if (v.selected)
-    {
-      populate_property_editor(v, i);
-      return;  // stop after finding the first one
-    }
+    populate_property_editor(level.vertices[vertex_idx], vertex_idx);
+    return;
   }
 
-  for (const auto& feature : building.levels[level_idx].floorplan_features)
+  const int floorplan_feature_idx =
+    level.first_selected(SelectionSet::FEATURE, 0);
+  if (floorplan_feature_idx >= 0)
   {
-    if (feature.selected())
-    {
-      populate_property_editor(feature);
-      return;
-    }
+    populate_property_editor(level.floorplan_features[floorplan_feature_idx]);
+    return;
   }
 
-  for (const auto& layer : building.levels[level_idx].layers)
+  for (std::size_t i = 0; i < level.layers.size(); i++)
   {
-    for (const auto& feature : layer.features)
+    const int feature_idx =
+      level.first_selected(SelectionSet::FEATURE, static_cast<int>(i) + 1);
+    if (feature_idx >= 0)
     {
-      if (feature.selected())
-      {
-        populate_property_editor(feature);
-        return;
-      }
+      populate_property_editor(level.layers[i].features[feature_idx]);
+      return;
     }
   }
 
-  for (const auto& f : building.levels[level_idx].fiducials)
+  const int fiducial_idx = level.first_selected(SelectionSet::FIDUCIAL);
+  if (fiducial_idx >= 0)
   {
-    if (f.selected)
-    {
-      populate_property_editor(f);
-      return;  // stop after finding the first one
-    }
+    populate_property_editor(level.fiducials[fiducial_idx]);
+    return;
   }
 
   // if we get here, we never found anything :(
@@ -1394,6 +2041,7 @@ void Editor::layer_add_button_clicked()
   printf("added a layer: [%s]\n", layer.name.c_str());
   layer.color = Layer::default_color(level.layers.size());
   layer.load_image();
+  layer.georeference(building.coordinate_system);
   level.layers.push_back(layer);
   layer_table->update(building, level_idx, layer_idx);
   create_scene();
@@ -1582,14 +2230,22 @@ void Editor::populate_property_editor(const Model& model)
   property_editor->blockSignals(false);  // re-enable callbacks
 }
 
-void Editor::populate_property_editor(const Polygon& polygon)
+void Editor::populate_property_editor(const Polygon& polygon, const int index)
 {
   printf("populate_property_editor(polygon)\n");
   property_editor->blockSignals(true);  // otherwise we get tons of callbacks
 
-  property_editor->setRowCount(polygon.params.size());
+  const Level& level = building.levels[level_idx];
+  property_editor->setRowCount(3 + polygon.params.size());
 
-  int row = 0;
+  property_editor_set_row(0, "index", index);
+  property_editor_set_row(
+    1,
+    "vertices",
+    static_cast<int>(polygon.vertices.size()));
+  property_editor_set_row(2, "area (m^2)", level.polygon_area(index));
+
+  int row = 3;
   for (const auto& param : polygon.params)
   {
     property_editor_set_row(
@@ -1626,10 +2282,13 @@ void Editor::property_editor_cell_changed(int row, int column)
   printf("property_editor_cell_changed(%d, %d) = param %s\n",
     row, column, name.c_str());
 
-  for (auto& v : building.levels[level_idx].vertices)
+  // edit the first selected element, in this order of precedence
+  Level& level = building.levels[level_idx];
+
+  const int vertex_idx = level.first_selected(SelectionSet::VERTEX);
+  if (vertex_idx >= 0)
   {
-    if (!v.selected)
-      continue;
+    Vertex& v = level.vertices[vertex_idx];
     if (name == "name")
       v.name = value;
     else if (name == "x (pixels)")
@@ -1640,46 +2299,42 @@ void Editor::property_editor_cell_changed(int row, int column)
       v.set_param(name, value);
     create_scene();
     setWindowModified(true);
-    return;  // stop after finding the first one
+    return;
   }
 
-  for (auto& e : building.levels[level_idx].edges)
+  const int edge_idx = level.first_selected(SelectionSet::EDGE);
+  if (edge_idx >= 0)
   {
-    if (!e.selected)
-      continue;
-    e.set_param(name, value);
+    level.edges[edge_idx].set_param(name, value);
     create_scene();
     setWindowModified(true);
-    return;  // stop after finding the first one
+    return;
   }
 
-  for (auto& f : building.levels[level_idx].fiducials)
+  const int fiducial_idx = level.first_selected(SelectionSet::FIDUCIAL);
+  if (fiducial_idx >= 0)
   {
-    if (!f.selected)
-      continue;
     if (name == "name")
-      f.name = value;
+      level.fiducials[fiducial_idx].name = value;
     create_scene();
     setWindowModified(true);
-    return;  // stop after finding the first one
+    return;
   }
 
-  for (auto& p : building.levels[level_idx].polygons)
+  const int polygon_idx = level.first_selected(SelectionSet::POLYGON);
+  if (polygon_idx >= 0)
   {
-    if (!p.selected)
-      continue;
-    p.set_param(name, value);
+    level.polygons[polygon_idx].set_param(name, value);
     setWindowModified(true);
-    return;  // stop after finding the first one
+    return;
   }
 
-  for (auto& m : building.levels[level_idx].models)
+  const int model_idx = level.first_selected(SelectionSet::MODEL);
+  if (model_idx >= 0)
   {
-    if (!m.selected)
-      continue;
-    m.set_param(name, value);
+    level.models[model_idx].set_param(name, value);
     setWindowModified(true);
-    return; // stop after finding the first one
+    return;
   }
 }
 
@@ -1692,15 +2347,97 @@ bool Editor::create_scene()
   mouse_motion_model = nullptr;
   mouse_motion_ellipse = nullptr;
   mouse_motion_polygon = nullptr;
+  replay_markers.item = nullptr;
+  live_markers.item = nullptr;
 
   // first draw the background map tiles (if requested)
   map_view->draw_tiles();
 
   building.draw(scene, level_idx, editor_models, rendering_options);
 
+  if (view_discrepancy_action->isChecked() &&
+    discrepancy_analysis.level_idx == level_idx)
+    discrepancy_analysis.draw(scene);
+
+  if (view_traffic_heatmap_action->isChecked() &&
+    traffic_heatmap.level_idx == level_idx &&
+    level_idx < static_cast<int>(building.levels.size()))
+    traffic_heatmap.draw(scene, building.levels[level_idx]);
+
+  if (view_building_diff_action->isChecked() &&
+    level_idx < static_cast<int>(building.levels.size()))
+    building_diff.draw(scene, building.levels[level_idx]);
+
+  draw_robot_markers(replay_markers);
+  draw_robot_markers(live_markers);
+
+  if (wall_proposal.level_idx == level_idx)
+    wall_proposal.draw(
+      scene,
+      building.levels[level_idx].drawing_meters_per_pixel);
+
+  if (view_clearance_action->isChecked() &&
+    clearance_analysis.level_idx == level_idx &&
+    level_idx < static_cast<int>(building.levels.size()))
+    clearance_analysis.draw(scene, building.levels[level_idx]);
+
+  colorize_layers();
   return true;
 }
 
+void Editor::colorize_layers()
+{
+  if (level_idx >= static_cast<int>(building.levels.size()))
+    return;
+  const Level& level = building.levels[level_idx];
+
+  for (const Layer& layer : level.layers)
+  {
+    if (!layer.needs_colorizing())
+      continue;
+
+    // if one is already running, it's redone afterwards if it went stale
+    const auto key = std::make_pair(level.name, layer.name);
+    const auto it = colorize_jobs.find(key);
+    if (it != colorize_jobs.end() && jobs.pending(it->second))
+      continue;
+
+    const QImage image = layer.image;  // shared, not copied
+    const qint64 image_key = image.cacheKey();
+    const QColor color = layer.color;
+    auto result = std::make_shared<QImage>();
+
+    colorize_jobs[key] = jobs.submit(
+      "Colorizing " + QString::fromStdString(layer.name),
+      JobScheduler::VISIBLE,
+      [image, color, result](JobContext&)
+      {
+        *result = Layer::colorized(image, color);
+        return true;
+      },
+      [this, key, image_key, color, result](
+        const JobScheduler::Outcome outcome)
+      {
+        colorize_jobs.erase(key);
+        if (outcome != JobScheduler::SUCCEEDED)
+          return;
+
+        const int result_level_idx = building.find_level(key.first);
+        if (result_level_idx < 0)
+          return;
+        for (Layer& result_layer : building.levels[result_level_idx].layers)
+        {
+          // its image may have been reloaded, or its color changed, since
+          if (result_layer.name == key.second &&
+            result_layer.image.cacheKey() == image_key &&
+            result_layer.color == color)
+            result_layer.set_colorized_image(*result, color);
+        }
+        create_scene();
+      });
+  }
+}
+
 void Editor::draw_mouse_motion_line_item(
   const double mouse_x,
   const double mouse_y)
@@ -1793,9 +2530,8 @@ void Editor::mouse_select(
   // todo: figure out something smarter than this abomination
   selected_polygon = building.get_selected_polygon(level_idx);
 
-  // todo: be smarter and go find the actual GraphicsItem to avoid
-  // a full repaint here?
-  create_scene();
+  // the level already restyled the graphics items of everything whose
+  // selection state changed, so there's no need to rebuild the scene
   update_property_editor();
 }
 
@@ -2422,7 +3158,7 @@ void Editor::mouse_add_polygon(
         return;// nothing to do. click wasn't on a vertex.
 
       Vertex* v = &building.levels[level_idx].vertices[clicked_idx];
-      v->selected = true;  // todo: colorize it?
+      level->select(SelectionSet::Item(SelectionSet::VERTEX, clicked_idx));
 
       if (mouse_motion_polygon == nullptr)
       {
@@ -2630,9 +3366,11 @@ void Editor::mouse_edit_polygon(
 void Editor::number_key_pressed(const int n)
 {
   bool found_edge = false;
-  for (auto& edge : building.levels[level_idx].edges)
+  Level& level = building.levels[level_idx];
+  for (const int edge_idx : level.selection().indices(SelectionSet::EDGE))
   {
-    if (edge.selected && edge.type == Edge::LANE)
+    Edge& edge = level.edges[edge_idx];
+    if (edge.type == Edge::LANE)
     {
       edge.set_graph_idx(n);
       found_edge = true;
@@ -2650,6 +3388,8 @@ void Editor::number_key_pressed(const int n)
 
 bool Editor::maybe_save()
 {
+  // a save that's still going may yet fail, which modifies the window
+  jobs.wait(save_job);
   if (!isWindowModified())
     return true;// no need to ask to save the document
   const QMessageBox::StandardButton button_clicked =
@@ -2661,7 +3401,7 @@ bool Editor::maybe_save()
   switch (button_clicked)
   {
     case QMessageBox::Save:
-      return building_save();
+      return jobs.wait(submit_save()) == JobScheduler::SUCCEEDED;
     case QMessageBox::Cancel:
       return false;
     default:
@@ -2832,4 +3572,143 @@ void Editor::cache_size_update_timer_timeout()
 {
   printf("cache_size_update_timer_timeout()\n");
   map_view->update_cache_size_label(cache_size_label);
+  memory_budget.enforce();
+}
+
+void Editor::load_memory_budget()
+{
+  QSettings settings;
+  const int budget_mb =
+    settings.value(preferences_keys::memory_budget_mb, 1024).toInt();
+  memory_budget.budget_bytes = static_cast<std::size_t>(budget_mb) << 20;
+  memory_budget.enforce();
+}
+
+std::vector<Level*> Editor::idle_levels()
+{
+  std::vector<Level*> levels;
+  for (std::size_t i = 0; i < building.levels.size(); i++)
+  {
+    if (static_cast<int>(i) != level_idx)
+      levels.push_back(&building.levels[i]);
+  }
+  std::sort(
+    levels.begin(),
+    levels.end(),
+    [](const Level* a, const Level* b)
+    {
+      return a->last_drawn < b->last_drawn;
+    });
+  return levels;
+}
+
+void Editor::register_memory_caches()
+{
+  // Only the levels which aren't being viewed give memory back, since the
+  // scene holds references to everything on the current level anyway.
+  memory_budget.add(
+    "level drawings",
+    MemoryBudget::RELOADABLE,
+    [this]()
+    {
+      std::size_t bytes = 0;
+      for (const auto& level : building.levels)
+        bytes += level.drawing_bytes();
+      return bytes;
+    },
+    [this](const std::size_t bytes)
+    {
+      std::size_t freed = 0;
+      for (Level* level : idle_levels())
+      {
+        if (freed >= bytes)
+          break;
+        freed += level->evict_drawing();
+      }
+      return freed;
+    });
+
+  memory_budget.add(
+    "layer images",
+    MemoryBudget::DERIVED,
+    [this]()
+    {
+      std::size_t bytes = 0;
+      for (const auto& level : building.levels)
+        bytes += level.layer_image_bytes();
+      return bytes;
+    },
+    [this](const std::size_t bytes)
+    {
+      std::size_t freed = 0;
+      for (Level* level : idle_levels())
+      {
+        if (freed >= bytes)
+          break;
+        freed += level->evict_layer_images(bytes - freed);
+      }
+      return freed;
+    });
+
+  memory_budget.add(
+    "model thumbnails",
+    MemoryBudget::RELOADABLE,
+    [this]()
+    {
+      std::size_t bytes = 0;
+      for (const auto& editor_model : editor_models)
+        bytes += editor_model.pixmap_bytes();
+      return bytes;
+    },
+    [this](const std::size_t bytes)
+    {
+      // get_pixmap() reloads them when they're next needed
+      std::vector<EditorModel*> models;
+      for (auto& editor_model : editor_models)
+      {
+        if (!editor_model.pixmap.isNull())
+          models.push_back(&editor_model);
+      }
+      std::sort(
+        models.begin(),
+        models.end(),
+        [](const EditorModel* a, const EditorModel* b)
+        {
+          return a->last_used < b->last_used;
+        });
+      std::size_t freed = 0;
+      for (EditorModel* editor_model : models)
+      {
+        if (freed >= bytes)
+          break;
+        freed += editor_model->pixmap_bytes();
+        editor_model->pixmap = QPixmap();
+      }
+      return freed;
+    });
+
+  memory_budget.add(
+    "level transforms",
+    MemoryBudget::DERIVED,
+    [this]() { return building.transform_cache_bytes(); },
+    [this](const std::size_t)
+    {
+      const std::size_t freed = building.transform_cache_bytes();
+      building.clear_transform_cache();
+      return freed;
+    });
+
+  // the visible map tiles can't be evicted, but they count
+  memory_budget.add(
+    "map tiles",
+    MemoryBudget::RELOADABLE,
+    [this]() { return map_view->tile_bytes(); });
+}
+
+void Editor::tools_memory_usage()
+{
+  MemoryDialog* dialog = new MemoryDialog(this, memory_budget);
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
 }
@@ -38,12 +38,23 @@
 #include "actions/move_vertex.h"
 #include "actions/rotate_model.h"
 #include "building.h"
+#include "building_diff.h"
+#include "clearance_analysis.h"
+#include "discrepancy_analysis.h"
 #include "editor_model.h"
+#include "floor_proposal.h"
+#include "job_scheduler.h"
+#include "lane_proposal.h"
+#include "memory_budget.h"
+#include "robot_markers_item.h"
+#include "traffic_heatmap.h"
+#include "wall_proposal.h"
 #include "rendering_options.h"
 
 #include "crowd_sim/crowd_sim_editor_table.h"
 
 class BuildingTable;
+class JobStatusWidget;
 class LayerTable;
 class LevelTable;
 class MapView;
@@ -132,7 +143,7 @@ private:
   // MENU ACTIONS
   void building_new();
   void building_open();
-  bool building_save();
+  void building_save();
   bool building_export_features();
 
   bool maybe_save();
@@ -155,6 +166,21 @@ private:
   void zoom_reset();
   void view_models();
   void view_tiles();
+  void view_clearance();
+  void view_discrepancy();
+  void view_traffic_heatmap();
+  void view_building_diff();
+
+  void tools_lane_clearance();
+  void tools_map_discrepancy();
+  void tools_traffic_heatmap();
+  void tools_replay();
+  void tools_live_feed();
+  void tools_building_diff();
+  void tools_propose_lanes();
+  void tools_propose_walls();
+  void tools_propose_floors();
+  void tools_memory_usage();
 
   void help_about();
 
@@ -190,6 +216,48 @@ private:
 
   QAction* view_models_action = nullptr;
   QAction* view_tiles_action = nullptr;
+  QAction* view_clearance_action = nullptr;
+  QAction* view_discrepancy_action = nullptr;
+  QAction* view_traffic_heatmap_action = nullptr;
+  QAction* view_building_diff_action = nullptr;
+
+  ClearanceAnalysis clearance_analysis;
+  DiscrepancyAnalysis discrepancy_analysis;
+  TrafficHeatmap traffic_heatmap;
+  BuildingDiff building_diff;
+
+  // robots drawn over the map by the trajectory replay and the live feed.
+  // They are kept across redraws, and updating them only touches the item.
+  struct RobotMarkers
+  {
+    std::vector<RobotMarkersItem::Marker> markers;
+    int level_idx = -1;
+    RobotMarkersItem* item = nullptr;
+  };
+  RobotMarkers replay_markers;
+  RobotMarkers live_markers;
+  void set_robot_markers(
+    RobotMarkers& robot_markers,
+    const int level_idx,
+    const std::vector<RobotMarkersItem::Marker>& markers);
+  void draw_robot_markers(RobotMarkers& robot_markers);
+  LaneProposal lane_proposal;
+  WallProposal wall_proposal;
+  FloorProposal floor_proposal;
+
+  // runs the slow tools above off the GUI thread
+  JobScheduler jobs;
+
+  // saves a snapshot of the building, after the previous save if that one
+  // is still going, so an older snapshot never overwrites a newer one
+  JobScheduler::JobId submit_save();
+  JobScheduler::JobId save_job = 0;
+
+  // colorizes the layers of the current level which need it, each in its
+  // own job, and redraws once they're done
+  void colorize_layers();
+  std::map<std::pair<std::string, std::string>, JobScheduler::JobId>
+  colorize_jobs;  // by level and layer name
 
   const QString tool_id_to_string(const int id);
   QButtonGroup* tool_button_group = nullptr;
@@ -221,7 +289,7 @@ private:
   void populate_property_editor(const Vertex& vertex, const int index);
   void populate_property_editor(const Feature& feature);
   void populate_property_editor(const Fiducial& fiducial);
-  void populate_property_editor(const Polygon& polygon);
+  void populate_property_editor(const Polygon& polygon, const int index);
   void populate_property_editor(const Layer& layer);
 
   QTableWidgetItem* create_table_item(const QString& str,
@@ -297,6 +365,13 @@ private:
 
   void number_key_pressed(const int n);
 
+  // nudges the selection, or scrolls if nothing is selected
+  void arrow_key_pressed(QKeyEvent* e);
+  double nudge_step = 0.01;  // meters
+  double nudge_large_step = 0.1;  // meters, with shift held
+  void load_nudge_steps();
+  QTimer* nudge_redraw_timer = nullptr;  // coalesces auto-repeated nudges
+
   // mouse handlers for various tools
   enum MouseType
   {
@@ -364,8 +439,16 @@ private:
   void sanity_check();
 
   QLabel* cache_size_label = nullptr;
+  JobStatusWidget* job_status_widget = nullptr;
   QTimer* cache_size_update_timer = nullptr;
   void cache_size_update_timer_timeout();
+
+  MemoryBudget memory_budget;
+  void register_memory_caches();
+  void load_memory_budget();
+
+  // levels other than the one being viewed, least recently drawn first
+  std::vector<Level*> idle_levels();
 };
 
 #endif
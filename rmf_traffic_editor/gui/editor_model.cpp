@@ -44,8 +44,19 @@ EditorModel::~EditorModel()
 {
 }
 
+std::size_t EditorModel::pixmap_bytes() const
+{
+  if (pixmap.isNull())
+    return 0;
+  return static_cast<std::size_t>(pixmap.width()) * pixmap.height() *
+    pixmap.depth() / 8;
+}
+
 QPixmap EditorModel::get_pixmap()
 {
+  static std::size_t use_count = 0;
+  last_used = ++use_count;
+
   if (!pixmap.isNull())
     return pixmap;
 
@@ -22,6 +22,7 @@
  * Represents a simulation model class and related helpers for rendering.
  */
 
+#include <cstddef>
 #include <string>
 #include <QPixmap>
 
@@ -36,6 +37,9 @@ public:
   double meters_per_pixel;
 
   QPixmap get_pixmap();  // will load if needed
+
+  std::size_t last_used = 0;  // increases with every get_pixmap()
+  std::size_t pixmap_bytes() const;
 };
 
 #endif
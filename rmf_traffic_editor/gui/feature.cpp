@@ -63,24 +63,34 @@ YAML::Node Feature::to_yaml() const
   return node;
 }
 
-void Feature::draw(
+SelectionSet::Restyler Feature::draw(
   QGraphicsScene* scene,
   const QColor color,
   const Transform& layer_transform,
-  const double meters_per_pixel) const
+  const double meters_per_pixel,
+  const bool selected) const
+{
+  QPointF p = layer_transform.forwards(QPointF(_x, _y));  // to meters
+  p /= meters_per_pixel;  // now to parent level's pixels
+  return draw(scene, color, p, meters_per_pixel, selected);
+}
+
+SelectionSet::Restyler Feature::draw(
+  QGraphicsScene* scene,
+  const QColor color,
+  const QPointF& p,
+  const double meters_per_pixel,
+  const bool selected) const
 {
   const QColor selected_color = QColor::fromRgbF(1.0, 0.0, 0.0, 0.5);
 
   const double pen_width = 0.025 / meters_per_pixel;
   QPen pen(
-    QBrush(_selected ? selected_color : color),
+    QBrush(selected ? selected_color : color),
     pen_width,
     Qt::SolidLine,
     Qt::FlatCap);
 
-  QPointF p = layer_transform.forwards(QPointF(_x, _y));  // to meters
-  p /= meters_per_pixel;  // now to parent level's pixels
-
   const double radius = radius_meters / meters_per_pixel;
 
   QGraphicsEllipseItem* circle = scene->addEllipse(
@@ -108,4 +118,13 @@ void Feature::draw(
     p.y() - line_radius,
     pen);
   line_2->setZValue(200.0);
+
+  return [=](const bool selected_now)
+    {
+      QPen restyled_pen(pen);
+      restyled_pen.setBrush(QBrush(selected_now ? selected_color : color));
+      circle->setPen(restyled_pen);
+      line_1->setPen(restyled_pen);
+      line_2->setPen(restyled_pen);
+    };
 }
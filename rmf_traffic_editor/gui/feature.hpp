@@ -24,6 +24,7 @@
 #include <QUuid>
 #include <yaml-cpp/yaml.h>
 
+#include "selection_set.h"
 #include "transform.hpp"
 
 class QGraphicsScene;
@@ -56,17 +57,23 @@ public:
 
   QUuid const& id() const { return _id; }
 
-  bool selected() const { return _selected; }
-  void setSelected(const bool selected) { _selected = selected; }
-
   void from_yaml(const YAML::Node& data);
   YAML::Node to_yaml() const;
 
-  void draw(
+  SelectionSet::Restyler draw(
     QGraphicsScene*,
     const QColor color,
     const Transform& layer_transform,
-    const double render_scale) const;
+    const double render_scale,
+    const bool selected) const;
+
+  // same, but with the position already transformed into level pixels
+  SelectionSet::Restyler draw(
+    QGraphicsScene*,
+    const QColor color,
+    const QPointF& level_position,
+    const double render_scale,
+    const bool selected) const;
 
   static constexpr double radius_meters = 0.1;
 
@@ -74,7 +81,6 @@ private:
   double _x = 0.0;
   double _y = 0.0;
   QUuid _id;
-  bool _selected = false;
   std::string _name;
 };
 
@@ -54,9 +54,10 @@ YAML::Node Fiducial::to_yaml() const
   return node;
 }
 
-void Fiducial::draw(
+SelectionSet::Restyler Fiducial::draw(
   QGraphicsScene* scene,
-  const double meters_per_pixel) const
+  const double meters_per_pixel,
+  const bool selected) const
 {
   const double a = 0.5;
   const QColor color = QColor::fromRgbF(0.0, 0.0, 1.0, a);
@@ -66,14 +67,16 @@ void Fiducial::draw(
   pen.setWidth(0.2 / meters_per_pixel);
   const double radius = 0.5 / meters_per_pixel;
 
-  scene->addEllipse(
+  QGraphicsEllipseItem* circle = scene->addEllipse(
     x - radius,
     y - radius,
     2 * radius,
     2 * radius,
     pen);
-  scene->addLine(x, y - 2 * radius, x, y + 2 * radius, pen);
-  scene->addLine(x - 2 * radius, y, x + 2 * radius, y, pen);
+  QGraphicsLineItem* line_1 =
+    scene->addLine(x, y - 2 * radius, x, y + 2 * radius, pen);
+  QGraphicsLineItem* line_2 =
+    scene->addLine(x - 2 * radius, y, x + 2 * radius, y, pen);
 
   if (!name.empty())
   {
@@ -82,9 +85,18 @@ void Fiducial::draw(
     item->setBrush(QColor(0, 0, 255, 255));
     item->setPos(x, y + radius);
   }
+
+  return [=](const bool selected_now)
+    {
+      QPen restyled_pen(pen);
+      restyled_pen.setColor(selected_now ? selected_color : color);
+      circle->setPen(restyled_pen);
+      line_1->setPen(restyled_pen);
+      line_2->setPen(restyled_pen);
+    };
 }
 
-double Fiducial::distance(const Fiducial& f)
+double Fiducial::distance(const Fiducial& f) const
 {
   const double dx = f.x - x;
   const double dy = f.y - y;
@@ -24,6 +24,8 @@
 #include <yaml-cpp/yaml.h>
 #include <quuid.h>
 
+#include "selection_set.h"
+
 class QGraphicsScene;
 
 
@@ -35,17 +37,18 @@ public:
   std::string name;
   QUuid uuid;
 
-  bool selected = false;
-
   Fiducial();
   Fiducial(double _x, double _y, const std::string& _name = std::string());
 
   void from_yaml(const YAML::Node& data);
   YAML::Node to_yaml() const;
 
-  void draw(QGraphicsScene*, const double meters_per_pixel) const;
+  SelectionSet::Restyler draw(
+    QGraphicsScene*,
+    const double meters_per_pixel,
+    const bool selected) const;
 
-  double distance(const Fiducial& f);
+  double distance(const Fiducial& f) const;
 };
 
 #endif
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <QElapsedTimer>
+
+#include "floor_proposal.h"
+#include "planar_faces.h"
+
+using std::vector;
+
+
+FloorProposal::FloorProposal()
+{
+}
+
+FloorProposal::~FloorProposal()
+{
+}
+
+void FloorProposal::run(const Level& level)
+{
+  vertices.clear();
+  polygons.clear();
+  num_floors = 0;
+  num_holes = 0;
+
+  const double mpp = level.drawing_meters_per_pixel;
+  if (mpp <= 0.0)
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  vector<PlanarFaces::Point> points;
+  points.reserve(level.vertices.size());
+  for (const auto& v : level.vertices)
+    points.push_back(PlanarFaces::Point(v.x, v.y));
+
+  vector<std::pair<int, int>> segments;
+  const int num_level_vertices = static_cast<int>(level.vertices.size());
+  for (const auto& edge : level.edges)
+  {
+    if (edge.type != Edge::WALL &&
+      !(include_doors && edge.type == Edge::DOOR))
+      continue;
+    if (edge.start_idx < 0 || edge.start_idx >= num_level_vertices ||
+      edge.end_idx < 0 || edge.end_idx >= num_level_vertices)
+      continue;
+    segments.push_back(std::make_pair(edge.start_idx, edge.end_idx));
+  }
+
+  PlanarFaces planar_faces;
+  planar_faces.tolerance = snap_tolerance / mpp;
+  planar_faces.find(points, segments);
+
+  // map the face vertices to level vertices, appending any new ones
+  vector<int> level_vertex(planar_faces.vertices.size(), -1);
+  auto to_level = [&](const vector<int>& ring)
+    {
+      vector<int> level_ring;
+      for (const int v : ring)
+      {
+        if (level_vertex[v] < 0)
+        {
+          if (planar_faces.source_point[v] >= 0)
+            level_vertex[v] = planar_faces.source_point[v];
+          else
+          {
+            level_vertex[v] =
+              num_level_vertices + static_cast<int>(vertices.size());
+            vertices.push_back(
+              QPointF(planar_faces.vertices[v].x, planar_faces.vertices[v].y));
+          }
+        }
+        level_ring.push_back(level_vertex[v]);
+      }
+      return level_ring;
+    };
+
+  auto already_exists = [&](const vector<int>& ring, const Polygon::Type type)
+    {
+      vector<int> sorted_ring(ring);
+      std::sort(sorted_ring.begin(), sorted_ring.end());
+      for (const auto& polygon : level.polygons)
+      {
+        if (polygon.type != type ||
+          polygon.vertices.size() != sorted_ring.size())
+          continue;
+        vector<int> sorted_polygon(polygon.vertices);
+        std::sort(sorted_polygon.begin(), sorted_polygon.end());
+        if (sorted_polygon == sorted_ring)
+          return true;
+      }
+      return false;
+    };
+
+  auto propose = [&](const vector<int>& ring, const Polygon::Type type)
+    {
+      // don't add vertices for polygons which would be skipped anyway
+      bool has_new_vertices = false;
+      for (const int v : ring)
+      {
+        if (planar_faces.source_point[v] < 0)
+          has_new_vertices = true;
+      }
+      if (!has_new_vertices)
+      {
+        vector<int> level_ring;
+        for (const int v : ring)
+          level_ring.push_back(planar_faces.source_point[v]);
+        if (already_exists(level_ring, type))
+          return;
+      }
+
+      Polygon polygon;
+      polygon.type = type;
+      polygon.vertices = to_level(ring);
+      polygon.create_required_parameters();
+      polygons.push_back(polygon);
+      if (type == Polygon::FLOOR)
+        num_floors++;
+      else
+        num_holes++;
+    };
+
+  const double min_area = min_room_area / (mpp * mpp);
+  const double max_pillar = max_pillar_area / (mpp * mpp);
+  for (const auto& face : planar_faces.faces)
+  {
+    // the inside of a pillar isn't a room
+    if (face.nested && face.area <= max_pillar)
+      continue;
+    if (face.area < min_area)
+      continue;
+    propose(face.outer, Polygon::FLOOR);
+
+    for (const auto& hole : face.holes)
+    {
+      const double hole_area =
+        std::abs(PlanarFaces::signed_area(planar_faces.vertices, hole));
+      if (hole_area <= max_pillar)
+        propose(hole, Polygon::HOLE);
+    }
+  }
+
+  printf(
+    "proposed %d floors and %d holes (%d new vertices) in %.3f s\n",
+    num_floors,
+    num_holes,
+    static_cast<int>(vertices.size()),
+    timer.nsecsElapsed() / 1e9);
+}
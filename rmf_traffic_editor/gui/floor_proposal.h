@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef FLOOR_PROPOSAL_H
+#define FLOOR_PROPOSAL_H
+
+#include <vector>
+
+#include <QPointF>
+
+#include "level.h"
+#include "polygon.h"
+
+/*
+ * Proposes a FLOOR polygon for every room enclosed by the walls (and,
+ * optionally, the doors) of a level, using PlanarFaces. Small islands
+ * inside a room, such as pillars, become HOLE polygons instead of floors.
+ * Rooms which already have a floor (or pillars which already have a hole)
+ * over exactly the same vertices are skipped.
+ */
+
+class FloorProposal
+{
+public:
+  FloorProposal();
+  ~FloorProposal();
+
+  bool include_doors = true;
+  double snap_tolerance = 0.05;  // meters; closer wall ends are joined
+  double min_room_area = 1.0;  // square meters
+  double max_pillar_area = 4.0;  // square meters
+
+  // vertices which must be appended to the level (where walls cross
+  // without a shared vertex), in level coordinates
+  std::vector<QPointF> vertices;
+
+  // proposed polygons. Vertex indices past the end of the level's vertices
+  // refer to the vertices above, in order, once they have been appended.
+  std::vector<Polygon> polygons;
+
+  int num_floors = 0;
+  int num_holes = 0;
+
+  void run(const Level& level);
+};
+
+#endif
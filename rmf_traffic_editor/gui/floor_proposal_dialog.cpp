@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <QtWidgets>
+
+#include "floor_proposal_dialog.h"
+
+
+FloorProposalDialog::FloorProposalDialog(
+  QWidget* parent,
+  FloorProposal& _proposal)
+: QDialog(parent), proposal(_proposal)
+{
+  setWindowTitle("Propose Floors");
+  ok_button = new QPushButton("OK", this);  // first button = [enter] button
+  cancel_button = new QPushButton("Cancel", this);
+
+  doors_checkbox = new QCheckBox("Doors close off rooms", this);
+  doors_checkbox->setChecked(proposal.include_doors);
+
+  QHBoxLayout* snap_hbox = new QHBoxLayout;
+  snap_hbox->addWidget(new QLabel("Join wall ends closer than (m):"));
+  snap_spin_box = new QDoubleSpinBox(this);
+  snap_spin_box->setDecimals(2);
+  snap_spin_box->setRange(0.0, 1.0);
+  snap_spin_box->setSingleStep(0.01);
+  snap_spin_box->setValue(proposal.snap_tolerance);
+  snap_hbox->addWidget(snap_spin_box);
+
+  QHBoxLayout* room_area_hbox = new QHBoxLayout;
+  room_area_hbox->addWidget(new QLabel("Minimum room area (m^2):"));
+  room_area_spin_box = new QDoubleSpinBox(this);
+  room_area_spin_box->setDecimals(1);
+  room_area_spin_box->setRange(0.0, 1000.0);
+  room_area_spin_box->setSingleStep(0.5);
+  room_area_spin_box->setValue(proposal.min_room_area);
+  room_area_hbox->addWidget(room_area_spin_box);
+
+  QHBoxLayout* pillar_area_hbox = new QHBoxLayout;
+  pillar_area_hbox->addWidget(new QLabel("Maximum pillar area (m^2):"));
+  pillar_area_spin_box = new QDoubleSpinBox(this);
+  pillar_area_spin_box->setDecimals(1);
+  pillar_area_spin_box->setRange(0.0, 1000.0);
+  pillar_area_spin_box->setSingleStep(0.5);
+  pillar_area_spin_box->setValue(proposal.max_pillar_area);
+  pillar_area_hbox->addWidget(pillar_area_spin_box);
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(cancel_button);
+  bottom_buttons_hbox->addWidget(ok_button);
+  connect(
+    ok_button, &QAbstractButton::clicked,
+    this, &FloorProposalDialog::ok_button_clicked);
+  connect(
+    cancel_button, &QAbstractButton::clicked,
+    this, &QDialog::reject);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addWidget(doors_checkbox);
+  top_vbox->addLayout(snap_hbox);
+  top_vbox->addLayout(room_area_hbox);
+  top_vbox->addLayout(pillar_area_hbox);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+}
+
+FloorProposalDialog::~FloorProposalDialog()
+{
+}
+
+void FloorProposalDialog::ok_button_clicked()
+{
+  proposal.include_doors = doors_checkbox->isChecked();
+  proposal.snap_tolerance = snap_spin_box->value();
+  proposal.min_room_area = room_area_spin_box->value();
+  proposal.max_pillar_area = pillar_area_spin_box->value();
+  accept();
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef FLOOR_PROPOSAL_DIALOG_H
+#define FLOOR_PROPOSAL_DIALOG_H
+
+#include <QDialog>
+
+#include "floor_proposal.h"
+class QCheckBox;
+class QDoubleSpinBox;
+
+
+class FloorProposalDialog : public QDialog
+{
+public:
+  FloorProposalDialog(QWidget* parent, FloorProposal& proposal);
+  ~FloorProposalDialog();
+
+private:
+  FloorProposal& proposal;
+
+  QCheckBox* doors_checkbox;
+  QDoubleSpinBox* snap_spin_box;
+  QDoubleSpinBox* room_area_spin_box;
+  QDoubleSpinBox* pillar_area_spin_box;
+  QPushButton* ok_button, * cancel_button;
+
+private slots:
+  void ok_button_clicked();
+};
+
+#endif
@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <mutex>
+
+#include <tiffio.h>
+
+#include "geotiff_image.h"
+
+using std::vector;
+
+// GeoTIFF tags, which libtiff doesn't know about by itself
+static const uint32_t MODEL_PIXEL_SCALE_TAG = 33550;
+static const uint32_t MODEL_TIEPOINT_TAG = 33922;
+static const uint32_t MODEL_TRANSFORMATION_TAG = 34264;
+static const uint32_t GEO_KEY_DIRECTORY_TAG = 34735;
+
+// GeoKeys
+static const int GT_RASTER_TYPE_GEO_KEY = 1025;
+static const int GEOGRAPHIC_TYPE_GEO_KEY = 2048;
+static const int PROJECTED_CS_TYPE_GEO_KEY = 3072;
+static const int RASTER_PIXEL_IS_POINT = 2;
+
+static TIFFExtendProc parent_tag_extender = nullptr;
+
+static void geotiff_tag_extender(TIFF* tiff)
+{
+  static const TIFFFieldInfo field_info[] =
+  {
+    {MODEL_PIXEL_SCALE_TAG, -1, -1, TIFF_DOUBLE, FIELD_CUSTOM, 1, 1,
+      const_cast<char*>("ModelPixelScaleTag")},
+    {MODEL_TIEPOINT_TAG, -1, -1, TIFF_DOUBLE, FIELD_CUSTOM, 1, 1,
+      const_cast<char*>("ModelTiepointTag")},
+    {MODEL_TRANSFORMATION_TAG, -1, -1, TIFF_DOUBLE, FIELD_CUSTOM, 1, 1,
+      const_cast<char*>("ModelTransformationTag")},
+    {GEO_KEY_DIRECTORY_TAG, -1, -1, TIFF_SHORT, FIELD_CUSTOM, 1, 1,
+      const_cast<char*>("GeoKeyDirectoryTag")},
+  };
+  TIFFMergeFieldInfo(
+    tiff,
+    field_info,
+    sizeof(field_info) / sizeof(field_info[0]));
+  if (parent_tag_extender)
+    parent_tag_extender(tiff);
+}
+
+// read an array-valued tag, whatever width libtiff uses for its count
+template<typename T>
+static bool get_array(TIFF* tiff, const uint32_t tag, vector<T>& values)
+{
+  const TIFFField* field = TIFFFindField(tiff, tag, TIFF_ANY);
+  if (!field)
+    return false;
+  T* data = nullptr;
+  uint32_t count = 0;
+  if (TIFFFieldReadCount(field) == TIFF_VARIABLE2)
+  {
+    if (!TIFFGetField(tiff, tag, &count, &data))
+      return false;
+  }
+  else
+  {
+    uint16_t count16 = 0;
+    if (!TIFFGetField(tiff, tag, &count16, &data))
+      return false;
+    count = count16;
+  }
+  if (!data)
+    return false;
+  values.assign(data, data + count);
+  return true;
+}
+
+
+GeoTiffImage::GeoTiffImage()
+{
+  static std::once_flag extender_flag;
+  std::call_once(
+    extender_flag,
+    []()
+    {
+      parent_tag_extender = TIFFSetTagExtender(geotiff_tag_extender);
+    });
+}
+
+GeoTiffImage::~GeoTiffImage()
+{
+  close();
+}
+
+void GeoTiffImage::close()
+{
+  if (tiff)
+    TIFFClose(tiff);
+  tiff = nullptr;
+  current_directory = -1;
+  levels.clear();
+  cache.clear();
+  cache_index.clear();
+  cache_bytes = 0;
+}
+
+bool GeoTiffImage::open(const std::string& filename)
+{
+  close();
+  tiff = TIFFOpen(filename.c_str(), "r");
+  if (!tiff)
+    return false;
+
+  // the first directory is the full image; reduced-resolution directories
+  // after it are overviews (anything else, e.g. masks, is ignored)
+  do
+  {
+    uint32_t subfile_type = 0;
+    TIFFGetField(tiff, TIFFTAG_SUBFILETYPE, &subfile_type);
+    if (!levels.empty() &&
+      (subfile_type & FILETYPE_REDUCEDIMAGE) == 0)
+      continue;
+    if (subfile_type & FILETYPE_MASK)
+      continue;
+
+    Level level;
+    level.directory = TIFFCurrentDirectory(tiff);
+    uint32_t width = 0, height = 0;
+    TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+    level.width = static_cast<int>(width);
+    level.height = static_cast<int>(height);
+    level.tiled = TIFFIsTiled(tiff);
+    if (level.tiled)
+    {
+      uint32_t tile_width = 0, tile_height = 0;
+      TIFFGetField(tiff, TIFFTAG_TILEWIDTH, &tile_width);
+      TIFFGetField(tiff, TIFFTAG_TILELENGTH, &tile_height);
+      level.block_width = static_cast<int>(tile_width);
+      level.block_height = static_cast<int>(tile_height);
+    }
+    else
+    {
+      // bands of whole strips, at least 256 rows tall
+      uint32_t rows_per_strip = 0;
+      TIFFGetFieldDefaulted(tiff, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+      const int strip_rows =
+        static_cast<int>(std::min<uint32_t>(rows_per_strip, height));
+      level.block_width = level.width;
+      level.block_height = std::max(strip_rows, 1) *
+        std::max(1, 256 / std::max(strip_rows, 1));
+    }
+    if (level.width <= 0 || level.height <= 0 ||
+      level.block_width <= 0 || level.block_height <= 0)
+      continue;
+
+    if (levels.empty())
+      read_georeference();
+    levels.push_back(level);
+  } while (TIFFReadDirectory(tiff));
+
+  current_directory = -1;
+  if (levels.empty())
+  {
+    close();
+    return false;
+  }
+
+  std::sort(
+    levels.begin() + 1,
+    levels.end(),
+    [](const Level& l1, const Level& l2)
+    {
+      return l1.width > l2.width;
+    });
+
+  printf("opened %s: %dx%d, %d overviews%s\n",
+    filename.c_str(),
+    width(),
+    height(),
+    static_cast<int>(levels.size()) - 1,
+    georeferenced ? ", georeferenced" : "");
+  return true;
+}
+
+void GeoTiffImage::read_georeference()
+{
+  georeferenced = false;
+
+  vector<double> transformation, tiepoint, pixel_scale;
+  if (get_array(tiff, MODEL_TRANSFORMATION_TAG, transformation) &&
+    transformation.size() >= 8)
+  {
+    a[0] = transformation[3];
+    a[1] = transformation[0];
+    a[2] = transformation[1];
+    b[0] = transformation[7];
+    b[1] = transformation[4];
+    b[2] = transformation[5];
+    georeferenced = true;
+  }
+  else if (get_array(tiff, MODEL_TIEPOINT_TAG, tiepoint) &&
+    get_array(tiff, MODEL_PIXEL_SCALE_TAG, pixel_scale) &&
+    tiepoint.size() >= 6 && pixel_scale.size() >= 2)
+  {
+    // tiepoint: raster (I, J, K) is at model (X, Y, Z); rows go down
+    a[1] = pixel_scale[0];
+    a[2] = 0.0;
+    a[0] = tiepoint[3] - tiepoint[0] * a[1];
+    b[1] = 0.0;
+    b[2] = -pixel_scale[1];
+    b[0] = tiepoint[4] - tiepoint[1] * b[2];
+    georeferenced = true;
+  }
+
+  vector<uint16_t> keys;
+  int raster_type = 1;
+  epsg = 0;
+  if (get_array(tiff, GEO_KEY_DIRECTORY_TAG, keys) && keys.size() >= 4)
+  {
+    // header, then (key, location, count, value) for every key. Only
+    // short values stored inline (location 0) are needed here.
+    const std::size_t num_keys = keys[3];
+    for (std::size_t i = 0; i < num_keys && 4 * i + 7 < keys.size(); i++)
+    {
+      const uint16_t* entry = &keys[4 * (i + 1)];
+      if (entry[1] != 0)
+        continue;
+      if (entry[0] == GT_RASTER_TYPE_GEO_KEY)
+        raster_type = entry[3];
+      else if (entry[0] == PROJECTED_CS_TYPE_GEO_KEY)
+        epsg = entry[3];
+      else if (entry[0] == GEOGRAPHIC_TYPE_GEO_KEY && epsg == 0)
+        epsg = entry[3];
+    }
+  }
+
+  // with "pixel is point", the model coordinates are of pixel centers
+  if (georeferenced && raster_type == RASTER_PIXEL_IS_POINT)
+  {
+    a[0] -= 0.5 * (a[1] + a[2]);
+    b[0] -= 0.5 * (b[1] + b[2]);
+  }
+
+  // 32767 means "user-defined", which would need the full GeoKey set
+  if (epsg == 32767)
+    epsg = 0;
+}
+
+int GeoTiffImage::level_for_downsample(const double downsample) const
+{
+  int best = 0;
+  for (std::size_t i = 1; i < levels.size(); i++)
+  {
+    const double level_downsample =
+      static_cast<double>(levels[0].width) / levels[i].width;
+    if (level_downsample <= downsample)
+      best = static_cast<int>(i);
+  }
+  return best;
+}
+
+QImage GeoTiffImage::block(
+  const int level_idx,
+  const int block_x,
+  const int block_y)
+{
+  if (!tiff || level_idx < 0 || level_idx >= static_cast<int>(levels.size()))
+    return QImage();
+
+  const uint64_t key =
+    (static_cast<uint64_t>(level_idx) << 48) |
+    (static_cast<uint64_t>(block_y & 0xffffff) << 24) |
+    static_cast<uint64_t>(block_x & 0xffffff);
+  auto it = cache_index.find(key);
+  if (it != cache_index.end())
+  {
+    cache.splice(cache.begin(), cache, it->second);
+    return it->second->image;
+  }
+
+  CachedBlock cached;
+  cached.key = key;
+  cached.image = read_block(levels[level_idx], block_x, block_y);
+  cache.push_front(cached);
+  cache_index[key] = cache.begin();
+  cache_bytes += cached.image.sizeInBytes();
+
+  while (cache_bytes > cache_budget && cache.size() > 1)
+  {
+    cache_bytes -= cache.back().image.sizeInBytes();
+    cache_index.erase(cache.back().key);
+    cache.pop_back();
+  }
+  return cached.image;
+}
+
+std::size_t GeoTiffImage::trim_cache(const std::size_t bytes)
+{
+  std::size_t freed = 0;
+  while (freed < bytes && !cache.empty())
+  {
+    const std::size_t block_bytes = cache.back().image.sizeInBytes();
+    freed += block_bytes;
+    cache_bytes -= block_bytes;
+    cache_index.erase(cache.back().key);
+    cache.pop_back();
+  }
+  return freed;
+}
+
+QImage GeoTiffImage::read_block(
+  const Level& level,
+  const int block_x,
+  const int block_y)
+{
+  const int x0 = block_x * level.block_width;
+  const int y0 = block_y * level.block_height;
+  if (x0 < 0 || y0 < 0 || x0 >= level.width || y0 >= level.height)
+    return QImage();
+
+  if (current_directory != level.directory)
+  {
+    if (!TIFFSetDirectory(tiff, static_cast<tdir_t>(level.directory)))
+      return QImage();
+    current_directory = level.directory;
+  }
+
+  const int w = std::min(level.block_width, level.width - x0);
+  const int h = std::min(level.block_height, level.height - y0);
+  QImage image(w, h, QImage::Format_ARGB32);
+
+  // libtiff's RGBA interface handles every photometric interpretation,
+  // and returns ABGR rasters with their rows bottom-up
+  auto copy_rows = [&image, w](
+    const vector<uint32_t>& raster,
+    const int raster_width,
+    const int raster_rows,
+    const int rows,
+    const int first_row)
+    {
+      for (int r = 0; r < rows; r++)
+      {
+        const uint32_t* in = &raster[(raster_rows - 1 - r) * raster_width];
+        QRgb* out = reinterpret_cast<QRgb*>(image.scanLine(first_row + r));
+        for (int c = 0; c < w; c++)
+        {
+          out[c] = qRgba(
+            TIFFGetR(in[c]),
+            TIFFGetG(in[c]),
+            TIFFGetB(in[c]),
+            TIFFGetA(in[c]));
+        }
+      }
+    };
+
+  if (level.tiled)
+  {
+    vector<uint32_t> raster(
+      static_cast<std::size_t>(level.block_width) * level.block_height);
+    if (!TIFFReadRGBATile(tiff, x0, y0, raster.data()))
+      return QImage();
+    copy_rows(raster, level.block_width, level.block_height, h, 0);
+  }
+  else
+  {
+    uint32_t rows_per_strip = 0;
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+    const int strip_rows = static_cast<int>(
+      std::min<uint32_t>(rows_per_strip, level.height));
+    vector<uint32_t> raster(static_cast<std::size_t>(level.width) * strip_rows);
+    for (int row = y0; row < y0 + h; row += strip_rows)
+    {
+      if (!TIFFReadRGBAStrip(tiff, row, raster.data()))
+        return QImage();
+      const int rows = std::min(strip_rows, level.height - row);
+      copy_rows(raster, level.width, rows, rows, row - y0);
+    }
+  }
+  return image;
+}
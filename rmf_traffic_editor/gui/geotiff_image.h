@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GEOTIFF_IMAGE_H
+#define GEOTIFF_IMAGE_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QImage>
+
+typedef struct tiff TIFF;
+
+/*
+ * Windowed access to a (Geo)TIFF image too large to hold in memory, such
+ * as an aerial orthophoto of a whole site.
+ *
+ * The image is read one block at a time: a TIFF tile, or a band of strips
+ * for untiled images. Reduced-resolution copies stored in the same file
+ * (the "internal overviews" written by e.g. gdaladdo) are used when the
+ * image is drawn zoomed out, so the number of blocks needed to fill the
+ * screen stays about the same at any zoom. Decoded blocks are kept in an
+ * LRU cache with a byte budget.
+ *
+ * The georeferencing tags (model tiepoint + pixel scale, or a model
+ * transformation, and the CRS EPSG code from the GeoKey directory) are
+ * read if present.
+ */
+
+class GeoTiffImage
+{
+public:
+  GeoTiffImage();
+  ~GeoTiffImage();
+
+  bool open(const std::string& filename);
+
+  struct Level
+  {
+    int directory = 0;
+    int width = 0;
+    int height = 0;
+    bool tiled = false;
+    int block_width = 0;
+    int block_height = 0;
+  };
+
+  // full resolution first, then the overviews from largest to smallest
+  std::vector<Level> levels;
+
+  int width() const { return levels.empty() ? 0 : levels[0].width; }
+  int height() const { return levels.empty() ? 0 : levels[0].height; }
+
+  // georeferencing: CRS coordinates of the corner of pixel (col, row) are
+  // (a[0] + a[1] * col + a[2] * row, b[0] + b[1] * col + b[2] * row)
+  bool georeferenced = false;
+  int epsg = 0;
+  double a[3] = {0.0, 1.0, 0.0};
+  double b[3] = {0.0, 0.0, 1.0};
+
+  std::size_t cache_budget = 256 << 20;  // bytes of decoded blocks
+  std::size_t cached_bytes() const { return cache_bytes; }
+
+  // drop least recently used blocks until this many bytes are freed
+  std::size_t trim_cache(const std::size_t bytes);
+
+  // the coarsest level with no more than this many full-resolution pixels
+  // per level pixel
+  int level_for_downsample(const double downsample) const;
+
+  // a decoded block (ARGB32), or a null image on read errors
+  QImage block(const int level_idx, const int block_x, const int block_y);
+
+private:
+  TIFF* tiff = nullptr;
+  int current_directory = -1;
+
+  struct CachedBlock
+  {
+    uint64_t key = 0;
+    QImage image;
+  };
+  std::list<CachedBlock> cache;  // most recently used first
+  std::unordered_map<uint64_t, std::list<CachedBlock>::iterator> cache_index;
+  std::size_t cache_bytes = 0;
+
+  QImage read_block(const Level& level, const int block_x, const int block_y);
+  void read_georeference();
+  void close();
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include "geotiff_item.h"
+
+
+GeoTiffItem::GeoTiffItem(std::shared_ptr<GeoTiffImage> _image)
+: image(_image)
+{
+  // needed to get the exposed area in paint()
+  setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+GeoTiffItem::~GeoTiffItem()
+{
+}
+
+QRectF GeoTiffItem::boundingRect() const
+{
+  return QRectF(0, 0, image->width(), image->height());
+}
+
+void GeoTiffItem::paint(
+  QPainter* painter,
+  const QStyleOptionGraphicsItem* option,
+  QWidget*)
+{
+  if (image->levels.empty())
+    return;
+
+  // use the overview with about one level pixel per screen pixel
+  const double device_pixels_per_pixel =
+    std::sqrt(std::abs(painter->worldTransform().determinant()));
+  if (device_pixels_per_pixel <= 0.0)
+    return;
+  const int level_idx =
+    image->level_for_downsample(1.0 / device_pixels_per_pixel);
+  const GeoTiffImage::Level& level = image->levels[level_idx];
+  const double sx = static_cast<double>(image->width()) / level.width;
+  const double sy = static_cast<double>(image->height()) / level.height;
+
+  const QRectF exposed = option->exposedRect & boundingRect();
+  if (exposed.isEmpty())
+    return;
+  const int bx0 = static_cast<int>(exposed.left() / sx / level.block_width);
+  const int by0 = static_cast<int>(exposed.top() / sy / level.block_height);
+  const int bx1 = std::min(
+    static_cast<int>(exposed.right() / sx / level.block_width),
+    (level.width - 1) / level.block_width);
+  const int by1 = std::min(
+    static_cast<int>(exposed.bottom() / sy / level.block_height),
+    (level.height - 1) / level.block_height);
+
+  painter->setRenderHint(QPainter::SmoothPixmapTransform);
+  for (int by = by0; by <= by1; by++)
+  {
+    for (int bx = bx0; bx <= bx1; bx++)
+    {
+      const QImage block = image->block(level_idx, bx, by);
+      if (block.isNull())
+        continue;
+      painter->drawImage(
+        QRectF(
+          bx * level.block_width * sx,
+          by * level.block_height * sy,
+          block.width() * sx,
+          block.height() * sy),
+        block);
+    }
+  }
+}
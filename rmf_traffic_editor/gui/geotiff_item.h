@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef GEOTIFF_ITEM_H
+#define GEOTIFF_ITEM_H
+
+#include <memory>
+
+#include <QGraphicsItem>
+
+#include "geotiff_image.h"
+
+/*
+ * Draws a GeoTiffImage in the scene, in full-resolution pixel coordinates
+ * (like a QGraphicsPixmapItem of the whole image would), but only reads
+ * the blocks of the exposed area, from the overview closest to the
+ * current zoom.
+ */
+
+class GeoTiffItem : public QGraphicsItem
+{
+public:
+  GeoTiffItem(std::shared_ptr<GeoTiffImage> image);
+  ~GeoTiffItem();
+
+  QRectF boundingRect() const override;
+
+  void paint(
+    QPainter* painter,
+    const QStyleOptionGraphicsItem* option,
+    QWidget* widget) override;
+
+private:
+  std::shared_ptr<GeoTiffImage> image;
+};
+
+#endif
@@ -39,6 +39,9 @@ bool Graph::from_yaml(const int _idx, const YAML::Node& data)
   if (data["default_lane_width"])
     default_lane_width = data["default_lane_width"].as<double>();
 
+  if (data["footprint_radius"])
+    footprint_radius = data["footprint_radius"].as<double>();
+
   return true;
 }
 
@@ -47,5 +50,7 @@ YAML::Node Graph::to_yaml() const
   YAML::Node data;
   data["name"] = name;
   data["default_lane_width"] = default_lane_width;
+  if (footprint_radius > 0.0)
+    data["footprint_radius"] = footprint_radius;
   return data;
 }
@@ -32,6 +32,10 @@ public:
   std::string name;
   double default_lane_width = 1.0;
 
+  // radius of the robot footprint (meters) used when checking lane
+  // clearance. Zero means "not configured", i.e. use the analysis default.
+  double footprint_radius = 0.0;
+
   bool from_yaml(const int _idx, const YAML::Node& data);
   YAML::Node to_yaml() const;
 };
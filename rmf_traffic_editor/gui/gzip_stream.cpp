@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <zlib.h>
+
+#include "gzip_stream.h"
+
+using std::string;
+
+// zlib buffers internally too, but handing it big blocks keeps the
+// per-call overhead out of the character-at-a-time paths of the parser
+static const std::size_t BUFFER_SIZE = 1 << 16;
+
+// speed matters more than the last few percent of size, since this runs
+// every time the editor saves; repetitive YAML compresses well regardless
+static const char* const WRITE_MODE = "wb3";
+
+
+GzipStreamBuf::GzipStreamBuf()
+{
+}
+
+GzipStreamBuf::~GzipStreamBuf()
+{
+  close();
+}
+
+bool GzipStreamBuf::is_gzip_filename(const string& filename)
+{
+  const string suffix(".gz");
+  return filename.size() > suffix.size() &&
+    filename.compare(filename.size() - suffix.size(), suffix.size(), suffix)
+    == 0;
+}
+
+bool GzipStreamBuf::open(
+  const string& filename,
+  const std::ios_base::openmode mode)
+{
+  if (file)
+    return false;
+
+  writing = (mode & std::ios_base::out) != 0;
+  file = gzopen(filename.c_str(), writing ? WRITE_MODE : "rb");
+  if (!file)
+    return false;
+  gzbuffer(file, BUFFER_SIZE);
+
+  error_message.clear();
+  buffer.resize(BUFFER_SIZE);
+  if (writing)
+    setp(buffer.data(), buffer.data() + buffer.size());
+  else
+    setg(buffer.data(), buffer.data(), buffer.data());
+  return true;
+}
+
+bool GzipStreamBuf::close()
+{
+  if (!file)
+    return false;
+
+  bool ok = true;
+  if (writing)
+    ok = write_buffer();
+
+  // gzclose() flushes the compressor and writes the trailer, so a full
+  // disk may only be noticed here
+  const int result = gzclose(file);
+  file = nullptr;
+  if (result != Z_OK)
+  {
+    if (error_message.empty())
+      error_message = "unable to close file";
+    ok = false;
+  }
+
+  setg(nullptr, nullptr, nullptr);
+  setp(nullptr, nullptr);
+  return ok && error_message.empty();
+}
+
+void GzipStreamBuf::set_error()
+{
+  if (!error_message.empty())
+    return;
+  int errnum = Z_OK;
+  const char* msg = gzerror(file, &errnum);
+  error_message = (errnum != Z_OK && msg && *msg) ? msg : "i/o error";
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::underflow()
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  if (!file || writing || !error_message.empty())
+    return traits_type::eof();
+
+  const int n = gzread(file, buffer.data(), buffer.size());
+  if (n < 0)
+  {
+    set_error();
+    return traits_type::eof();
+  }
+  if (n == 0)
+  {
+    // a truncated stream reads as a short end of file; tell them apart
+    int errnum = Z_OK;
+    gzerror(file, &errnum);
+    if (errnum != Z_OK)
+      set_error();
+    return traits_type::eof();
+  }
+
+  setg(buffer.data(), buffer.data(), buffer.data() + n);
+  return traits_type::to_int_type(*gptr());
+}
+
+bool GzipStreamBuf::write_buffer()
+{
+  const int n = static_cast<int>(pptr() - pbase());
+  if (n > 0 && gzwrite(file, pbase(), n) != n)
+  {
+    set_error();
+    return false;
+  }
+  setp(buffer.data(), buffer.data() + buffer.size());
+  return true;
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow(int_type c)
+{
+  if (!file || !writing || !write_buffer())
+    return traits_type::eof();
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  *pptr() = traits_type::to_char_type(c);
+  pbump(1);
+  return c;
+}
+
+int GzipStreamBuf::sync()
+{
+  // only hand the buffer to zlib; a gzflush() would cost compression
+  if (file && writing && !write_buffer())
+    return -1;
+  return 0;
+}
+
+GzipIStream::GzipIStream()
+: std::istream(nullptr)
+{
+  rdbuf(&buf);
+}
+
+GzipIStream::GzipIStream(const string& filename)
+: GzipIStream()
+{
+  open(filename);
+}
+
+void GzipIStream::open(const string& filename)
+{
+  if (buf.open(filename, std::ios_base::in))
+    clear();
+  else
+    setstate(std::ios_base::failbit);
+}
+
+void GzipIStream::close()
+{
+  if (!buf.close())
+    setstate(std::ios_base::failbit);
+}
+
+GzipOStream::GzipOStream()
+: std::ostream(nullptr)
+{
+  rdbuf(&buf);
+}
+
+GzipOStream::GzipOStream(const string& filename)
+: GzipOStream()
+{
+  open(filename);
+}
+
+void GzipOStream::open(const string& filename)
+{
+  if (buf.open(filename, std::ios_base::out))
+    clear();
+  else
+    setstate(std::ios_base::failbit);
+}
+
+void GzipOStream::close()
+{
+  if (!buf.close())
+    setstate(std::ios_base::failbit);
+}
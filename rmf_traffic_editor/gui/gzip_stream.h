@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+struct gzFile_s;
+
+/*
+ * std::streambuf over a gzip file, so that building files can be parsed
+ * straight out of the decompressor and emitted straight into the
+ * compressor, without ever holding the whole (much larger) text in memory.
+ * When reading, files which aren't compressed are passed through as-is.
+ */
+
+class GzipStreamBuf : public std::streambuf
+{
+public:
+  GzipStreamBuf();
+  ~GzipStreamBuf();
+
+  bool open(const std::string& filename, const std::ios_base::openmode mode);
+  bool close();
+  bool is_open() const { return file != nullptr; }
+
+  // zlib's description of the first read or write error, or an empty
+  // string if there hasn't been one. A truncated file only shows up here.
+  std::string error() const { return error_message; }
+
+  // true if the filename ends in ".gz"
+  static bool is_gzip_filename(const std::string& filename);
+
+protected:
+  int_type underflow() override;
+  int_type overflow(int_type c) override;
+  int sync() override;
+
+private:
+  gzFile_s* file = nullptr;
+  bool writing = false;
+  std::vector<char> buffer;
+  std::string error_message;
+
+  bool write_buffer();
+  void set_error();
+};
+
+class GzipIStream : public std::istream
+{
+public:
+  GzipIStream();
+  explicit GzipIStream(const std::string& filename);
+
+  void open(const std::string& filename);
+  void close();
+  std::string error() const { return buf.error(); }
+
+private:
+  GzipStreamBuf buf;
+};
+
+class GzipOStream : public std::ostream
+{
+public:
+  GzipOStream();
+  explicit GzipOStream(const std::string& filename);
+
+  void open(const std::string& filename);
+  void close();
+  std::string error() const { return buf.error(); }
+
+private:
+  GzipStreamBuf buf;
+};
+
+#endif
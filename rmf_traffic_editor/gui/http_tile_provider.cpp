@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QtConcurrent/QtConcurrent>
+
+#include "http_tile_provider.h"
+
+// the tile coordinates of a request are kept in its user attributes
+static const QNetworkRequest::Attribute ZOOM_ATTRIBUTE =
+  QNetworkRequest::User;
+static const QNetworkRequest::Attribute X_ATTRIBUTE =
+  static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+static const QNetworkRequest::Attribute Y_ATTRIBUTE =
+  static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 2);
+
+
+HttpTileProvider::HttpTileProvider(
+  QObject* parent,
+  const QString& _url_template,
+  MapTileCache& _cache)
+: TileProvider(parent),
+  url_template(_url_template),
+  cache(_cache)
+{
+  network = new QNetworkAccessManager(this);
+  connect(
+    network,
+    &QNetworkAccessManager::finished,
+    this,
+    &HttpTileProvider::request_finished);
+}
+
+HttpTileProvider::~HttpTileProvider()
+{
+  stop_workers();
+}
+
+QString HttpTileProvider::description() const
+{
+  return url_template;
+}
+
+int HttpTileProvider::max_requests_in_flight() const
+{
+  // todo: tune this, or allow it to be a user-configurable parameter.
+  // It seems to behave fairly nicely with a cap at just one
+  // request in flight, but that may vary depending on server load
+  // and latency.
+  return 1;
+}
+
+void HttpTileProvider::request(const int zoom, const int x, const int y)
+{
+  std::optional<const QByteArray> cached = cache.get(zoom, x, y);
+  if (cached.has_value())
+  {
+    const QByteArray bytes = cached.value();
+    QtConcurrent::run(
+      &thread_pool,
+      [=]()
+      {
+        decode(zoom, x, y, bytes);
+      });
+    return;
+  }
+
+  num_requests++;
+  if (num_requests > 2000)
+  {
+    printf("past max number of requests this run (%d)..."
+      "in case this is a wild bug, I'm stopping now!\n",
+      num_requests);
+    emit tile_failed(zoom, x, y);
+    return;
+  }
+
+  printf("  requesting tile %d: zoom=%d, x=%d, y=%d\n",
+    num_requests,
+    zoom,
+    x,
+    y);
+
+  QString request_url(url_template);
+  request_url.replace("{z}", QString::number(zoom));
+  request_url.replace("{x}", QString::number(x));
+  request_url.replace("{y}", QString::number(y));
+
+  QNetworkRequest request;
+  request.setUrl(QUrl(request_url));
+  request.setRawHeader(
+    "User-Agent",
+    "TrafficEditor/1.4 (http://open-rmf.org)");
+  request.setAttribute(ZOOM_ATTRIBUTE, zoom);
+  request.setAttribute(X_ATTRIBUTE, x);
+  request.setAttribute(Y_ATTRIBUTE, y);
+  network->get(request);
+}
+
+void HttpTileProvider::request_finished(QNetworkReply* reply)
+{
+  const int zoom = reply->request().attribute(ZOOM_ATTRIBUTE).toInt();
+  const int x = reply->request().attribute(X_ATTRIBUTE).toInt();
+  const int y = reply->request().attribute(Y_ATTRIBUTE).toInt();
+
+  if (reply->error() != QNetworkReply::NoError)
+  {
+    printf("tile request failed: %s\n",
+      reply->errorString().toStdString().c_str());
+    emit tile_failed(zoom, x, y);
+    reply->deleteLater();
+    return;
+  }
+
+  const QByteArray bytes = reply->readAll();
+  printf("received %d-byte tile: zoom=%d x=%d y=%d\n",
+    bytes.length(),
+    zoom,
+    x,
+    y);
+
+  // decode off the GUI thread, and only cache tiles which can be parsed
+  QtConcurrent::run(
+    &thread_pool,
+    [=]()
+    {
+      QImage image;
+      if (!image.loadFromData(bytes))
+      {
+        printf("  unable to parse\n");
+        emit tile_failed(zoom, x, y);
+        return;
+      }
+      QMetaObject::invokeMethod(
+        this,
+        [=]()
+        {
+          cache.set(zoom, x, y, bytes);
+        },
+        Qt::QueuedConnection);
+      emit tile_ready(
+        zoom,
+        x,
+        y,
+        image.convertToFormat(QImage::Format_Grayscale8));
+    });
+
+  // schedule this reply object for deletion (eventually)
+  reply->deleteLater();
+}
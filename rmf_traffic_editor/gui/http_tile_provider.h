@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef HTTP_TILE_PROVIDER_H
+#define HTTP_TILE_PROVIDER_H
+
+#include "map_tile_cache.h"
+#include "tile_provider.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/*
+ * Tiles from a web tile server, kept in the on-disk MapTileCache.
+ */
+
+class HttpTileProvider : public TileProvider
+{
+  Q_OBJECT
+
+public:
+  HttpTileProvider(
+    QObject* parent,
+    const QString& url_template,
+    MapTileCache& cache);
+  ~HttpTileProvider();
+
+  QString description() const override;
+  void request(const int zoom, const int x, const int y) override;
+  int max_requests_in_flight() const override;
+
+private:
+  QString url_template;
+  MapTileCache& cache;
+  QNetworkAccessManager* network = nullptr;
+  int num_requests = 0;
+
+  void request_finished(QNetworkReply* reply);
+};
+
+#endif
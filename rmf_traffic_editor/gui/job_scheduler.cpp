@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+
+#include <QEventLoop>
+#include <QRunnable>
+#include <QThread>
+
+#include "job_scheduler.h"
+
+using std::vector;
+
+
+void JobContext::set_progress(const double fraction)
+{
+  if (fraction < 0.0)
+    _progress_permille = -1;
+  else
+    _progress_permille = static_cast<int>(std::min(fraction, 1.0) * 1000.0);
+}
+
+double JobContext::progress() const
+{
+  const int permille = _progress_permille.load();
+  return permille < 0 ? -1.0 : permille / 1000.0;
+}
+
+// runs the work of a job on a pool thread, then hands the result back to
+// the scheduler on the GUI thread. It never owns the job, so nothing the
+// job captured is destroyed on the pool thread.
+class JobRunnable : public QRunnable
+{
+public:
+  JobRunnable(
+    JobScheduler* _scheduler,
+    const JobScheduler::JobId _id,
+    const JobScheduler::Work* _work,
+    const std::shared_ptr<JobContext>& _context,
+    std::function<void(JobScheduler::JobId, bool)> _finish)
+  : scheduler(_scheduler),
+    id(_id),
+    work(_work),
+    context(_context),
+    finish(_finish)
+  {
+  }
+
+  void run() override
+  {
+    bool ok = false;
+    if (!context->cancelled())
+      ok = (*work)(*context) && !context->cancelled();
+
+    const JobScheduler::JobId job_id = id;
+    auto finish_job = finish;
+    QMetaObject::invokeMethod(
+      scheduler,
+      [finish_job, job_id, ok]() { finish_job(job_id, ok); },
+      Qt::QueuedConnection);
+  }
+
+private:
+  JobScheduler* scheduler;
+  JobScheduler::JobId id;
+  const JobScheduler::Work* work;
+  std::shared_ptr<JobContext> context;
+  std::function<void(JobScheduler::JobId, bool)> finish;
+};
+
+JobScheduler::JobScheduler(QObject* parent)
+: QObject(parent)
+{
+  // leave a core for the GUI thread
+  pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+JobScheduler::~JobScheduler()
+{
+  for (auto& it : jobs)
+    it.second->context->cancel();
+  pool.clear();  // drop the ones which haven't started
+  pool.waitForDone();
+}
+
+JobScheduler::JobId JobScheduler::submit(
+  const QString& name,
+  const Priority priority,
+  Work work,
+  Done done,
+  const vector<JobId>& after)
+{
+  std::unique_ptr<Job> job = std::make_unique<Job>();
+  job->id = next_id++;
+  job->name = name;
+  job->priority = priority;
+  job->work = work;
+  job->done = done;
+  job->context = std::make_shared<JobContext>();
+
+  // jobs which have already finished successfully don't need waiting for,
+  // but if one failed or was cancelled, this one will never run
+  bool doomed = false;
+  for (const JobId after_id : after)
+  {
+    if (jobs.count(after_id))
+      job->after.push_back(after_id);
+    else if (outcome(after_id) != SUCCEEDED)
+      doomed = true;
+  }
+
+  const JobId id = job->id;
+  if (doomed)
+  {
+    // finish it from the event loop, so the done function isn't called
+    // before the caller even has the id
+    job->context->cancel();
+    QMetaObject::invokeMethod(
+      this,
+      [this, id]() { cancel(id); },
+      Qt::QueuedConnection);
+  }
+  jobs[id] = std::move(job);
+  start_ready_jobs();
+  emit status_changed();
+  return id;
+}
+
+void JobScheduler::cancel(const JobId id)
+{
+  auto it = jobs.find(id);
+  if (it == jobs.end())
+    return;
+  Job& job = *it->second;
+  job.context->cancel();
+  if (!job.started)
+  {
+    // it'll never start, so finish it now; that also cancels its chain
+    finish(id, false);
+  }
+}
+
+void JobScheduler::cancel_all()
+{
+  vector<JobId> ids;
+  for (const auto& it : jobs)
+    ids.push_back(it.first);
+  for (const JobId id : ids)
+    cancel(id);
+}
+
+void JobScheduler::start_ready_jobs()
+{
+  for (auto& it : jobs)
+  {
+    Job& job = *it.second;
+    if (job.started || !job.after.empty() || job.context->cancelled())
+      continue;
+    job.started = true;
+    pool.start(
+      new JobRunnable(
+        this,
+        job.id,
+        &job.work,
+        job.context,
+        [this](const JobId id, const bool ok) { finish(id, ok); }),
+      static_cast<int>(job.priority));
+  }
+}
+
+void JobScheduler::finish(const JobId id, const bool ok)
+{
+  auto it = jobs.find(id);
+  if (it == jobs.end())
+    return;
+  std::unique_ptr<Job> job = std::move(it->second);
+  jobs.erase(it);
+
+  Outcome result = ok ? SUCCEEDED : FAILED;
+  if (job->context->cancelled())
+    result = CANCELLED;
+  outcomes[id] = result;
+
+  // release or cancel the jobs chained after this one
+  vector<JobId> cancelled;
+  for (auto& chained : jobs)
+  {
+    vector<JobId>& after = chained.second->after;
+    const auto after_it = std::find(after.begin(), after.end(), id);
+    if (after_it == after.end())
+      continue;
+    after.erase(after_it);
+    if (result != SUCCEEDED)
+      cancelled.push_back(chained.first);
+  }
+
+  if (job->done)
+    job->done(result);
+
+  for (const JobId cancelled_id : cancelled)
+    cancel(cancelled_id);
+
+  start_ready_jobs();
+  emit job_finished(id);
+  emit status_changed();
+}
+
+JobScheduler::Outcome JobScheduler::outcome(const JobId id) const
+{
+  const auto it = outcomes.find(id);
+  if (it == outcomes.end())
+    return CANCELLED;
+  return it->second;
+}
+
+JobScheduler::Outcome JobScheduler::wait(const JobId id)
+{
+  if (pending(id))
+  {
+    QEventLoop loop;
+    connect(
+      this,
+      &JobScheduler::job_finished,
+      &loop,
+      [&loop, id](const JobId finished_id)
+      {
+        if (finished_id == id)
+          loop.quit();
+      });
+    loop.exec(QEventLoop::ExcludeUserInputEvents);
+  }
+  return outcome(id);
+}
+
+JobScheduler::Status JobScheduler::status() const
+{
+  Status status;
+  const Job* shown = nullptr;
+  for (const auto& it : jobs)
+  {
+    const Job& job = *it.second;
+    if (!job.started)
+    {
+      status.waiting++;
+      continue;
+    }
+    status.running++;
+    if (!shown || job.priority > shown->priority)
+      shown = &job;
+  }
+  if (shown)
+  {
+    status.name = shown->name;
+    status.progress = shown->context->progress();
+  }
+  return status;
+}
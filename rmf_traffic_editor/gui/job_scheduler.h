@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+/*
+ * Handed to a running job, so it can notice that it was cancelled and
+ * report how far along it is. Both are safe to use from any thread.
+ */
+class JobContext
+{
+public:
+  bool cancelled() const { return _cancelled.load(); }
+  void cancel() { _cancelled = true; }
+
+  // fraction done, from 0 to 1, or negative if unknown
+  void set_progress(const double fraction);
+  double progress() const;
+
+private:
+  std::atomic<bool> _cancelled {false};
+  std::atomic<int> _progress_permille {-1};
+};
+
+/*
+ * Runs slow editor operations on worker threads, so the GUI never blocks
+ * on them. Jobs run in order of priority, and a job can be chained after
+ * others so it only starts once they have all succeeded; if any of them
+ * fails or is cancelled (or already has, or was never submitted), so is
+ * the chained job.
+ *
+ * The work function runs on a worker thread and must not touch anything
+ * the GUI thread may be using, so it should work on copies (for levels,
+ * see Level::snapshot()). The done function runs on the GUI thread once
+ * the work is over, which is where results are handed back. Both
+ * functions are destroyed on the GUI thread.
+ */
+class JobScheduler : public QObject
+{
+  Q_OBJECT
+
+public:
+  enum Priority
+  {
+    BACKGROUND = 0,  // nobody is waiting for it
+    VISIBLE,  // its result will be shown when it's done
+    INTERACTIVE  // the user asked for it and is waiting
+  };
+
+  typedef int JobId;
+
+  // returns whether it succeeded
+  typedef std::function<bool(JobContext& context)> Work;
+
+  enum Outcome
+  {
+    SUCCEEDED = 0,
+    FAILED,
+    CANCELLED
+  };
+
+  typedef std::function<void(const Outcome outcome)> Done;
+
+  JobScheduler(QObject* parent = nullptr);
+  ~JobScheduler();  // cancels all jobs and waits for the running ones
+
+  JobId submit(
+    const QString& name,
+    const Priority priority,
+    Work work,
+    Done done = nullptr,
+    const std::vector<JobId>& after = std::vector<JobId>());
+
+  void cancel(const JobId id);
+  void cancel_all();
+
+  bool busy() const { return !jobs.empty(); }
+  bool pending(const JobId id) const { return jobs.count(id) > 0; }
+
+  // how a finished job went; CANCELLED if it was never submitted
+  Outcome outcome(const JobId id) const;
+
+  // runs the event loop, without user input, until the job has finished
+  // and its done function has been called
+  Outcome wait(const JobId id);
+
+  struct Status
+  {
+    int running = 0;  // handed to the thread pool
+    int waiting = 0;  // for the jobs they're chained after
+    QString name;  // of the highest-priority running job
+    double progress = -1.0;  // of that job, or negative if unknown
+  };
+  Status status() const;
+
+signals:
+  void status_changed();
+  void job_finished(const JobId id);
+
+private:
+  struct Job
+  {
+    JobId id = 0;
+    QString name;
+    Priority priority = BACKGROUND;
+    Work work;
+    Done done;
+    std::vector<JobId> after;
+    std::shared_ptr<JobContext> context;
+    bool started = false;
+  };
+  std::map<JobId, std::unique_ptr<Job>> jobs;
+  std::map<JobId, Outcome> outcomes;  // of the finished jobs
+  JobId next_id = 1;
+  QThreadPool pool;
+
+  void start_ready_jobs();
+  void finish(const JobId id, const bool ok);
+};
+
+#endif
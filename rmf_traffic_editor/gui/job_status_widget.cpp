@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <QtWidgets>
+
+#include "job_status_widget.h"
+
+
+JobStatusWidget::JobStatusWidget(QWidget* parent, JobScheduler& _scheduler)
+: QWidget(parent),
+  scheduler(_scheduler)
+{
+  name_label = new QLabel(this);
+
+  progress_bar = new QProgressBar(this);
+  progress_bar->setMaximumWidth(150);
+  progress_bar->setTextVisible(false);
+
+  cancel_button = new QToolButton(this);
+  cancel_button->setText("Cancel");
+  cancel_button->setToolTip("Cancel all background jobs");
+  connect(
+    cancel_button,
+    &QAbstractButton::clicked,
+    [this]() { scheduler.cancel_all(); });
+
+  QHBoxLayout* hbox = new QHBoxLayout;
+  hbox->setContentsMargins(0, 0, 0, 0);
+  hbox->addWidget(name_label);
+  hbox->addWidget(progress_bar);
+  hbox->addWidget(cancel_button);
+  setLayout(hbox);
+
+  progress_timer = new QTimer(this);
+  connect(
+    progress_timer,
+    &QTimer::timeout,
+    this,
+    &JobStatusWidget::update_status);
+  connect(
+    &scheduler,
+    &JobScheduler::status_changed,
+    this,
+    &JobStatusWidget::update_status);
+
+  update_status();
+}
+
+JobStatusWidget::~JobStatusWidget()
+{
+}
+
+void JobStatusWidget::update_status()
+{
+  const JobScheduler::Status status = scheduler.status();
+  if (status.running == 0 && status.waiting == 0)
+  {
+    progress_timer->stop();
+    hide();
+    return;
+  }
+
+  QString text = status.name;
+  const int others = status.running + status.waiting - 1;
+  if (others > 0)
+    text += QString(" (+%1 more)").arg(others);
+  name_label->setText(text);
+
+  if (status.progress < 0.0)
+    progress_bar->setRange(0, 0);  // busy indicator
+  else
+  {
+    progress_bar->setRange(0, 1000);
+    progress_bar->setValue(static_cast<int>(status.progress * 1000.0));
+  }
+
+  if (!progress_timer->isActive())
+    progress_timer->start(200);
+  show();
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef JOB_STATUS_WIDGET_H
+#define JOB_STATUS_WIDGET_H
+
+#include <QWidget>
+
+#include "job_scheduler.h"
+class QLabel;
+class QProgressBar;
+class QTimer;
+class QToolButton;
+
+/*
+ * Status bar widget showing what the JobScheduler is busy with, and a
+ * button to cancel it all. It's hidden while there's nothing to show.
+ */
+class JobStatusWidget : public QWidget
+{
+  Q_OBJECT
+
+public:
+  JobStatusWidget(QWidget* parent, JobScheduler& scheduler);
+  ~JobStatusWidget();
+
+private:
+  JobScheduler& scheduler;
+
+  QLabel* name_label;
+  QProgressBar* progress_bar;
+  QToolButton* cancel_button;
+  QTimer* progress_timer;  // progress isn't signalled, so poll it
+
+  void update_status();
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrent>
+
+#include "distance_transform.h"
+#include "lane_proposal.h"
+#include "skeleton.h"
+
+using std::vector;
+
+
+LaneProposal::LaneProposal()
+{
+}
+
+LaneProposal::~LaneProposal()
+{
+}
+
+bool LaneProposal::run(const Level& level)
+{
+  vertices.clear();
+  lanes.clear();
+
+  const double mpp = level.drawing_meters_per_pixel;
+  if (mpp <= 0.0)
+    return false;
+  if (layer_idx < 0 || layer_idx >= static_cast<int>(level.layers.size()))
+    return false;
+  const Layer& layer = level.layers[layer_idx];
+  const QImage& image = layer.image;
+  const double layer_mpp = layer.transform.scale();  // meters per pixel
+  if (image.isNull() || layer_mpp <= 0.0)
+    return false;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  const int width = image.width();
+  const int height = image.height();
+  const std::size_t num_pixels = static_cast<std::size_t>(width) * height;
+  vector<int> rows(height);
+  for (int y = 0; y < height; y++)
+    rows[y] = y;
+
+  vector<uint8_t> free_space(num_pixels);
+  const double clearance_pixels = min_clearance / layer_mpp;
+  if (clearance_pixels > 0.0)
+  {
+    // shrink the free space by thresholding its distance transform
+    vector<float> distance(num_pixels);
+    QtConcurrent::blockingMap(
+      rows,
+      [&](const int y)
+      {
+        const uchar* in = image.constScanLine(y);
+        float* out = &distance[static_cast<std::size_t>(y) * width];
+        for (int x = 0; x < width; x++)
+          out[x] = in[x] >= free_threshold ? DistanceTransform::INF : 0.0f;
+      });
+    DistanceTransform::squared_edt_parallel(distance.data(), width, height);
+
+    const float min_sq =
+      static_cast<float>(clearance_pixels * clearance_pixels);
+    QtConcurrent::blockingMap(
+      rows,
+      [&](const int y)
+      {
+        const std::size_t row = static_cast<std::size_t>(y) * width;
+        for (int x = 0; x < width; x++)
+          free_space[row + x] = distance[row + x] >= min_sq;
+      });
+  }
+  else
+  {
+    QtConcurrent::blockingMap(
+      rows,
+      [&](const int y)
+      {
+        const uchar* in = image.constScanLine(y);
+        uint8_t* out = &free_space[static_cast<std::size_t>(y) * width];
+        for (int x = 0; x < width; x++)
+          out[x] = in[x] >= free_threshold;
+      });
+  }
+
+  Skeleton::thin(free_space, width, height);
+
+  Skeleton skeleton;
+  skeleton.min_branch_length = min_branch_length / layer_mpp;
+  skeleton.simplify_tolerance = simplify_tolerance / layer_mpp;
+  skeleton.extract_graph(free_space, width, height);
+
+  for (const auto& node : skeleton.nodes)
+    vertices.push_back(
+      layer.transform.forwards(QPointF(node.x, node.y)) / mpp);
+  lanes = skeleton.edges;
+
+  printf("proposed %d vertices and %d lanes from a %dx%d layer in %.3f s\n",
+    static_cast<int>(vertices.size()),
+    static_cast<int>(lanes.size()),
+    width,
+    height,
+    timer.elapsed() / 1000.0);
+  return true;
+}
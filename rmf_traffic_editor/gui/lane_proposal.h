@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef LANE_PROPOSAL_H
+#define LANE_PROPOSAL_H
+
+#include <utility>
+#include <vector>
+
+#include <QPointF>
+
+#include "level.h"
+
+/*
+ * Proposes a lane graph from an occupancy layer: the free space of the
+ * layer image is thresholded, shrunk away from obstacles by a minimum
+ * clearance, thinned down to its skeleton, and the skeleton is simplified
+ * into straight lanes.
+ */
+
+class LaneProposal
+{
+public:
+  LaneProposal();
+  ~LaneProposal();
+
+  int layer_idx = 0;
+  int free_threshold = 250;  // layer pixels at least this bright are free
+  double min_clearance = 0.3;  // meters from the nearest obstacle
+  double min_branch_length = 1.0;  // meters; shorter dead ends are pruned
+  double simplify_tolerance = 0.1;  // meters
+
+  // proposed graph, in level coordinates
+  std::vector<QPointF> vertices;
+  std::vector<std::pair<int, int>> lanes;
+
+  bool run(const Level& level);
+};
+
+#endif
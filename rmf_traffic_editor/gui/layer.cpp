@@ -17,10 +17,13 @@
 
 #include <cmath>
 
+#include <QFileInfo>
 #include <QImageReader>
 #include <QGraphicsPixmapItem>
 #include <QGraphicsScene>
 #include <QTableWidget>
+#include "geotiff_image.h"
+#include "geotiff_item.h"
 #include "layer.h"
 using std::string;
 using std::vector;
@@ -36,7 +39,8 @@ Layer::~Layer()
 bool Layer::from_yaml(
   const std::string& _name,
   const YAML::Node& y,
-  const CoordinateSystem& coordinate_system)
+  const CoordinateSystem& coordinate_system,
+  const bool load)
 {
   if (!y.IsMap())
     throw std::runtime_error("Layer::from_yaml() expected a map");
@@ -102,11 +106,37 @@ bool Layer::from_yaml(
     }
   }
 
-  return load_image();
+  if (!load)
+    return true;
+
+  const bool loaded = load_image();
+  if (loaded && !y["transform"] && !y["meters_per_pixel"])
+    georeference(coordinate_system);
+  return loaded;
 }
 
 bool Layer::load_image()
 {
+  // georeferenced or huge TIFFs are read a window at a time when drawn
+  geotiff.reset();
+  const QString suffix =
+    QFileInfo(QString::fromStdString(filename)).suffix().toLower();
+  if (suffix == "tif" || suffix == "tiff")
+  {
+    const double MAX_LOADED_PIXELS = 64e6;
+    std::shared_ptr<GeoTiffImage> tiff = std::make_shared<GeoTiffImage>();
+    if (tiff->open(filename) &&
+      (tiff->georeferenced ||
+      static_cast<double>(tiff->width()) * tiff->height() > MAX_LOADED_PIXELS))
+    {
+      geotiff = tiff;
+      image = QImage();
+      colorized_image = QImage();
+      pixmap = QPixmap();
+      return true;
+    }
+  }
+
   QImageReader image_reader(QString::fromStdString(filename));
   image_reader.setAutoTransform(true);
   image = image_reader.read();
@@ -118,7 +148,9 @@ bool Layer::load_image()
     return false;
   }
   image = image.convertToFormat(QImage::Format_Grayscale8);
-  colorize_image();
+  color.setAlphaF(0.5);
+  colorized_image = QImage();
+  pixmap = QPixmap();
   printf("successfully opened %s\n", filename.c_str());
 
   return true;
@@ -152,10 +184,21 @@ void Layer::draw(
   if (!visible)
     return;
 
-  QGraphicsPixmapItem* item = scene->addPixmap(pixmap);
+  QGraphicsItem* item = nullptr;
+  if (geotiff)
+  {
+    item = new GeoTiffItem(geotiff);
+    scene->addItem(item);
+    scene_item = nullptr;
+  }
+  else
+  {
+    QGraphicsPixmapItem* pixmap_item = scene->addPixmap(pixmap);
 
-  // Store for later use in getting coordinates back out
-  scene_item = item;
+    // Store for later use in getting coordinates back out
+    scene_item = pixmap_item;
+    item = pixmap_item;
+  }
 
   item->setPos(
     transform.translation().x() / level_meters_per_pixel,
@@ -194,9 +237,44 @@ void Layer::draw(
     origin.x() + 2.0 * origin_radius * cos(transform.yaw()),
     origin.y() + y_flip * 2.0 * origin_radius * sin(transform.yaw()));
   scene->addLine(QLineF(origin, x_arrow), origin_pen);
+}
+
+bool Layer::georeference(const CoordinateSystem& coordinate_system)
+{
+  if (!geotiff || !geotiff->georeferenced || geotiff->epsg <= 0 ||
+    !coordinate_system.is_global())
+    return false;
+
+  // project the top edge of the image, which gives its position, scale
+  // and rotation in EPSG:3857 (which is conformal, so that's enough)
+  const std::string crs = "EPSG:" + std::to_string(geotiff->epsg);
+  const double w = geotiff->width();
+  CoordinateSystem::ProjectedPoint upper_left, upper_right;
+  if (!coordinate_system.to_epsg3857(
+      crs,
+      geotiff->a[0],
+      geotiff->b[0],
+      upper_left) ||
+    !coordinate_system.to_epsg3857(
+      crs,
+      geotiff->a[0] + geotiff->a[1] * w,
+      geotiff->b[0] + geotiff->b[1] * w,
+      upper_right))
+  {
+    printf("unable to project %s from %s\n", filename.c_str(), crs.c_str());
+    return false;
+  }
 
-  for (Feature& feature : features)
-    feature.draw(scene, color, transform, level_meters_per_pixel);
+  const double dx = upper_right.x - upper_left.x;
+  const double dy = upper_right.y - upper_left.y;
+  transform.setTranslation(QPointF(upper_left.x, upper_left.y));
+  transform.setScale(std::sqrt(dx * dx + dy * dy) / w);
+  transform.setYaw(std::atan2(-dy, dx));
+  printf("georeferenced %s from %s: %.3f m/px\n",
+    filename.c_str(),
+    crs.c_str(),
+    transform.scale());
+  return true;
 }
 
 QColor Layer::default_color(const int layer_idx)
@@ -282,6 +360,21 @@ const Feature* Layer::find_feature(
   return nullptr;
 }
 
+void Layer::feature_positions(
+  const double level_meters_per_pixel,
+  std::vector<QPointF>& positions) const
+{
+  // fold the conversion from meters to level pixels into the transform
+  Transform to_pixels(transform);
+  to_pixels.setScale(transform.scale() / level_meters_per_pixel);
+  to_pixels.setTranslation(transform.translation() / level_meters_per_pixel);
+
+  positions.resize(features.size());
+  for (std::size_t i = 0; i < features.size(); i++)
+    positions[i] = features[i].qpoint();
+  to_pixels.forwards(positions.data(), positions.data(), positions.size());
+}
+
 QPointF Layer::transform_global_to_layer(const QPointF& global_point)
 {
   return transform.backwards(global_point);
@@ -292,26 +385,46 @@ QPointF Layer::transform_layer_to_global(const QPointF& layer_point)
   return transform.forwards(layer_point);
 }
 
-void Layer::clear_selection()
+std::size_t Layer::image_bytes() const
 {
-  for (auto& feature : features)
-    feature.setSelected(false);
+  std::size_t bytes = image.sizeInBytes() + colorized_image.sizeInBytes();
+  if (!pixmap.isNull())
+    bytes += static_cast<std::size_t>(pixmap.width()) * pixmap.height() *
+      pixmap.depth() / 8;
+  if (geotiff)
+    bytes += geotiff->cached_bytes();
+  return bytes;
 }
 
-void Layer::colorize_image()
+std::size_t Layer::evict_images(const std::size_t bytes)
 {
-  color.setAlphaF(0.5);
-  colorized_image = QImage(image.size(), QImage::Format_ARGB32);
-  for (int row_idx = 0; row_idx < image.height(); row_idx++)
+  std::size_t freed = 0;
+  if (!image.isNull() && !pixmap.isNull())
   {
-    const uint8_t* const in_row = (uint8_t*)image.scanLine(row_idx);
-    QRgb* out_row = (QRgb*)colorized_image.scanLine(row_idx);
+    freed += colorized_image.sizeInBytes();
+    freed += static_cast<std::size_t>(pixmap.width()) * pixmap.height() *
+      pixmap.depth() / 8;
+    colorized_image = QImage();
+    pixmap = QPixmap();
+  }
+  if (geotiff && freed < bytes)
+    freed += geotiff->trim_cache(bytes - freed);
+  return freed;
+}
 
-    for (int col_idx = 0; col_idx < image.width(); col_idx++)
+QImage Layer::colorized(const QImage& gray, const QColor& tint)
+{
+  QImage out(gray.size(), QImage::Format_ARGB32);
+  for (int row_idx = 0; row_idx < gray.height(); row_idx++)
+  {
+    const uint8_t* const in_row = (const uint8_t*)gray.constScanLine(row_idx);
+    QRgb* out_row = (QRgb*)out.scanLine(row_idx);
+
+    for (int col_idx = 0; col_idx < gray.width(); col_idx++)
     {
       const uint8_t in = in_row[col_idx];
-      if (in < 100 || row_idx == 0 || row_idx == image.height() - 1)
-        out_row[col_idx] = color.rgba();
+      if (in < 100 || row_idx == 0 || row_idx == gray.height() - 1)
+        out_row[col_idx] = tint.rgba();
       else if (in > 200)
         out_row[col_idx] = qRgba(0, 0, 0, 0);
       else
@@ -320,13 +433,27 @@ void Layer::colorize_image()
 
     // draw bold first/last columns the requested color on the image,
     // so it's easier to see what's going on with its transform
-    out_row[0] = color.rgba();
-    out_row[image.width()-1] = color.rgba();
+    out_row[0] = tint.rgba();
+    out_row[gray.width()-1] = tint.rgba();
   }
 
+  return out;
+}
+
+void Layer::set_colorized_image(const QImage& _colorized, const QColor& _color)
+{
+  colorized_image = _colorized;
+  colorized_color = _color;
   pixmap = QPixmap::fromImage(colorized_image);
 }
 
+bool Layer::needs_colorizing() const
+{
+  if (image.isNull())
+    return false;
+  return pixmap.isNull() || colorized_color != color;
+}
+
 void Layer::populate_property_editor(QTableWidget* property_editor) const
 {
   property_editor->blockSignals(true);
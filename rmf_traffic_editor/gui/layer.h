@@ -18,6 +18,7 @@
 #ifndef LAYER_H
 #define LAYER_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,7 @@
 #include "feature.hpp"
 #include "transform.hpp"
 
+class GeoTiffImage;
 class QGraphicsScene;
 class QGraphicsPixmapItem;
 class QTableWidget;
@@ -54,19 +56,41 @@ public:
 
   QImage image, colorized_image;
   QPixmap pixmap;
+  QColor colorized_color;  // the color the pixmap was made in
   QGraphicsPixmapItem* scene_item = nullptr;  // Borrowed pointer, not owned, don't delete
 
+  // Georeferenced or very large TIFF images (e.g. orthophotos) aren't
+  // loaded into image/pixmap; they are drawn a window at a time instead.
+  std::shared_ptr<GeoTiffImage> geotiff;
+
   std::vector<Feature> features;
 
   bool from_yaml(
     const std::string& name,
     const YAML::Node& data,
-    const CoordinateSystem& coordinate_system);
+    const CoordinateSystem& coordinate_system,
+    const bool load = true);  // whether to load the image, too
 
   YAML::Node to_yaml(const CoordinateSystem& coordinate_system) const;
 
   bool load_image();
-  void colorize_image();
+
+  // the colorized copy is slow to make for large images, so it's made off
+  // the GUI thread (see Editor::colorize_layers()) and handed back here
+  static QImage colorized(const QImage& gray, const QColor& tint);
+  void set_colorized_image(const QImage& _colorized, const QColor& _color);
+  bool needs_colorizing() const;
+
+  // memory held by the images and the GeoTIFF block cache
+  std::size_t image_bytes() const;
+
+  // free up to this many bytes of what can be regenerated: the colorized
+  // copies (remade from the image after it's next drawn), then GeoTIFF
+  // blocks
+  std::size_t evict_images(const std::size_t bytes);
+
+  // place a georeferenced image by its own georeferencing, if possible
+  bool georeference(const CoordinateSystem& coordinate_system);
 
   void draw(
     QGraphicsScene* scene,
@@ -89,10 +113,14 @@ public:
     const double y,
     const double drawing_meters_per_pixel) const;
 
+  // positions of all features in the parent level's pixels, in one pass
+  void feature_positions(
+    const double level_meters_per_pixel,
+    std::vector<QPointF>& positions) const;
+
   QPointF transform_global_to_layer(const QPointF& global_point);
   QPointF transform_layer_to_global(const QPointF& layer_point);
 
-  void clear_selection();
 
   void populate_property_editor(QTableWidget* property_editor) const;
 
@@ -153,7 +153,7 @@ void LayerDialog::filename_button_clicked()
 {
   QFileDialog file_dialog(this, "Find Image");
   file_dialog.setFileMode(QFileDialog::ExistingFile);
-  file_dialog.setNameFilter("*.png");
+  file_dialog.setNameFilter("Images (*.png *.tif *.tiff)");
   if (file_dialog.exec() != QDialog::Accepted)
   {
     return;  // user clicked 'cancel'
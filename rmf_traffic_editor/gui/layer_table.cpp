@@ -119,8 +119,8 @@ void LayerTable::set_row(
         if (selected_color.isValid())
         {
           selected_color.setAlphaF(0.5);
+          // the scene redraw recolors it
           level.layers[row_idx - 1].color = selected_color;
-          level.layers[row_idx - 1].colorize_image();
           emit redraw_scene();
         }
       }
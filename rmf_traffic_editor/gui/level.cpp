@@ -45,7 +45,8 @@ Level::~Level()
 bool Level::from_yaml(
   const std::string& _name,
   const YAML::Node& _data,
-  const CoordinateSystem& coordinate_system)
+  const CoordinateSystem& coordinate_system,
+  const bool load_layer_images)
 {
   printf("parsing level [%s]\n", _name.c_str());
   name = _name;
@@ -81,47 +82,51 @@ bool Level::from_yaml(
     drawing_height = y_meters / drawing_meters_per_pixel;
   }
 
-  if (_data["vertices"] && _data["vertices"].IsSequence())
+  const YAML::Node pts = _data["vertices"];
+  if (pts && pts.IsSequence())
   {
-    const YAML::Node& pts = _data["vertices"];
+    vertices.reserve(vertices.size() + pts.size());
     for (YAML::const_iterator it = pts.begin(); it != pts.end(); ++it)
     {
       Vertex v;
       v.from_yaml(*it, coordinate_system);
-      vertices.push_back(v);
+      vertices.push_back(std::move(v));
     }
   }
 
-  if (_data["fiducials"] && _data["fiducials"].IsSequence())
+  const YAML::Node fy = _data["fiducials"];
+  if (fy && fy.IsSequence())
   {
-    const YAML::Node& fy = _data["fiducials"];
+    fiducials.reserve(fiducials.size() + fy.size());
     for (YAML::const_iterator it = fy.begin(); it != fy.end(); ++it)
     {
       Fiducial f;
       f.from_yaml(*it);
-      fiducials.push_back(f);
+      fiducials.push_back(std::move(f));
     }
   }
 
-  if (_data["features"] && _data["features"].IsSequence())
+  const YAML::Node ff = _data["features"];
+  if (ff && ff.IsSequence())
   {
-    const YAML::Node& fy = _data["features"];
-    for (YAML::const_iterator it = fy.begin(); it != fy.end(); ++it)
+    floorplan_features.reserve(floorplan_features.size() + ff.size());
+    for (YAML::const_iterator it = ff.begin(); it != ff.end(); ++it)
     {
       Feature f;
       f.from_yaml(*it);
-      floorplan_features.push_back(f);
+      floorplan_features.push_back(std::move(f));
     }
   }
 
-  if (_data["constraints"] && _data["constraints"].IsSequence())
+  const YAML::Node c_data = _data["constraints"];
+  if (c_data && c_data.IsSequence())
   {
-    const YAML::Node& c_data = _data["constraints"];
+    constraints.reserve(constraints.size() + c_data.size());
     for (YAML::const_iterator it = c_data.begin(); it != c_data.end(); ++it)
     {
       Constraint c;
       c.from_yaml(*it);
-      constraints.push_back(c);
+      constraints.push_back(std::move(c));
     }
   }
 
@@ -131,36 +136,39 @@ bool Level::from_yaml(
   load_yaml_edge_sequence(_data, "doors", Edge::DOOR);
   load_yaml_edge_sequence(_data, "human_lanes", Edge::HUMAN_LANE);
 
-  if (_data["models"] && _data["models"].IsSequence())
+  const YAML::Node ys = _data["models"];
+  if (ys && ys.IsSequence())
   {
-    const YAML::Node& ys = _data["models"];
+    models.reserve(models.size() + ys.size());
     for (YAML::const_iterator it = ys.begin(); it != ys.end(); ++it)
     {
       Model m;
       m.from_yaml(*it, this->name, coordinate_system);
-      models.push_back(m);
+      models.push_back(std::move(m));
     }
   }
 
-  if (_data["floors"] && _data["floors"].IsSequence())
+  const YAML::Node yf = _data["floors"];
+  if (yf && yf.IsSequence())
   {
-    const YAML::Node& yf = _data["floors"];
+    polygons.reserve(polygons.size() + yf.size());
     for (YAML::const_iterator it = yf.begin(); it != yf.end(); ++it)
     {
       Polygon p;
       p.from_yaml(*it, Polygon::FLOOR);
-      polygons.push_back(p);
+      polygons.push_back(std::move(p));
     }
   }
 
-  if (_data["holes"] && _data["holes"].IsSequence())
+  const YAML::Node yh = _data["holes"];
+  if (yh && yh.IsSequence())
   {
-    const YAML::Node& yf = _data["holes"];
-    for (YAML::const_iterator it = yf.begin(); it != yf.end(); ++it)
+    polygons.reserve(polygons.size() + yh.size());
+    for (YAML::const_iterator it = yh.begin(); it != yh.end(); ++it)
     {
       Polygon p;
       p.from_yaml(*it, Polygon::HOLE);
-      polygons.push_back(p);
+      polygons.push_back(std::move(p));
     }
   }
 
@@ -173,8 +181,12 @@ bool Level::from_yaml(
     for (YAML::const_iterator it = yl.begin(); it != yl.end(); ++it)
     {
       Layer layer;
-      layer.from_yaml(it->first.as<string>(), it->second, coordinate_system);
-      layers.push_back(layer);
+      layer.from_yaml(
+        it->first.as<string>(),
+        it->second,
+        coordinate_system,
+        load_layer_images);
+      layers.push_back(std::move(layer));
     }
   }
 
@@ -209,6 +221,69 @@ bool Level::load_drawing()
   return true;
 }
 
+Level Level::snapshot() const
+{
+  Level level(*this);
+  level.floorplan_pixmap = QPixmap();
+  level.restylers.clear();
+  for (auto& layer : level.layers)
+  {
+    layer.pixmap = QPixmap();
+    layer.scene_item = nullptr;
+    layer.geotiff.reset();
+  }
+  return level;
+}
+
+std::size_t Level::drawing_bytes() const
+{
+  if (floorplan_pixmap.isNull())
+    return 0;
+  return static_cast<std::size_t>(floorplan_pixmap.width()) *
+    floorplan_pixmap.height() * floorplan_pixmap.depth() / 8;
+}
+
+std::size_t Level::layer_image_bytes() const
+{
+  std::size_t bytes = 0;
+  for (const auto& layer : layers)
+    bytes += layer.image_bytes();
+  return bytes;
+}
+
+std::size_t Level::evict_drawing()
+{
+  const std::size_t bytes = drawing_bytes();
+  if (bytes == 0)
+    return 0;
+  floorplan_pixmap = QPixmap();
+  drawing_evicted = true;
+  return bytes;
+}
+
+std::size_t Level::evict_layer_images(const std::size_t bytes)
+{
+  vector<Layer*> by_size;
+  for (auto& layer : layers)
+    by_size.push_back(&layer);
+  std::sort(
+    by_size.begin(),
+    by_size.end(),
+    [](const Layer* a, const Layer* b)
+    {
+      return a->image_bytes() > b->image_bytes();
+    });
+
+  std::size_t freed = 0;
+  for (Layer* layer : by_size)
+  {
+    if (freed >= bytes)
+      break;
+    freed += layer->evict_images(bytes - freed);
+  }
+  return freed;
+}
+
 YAML::Node Level::to_yaml(const CoordinateSystem& coordinate_system) const
 {
   YAML::Node y;
@@ -296,42 +371,20 @@ YAML::Node Level::to_yaml(const CoordinateSystem& coordinate_system) const
 bool Level::can_delete_current_selection()
 {
   // if a feature is selected, refuse to delete it if it's in a constraint
-  for (const Feature& feature : floorplan_features)
+  for (const SelectionSet::Item& item : _selection.items())
   {
-    if (!feature.selected())
+    const Feature* feature = selected_feature(item);
+    if (feature == nullptr)
       continue;
     for (const Constraint& constraint : constraints)
     {
-      if (constraint.includes_id(feature.id()))
+      if (constraint.includes_id(feature->id()))
         return false;
     }
   }
 
-  for (const Layer& layer : layers)
-  {
-    for (const Feature& feature : layer.features)
-    {
-      if (!feature.selected())
-        continue;
-
-      for (const Constraint& constraint : constraints)
-      {
-        if (constraint.includes_id(feature.id()))
-          return false;
-      }
-    }
-  }
-
-  int selected_vertex_idx = -1;
-  for (int i = 0; i < static_cast<int>(vertices.size()); i++)
-  {
-    if (vertices[i].selected)
-    {
-      selected_vertex_idx = i;
-      break;  // just grab the index of the first selected vertex
-    }
-  }
-
+  // just grab the index of the first selected vertex
+  const int selected_vertex_idx = first_selected(SelectionSet::VERTEX);
   if (selected_vertex_idx < 0)
     return true;
 
@@ -365,58 +418,59 @@ bool Level::can_delete_current_selection()
   return true;
 }
 
-bool Level::delete_selected()
+const Feature* Level::selected_feature(const SelectionSet::Item& item) const
+{
+  if (item.type != SelectionSet::FEATURE ||
+    item.idx < 0 ||
+    item.idx >= static_cast<int>(num_elements(item.type, item.layer_idx)))
+    return nullptr;
+  if (item.layer_idx == 0)
+    return &floorplan_features[item.idx];
+  return &layers[item.layer_idx - 1].features[item.idx];
+}
+
+// erase the selected elements of one type, visiting the container only if
+// at least one of them is selected
+template<typename T>
+static void erase_selected(
+  std::vector<T>& elements,
+  SelectionSet& selection,
+  const SelectionSet::Type type)
 {
-  edges.erase(
-    std::remove_if(
-      edges.begin(),
-      edges.end(),
-      [](const Edge& edge) { return edge.selected; }),
-    edges.end());
-
-  models.erase(
-    std::remove_if(
-      models.begin(),
-      models.end(),
-      [](const auto& model) { return model.selected; }),
-    models.end());
-
-  fiducials.erase(
-    std::remove_if(
-      fiducials.begin(),
-      fiducials.end(),
-      [](const Fiducial& fiducial) { return fiducial.selected; }),
-    fiducials.end());
-
-  polygons.erase(
-    std::remove_if(
-      polygons.begin(),
-      polygons.end(),
-      [](const Polygon& polygon) { return polygon.selected; }),
-    polygons.end());
-
-  constraints.erase(
-    std::remove_if(
-      constraints.begin(),
-      constraints.end(),
-      [](const Constraint& constraint) { return constraint.selected(); }),
-    constraints.end());
+  const vector<int> indices = selection.indices(type);
+  if (indices.empty())
+    return;
 
-  // Vertices take a lot more care, because we have to check if a vertex
-  // is used in an edge or a polygon before deleting it, and update all
-  // higher-index vertex indices in the edges and polygon vertex lists.
-  // Since this is a potentially expensive operation, first we'll spin
-  // through the vertex list and see if any vertices are selected, and
-  // only then make a copy of the vertex list.
-  int selected_vertex_idx = -1;
-  for (int i = 0; i < static_cast<int>(vertices.size()); i++)
+  std::size_t next = 0;
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < elements.size(); i++)
   {
-    if (vertices[i].selected)
+    if (next < indices.size() && indices[next] == static_cast<int>(i))
     {
-      selected_vertex_idx = i;
-      break;  // just grab the index of the first selected vertex
+      next++;
+      continue;
     }
+    if (kept != i)
+      elements[kept] = std::move(elements[i]);
+    kept++;
   }
+  elements.resize(kept);
+  selection.erase_type(type);
+}
+
+bool Level::delete_selected()
+{
+  erase_selected(edges, _selection, SelectionSet::EDGE);
+  erase_selected(models, _selection, SelectionSet::MODEL);
+  erase_selected(fiducials, _selection, SelectionSet::FIDUCIAL);
+  erase_selected(polygons, _selection, SelectionSet::POLYGON);
+  erase_selected(constraints, _selection, SelectionSet::CONSTRAINT);
+
+  // Vertices take a lot more care, because we have to check if a vertex
+  // is used in an edge or a polygon before deleting it, and update all
+  // higher-index vertex indices in the edges and polygon vertex lists,
+  // so only the first selected vertex is considered.
+  const int selected_vertex_idx = first_selected(SelectionSet::VERTEX);
   if (selected_vertex_idx >= 0)
   {
     // See if this vertex is used in any edges/polygons.
@@ -440,6 +494,7 @@ bool Level::delete_selected()
 
     // the vertex is not currently being used, so let's erase it
     vertices.erase(vertices.begin() + selected_vertex_idx);
+    _selection.erase_index(SelectionSet::VERTEX, selected_vertex_idx);
 
     // now go through all edges and polygons to decrement any larger indices
     for (Edge& edge : edges)
@@ -460,130 +515,67 @@ bool Level::delete_selected()
     }
   }
 
-  // if a feature is selected, refuse to delete it if it's in a constraint
-  for (std::size_t i = 0; i < floorplan_features.size(); i++)
+  // Only the first selected feature (floorplan first, then the layers in
+  // order) is deleted. Refuse to delete it if it's in a constraint.
+  for (int layer_idx = 0; layer_idx <= static_cast<int>(layers.size());
+    layer_idx++)
   {
-    if (!floorplan_features[i].selected())
+    const int feature_idx = first_selected(SelectionSet::FEATURE, layer_idx);
+    if (feature_idx < 0)
       continue;
+    std::vector<Feature>& features = layer_idx == 0 ?
+      floorplan_features : layers[layer_idx - 1].features;
 
     for (std::size_t j = 0; j < constraints.size(); j++)
     {
-      if (constraints[j].includes_id(floorplan_features[i].id()))
+      if (constraints[j].includes_id(features[feature_idx].id()))
         return false;
     }
 
-    floorplan_features.erase(floorplan_features.begin() + i);
+    features.erase(features.begin() + feature_idx);
+    _selection.erase_index(SelectionSet::FEATURE, feature_idx, layer_idx);
     return true;
   }
 
-  for (std::size_t layer_idx = 0; layer_idx < layers.size(); layer_idx++)
-  {
-    Layer& layer = layers[layer_idx];
-    for (std::size_t i = 0; i < layer.features.size(); i++)
-    {
-      if (!layer.features[i].selected())
-        continue;
-
-      for (std::size_t j = 0; j < constraints.size(); j++)
-      {
-        if (constraints[j].includes_id(layer.features[i].id()))
-          return false;
-      }
-
-      layer.features.erase(layer.features.begin() + i);
-      return true;
-    }
-  }
-
   return true;
 }
 
 void Level::get_selected_items(
   std::vector<Level::SelectedItem>& items)
 {
-  for (std::size_t i = 0; i < edges.size(); i++)
-  {
-    if (edges[i].selected)
-    {
-      Level::SelectedItem item;
-      item.edge_idx = i;
-      items.push_back(item);
-    }
-  }
-
-  for (std::size_t i = 0; i < models.size(); i++)
-  {
-    if (models[i].selected)
-    {
-      Level::SelectedItem item;
-      item.model_idx = i;
-      items.push_back(item);
-    }
-  }
-
-  for (std::size_t i = 0; i < vertices.size(); i++)
-  {
-    if (vertices[i].selected)
-    {
-      Level::SelectedItem item;
-      item.vertex_idx = i;
-      items.push_back(item);
-    }
-  }
-
-  for (std::size_t i = 0; i < fiducials.size(); i++)
-  {
-    if (fiducials[i].selected)
-    {
-      Level::SelectedItem item;
-      item.fiducial_idx = i;
-      items.push_back(item);
-    }
-  }
-
-  for (std::size_t i = 0; i < polygons.size(); i++)
-  {
-    if (polygons[i].selected)
-    {
-      Level::SelectedItem item;
-      item.polygon_idx = i;
-      items.push_back(item);
-    }
-  }
-
-  for (std::size_t i = 0; i < floorplan_features.size(); i++)
-  {
-    if (floorplan_features[i].selected())
-    {
-      Level::SelectedItem item;
-      item.feature_idx = i;
-      item.feature_layer_idx = 0;
-      items.push_back(item);
-    }
-  }
-
-  for (std::size_t layer_idx = 0; layer_idx < layers.size(); layer_idx++)
-  {
-    for (std::size_t i = 0; i < layers[layer_idx].features.size(); i++)
-    {
-      if (layers[layer_idx].features[i].selected())
-      {
-        Level::SelectedItem item;
-        item.feature_idx = i;
-        item.feature_layer_idx = layer_idx + 1;
-        items.push_back(item);
-      }
-    }
-  }
+  // report them grouped by type and in index order, like a scan over the
+  // element containers would, but only visit the selected ones
+  vector<SelectionSet::Item> selected = _selection.items();
+  std::sort(
+    selected.begin(),
+    selected.end(),
+    [](const SelectionSet::Item& a, const SelectionSet::Item& b)
+    {
+      if (a.type != b.type)
+        return a.type < b.type;
+      if (a.layer_idx != b.layer_idx)
+        return a.layer_idx < b.layer_idx;
+      return a.idx < b.idx;
+    });
 
-  for (std::size_t i = 0; i < constraints.size(); i++)
+  for (const SelectionSet::Item& s : selected)
   {
-    if (constraints[i].selected())
+    Level::SelectedItem item;
+    switch (s.type)
     {
-      Level::SelectedItem item;
-      item.constraint_idx = i;
-      items.push_back(item);
+      case SelectionSet::EDGE: item.edge_idx = s.idx; break;
+      case SelectionSet::MODEL: item.model_idx = s.idx; break;
+      case SelectionSet::VERTEX: item.vertex_idx = s.idx; break;
+      case SelectionSet::FIDUCIAL: item.fiducial_idx = s.idx; break;
+      case SelectionSet::POLYGON: item.polygon_idx = s.idx; break;
+      case SelectionSet::FEATURE:
+        item.feature_idx = s.idx;
+        item.feature_layer_idx = s.layer_idx;
+        break;
+      case SelectionSet::CONSTRAINT: item.constraint_idx = s.idx; break;
+      default: continue;
     }
+    items.push_back(item);
   }
 }
 
@@ -593,7 +585,7 @@ void Level::calculate_scale(const CoordinateSystem& coordinate_system)
   double scale_sum = 0.0;
   int scale_count = 0;
 
-  for (auto& edge : edges)
+  for (const auto& edge : edges)
   {
     if (edge.type == Edge::MEAS)
     {
@@ -601,10 +593,7 @@ void Level::calculate_scale(const CoordinateSystem& coordinate_system)
       const double dx = vertices[edge.start_idx].x - vertices[edge.end_idx].x;
       const double dy = vertices[edge.start_idx].y - vertices[edge.end_idx].y;
       const double distance_pixels = std::sqrt(dx*dx + dy*dy);
-      // todo: a clean, strongly-typed parameter API for edges
-      const double distance_meters =
-        edge.params[std::string("distance")].value_double;
-      scale_sum += distance_meters / distance_pixels;
+      scale_sum += edge.get_distance() / distance_pixels;
     }
   }
 
@@ -624,18 +613,134 @@ void Level::calculate_scale(const CoordinateSystem& coordinate_system)
   }
 }
 
+Triangulation::Ring Level::polygon_ring(const Polygon& polygon) const
+{
+  const int num_vertices = static_cast<int>(vertices.size());
+  Triangulation::Ring ring;
+  ring.reserve(polygon.vertices.size());
+  for (const int v_idx : polygon.vertices)
+  {
+    if (v_idx >= 0 && v_idx < num_vertices)
+      ring.push_back(
+        Triangulation::Point(vertices[v_idx].x, vertices[v_idx].y));
+  }
+  return ring;
+}
+
+vector<Level::HoleRing> Level::hole_rings() const
+{
+  vector<HoleRing> rings;
+  for (const auto& polygon : polygons)
+  {
+    if (polygon.type != Polygon::HOLE)
+      continue;
+    HoleRing hole;
+    hole.ring = polygon_ring(polygon);
+    hole.min_x = hole.min_y = 1e100;
+    hole.max_x = hole.max_y = -1e100;
+    for (const auto& p : hole.ring)
+    {
+      hole.min_x = std::min(hole.min_x, p.x);
+      hole.min_y = std::min(hole.min_y, p.y);
+      hole.max_x = std::max(hole.max_x, p.x);
+      hole.max_y = std::max(hole.max_y, p.y);
+    }
+    rings.push_back(std::move(hole));
+  }
+  return rings;
+}
+
+const Triangulation& Level::polygon_triangulation(
+  const int polygon_idx,
+  const vector<Triangulation::Ring>& extra_holes) const
+{
+  // only floors have holes cut out of them
+  if (polygons[polygon_idx].type != Polygon::FLOOR)
+    return polygon_triangulation(polygon_idx, vector<HoleRing>(), extra_holes);
+  return polygon_triangulation(polygon_idx, hole_rings(), extra_holes);
+}
+
+const Triangulation& Level::polygon_triangulation(
+  const int polygon_idx,
+  const vector<HoleRing>& hole_rings,
+  const vector<Triangulation::Ring>& extra_holes) const
+{
+  const Polygon& polygon = polygons[polygon_idx];
+  const Triangulation::Ring outer = polygon_ring(polygon);
+
+  double min_x = 1e100, min_y = 1e100, max_x = -1e100, max_y = -1e100;
+  for (const auto& p : outer)
+  {
+    min_x = std::min(min_x, p.x);
+    min_y = std::min(min_y, p.y);
+    max_x = std::max(max_x, p.x);
+    max_y = std::max(max_y, p.y);
+  }
+
+  // only bother with holes whose bounding box overlaps this floor
+  vector<const Triangulation::Ring*> holes;
+  if (polygon.type == Polygon::FLOOR)
+  {
+    for (const HoleRing& hole : hole_rings)
+    {
+      if (hole.max_x >= min_x && hole.min_x <= max_x &&
+        hole.max_y >= min_y && hole.min_y <= max_y)
+        holes.push_back(&hole.ring);
+    }
+  }
+  for (const auto& hole : extra_holes)
+    holes.push_back(&hole);
+
+  // the cache key is simply every input coordinate, in order. Comparing
+  // it is linear, whereas re-triangulating is quadratic (or worse).
+  vector<double> inputs;
+  inputs.reserve(2 * outer.size() + 1);
+  auto append_ring = [&inputs](const Triangulation::Ring& ring)
+    {
+      inputs.push_back(static_cast<double>(ring.size()));
+      for (const auto& p : ring)
+      {
+        inputs.push_back(p.x);
+        inputs.push_back(p.y);
+      }
+    };
+  append_ring(outer);
+  for (const auto* hole : holes)
+    append_ring(*hole);
+
+  if (inputs != polygon.triangulation_inputs)
+  {
+    vector<Triangulation::Ring> hole_copies;
+    hole_copies.reserve(holes.size());
+    for (const auto* hole : holes)
+      hole_copies.push_back(*hole);
+    polygon.triangulation.triangulate(outer, hole_copies);
+    polygon.triangulation_inputs.swap(inputs);
+  }
+  return polygon.triangulation;
+}
+
+double Level::polygon_area(const int polygon_idx) const
+{
+  if (polygon_idx < 0 || polygon_idx >= static_cast<int>(polygons.size()))
+    return 0.0;
+  return polygon_triangulation(polygon_idx).area() *
+    drawing_meters_per_pixel * drawing_meters_per_pixel;
+}
+
 // todo: migrate this to the TrafficMap class eventually
-void Level::draw_lane(
+SelectionSet::Restyler Level::draw_lane(
   QGraphicsScene* scene,
   const Edge& edge,
   const RenderingOptions& opts,
-  const vector<Graph>& graphs) const
+  const vector<double>& graph_lane_widths,
+  const bool selected) const
 {
   const int graph_idx = edge.get_graph_idx();
   if (graph_idx >= 0 &&
     graph_idx < static_cast<int>(opts.show_building_lanes.size()) &&
     !opts.show_building_lanes[graph_idx])
-    return;// don't render this lane
+    return nullptr;// don't render this lane
 
   const auto& v_start = vertices[edge.start_idx];
   const auto& v_end = vertices[edge.end_idx];
@@ -645,14 +750,9 @@ void Level::draw_lane(
 
   // see if there is a default width for this graph_idx
   double graph_default_width = -1.0;
-  for (const auto& graph : graphs)
-  {
-    if (graph.idx == graph_idx)
-    {
-      graph_default_width = graph.default_lane_width;
-      break;
-    }
-  }
+  if (graph_idx >= 0 &&
+    graph_idx < static_cast<int>(graph_lane_widths.size()))
+    graph_default_width = graph_lane_widths[graph_idx];
 
   double lane_width_meters = 1.0;
   if (edge.get_width() > 0)
@@ -710,22 +810,33 @@ void Level::draw_lane(
     default: break;  // will render as dark grey
   }
 
-  // always draw lane as red if it's selected
-  if (edge.selected)
-    color.setRgbF(0.5, 0.0, 0.0);
-
   // always draw lanes somewhat transparent
   color.setAlphaF(0.5);
 
+  // always draw lane as red if it's selected
+  const QColor selected_color = QColor::fromRgbF(0.5, 0.0, 0.0, 0.5);
+
+  const QPen lane_pen(
+    QBrush(selected ? selected_color : color),
+    lane_pen_width,
+    Qt::SolidLine,
+    Qt::RoundCap);
   QGraphicsLineItem* lane_item = scene->addLine(
     v_start.x, v_start.y,
     v_end.x, v_end.y,
-    QPen(QBrush(color), lane_pen_width, Qt::SolidLine, Qt::RoundCap));
+    lane_pen);
   lane_item->setZValue(edge.get_graph_idx() + 1.0);
 
+  SelectionSet::Restyler restyler = [=](const bool selected_now)
+    {
+      QPen pen(lane_pen);
+      pen.setColor(selected_now ? selected_color : color);
+      lane_item->setPen(pen);
+    };
+
   // draw the orientation icon, if specified
-  auto orientation_it = edge.params.find("orientation");
-  if (orientation_it != edge.params.end())
+  const Edge::Orientation orientation = edge.get_orientation();
+  if (orientation != Edge::ORIENTATION_ANY)
   {
     // draw robot-outline box midway down this lane
     const double mx = (v_start.x + v_end.x) / 2.0;
@@ -771,7 +882,7 @@ void Level::draw_lane(
     pp.moveTo(QPointF(mx, my));
 
     QPen orientation_pen(Qt::white, 5.0);
-    if (orientation_it->second.value_string == "forward")
+    if (orientation == Edge::ORIENTATION_FORWARD)
     {
       const double hix = mx + 1.0 * cos(yaw) / drawing_meters_per_pixel;
       const double hiy = my + 1.0 * sin(yaw) / drawing_meters_per_pixel;
@@ -779,7 +890,7 @@ void Level::draw_lane(
       QGraphicsPathItem* pi = scene->addPath(pp, orientation_pen);
       pi->setZValue(edge.get_graph_idx() + 1.1);
     }
-    else if (orientation_it->second.value_string == "backward")
+    else
     {
       const double hix = mx - 1.0 * cos(yaw) / drawing_meters_per_pixel;
       const double hiy = my - 1.0 * sin(yaw) / drawing_meters_per_pixel;
@@ -788,45 +899,74 @@ void Level::draw_lane(
       pi->setZValue(edge.get_graph_idx() + 1.1);
     }
   }
+  return restyler;
 }
 
-void Level::draw_wall(QGraphicsScene* scene, const Edge& edge) const
+SelectionSet::Restyler Level::draw_wall(
+  QGraphicsScene* scene,
+  const Edge& edge,
+  const bool selected) const
 {
   const auto& v_start = vertices[edge.start_idx];
   const auto& v_end = vertices[edge.end_idx];
 
-  const double r = edge.selected ? 0.5 : 0.0;
-  const double b = edge.selected ? 0.0 : 0.5;
+  const QColor color = QColor::fromRgbF(0.0, 0.0, 0.5, 0.5);
+  const QColor selected_color = QColor::fromRgbF(0.5, 0.0, 0.0, 0.5);
 
-  scene->addLine(
+  const QPen pen(
+    QBrush(selected ? selected_color : color),
+    0.2 / drawing_meters_per_pixel,
+    Qt::SolidLine, Qt::RoundCap);
+  QGraphicsLineItem* item = scene->addLine(
     v_start.x, v_start.y,
     v_end.x, v_end.y,
-    QPen(
-      QBrush(QColor::fromRgbF(r, 0.0, b, 0.5)),
-      0.2 / drawing_meters_per_pixel,
-      Qt::SolidLine, Qt::RoundCap));
+    pen);
+
+  return [=](const bool selected_now)
+    {
+      QPen restyled_pen(pen);
+      restyled_pen.setColor(selected_now ? selected_color : color);
+      item->setPen(restyled_pen);
+    };
 }
 
-void Level::draw_meas(QGraphicsScene* scene, const Edge& edge) const
+SelectionSet::Restyler Level::draw_meas(
+  QGraphicsScene* scene,
+  const Edge& edge,
+  const bool selected) const
 {
   const auto& v_start = vertices[edge.start_idx];
   const auto& v_end = vertices[edge.end_idx];
-  const double b = edge.selected ? 0.0 : 0.5;
 
-  scene->addLine(
+  const QColor color = QColor::fromRgbF(0.5, 0.0, 0.5, 0.5);
+  const QColor selected_color = QColor::fromRgbF(0.5, 0.0, 0.0, 0.5);
+
+  const QPen pen(
+    QBrush(selected ? selected_color : color),
+    0.5 / drawing_meters_per_pixel,
+    Qt::SolidLine, Qt::RoundCap);
+  QGraphicsLineItem* item = scene->addLine(
     v_start.x, v_start.y,
     v_end.x, v_end.y,
-    QPen(
-      QBrush(QColor::fromRgbF(0.5, 0, b, 0.5)),
-      0.5 / drawing_meters_per_pixel,
-      Qt::SolidLine, Qt::RoundCap));
+    pen);
+
+  return [=](const bool selected_now)
+    {
+      QPen restyled_pen(pen);
+      restyled_pen.setColor(selected_now ? selected_color : color);
+      item->setPen(restyled_pen);
+    };
 }
 
-void Level::draw_door(QGraphicsScene* scene, const Edge& edge) const
+SelectionSet::Restyler Level::draw_door(
+  QGraphicsScene* scene,
+  const Edge& edge,
+  const bool selected) const
 {
   const auto& v_start = vertices[edge.start_idx];
   const auto& v_end = vertices[edge.end_idx];
-  const double g = edge.selected ? 1.0 : 0.0;
+  const QColor color = QColor::fromRgbF(1.0, 0.0, 0.0, 0.5);
+  const QColor selected_color = QColor::fromRgbF(1.0, 1.0, 0.0, 0.5);
   const double door_thickness = 0.2;  // meters
   const double door_motion_thickness = 0.05;  // meters
 
@@ -934,13 +1074,21 @@ void Level::draw_door(QGraphicsScene* scene, const Edge& edge) const
     QPen(Qt::black, door_motion_thickness / drawing_meters_per_pixel));
 
   // add the doorjamb last, so it sits on top of the Z stack of the travel arc
-  scene->addLine(
+  const QPen pen(
+    QBrush(selected ? selected_color : color),
+    door_thickness / drawing_meters_per_pixel,
+    Qt::SolidLine, Qt::RoundCap);
+  QGraphicsLineItem* item = scene->addLine(
     v_start.x, v_start.y,
     v_end.x, v_end.y,
-    QPen(
-      QBrush(QColor::fromRgbF(1.0, g, 0.0, 0.5)),
-      door_thickness / drawing_meters_per_pixel,
-      Qt::SolidLine, Qt::RoundCap));
+    pen);
+
+  return [=](const bool selected_now)
+    {
+      QPen restyled_pen(pen);
+      restyled_pen.setColor(selected_now ? selected_color : color);
+      item->setPen(restyled_pen);
+    };
 }
 
 void Level::add_door_slide_path(
@@ -1013,12 +1161,15 @@ void Level::add_door_swing_path(
   path.lineTo(hinge_x, hinge_y);
 }
 
-void Level::draw_polygon(
+SelectionSet::Restyler Level::draw_polygon(
   QGraphicsScene* scene,
   const QBrush& brush,
-  const Polygon& polygon) const
+  const int polygon_idx,
+  const vector<HoleRing>& hole_rings) const
 {
-  QBrush selected_brush(QColor::fromRgbF(1.0, 0.0, 0.0, 0.5));
+  const Polygon& polygon = polygons[polygon_idx];
+  const QBrush selected_brush(QColor::fromRgbF(1.0, 0.0, 0.0, 0.5));
+  const bool selected = is_selected(SelectionSet::POLYGON, polygon_idx);
 
   QVector<QPointF> polygon_vertices;
   for (const auto& vertex_idx: polygon.vertices)
@@ -1030,29 +1181,73 @@ void Level::draw_polygon(
   QPen pen(Qt::black);
   pen.setWidthF(0.05 / drawing_meters_per_pixel);
 
-  scene->addPolygon(
-    QPolygonF(polygon_vertices),
-    pen,
-    polygon.selected ? selected_brush : brush);
+  const Triangulation* triangulation = nullptr;
+  if (polygon.type == Polygon::FLOOR)
+    triangulation = &polygon_triangulation(polygon_idx, hole_rings);
+
+  if (!triangulation || triangulation->empty())
+  {
+    QGraphicsPolygonItem* item = scene->addPolygon(
+      QPolygonF(polygon_vertices),
+      pen,
+      selected ? selected_brush : brush);
+    return [=](const bool selected_now)
+      {
+        item->setBrush(selected_now ? selected_brush : brush);
+      };
+  }
+
+  // fill the floor using its (cached) triangulation, so that the holes
+  // cut out of it are actually empty, then outline the original polygon
+  QPainterPath fill_path;
+  fill_path.setFillRule(Qt::WindingFill);
+  const vector<int>& triangles = triangulation->triangles;
+  for (std::size_t i = 0; i + 2 < triangles.size(); i += 3)
+  {
+    const Triangulation::Point& a = triangulation->points[triangles[i]];
+    const Triangulation::Point& b = triangulation->points[triangles[i + 1]];
+    const Triangulation::Point& c = triangulation->points[triangles[i + 2]];
+    fill_path.moveTo(a.x, a.y);
+    fill_path.lineTo(b.x, b.y);
+    fill_path.lineTo(c.x, c.y);
+    fill_path.closeSubpath();
+  }
+
+  QGraphicsPathItem* item = scene->addPath(
+    fill_path,
+    QPen(Qt::NoPen),
+    selected ? selected_brush : brush);
+  scene->addPolygon(QPolygonF(polygon_vertices), pen, QBrush(Qt::NoBrush));
+  return [=](const bool selected_now)
+    {
+      item->setBrush(selected_now ? selected_brush : brush);
+    };
 }
 
-void Level::draw_polygons(QGraphicsScene* scene) const
+void Level::draw_polygons(QGraphicsScene* scene)
 {
   const QBrush floor_brush(QColor::fromRgbF(0.9, 0.9, 0.9, 0.8));
   const QBrush hole_brush(QColor::fromRgbF(0.3, 0.3, 0.3, 0.5));
 
+  // gathered once for all the floors, rather than once for each of them
+  const vector<HoleRing> holes = hole_rings();
+
   // first draw the floor polygons
-  for (const auto& polygon : polygons)
+  for (std::size_t i = 0; i < polygons.size(); i++)
   {
-    if (polygon.type == Polygon::FLOOR)
-      draw_polygon(scene, floor_brush, polygon);
+    if (polygons[i].type == Polygon::FLOOR)
+      add_restyler(
+        SelectionSet::Item(SelectionSet::POLYGON, static_cast<int>(i)),
+        draw_polygon(scene, floor_brush, static_cast<int>(i), holes));
   }
 
   // now draw the holes
-  for (const auto& polygon : polygons)
+  for (std::size_t i = 0; i < polygons.size(); i++)
   {
-    if (polygon.type == Polygon::HOLE)
-      draw_polygon(scene, hole_brush, polygon);
+    if (polygons[i].type == Polygon::HOLE)
+      add_restyler(
+        SelectionSet::Item(SelectionSet::POLYGON, static_cast<int>(i)),
+        draw_polygon(scene, hole_brush, static_cast<int>(i), holes));
   }
 
 #if 0
@@ -1073,31 +1268,82 @@ void Level::draw_polygons(QGraphicsScene* scene) const
 #endif
 }
 
-void Level::clear_selection()
+void Level::select(const SelectionSet::Item& item)
 {
-  for (auto& vertex : vertices)
-    vertex.selected = false;
+  if (_selection.insert(item))
+    restyle(item);
+}
 
-  for (auto& edge : edges)
-    edge.selected = false;
+void Level::deselect(const SelectionSet::Item& item)
+{
+  if (_selection.erase(item))
+    restyle(item);
+}
 
-  for (auto& model : models)
-    model.selected = false;
+void Level::clear_selection()
+{
+  const vector<SelectionSet::Item> items = _selection.items();
+  _selection.clear();
+  for (const SelectionSet::Item& item : items)
+    restyle(item);
+}
 
-  for (auto& polygon : polygons)
-    polygon.selected = false;
+void Level::restyle(const SelectionSet::Item& item)
+{
+  auto it = restylers.find(item);
+  if (it != restylers.end())
+    it->second(_selection.contains(item));
+}
 
-  for (auto& fiducial : fiducials)
-    fiducial.selected = false;
+void Level::add_restyler(
+  const SelectionSet::Item& item,
+  SelectionSet::Restyler restyler)
+{
+  if (restyler)
+    restylers[item] = std::move(restyler);
+}
 
-  for (auto& feature : floorplan_features)
-    feature.setSelected(false);
+int Level::first_selected(
+  const SelectionSet::Type type,
+  const int layer_idx) const
+{
+  const int idx = _selection.first(type, layer_idx);
+  if (idx < 0 || idx >= static_cast<int>(num_elements(type, layer_idx)))
+    return -1;
+  return idx;
+}
 
-  for (auto& layer : layers)
-    layer.clear_selection();
+std::size_t Level::num_elements(
+  const SelectionSet::Type type,
+  const int layer_idx) const
+{
+  switch (type)
+  {
+    case SelectionSet::EDGE: return edges.size();
+    case SelectionSet::MODEL: return models.size();
+    case SelectionSet::VERTEX: return vertices.size();
+    case SelectionSet::FIDUCIAL: return fiducials.size();
+    case SelectionSet::POLYGON: return polygons.size();
+    case SelectionSet::CONSTRAINT: return constraints.size();
+    case SelectionSet::FEATURE:
+      if (layer_idx == 0)
+        return floorplan_features.size();
+      if (layer_idx < 0 || layer_idx > static_cast<int>(layers.size()))
+        return 0;
+      return layers[layer_idx - 1].features.size();
+    default:
+      return 0;
+  }
+}
 
-  for (auto& constraint : constraints)
-    constraint.setSelected(false);
+void Level::prune_selection()
+{
+  _selection.erase_if(
+    [this](const SelectionSet::Item& item)
+    {
+      return item.idx < 0 ||
+      item.idx >= static_cast<int>(num_elements(item.type, item.layer_idx));
+    });
 }
 
 void Level::draw(
@@ -1110,6 +1356,17 @@ void Level::draw(
   printf("Level::draw()\n");
   vertex_radius = 0.1;
 
+  restylers.clear();
+  prune_selection();
+
+  static std::size_t draw_count = 0;
+  last_drawn = ++draw_count;
+  if (drawing_evicted)
+  {
+    drawing_evicted = false;
+    load_drawing();
+  }
+
   if (!coordinate_system.is_global())
   {
     // If we're using an image-defined coordinate system, we should
@@ -1138,39 +1395,99 @@ void Level::draw(
 
   draw_polygons(scene);
 
-  for (auto& layer : layers)
+  vector<QPointF> feature_positions;
+  for (std::size_t i = 0; i < layers.size(); i++)
+  {
+    Layer& layer = layers[i];
     layer.draw(scene, drawing_meters_per_pixel, coordinate_system);
+    if (!layer.visible)
+      continue;
+
+    const int layer_number = static_cast<int>(i) + 1;
+    layer.feature_positions(drawing_meters_per_pixel, feature_positions);
+    for (std::size_t j = 0; j < layer.features.size(); j++)
+    {
+      const int feature_idx = static_cast<int>(j);
+      add_restyler(
+        SelectionSet::Item(SelectionSet::FEATURE, feature_idx, layer_number),
+        layer.features[j].draw(
+          scene,
+          layer.color,
+          feature_positions[j],
+          drawing_meters_per_pixel,
+          is_selected(SelectionSet::FEATURE, feature_idx, layer_number)));
+    }
+  }
 
   if (rendering_options.show_models)
   {
-    for (Model& model : models)
-      model.draw(scene, editor_models, drawing_meters_per_pixel);
+    for (std::size_t i = 0; i < models.size(); i++)
+    {
+      const int model_idx = static_cast<int>(i);
+      add_restyler(
+        SelectionSet::Item(SelectionSet::MODEL, model_idx),
+        models[i].draw(
+          scene,
+          editor_models,
+          drawing_meters_per_pixel,
+          is_selected(SelectionSet::MODEL, model_idx)));
+    }
   }
 
-  for (const auto& edge : edges)
+  // default lane width of each graph, indexed by graph_idx, so that
+  // drawing a lane doesn't have to search the graphs. Walk backwards so
+  // that the first of any duplicated graph indices wins.
+  vector<double> graph_lane_widths;
+  for (auto it = graphs.rbegin(); it != graphs.rend(); ++it)
+  {
+    if (it->idx < 0)
+      continue;
+    if (it->idx >= static_cast<int>(graph_lane_widths.size()))
+      graph_lane_widths.resize(it->idx + 1, -1.0);
+    graph_lane_widths[it->idx] = it->default_lane_width;
+  }
+
+  for (std::size_t i = 0; i < edges.size(); i++)
   {
+    const Edge& edge = edges[i];
+    const int edge_idx = static_cast<int>(i);
+    const bool selected = is_selected(SelectionSet::EDGE, edge_idx);
+    SelectionSet::Restyler restyler;
     switch (edge.type)
     {
       case Edge::LANE:
-        draw_lane(scene, edge, rendering_options, graphs);
+        restyler = draw_lane(
+          scene,
+          edge,
+          rendering_options,
+          graph_lane_widths,
+          selected);
         break;
       case Edge::WALL:
-        draw_wall(scene, edge);
+        restyler = draw_wall(scene, edge, selected);
         break;
       case Edge::MEAS:
-        draw_meas(scene, edge);
+        restyler = draw_meas(scene, edge, selected);
         break;
       case Edge::DOOR:
-        draw_door(scene, edge);
+        restyler = draw_door(scene, edge, selected);
         break;
       case Edge::HUMAN_LANE:
-        draw_lane(scene, edge, rendering_options, graphs);
+        restyler = draw_lane(
+          scene,
+          edge,
+          rendering_options,
+          graph_lane_widths,
+          selected);
         break;
       default:
         printf("tried to draw unknown edge type: %d\n",
           static_cast<int>(edge.type));
         break;
     }
+    add_restyler(
+      SelectionSet::Item(SelectionSet::EDGE, edge_idx),
+      std::move(restyler));
   }
 
   QFont vertex_name_font("Helvetica");
@@ -1180,33 +1497,54 @@ void Level::draw(
     vertex_name_font_size = 1.0;
   vertex_name_font.setPointSizeF(vertex_name_font_size);
 
-  for (const auto& v : vertices)
-    v.draw(
-      scene,
-      vertex_radius / drawing_meters_per_pixel,
-      vertex_name_font,
-      coordinate_system);
+  for (std::size_t i = 0; i < vertices.size(); i++)
+  {
+    const int vertex_idx = static_cast<int>(i);
+    add_restyler(
+      SelectionSet::Item(SelectionSet::VERTEX, vertex_idx),
+      vertices[i].draw(
+        scene,
+        vertex_radius / drawing_meters_per_pixel,
+        vertex_name_font,
+        coordinate_system,
+        is_selected(SelectionSet::VERTEX, vertex_idx)));
+  }
 
-  for (const auto& f : fiducials)
-    f.draw(scene, drawing_meters_per_pixel);
+  for (std::size_t i = 0; i < fiducials.size(); i++)
+  {
+    const int fiducial_idx = static_cast<int>(i);
+    add_restyler(
+      SelectionSet::Item(SelectionSet::FIDUCIAL, fiducial_idx),
+      fiducials[i].draw(
+        scene,
+        drawing_meters_per_pixel,
+        is_selected(SelectionSet::FIDUCIAL, fiducial_idx)));
+  }
 
   Transform level_scale;
   level_scale.setScale(drawing_meters_per_pixel);
-  for (auto& feature : floorplan_features)
+  for (std::size_t i = 0; i < floorplan_features.size(); i++)
   {
-    feature.draw(
-      scene,
-      QColor::fromRgbF(0, 0, 0, 0.5),
-      level_scale,
-      drawing_meters_per_pixel);
+    const int feature_idx = static_cast<int>(i);
+    add_restyler(
+      SelectionSet::Item(SelectionSet::FEATURE, feature_idx),
+      floorplan_features[i].draw(
+        scene,
+        QColor::fromRgbF(0, 0, 0, 0.5),
+        level_scale,
+        drawing_meters_per_pixel,
+        is_selected(SelectionSet::FEATURE, feature_idx)));
   }
 
   for (std::size_t i = 0; i < constraints.size(); i++)
-    draw_constraint(scene, constraints[i], i);
+    add_restyler(
+      SelectionSet::Item(SelectionSet::CONSTRAINT, static_cast<int>(i)),
+      draw_constraint(scene, constraints[i], i));
 }
 
 void Level::clear_scene()
 {
+  restylers.clear();  // the graphics items are gone
   for (auto& model : models)
     model.clear_scene();
 }
@@ -1377,15 +1715,16 @@ void Level::load_yaml_edge_sequence(
   const char* sequence_name,
   const Edge::Type type)
 {
-  if (!data[sequence_name] || !data[sequence_name].IsSequence())
+  const YAML::Node yl = data[sequence_name];
+  if (!yl || !yl.IsSequence())
     return;
 
-  const YAML::Node& yl = data[sequence_name];
+  edges.reserve(edges.size() + yl.size());
   for (YAML::const_iterator it = yl.begin(); it != yl.end(); ++it)
   {
     Edge e;
     e.from_yaml(*it, type);
-    edges.push_back(e);
+    edges.push_back(std::move(e));
   }
 }
 
@@ -1644,7 +1983,7 @@ bool Level::get_feature_point(const QUuid& id, QPointF& point) const
   return false;
 }
 
-void Level::draw_constraint(
+SelectionSet::Restyler Level::draw_constraint(
   QGraphicsScene* scene,
   const Constraint& constraint,
   int constraint_idx) const
@@ -1654,7 +1993,7 @@ void Level::draw_constraint(
   {
     printf("WOAH! tried to draw a constraint with only %d ID's!\n",
       static_cast<int>(feature_ids.size()));
-    return;
+    return nullptr;
   }
 
   const QColor color = QColor::fromRgbF(0.7, 0.7, 0.2, 1.0);
@@ -1662,7 +2001,9 @@ void Level::draw_constraint(
 
   const double pen_width = 0.1 / drawing_meters_per_pixel;
   QPen pen(
-    QBrush(constraint.selected() ? selected_color : color),
+    QBrush(
+      is_selected(SelectionSet::CONSTRAINT, constraint_idx) ?
+      selected_color : color),
     pen_width,
     Qt::SolidLine,
     Qt::RoundCap);
@@ -1672,14 +2013,14 @@ void Level::draw_constraint(
   {
     printf("woah! couldn't find constraint feature ID %s\n",
       feature_ids[0].toString().toStdString().c_str());
-    return;
+    return nullptr;
   }
 
   if (!get_feature_point(feature_ids[1], p2))
   {
     printf("woah! couldn't find constraint feature ID %s\n",
       feature_ids[1].toString().toStdString().c_str());
-    return;
+    return nullptr;
   }
 
   QGraphicsLineItem* line = scene->addLine(
@@ -1691,6 +2032,13 @@ void Level::draw_constraint(
   line->setZValue(199.0);
   line->setData(0, "constraint");
   line->setData(1, constraint_idx);
+
+  return [=](const bool selected_now)
+    {
+      QPen restyled_pen(pen);
+      restyled_pen.setBrush(QBrush(selected_now ? selected_color : color));
+      line->setPen(restyled_pen);
+    };
 }
 
 class TransformResidual
@@ -1737,12 +2085,19 @@ private:
   double _layer_x, _layer_y;
 };
 
-void Level::optimize_layer_transforms()
+bool Level::optimize_layer_transforms(JobContext* job)
 {
   printf("level %s optimizing layer transforms...\n", name.c_str());
 
   for (std::size_t i = 0; i < layers.size(); i++)
   {
+    if (job)
+    {
+      if (job->cancelled())
+        return false;
+      job->set_progress(static_cast<double>(i) / layers.size());
+    }
+
     ceres::Problem problem;
 
     double yaw = layers[i].transform.yaw();
@@ -1840,6 +2195,7 @@ void Level::optimize_layer_transforms()
     layers[i].transform.setTranslation(
       QPointF(translation[0], translation[1]));
   }
+  return true;
 }
 
 void Level::mouse_select_press(
@@ -1867,9 +2223,9 @@ void Level::mouse_select_press(
   if (rendering_options.show_models &&
     ni.model_idx >= 0 &&
     ni.model_dist < model_dist_thresh)
-    models[ni.model_idx].selected = true;
+    select(SelectionSet::Item(SelectionSet::MODEL, ni.model_idx));
   else if (ni.vertex_idx >= 0 && ni.vertex_dist < vertex_dist_thresh)
-    vertices[ni.vertex_idx].selected = true;
+    select(SelectionSet::Item(SelectionSet::VERTEX, ni.vertex_idx));
   else if (ni.feature_idx >= 0 && ni.feature_dist < feature_dist_thresh)
   {
     //levels[level_idx].feature_sets[
@@ -1878,18 +2234,14 @@ void Level::mouse_select_press(
       ni.feature_idx,
       ni.feature_dist);
 
-    if (ni.feature_layer_idx == 0)
-    {
-      floorplan_features[ni.feature_idx].setSelected(true);
-    }
-    else
-    {
-      layers[ni.feature_layer_idx-1].
-      features[ni.feature_idx].setSelected(true);
-    }
+    select(
+      SelectionSet::Item(
+        SelectionSet::FEATURE,
+        ni.feature_idx,
+        ni.feature_layer_idx));
   }
   else if (ni.fiducial_idx >= 0 && ni.fiducial_dist < 10.0)
-    fiducials[ni.fiducial_idx].selected = true;
+    select(SelectionSet::Item(SelectionSet::FIDUCIAL, ni.fiducial_idx));
   else
   {
     // use the QGraphics stuff to see if it's an edge segment or polygon
@@ -1949,17 +2301,15 @@ Level::NearestItem Level::nearest_items(const double x, const double y)
   }
 
   // now search all "other" layer features
+  vector<QPointF> feature_positions;
   for (std::size_t layer_idx = 0; layer_idx < layers.size(); layer_idx++)
   {
     const Layer& layer = layers[layer_idx];
+    // transform all the features into parent level's pixel space
+    layer.feature_positions(drawing_meters_per_pixel, feature_positions);
     for (std::size_t i = 0; i < layer.features.size(); i++)
     {
-      const Feature& f = layer.features[i];
-
-      // transform this point into parent level's pixel space
-      QPointF p(layer.transform.forwards(f.qpoint()));
-      p /= drawing_meters_per_pixel;
-
+      const QPointF& p = feature_positions[i];
       const double dx = x - p.x();
       const double dy = y - p.y();
       const double dist = sqrt(dx*dx + dy*dy);
@@ -2074,10 +2424,11 @@ void Level::set_selected_line_item(
   const double y2 = line_item->line().y2();
 
   double min_edge_dist = 1e9;
-  Edge* min_edge = nullptr;
+  int min_edge_idx = -1;
   // find if any of our lanes match those vertices
-  for (auto& edge : edges)
+  for (std::size_t i = 0; i < edges.size(); i++)
   {
+    const Edge& edge = edges[i];
     if ((edge.type == Edge::LANE) &&
       (edge.get_graph_idx() != rendering_options.active_traffic_map_idx))
       continue;
@@ -2097,14 +2448,14 @@ void Level::set_selected_line_item(
     if (max_dist < min_edge_dist)
     {
       min_edge_dist = max_dist;
-      min_edge = &edge;
+      min_edge_idx = static_cast<int>(i);
     }
   }
 
   const double thresh = 10.0;  // should be really tiny if it matches
-  if (min_edge_dist < thresh && min_edge != nullptr)
+  if (min_edge_dist < thresh && min_edge_idx >= 0)
   {
-    min_edge->selected = true;
+    select(SelectionSet::Item(SelectionSet::EDGE, min_edge_idx));
     return;
   }
 
@@ -2118,7 +2469,7 @@ void Level::set_selected_line_item(
       if (constraint_idx >= 0 &&
         constraint_idx < static_cast<int>(constraints.size()))
       {
-        constraints[constraint_idx].setSelected(true);
+        select(SelectionSet::Item(SelectionSet::CONSTRAINT, constraint_idx));
       }
       return;
     }
@@ -2131,37 +2482,34 @@ void Level::set_selected_containing_polygon(
 {
   // holes are "higher" in our Z-stack (to make them clickable), so first
   // we need to make a list of all polygons that contain this point.
-  vector<Polygon*> containing_polygons;
+  vector<int> containing_polygons;
+  QPolygonF qpolygon;  // reused, so it only grows a few times
   for (std::size_t i = 0; i < polygons.size(); i++)
   {
-    Polygon& polygon = polygons[i];
-    QVector<QPointF> polygon_vertices;
+    const Polygon& polygon = polygons[i];
+    qpolygon.resize(0);
     for (const auto& vertex_idx: polygon.vertices)
     {
       const Vertex& v = vertices[vertex_idx];
-      polygon_vertices.append(QPointF(v.x, v.y));
+      qpolygon.append(QPointF(v.x, v.y));
     }
-    QPolygonF qpolygon(polygon_vertices);
     if (qpolygon.containsPoint(QPoint(x, y), Qt::OddEvenFill))
-      containing_polygons.push_back(&polygons[i]);
+      containing_polygons.push_back(static_cast<int>(i));
   }
 
   // first search for holes
-  for (Polygon* p : containing_polygons)
+  for (const int polygon_idx : containing_polygons)
   {
-    if (p->type == Polygon::HOLE)
+    if (polygons[polygon_idx].type == Polygon::HOLE)
     {
-      p->selected = true;
+      select(SelectionSet::Item(SelectionSet::POLYGON, polygon_idx));
       return;
     }
   }
 
   // if we get here, just return the first thing.
-  for (Polygon* p : containing_polygons)
-  {
-    p->selected = true;
-    return;
-  }
+  if (!containing_polygons.empty())
+    select(SelectionSet::Item(SelectionSet::POLYGON, containing_polygons[0]));
 }
 
 void Level::compute_layer_transforms()
@@ -2252,26 +2600,28 @@ void Level::align_colinear()
 
   // build up a vector of selected vertex indices
   vector<SelectedVertex> selected_vertices;
-  for (size_t i = 0; i < vertices.size(); i++)
+  for (const int vertex_idx : _selection.indices(SelectionSet::VERTEX))
   {
-    if (vertices[i].selected)
-    {
-      SelectedVertex sv;
-      sv.index = i;
-      sv.expanded = false;
-
-      for (size_t j = 0; j < edges.size(); j++)
-      {
-        const size_t start_idx = static_cast<size_t>(edges[j].start_idx);
-        const size_t end_idx = static_cast<size_t>(edges[j].end_idx);
-        if (start_idx == i && vertices[end_idx].selected)
-          sv.connected_vertex_indices.push_back(end_idx);
-        else if (end_idx == i && vertices[start_idx].selected)
-          sv.connected_vertex_indices.push_back(start_idx);
-      }
+    if (vertex_idx >= static_cast<int>(vertices.size()))
+      continue;
+    const size_t i = static_cast<size_t>(vertex_idx);
+    SelectedVertex sv;
+    sv.index = i;
+    sv.expanded = false;
 
-      selected_vertices.push_back(sv);
+    for (size_t j = 0; j < edges.size(); j++)
+    {
+      const int start_idx = edges[j].start_idx;
+      const int end_idx = edges[j].end_idx;
+      if (start_idx == vertex_idx &&
+        is_selected(SelectionSet::VERTEX, end_idx))
+        sv.connected_vertex_indices.push_back(end_idx);
+      else if (end_idx == vertex_idx &&
+        is_selected(SelectionSet::VERTEX, start_idx))
+        sv.connected_vertex_indices.push_back(start_idx);
     }
+
+    selected_vertices.push_back(sv);
   }
 
   printf("align_colinear() vertices:\n");
@@ -20,6 +20,7 @@
 
 #include <yaml-cpp/yaml.h>
 #include <string>
+#include <unordered_map>
 
 #include "constraint.hpp"
 #include "coordinate_system.h"
@@ -28,10 +29,12 @@
 #include "feature.hpp"
 #include "fiducial.h"
 #include "graph.h"
+#include "job_scheduler.h"
 #include "layer.h"
 #include "model.h"
 #include "polygon.h"
 #include "rendering_options.h"
+#include "selection_set.h"
 #include "vertex.h"
 
 #include <QPixmap>
@@ -82,11 +85,13 @@ public:
   std::vector<Constraint> constraints;
 
   QPixmap floorplan_pixmap;
+  bool drawing_evicted = false;
 
   bool from_yaml(
     const std::string& name,
     const YAML::Node& data,
-    const CoordinateSystem& coordinate_system);
+    const CoordinateSystem& coordinate_system,
+    const bool load_layer_images = true);
   YAML::Node to_yaml(const CoordinateSystem& coordinate_system) const;
 
   const Feature* find_feature(const QUuid& id) const;
@@ -146,6 +151,55 @@ public:
   bool can_delete_current_selection();
   bool delete_selected();
   void calculate_scale(const CoordinateSystem& coordinate_system);
+
+  // Triangulation of a polygon in level (pixel) coordinates. For FLOOR
+  // polygons, the HOLE polygons which overlap it are subtracted, as are
+  // any extra_holes supplied by the caller. The result is cached in the
+  // polygon and only recomputed after its (or the holes') vertices move.
+  const Triangulation& polygon_triangulation(
+    const int polygon_idx,
+    const std::vector<Triangulation::Ring>& extra_holes =
+    std::vector<Triangulation::Ring>()) const;
+
+  // The outlines of the HOLE polygons, with their bounds. Triangulating
+  // every floor of a level should gather these once and pass them in,
+  // rather than have each floor gather them again.
+  struct HoleRing
+  {
+    Triangulation::Ring ring;
+    double min_x = 0.0;
+    double min_y = 0.0;
+    double max_x = 0.0;
+    double max_y = 0.0;
+  };
+  std::vector<HoleRing> hole_rings() const;
+
+  const Triangulation& polygon_triangulation(
+    const int polygon_idx,
+    const std::vector<HoleRing>& hole_rings,
+    const std::vector<Triangulation::Ring>& extra_holes =
+    std::vector<Triangulation::Ring>()) const;
+
+  // area of the polygon (minus its holes) in square meters
+  double polygon_area(const int polygon_idx) const;
+
+  // The selection is only changed through these, which restyle the
+  // graphics items of exactly the elements whose state changed, so
+  // clicking around doesn't need to rebuild the scene.
+  const SelectionSet& selection() const { return _selection; }
+  bool is_selected(
+    const SelectionSet::Type type,
+    const int idx,
+    const int layer_idx = 0) const
+  {
+    return _selection.contains(type, idx, layer_idx);
+  }
+  // lowest selected index of a type (and feature layer), or -1
+  int first_selected(
+    const SelectionSet::Type type,
+    const int layer_idx = 0) const;
+  void select(const SelectionSet::Item& item);
+  void deselect(const SelectionSet::Item& item);
   void clear_selection();
 
   void get_selected_items(std::vector<SelectedItem>& selected_items);
@@ -169,13 +223,31 @@ public:
 
   bool load_drawing();
 
+  // a copy without any pixmaps (or GeoTIFF handles, whose block caches
+  // aren't thread-safe), which can be handed to a worker thread
+  Level snapshot() const;
+
+  // memory held by the drawing and the layer images, for MemoryBudget
+  std::size_t drawing_bytes() const;
+  std::size_t layer_image_bytes() const;
+
+  // drop the drawing pixmap; it's reloaded the next time the level is drawn
+  std::size_t evict_drawing();
+
+  // drop the layer images which can be regenerated, largest first
+  std::size_t evict_layer_images(const std::size_t bytes);
+
+  std::size_t last_drawn = 0;  // increases with every Level::draw()
+
   void set_drawing_visible(bool value) { _drawing_visible = value; }
   bool get_drawing_visible() const { return _drawing_visible; }
 
   QUuid add_feature(const int layer, const double x, const double y);
   void remove_feature(const int layer_idx, QUuid feature_uuid);
   bool export_features(const std::string& filename) const;
-  void optimize_layer_transforms();
+  // fits each layer's transform to its constraints; returns false if the
+  // job was cancelled, which may leave some layers fitted and others not
+  bool optimize_layer_transforms(JobContext* job = nullptr);
 
   void compute_layer_transforms();
   void compute_layer_transform(const std::size_t layer_idx);
@@ -200,28 +272,67 @@ private:
 
   bool _drawing_visible = true;
 
-  void draw_lane(
+  SelectionSet _selection;
+
+  // how to restyle each element drawn into the current scene
+  std::unordered_map<
+    SelectionSet::Item,
+    SelectionSet::Restyler,
+    SelectionSet::ItemHash> restylers;
+
+  void restyle(const SelectionSet::Item& item);
+
+  // the feature a FEATURE selection item refers to, if it still exists
+  const Feature* selected_feature(const SelectionSet::Item& item) const;
+
+  void add_restyler(
+    const SelectionSet::Item& item,
+    SelectionSet::Restyler restyler);
+
+  // size of the container holding elements of a type (and feature layer)
+  std::size_t num_elements(
+    const SelectionSet::Type type,
+    const int layer_idx = 0) const;
+
+  // drop selected items whose elements no longer exist, for example
+  // after an undo command restored a shorter container
+  void prune_selection();
+
+  SelectionSet::Restyler draw_lane(
     QGraphicsScene* scene,
     const Edge& edge,
     const RenderingOptions& rendering_options,
-    const std::vector<Graph>& graphs) const;
+    const std::vector<double>& graph_lane_widths,
+    const bool selected) const;
 
-  void draw_wall(QGraphicsScene* scene, const Edge& edge) const;
-  void draw_meas(QGraphicsScene* scene, const Edge& edge) const;
-  void draw_door(QGraphicsScene* scene, const Edge& edge) const;
+  SelectionSet::Restyler draw_wall(
+    QGraphicsScene* scene,
+    const Edge& edge,
+    const bool selected) const;
+  SelectionSet::Restyler draw_meas(
+    QGraphicsScene* scene,
+    const Edge& edge,
+    const bool selected) const;
+  SelectionSet::Restyler draw_door(
+    QGraphicsScene* scene,
+    const Edge& edge,
+    const bool selected) const;
   void draw_fiducials(QGraphicsScene* scene) const;
-  void draw_polygons(QGraphicsScene* scene) const;
+  void draw_polygons(QGraphicsScene* scene);
 
-  void draw_constraint(
+  SelectionSet::Restyler draw_constraint(
     QGraphicsScene* scene,
     const Constraint& constraint,
     int constraint_idx) const;
 
   // helper function
-  void draw_polygon(
+  SelectionSet::Restyler draw_polygon(
     QGraphicsScene* scene,
     const QBrush& brush,
-    const Polygon& polygon) const;
+    const int polygon_idx,
+    const std::vector<HoleRing>& hole_rings) const;
+
+  Triangulation::Ring polygon_ring(const Polygon& polygon) const;
 
   void add_door_swing_path(
     QPainterPath& path,
@@ -84,6 +84,7 @@ void LevelTable::update(Building& building)
           if (level_dialog.exec() == QDialog::Accepted)
           {
             building.levels[i].load_drawing();
+            building.update_symbols();
             setWindowModified(true);  // not sure why, but this doesn't work
           }
         }
@@ -96,6 +97,7 @@ void LevelTable::update(Building& building)
           {
             building.levels[i].name = ui.name_line_edit->text().toStdString();
             building.levels[i].elevation = ui.elevation_line_edit->text().toDouble();
+            building.update_symbols();
             setWindowModified(true);  // not sure why, but this doesn't work
           }
         }
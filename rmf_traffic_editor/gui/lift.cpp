@@ -31,8 +31,7 @@ Lift::Lift()
 
 void Lift::from_yaml(
   const std::string& _name,
-  const YAML::Node& data,
-  const std::vector<Level>& levels)
+  const YAML::Node& data)
 {
   if (!data.IsMap())
     throw std::runtime_error("Lift::from_yaml() expected a map");
@@ -67,13 +66,6 @@ void Lift::from_yaml(
     highest_floor = data["highest_floor"].as<string>();
   if (data["lowest_floor"])
     lowest_floor = data["lowest_floor"].as<string>();
-  for (const auto& level : levels)
-  {
-    if (level.name == highest_floor)
-      highest_elevation = level.elevation;
-    if (level.name == lowest_floor)
-      lowest_elevation = level.elevation;
-  }
 
   // for every level, load if every door can open
   if (data["level_doors"] && data["level_doors"].IsMap())
@@ -224,21 +216,14 @@ void Lift::draw(
 bool Lift::level_door_opens(
   const std::string& level_name,
   const std::string& door_name,
-  const std::vector<Level>& levels) const
+  const double level_elevation) const
 {
   LevelDoorMap::const_iterator level_it = level_doors.find(level_name);
   if (level_it == level_doors.end())
     return false;
-  for (const auto& level : levels)
-  {
-    if (level.name == level_name)
-    {
-      if (level.elevation < lowest_elevation ||
-        level.elevation > highest_elevation)
-        return false;
-      break;
-    }
-  }
+  if (level_elevation < lowest_elevation ||
+    level_elevation > highest_elevation)
+    return false;
   const DoorNameList& names = level_it->second;
   if (std::find(names.begin(), names.end(), door_name) == names.end())
     return false;
@@ -81,8 +81,9 @@ public:
   Lift();
 
   YAML::Node to_yaml() const;
-  void from_yaml(const std::string& _name, const YAML::Node& data,
-    const std::vector<Level>& levels);
+  // highest_elevation and lowest_elevation are left at their defaults;
+  // Building::update_lift_elevations() resolves them once levels are known
+  void from_yaml(const std::string& _name, const YAML::Node& data);
 
   void draw(
     QGraphicsScene* scene,
@@ -97,7 +98,7 @@ public:
   bool level_door_opens(
     const std::string& level_name,
     const std::string& door_name,
-    const std::vector<Level>& levels) const;
+    const double level_elevation) const;
 };
 
 #endif
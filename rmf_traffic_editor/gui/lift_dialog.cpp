@@ -55,6 +55,7 @@ LiftDialog::LiftDialog(Lift& lift, Building& building)
     [this](const QString& text)
     {
       _lift.name = text.toStdString();
+      _building.update_symbols();
       update_lift_view();
       emit redraw();
     });
@@ -108,19 +109,7 @@ LiftDialog::LiftDialog(Lift& lift, Building& building)
     [this](const QString& text)
     {
       _lift.highest_floor = text.toStdString();
-      if (_lift.highest_floor.empty())
-        _lift.highest_elevation = DBL_MAX;
-      else
-      {
-        for (const auto& level : _building.levels)
-        {
-          if (level.name == _lift.highest_floor)
-          {
-            _lift.highest_elevation = level.elevation;
-            break;
-          }
-        }
-      }
+      _building.update_lift_elevations(_lift);
       update_level_table();
       emit redraw();
     });
@@ -140,19 +129,7 @@ LiftDialog::LiftDialog(Lift& lift, Building& building)
     [this](const QString& text)
     {
       _lift.lowest_floor = text.toStdString();
-      if (_lift.lowest_floor.empty())
-        _lift.lowest_elevation = -DBL_MAX;
-      else
-      {
-        for (const auto& level : _building.levels)
-        {
-          if (level.name == _lift.lowest_floor)
-          {
-            _lift.lowest_elevation = level.elevation;
-            break;
-          }
-        }
-      }
+      _building.update_lift_elevations(_lift);
       update_level_table();
       emit redraw();
     });
@@ -412,6 +389,7 @@ void LiftDialog::ok_button_clicked()
       }
     }
   }
+  _building.update_symbols();  // for the new name and level doors
   update_lift_view();
   emit redraw();
   accept();
@@ -540,10 +518,10 @@ void LiftDialog::update_level_table()
     {
       QCheckBox* checkbox = new QCheckBox;
       checkbox->setStyleSheet("margin-left: 50%; margin-right: 50%");
-      if (_lift.level_door_opens(
-          level_name.toStdString(),
-          _lift.doors[door_idx].name,
-          _building.levels))
+      if (_building.lift_door_opens(
+          _lift,
+          static_cast<int>(level_idx),
+          _lift.doors[door_idx].name))
         checkbox->setChecked(true);
       _level_table->setCellWidget(level_idx, door_idx + 1, checkbox);
     }
@@ -86,6 +86,7 @@ void LiftTable::update(Building& building)
       if (lift_dialog.exec() == QDialog::Accepted)
       {
         building.lifts.push_back(lift);
+        building.update_symbols();
         update(building);
         emit redraw();
       }
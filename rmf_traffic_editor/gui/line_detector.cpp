@@ -0,0 +1,624 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <unordered_map>
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "line_detector.h"
+
+using std::vector;
+
+// tile size in pixels, and the margin around each tile needed by the
+// smoothing and gradient kernels
+static const int TILE_SIZE = 1024;
+static const int MARGIN = 4;
+
+// smoothing kernel (binomial, sigma ~1.2 pixels)
+static const int KERNEL_RADIUS = 3;
+static const float KERNEL[2 * KERNEL_RADIUS + 1] =
+{
+  1.f / 64, 6.f / 64, 15.f / 64, 20.f / 64, 15.f / 64, 6.f / 64, 1.f / 64
+};
+
+// gradients weaker than this (per pixel, on a 0..1 image) aren't edges
+static const float MIN_GRADIENT = 0.05f;
+
+static double angle_difference(const double a, const double b)
+{
+  double d = std::fmod(std::abs(a - b), 2.0 * M_PI);
+  return d > M_PI ? 2.0 * M_PI - d : d;
+}
+
+
+LineDetector::LineDetector()
+{
+}
+
+LineDetector::~LineDetector()
+{
+}
+
+void LineDetector::detect(
+  const vector<uint8_t>& image,
+  const int width,
+  const int height)
+{
+  segments.clear();
+  vertices.clear();
+  edges.clear();
+
+  struct Tile
+  {
+    int x0, y0, x1, y1;
+    vector<Segment> found;
+  };
+  vector<Tile> tiles;
+  for (int y = 0; y < height; y += TILE_SIZE)
+  {
+    for (int x = 0; x < width; x += TILE_SIZE)
+    {
+      Tile tile;
+      tile.x0 = x;
+      tile.y0 = y;
+      tile.x1 = std::min(x + TILE_SIZE, width);
+      tile.y1 = std::min(y + TILE_SIZE, height);
+      tiles.push_back(tile);
+    }
+  }
+
+  QtConcurrent::blockingMap(
+    tiles,
+    [&](Tile& tile)
+    {
+      detect_tile(
+        image,
+        width,
+        height,
+        tile.x0,
+        tile.y0,
+        tile.x1,
+        tile.y1,
+        tile.found);
+    });
+
+  for (const Tile& tile : tiles)
+    segments.insert(segments.end(), tile.found.begin(), tile.found.end());
+
+  merge();
+  snap();
+}
+
+void LineDetector::detect_tile(
+  const vector<uint8_t>& image,
+  const int width,
+  const int height,
+  const int x0,
+  const int y0,
+  const int x1,
+  const int y1,
+  vector<Segment>& found) const
+{
+  // the tile plus its margin, clipped to the image
+  const int ax0 = std::max(0, x0 - MARGIN);
+  const int ay0 = std::max(0, y0 - MARGIN);
+  const int ax1 = std::min(width, x1 + MARGIN);
+  const int ay1 = std::min(height, y1 + MARGIN);
+  const int w = ax1 - ax0;
+  const int h = ay1 - ay0;
+
+  bool any = false;
+  for (int y = ay0; y < ay1 && !any; y++)
+  {
+    const uint8_t* row = &image[static_cast<std::size_t>(y) * width];
+    any = std::any_of(row + ax0, row + ax1, [](uint8_t p) { return p != 0; });
+  }
+  if (!any)
+    return;
+
+  // separable smoothing, clamping at the edges
+  vector<float> horizontal(static_cast<std::size_t>(w) * h);
+  vector<float> smooth(horizontal.size());
+  for (int y = 0; y < h; y++)
+  {
+    const uint8_t* in = &image[static_cast<std::size_t>(ay0 + y) * width + ax0];
+    float* out = &horizontal[static_cast<std::size_t>(y) * w];
+    for (int x = 0; x < w; x++)
+    {
+      float sum = 0.0f;
+      for (int k = -KERNEL_RADIUS; k <= KERNEL_RADIUS; k++)
+      {
+        const int xx = std::min(w - 1, std::max(0, x + k));
+        sum += KERNEL[k + KERNEL_RADIUS] * (in[xx] ? 1.0f : 0.0f);
+      }
+      out[x] = sum;
+    }
+  }
+  for (int y = 0; y < h; y++)
+  {
+    float* out = &smooth[static_cast<std::size_t>(y) * w];
+    std::fill(out, out + w, 0.0f);
+    for (int k = -KERNEL_RADIUS; k <= KERNEL_RADIUS; k++)
+    {
+      const int yy = std::min(h - 1, std::max(0, y + k));
+      const float* in = &horizontal[static_cast<std::size_t>(yy) * w];
+      const float weight = KERNEL[k + KERNEL_RADIUS];
+      for (int x = 0; x < w; x++)
+        out[x] += weight * in[x];
+    }
+  }
+
+  // gradient by central differences; reuse the first buffer for magnitude
+  vector<float>& magnitude = horizontal;
+  vector<float> angle(horizontal.size(), 0.0f);
+  std::fill(magnitude.begin(), magnitude.end(), 0.0f);
+  for (int y = 1; y < h - 1; y++)
+  {
+    const float* above = &smooth[static_cast<std::size_t>(y - 1) * w];
+    const float* row = above + w;
+    const float* below = row + w;
+    float* mag = &magnitude[static_cast<std::size_t>(y) * w];
+    float* ang = &angle[static_cast<std::size_t>(y) * w];
+    for (int x = 1; x < w - 1; x++)
+    {
+      const float gx = 0.5f * (row[x + 1] - row[x - 1]);
+      const float gy = 0.5f * (below[x] - above[x]);
+      mag[x] = std::sqrt(gx * gx + gy * gy);
+      ang[x] = std::atan2(gy, gx);
+    }
+  }
+
+  // seeds are the core pixels with a real gradient, strongest first
+  vector<std::pair<float, int>> seeds;
+  for (int y = y0; y < y1; y++)
+  {
+    for (int x = x0; x < x1; x++)
+    {
+      const int i = (y - ay0) * w + (x - ax0);
+      if (magnitude[i] > MIN_GRADIENT)
+        seeds.push_back(std::make_pair(magnitude[i], i));
+    }
+  }
+  std::sort(
+    seeds.begin(),
+    seeds.end(),
+    [](const std::pair<float, int>& a, const std::pair<float, int>& b)
+    {
+      return a.first > b.first;
+    });
+
+  const double tolerance = angle_tolerance * M_PI / 180.0;
+  vector<uint8_t> used(horizontal.size(), 0);
+  vector<int> region;
+  for (const auto& seed : seeds)
+  {
+    if (used[seed.second])
+      continue;
+
+    // grow a region of pixels whose gradients agree with the region's
+    region.clear();
+    region.push_back(seed.second);
+    used[seed.second] = 1;
+    double sum_cos = std::cos(angle[seed.second]);
+    double sum_sin = std::sin(angle[seed.second]);
+    for (std::size_t r = 0; r < region.size(); r++)
+    {
+      const int i = region[r];
+      const int x = i % w;
+      const int y = i / w;
+      const double region_angle = std::atan2(sum_sin, sum_cos);
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+          const int nx = x + dx;
+          const int ny = y + dy;
+          if (nx + ax0 < x0 || nx + ax0 >= x1 || ny + ay0 < y0 ||
+            ny + ay0 >= y1)
+            continue;
+          const int n = ny * w + nx;
+          if (used[n] || magnitude[n] <= MIN_GRADIENT ||
+            angle_difference(angle[n], region_angle) > tolerance)
+            continue;
+          used[n] = 1;
+          region.push_back(n);
+          sum_cos += std::cos(angle[n]);
+          sum_sin += std::sin(angle[n]);
+        }
+      }
+    }
+    if (region.size() < min_length)
+      continue;
+
+    // the segment runs along the principal axis of the region
+    double total = 0.0, cx = 0.0, cy = 0.0;
+    for (const int i : region)
+    {
+      total += magnitude[i];
+      cx += magnitude[i] * (i % w);
+      cy += magnitude[i] * (i / w);
+    }
+    cx /= total;
+    cy /= total;
+    double ixx = 0.0, iyy = 0.0, ixy = 0.0;
+    for (const int i : region)
+    {
+      const double dx = i % w - cx;
+      const double dy = i / w - cy;
+      ixx += magnitude[i] * dx * dx;
+      iyy += magnitude[i] * dy * dy;
+      ixy += magnitude[i] * dx * dy;
+    }
+    const double theta = 0.5 * std::atan2(2.0 * ixy, ixx - iyy);
+    const double ux = std::cos(theta);
+    const double uy = std::sin(theta);
+
+    double t_min = 1e100, t_max = -1e100, s_min = 1e100, s_max = -1e100;
+    for (const int i : region)
+    {
+      const double dx = i % w - cx;
+      const double dy = i / w - cy;
+      const double t = dx * ux + dy * uy;
+      const double s = -dx * uy + dy * ux;
+      t_min = std::min(t_min, t);
+      t_max = std::max(t_max, t);
+      s_min = std::min(s_min, s);
+      s_max = std::max(s_max, s);
+    }
+    const double length = t_max - t_min;
+    const double density =
+      region.size() / ((length + 1.0) * (s_max - s_min + 1.0));
+    if (length < min_length || density < min_density)
+      continue;
+
+    Segment segment;
+    segment.a = Point(
+      ax0 + cx + t_min * ux + 0.5,
+      ay0 + cy + t_min * uy + 0.5);
+    segment.b = Point(
+      ax0 + cx + t_max * ux + 0.5,
+      ay0 + cy + t_max * uy + 0.5);
+    found.push_back(segment);
+  }
+}
+
+void LineDetector::merge()
+{
+  const double max_angle = merge_angle * M_PI / 180.0;
+
+  bool merged_any = true;
+  while (merged_any)
+  {
+    merged_any = false;
+
+    // sort by direction (modulo pi), and only compare neighbors in that
+    // order; the list is repeated with the directions shifted by pi so
+    // that directions near 0 and near pi also meet
+    struct Entry
+    {
+      double angle;
+      int idx;
+    };
+    vector<Entry> order;
+    for (std::size_t i = 0; i < segments.size(); i++)
+    {
+      const Segment& s = segments[i];
+      double a = std::atan2(s.b.y - s.a.y, s.b.x - s.a.x);
+      if (a < 0.0)
+        a += M_PI;
+      if (a >= M_PI)
+        a -= M_PI;
+      order.push_back({a, static_cast<int>(i)});
+    }
+    std::sort(
+      order.begin(),
+      order.end(),
+      [](const Entry& a, const Entry& b) { return a.angle < b.angle; });
+    const std::size_t n = order.size();
+    for (std::size_t i = 0; i < n; i++)
+      order.push_back({order[i].angle + M_PI, order[i].idx});
+
+    vector<bool> alive(segments.size(), true);
+    for (std::size_t i = 0; i < n; i++)
+    {
+      const int si = order[i].idx;
+      for (std::size_t j = i + 1;
+        j < order.size() && order[j].angle - order[i].angle <= max_angle; j++)
+      {
+        const int sj = order[j].idx;
+        if (sj == si || !alive[si] || !alive[sj])
+          continue;
+
+        Segment& a = segments[si];
+        const Segment& b = segments[sj];
+        const double la = std::hypot(a.b.x - a.a.x, a.b.y - a.a.y);
+        const double lb = std::hypot(b.b.x - b.a.x, b.b.y - b.a.y);
+        if (la < 1e-9 || lb < 1e-9)
+          continue;
+        const double ux = (a.b.x - a.a.x) / la;
+        const double uy = (a.b.y - a.a.y) / la;
+
+        // b must be close to the line of a, and overlap it or nearly
+        const double sb0 = -(b.a.x - a.a.x) * uy + (b.a.y - a.a.y) * ux;
+        const double sb1 = -(b.b.x - a.a.x) * uy + (b.b.y - a.a.y) * ux;
+        if (std::abs(sb0) > merge_distance || std::abs(sb1) > merge_distance)
+          continue;
+        const double tb0 = (b.a.x - a.a.x) * ux + (b.a.y - a.a.y) * uy;
+        const double tb1 = (b.b.x - a.a.x) * ux + (b.b.y - a.a.y) * uy;
+        const double gap =
+          std::max(std::min(tb0, tb1) - la, -std::max(tb0, tb1));
+        if (gap > merge_gap)
+          continue;
+
+        // length-weighted direction and position, spanning both segments
+        double vx = b.b.x - b.a.x;
+        double vy = b.b.y - b.a.y;
+        if (vx * ux + vy * uy < 0.0)
+        {
+          vx = -vx;
+          vy = -vy;
+        }
+        double dx = ux * la + vx;
+        double dy = uy * la + vy;
+        const double dl = std::hypot(dx, dy);
+        dx /= dl;
+        dy /= dl;
+        const double mx = (la * (a.a.x + a.b.x) + lb * (b.a.x + b.b.x)) /
+          (2.0 * (la + lb));
+        const double my = (la * (a.a.y + a.b.y) + lb * (b.a.y + b.b.y)) /
+          (2.0 * (la + lb));
+        double t_min = 1e100, t_max = -1e100;
+        for (const Point& p : {a.a, a.b, b.a, b.b})
+        {
+          const double t = (p.x - mx) * dx + (p.y - my) * dy;
+          t_min = std::min(t_min, t);
+          t_max = std::max(t_max, t);
+        }
+        a.a = Point(mx + t_min * dx, my + t_min * dy);
+        a.b = Point(mx + t_max * dx, my + t_max * dy);
+        alive[sj] = false;
+        merged_any = true;
+      }
+    }
+
+    vector<Segment> remaining;
+    for (std::size_t i = 0; i < segments.size(); i++)
+    {
+      if (alive[i])
+        remaining.push_back(segments[i]);
+    }
+    segments.swap(remaining);
+  }
+}
+
+void LineDetector::snap()
+{
+  const std::size_t num_segments = segments.size();
+  auto endpoint = [this](const std::size_t e) -> const Point&
+    {
+      return e % 2 ? segments[e / 2].b : segments[e / 2].a;
+    };
+
+  // cluster endpoints closer than the snap distance (union-find over a
+  // hash grid of cells the size of the snap distance)
+  vector<std::size_t> parent(2 * num_segments);
+  for (std::size_t i = 0; i < parent.size(); i++)
+    parent[i] = i;
+  auto find = [&parent](std::size_t i)
+    {
+      while (parent[i] != i)
+      {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+      }
+      return i;
+    };
+
+  const double cell = std::max(snap_distance, 1.0);
+  auto cell_key = [](const long long cx, const long long cy)
+    {
+      return (cx << 32) ^ (cy & 0xffffffffLL);
+    };
+  std::unordered_map<long long, vector<std::size_t>> grid;
+  for (std::size_t e = 0; e < parent.size(); e++)
+  {
+    const Point& p = endpoint(e);
+    const long long cx = static_cast<long long>(std::floor(p.x / cell));
+    const long long cy = static_cast<long long>(std::floor(p.y / cell));
+    for (long long dy = -1; dy <= 1; dy++)
+    {
+      for (long long dx = -1; dx <= 1; dx++)
+      {
+        auto it = grid.find(cell_key(cx + dx, cy + dy));
+        if (it == grid.end())
+          continue;
+        for (const std::size_t other : it->second)
+        {
+          const Point& q = endpoint(other);
+          if (std::hypot(p.x - q.x, p.y - q.y) <= snap_distance)
+            parent[find(e)] = find(other);
+        }
+      }
+    }
+    grid[cell_key(cx, cy)].push_back(e);
+  }
+
+  // one vertex per cluster: at the corner where two walls meet at an
+  // angle, otherwise at the centroid of the endpoints
+  std::unordered_map<std::size_t, int> vertex_of_root;
+  vector<vector<std::size_t>> members;
+  vector<int> endpoint_vertex(parent.size());
+  for (std::size_t e = 0; e < parent.size(); e++)
+  {
+    const std::size_t root = find(e);
+    auto it = vertex_of_root.find(root);
+    if (it == vertex_of_root.end())
+    {
+      it = vertex_of_root.insert(
+        std::make_pair(root, static_cast<int>(members.size()))).first;
+      members.push_back(vector<std::size_t>());
+    }
+    endpoint_vertex[e] = it->second;
+    members[it->second].push_back(e);
+  }
+
+  auto intersect = [](const Segment& s, const Segment& t, Point& p)
+    {
+      const double rx = s.b.x - s.a.x, ry = s.b.y - s.a.y;
+      const double qx = t.b.x - t.a.x, qy = t.b.y - t.a.y;
+      const double denom = rx * qy - ry * qx;
+      if (std::abs(denom) < 1e-9)
+        return false;
+      const double u = ((t.a.x - s.a.x) * qy - (t.a.y - s.a.y) * qx) / denom;
+      p = Point(s.a.x + u * rx, s.a.y + u * ry);
+      return true;
+    };
+
+  vertices.resize(members.size());
+  for (std::size_t v = 0; v < members.size(); v++)
+  {
+    Point centroid;
+    for (const std::size_t e : members[v])
+    {
+      centroid.x += endpoint(e).x / members[v].size();
+      centroid.y += endpoint(e).y / members[v].size();
+    }
+    vertices[v] = centroid;
+
+    Point corner;
+    if (members[v].size() == 2 &&
+      members[v][0] / 2 != members[v][1] / 2 &&
+      intersect(
+        segments[members[v][0] / 2],
+        segments[members[v][1] / 2],
+        corner) &&
+      std::hypot(corner.x - centroid.x, corner.y - centroid.y) <
+      2.0 * snap_distance)
+      vertices[v] = corner;
+  }
+
+  // endpoints which stop just short of (or just past) another wall join
+  // it there, splitting that wall
+  vector<vector<std::pair<double, int>>> splits(num_segments);
+  auto direction = [this](const std::size_t s)
+    {
+      const Segment& seg = segments[s];
+      return std::atan2(seg.b.y - seg.a.y, seg.b.x - seg.a.x);
+    };
+  for (std::size_t v = 0; v < members.size(); v++)
+  {
+    // only loose ends, i.e. not where walls already meet at an angle
+    bool corner = false;
+    for (const std::size_t e : members[v])
+    {
+      const double diff =
+        angle_difference(direction(e / 2), direction(members[v][0] / 2));
+      corner |= std::min(diff, M_PI - diff) > 20.0 * M_PI / 180.0;
+    }
+    if (corner)
+      continue;
+
+    const std::size_t own = members[v][0] / 2;
+    const Point p = vertices[v];
+    for (std::size_t s = 0; s < num_segments; s++)
+    {
+      bool member = false;
+      for (const std::size_t e : members[v])
+        member |= e / 2 == s;
+      if (member)
+        continue;
+      const Segment& seg = segments[s];
+      const double len = std::hypot(seg.b.x - seg.a.x, seg.b.y - seg.a.y);
+      if (len < 1e-9)
+        continue;
+      const double ux = (seg.b.x - seg.a.x) / len;
+      const double uy = (seg.b.y - seg.a.y) / len;
+      const double t = (p.x - seg.a.x) * ux + (p.y - seg.a.y) * uy;
+      const double d = -(p.x - seg.a.x) * uy + (p.y - seg.a.y) * ux;
+      if (t <= 0.0 || t >= len || std::abs(d) > snap_distance)
+        continue;
+
+      Point q(seg.a.x + t * ux, seg.a.y + t * uy);
+      Point corner;
+      if (intersect(segments[own], seg, corner) &&
+        std::hypot(corner.x - p.x, corner.y - p.y) <= snap_distance)
+        q = corner;
+      vertices[v] = q;
+      splits[s].push_back(
+        std::make_pair(
+          (q.x - seg.a.x) * ux + (q.y - seg.a.y) * uy,
+          static_cast<int>(v)));
+      break;
+    }
+  }
+
+  // walls which cross each other get a shared vertex at the crossing
+  for (std::size_t s = 0; s < num_segments; s++)
+  {
+    const Segment& a = segments[s];
+    const double la = std::hypot(a.b.x - a.a.x, a.b.y - a.a.y);
+    for (std::size_t t = s + 1; t < num_segments; t++)
+    {
+      const Segment& b = segments[t];
+      if (std::max(a.a.x, a.b.x) < std::min(b.a.x, b.b.x) ||
+        std::max(b.a.x, b.b.x) < std::min(a.a.x, a.b.x) ||
+        std::max(a.a.y, a.b.y) < std::min(b.a.y, b.b.y) ||
+        std::max(b.a.y, b.b.y) < std::min(a.a.y, a.b.y))
+        continue;
+      Point p;
+      if (!intersect(a, b, p))
+        continue;
+      const double lb = std::hypot(b.b.x - b.a.x, b.b.y - b.a.y);
+      const double ta = std::hypot(p.x - a.a.x, p.y - a.a.y);
+      const double tb = std::hypot(p.x - b.a.x, p.y - b.a.y);
+      const bool inside_a =
+        (p.x - a.a.x) * (a.b.x - a.a.x) + (p.y - a.a.y) * (a.b.y - a.a.y) > 0;
+      const bool inside_b =
+        (p.x - b.a.x) * (b.b.x - b.a.x) + (p.y - b.a.y) * (b.b.y - b.a.y) > 0;
+      if (!inside_a || !inside_b ||
+        ta <= snap_distance || ta >= la - snap_distance ||
+        tb <= snap_distance || tb >= lb - snap_distance)
+        continue;
+      const int v = static_cast<int>(vertices.size());
+      vertices.push_back(p);
+      splits[s].push_back(std::make_pair(ta, v));
+      splits[t].push_back(std::make_pair(tb, v));
+    }
+  }
+
+  std::set<std::pair<int, int>> edge_set;
+  for (std::size_t s = 0; s < num_segments; s++)
+  {
+    vector<std::pair<double, int>>& stops = splits[s];
+    stops.push_back(std::make_pair(-1e100, endpoint_vertex[2 * s]));
+    stops.push_back(std::make_pair(1e100, endpoint_vertex[2 * s + 1]));
+    std::sort(stops.begin(), stops.end());
+    for (std::size_t i = 1; i < stops.size(); i++)
+    {
+      const int v0 = stops[i - 1].second;
+      const int v1 = stops[i].second;
+      if (v0 == v1)
+        continue;
+      if (edge_set.insert(std::make_pair(std::min(v0, v1), std::max(v0, v1)))
+        .second)
+        edges.push_back(std::make_pair(v0, v1));
+    }
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef LINE_DETECTOR_H
+#define LINE_DETECTOR_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ * Finds straight walls in a binary occupancy image and turns them into a
+ * graph of segments with shared endpoints.
+ *
+ * Detection follows the line-support-region idea of LSD: the image is
+ * smoothed, its gradient is computed, and pixels are grown (strongest
+ * gradient first) into regions whose gradient directions agree; every
+ * long, dense region becomes a segment along its principal axis. The
+ * image is processed in independent tiles on the thread pool, with
+ * plain float loops over rows which the compiler can vectorize.
+ *
+ * The two sides of a thin wall, and pieces of one wall cut by tile
+ * boundaries, come out as nearly collinear segments, so these are then
+ * merged. Finally nearby endpoints are snapped together (at the corner
+ * itself, when two walls meet at an angle), endpoints which stop just
+ * short of another wall are snapped onto it, and walls are split where
+ * they meet or cross so that they share vertices.
+ */
+
+class LineDetector
+{
+public:
+  LineDetector();
+  ~LineDetector();
+
+  // all distances are in pixels
+  double min_length = 10.0;
+  double angle_tolerance = 22.5;  // degrees, when growing regions
+  double min_density = 0.5;  // region pixels / bounding rectangle area
+  double merge_angle = 5.0;  // degrees
+  double merge_distance = 6.0;  // between (nearly) parallel segments
+  double merge_gap = 6.0;  // along the direction of collinear segments
+  double snap_distance = 6.0;
+
+  struct Point
+  {
+    double x = 0.0;
+    double y = 0.0;
+
+    Point() {}
+    Point(const double _x, const double _y) : x(_x), y(_y) {}
+  };
+
+  struct Segment
+  {
+    Point a, b;
+  };
+
+  // after detect(): the merged segments
+  std::vector<Segment> segments;
+
+  // after detect(): segments split and joined at their shared vertices
+  std::vector<Point> vertices;
+  std::vector<std::pair<int, int>> edges;
+
+  // nonzero pixels of the row-major image are occupied
+  void detect(const std::vector<uint8_t>& image, const int width,
+    const int height);
+
+private:
+  void detect_tile(
+    const std::vector<uint8_t>& image,
+    const int width,
+    const int height,
+    const int x0,
+    const int y0,
+    const int x1,
+    const int y1,
+    std::vector<Segment>& found) const;
+
+  void merge();
+  void snap();
+};
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtEndian>
+#include <QUdpSocket>
+
+#include "live_feed.h"
+
+using std::string;
+using std::vector;
+
+static const char MAGIC[] = "RPOS";
+static const std::size_t MAGIC_SIZE = 4;
+static const std::size_t FIXED_SIZE = 3 * sizeof(float) + 3;
+
+// reads a little-endian float32, which may not be aligned
+static float read_float(const char* data)
+{
+  const quint32 bits = qFromLittleEndian<quint32>(data);
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+
+LiveFeed::LiveFeed(QObject* parent)
+: QObject(parent)
+{
+  clock.start();
+  receiver = new LiveFeedReceiver(clock);
+  receiver->moveToThread(&thread);
+  connect(&thread, &QThread::finished, receiver, &QObject::deleteLater);
+  thread.setObjectName("live_feed");
+  thread.start();
+}
+
+LiveFeed::~LiveFeed()
+{
+  close();
+  thread.quit();
+  thread.wait();
+}
+
+bool LiveFeed::listen(
+  const quint16 port,
+  const bool all_interfaces,
+  QString& error)
+{
+  close();
+  bool ok = false;
+  QMetaObject::invokeMethod(
+    receiver,
+    [this, port, all_interfaces, &error, &ok]()
+    {
+      ok = receiver->listen(port, all_interfaces, error);
+    },
+    Qt::BlockingQueuedConnection);
+  _listening = ok;
+  return ok;
+}
+
+void LiveFeed::close()
+{
+  if (!_listening)
+    return;
+  QMetaObject::invokeMethod(
+    receiver,
+    [this]() { receiver->close(); },
+    Qt::BlockingQueuedConnection);
+  _listening = false;
+}
+
+void LiveFeed::take_updates(vector<Pose>& poses)
+{
+  poses.clear();
+  std::unordered_map<string, Pose> updates;
+  {
+    std::lock_guard<std::mutex> lock(receiver->mutex);
+    updates.swap(receiver->pending);
+  }
+  poses.reserve(updates.size());
+  for (auto& it : updates)
+    poses.push_back(std::move(it.second));
+}
+
+quint64 LiveFeed::num_messages() const
+{
+  return receiver->num_messages.load();
+}
+
+quint64 LiveFeed::num_bad_datagrams() const
+{
+  return receiver->num_bad_datagrams.load();
+}
+
+bool LiveFeed::parse_datagram(
+  const char* data,
+  const std::size_t size,
+  vector<Pose>& poses)
+{
+  if (size < MAGIC_SIZE || std::memcmp(data, MAGIC, MAGIC_SIZE) != 0)
+    return false;
+
+  std::size_t offset = MAGIC_SIZE;
+  while (offset < size)
+  {
+    if (size - offset < FIXED_SIZE)
+      return false;
+    const float x = read_float(data + offset);
+    const float y = read_float(data + offset + sizeof(float));
+    const float yaw = read_float(data + offset + 2 * sizeof(float));
+    offset += 3 * sizeof(float);
+    const std::size_t robot_len = static_cast<unsigned char>(data[offset]);
+    const std::size_t fleet_len = static_cast<unsigned char>(data[offset + 1]);
+    const std::size_t level_len = static_cast<unsigned char>(data[offset + 2]);
+    offset += 3;
+    if (size - offset < robot_len + fleet_len + level_len)
+      return false;
+
+    Pose pose;
+    pose.x = x;
+    pose.y = y;
+    pose.yaw = yaw;
+    pose.robot.assign(data + offset, robot_len);
+    offset += robot_len;
+    pose.fleet.assign(data + offset, fleet_len);
+    offset += fleet_len;
+    pose.level.assign(data + offset, level_len);
+    offset += level_len;
+    poses.push_back(std::move(pose));
+  }
+  return true;
+}
+
+LiveFeedReceiver::LiveFeedReceiver(const QElapsedTimer& _clock)
+: clock(_clock)
+{
+}
+
+bool LiveFeedReceiver::listen(
+  const quint16 port,
+  const bool all_interfaces,
+  QString& error)
+{
+  close();
+  socket = new QUdpSocket(this);
+  const QHostAddress address =
+    all_interfaces ? QHostAddress(QHostAddress::Any) :
+    QHostAddress(QHostAddress::LocalHost);
+  if (!socket->bind(address, port))
+  {
+    error = socket->errorString();
+    delete socket;
+    socket = nullptr;
+    return false;
+  }
+  connect(
+    socket, &QUdpSocket::readyRead,
+    this, &LiveFeedReceiver::read_datagrams);
+  return true;
+}
+
+void LiveFeedReceiver::close()
+{
+  delete socket;
+  socket = nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  pending.clear();
+}
+
+void LiveFeedReceiver::read_datagrams()
+{
+  // parse everything that's waiting first, then take the lock just once
+  poses.clear();
+  while (socket && socket->hasPendingDatagrams())
+  {
+    const qint64 size = socket->pendingDatagramSize();
+    buffer.resize(static_cast<std::size_t>(std::max<qint64>(size, 1)));
+    const qint64 n = socket->readDatagram(buffer.data(), buffer.size());
+    if (n < 0)
+      break;
+    if (!LiveFeed::parse_datagram(buffer.data(), n, poses))
+      num_bad_datagrams++;
+  }
+  if (poses.empty())
+    return;
+  num_messages += poses.size();
+
+  const qint64 now = clock.elapsed();
+  std::lock_guard<std::mutex> lock(mutex);
+  for (LiveFeed::Pose& pose : poses)
+  {
+    key.assign(pose.fleet);
+    key.push_back('\0');
+    key.append(pose.robot);
+    pose.received_msec = now;
+    pending[key] = std::move(pose);
+  }
+}
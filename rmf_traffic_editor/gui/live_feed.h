@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef LIVE_FEED_H
+#define LIVE_FEED_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+class LiveFeedReceiver;
+class QUdpSocket;
+
+/*
+ * Listens for robot poses on a local UDP port, so that robots can be
+ * watched live on top of the map. Each datagram is the 4 bytes "RPOS"
+ * followed by any number of pose messages, back to back:
+ *
+ *   float32  x (meters)
+ *   float32  y (meters)
+ *   float32  yaw (radians)
+ *   uint8    length of the robot name
+ *   uint8    length of the fleet name
+ *   uint8    length of the level name
+ *   the robot, fleet and level names (UTF-8, not terminated)
+ *
+ * All numbers are little-endian. The poses are in the same frame as the
+ * pose logs (see TrafficHeatmap), and an empty level name means "any
+ * level". scripts/publish_test_poses.py publishes made-up robots.
+ *
+ * Datagrams are received and parsed on a thread of their own, which only
+ * keeps the latest pose of each robot, so however fast they arrive the
+ * GUI thread only sees as many updates as it asks for.
+ *
+ * Anything that can reach the port can move the markers, so by default
+ * only datagrams sent from this machine are received.
+ */
+
+class LiveFeed : public QObject
+{
+  Q_OBJECT
+
+public:
+  struct Pose
+  {
+    std::string robot;
+    std::string fleet;
+    std::string level;
+    double x = 0.0;
+    double y = 0.0;
+    double yaw = 0.0;
+    qint64 received_msec = 0;  // by the clock of now_msec()
+  };
+
+  LiveFeed(QObject* parent = nullptr);
+  ~LiveFeed();  // stops listening
+
+  // listens on the loopback interface only, unless all_interfaces is set
+  bool listen(
+    const quint16 port,
+    const bool all_interfaces,
+    QString& error);
+  void close();
+  bool listening() const { return _listening; }
+
+  // the latest pose of each robot heard from since the previous call
+  void take_updates(std::vector<Pose>& poses);
+
+  qint64 now_msec() const { return clock.elapsed(); }
+  quint64 num_messages() const;
+  quint64 num_bad_datagrams() const;
+
+  // appends the poses in a datagram, or returns false if it's malformed
+  // (the poses before the problem are still appended)
+  static bool parse_datagram(
+    const char* data,
+    const std::size_t size,
+    std::vector<Pose>& poses);
+
+private:
+  QThread thread;
+  LiveFeedReceiver* receiver = nullptr;
+  QElapsedTimer clock;
+  bool _listening = false;
+};
+
+// lives on the feed's thread
+class LiveFeedReceiver : public QObject
+{
+  Q_OBJECT
+
+public:
+  LiveFeedReceiver(const QElapsedTimer& clock);
+
+  bool listen(
+    const quint16 port,
+    const bool all_interfaces,
+    QString& error);
+  void close();
+
+  std::mutex mutex;
+  std::unordered_map<std::string, LiveFeed::Pose> pending;  // by robot
+  std::atomic<quint64> num_messages {0};
+  std::atomic<quint64> num_bad_datagrams {0};
+
+private:
+  const QElapsedTimer& clock;
+  QUdpSocket* socket = nullptr;
+  std::vector<char> buffer;
+  std::vector<LiveFeed::Pose> poses;  // reused for each datagram
+  std::string key;
+
+private slots:
+  void read_datagrams();
+};
+
+#endif
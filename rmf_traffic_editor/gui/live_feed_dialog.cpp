@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <QtWidgets>
+
+#include "live_feed_dialog.h"
+
+static const quint16 DEFAULT_PORT = 47474;
+
+static const int FRAME_MSEC = 16;
+static const int STATUS_MSEC = 500;
+
+// robot markers are drawn this big
+static const double MARKER_RADIUS_METERS = 0.35;
+
+
+LiveFeedDialog::LiveFeedDialog(
+  QWidget* parent,
+  Building& _building,
+  const int _level_idx)
+: QDialog(parent),
+  building(_building),
+  level_idx(_level_idx)
+{
+  setWindowTitle("Live Robot Poses");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  listen_button = new QPushButton("Listen", this);  // first = [enter] button
+  listen_button->setCheckable(true);
+  close_button = new QPushButton("Close", this);
+
+  QHBoxLayout* port_hbox = new QHBoxLayout;
+  port_hbox->addWidget(new QLabel("UDP port:"));
+  port_spin_box = new QSpinBox(this);
+  port_spin_box->setRange(1, 65535);
+  port_spin_box->setValue(DEFAULT_PORT);
+  port_hbox->addWidget(port_spin_box, 1);
+  port_hbox->addWidget(listen_button);
+  connect(
+    listen_button, &QAbstractButton::toggled,
+    this, &LiveFeedDialog::listen_button_toggled);
+
+  // off by default: anyone who can reach the port can move the markers
+  all_interfaces_checkbox = new QCheckBox(
+    "Also accept poses from other machines (unauthenticated)",
+    this);
+  all_interfaces_checkbox->setChecked(false);
+
+  QHBoxLayout* stale_hbox = new QHBoxLayout;
+  stale_hbox->addWidget(new QLabel("Hide robots not heard from for (s):"));
+  stale_spin_box = new QDoubleSpinBox(this);
+  stale_spin_box->setDecimals(1);
+  stale_spin_box->setRange(0.1, 600.0);
+  stale_spin_box->setValue(3.0);
+  stale_hbox->addWidget(stale_spin_box);
+
+  status_label = new QLabel("Not listening", this);
+  status_label->setWordWrap(true);
+
+  frame_timer.setInterval(FRAME_MSEC);
+  connect(&frame_timer, &QTimer::timeout, this, &LiveFeedDialog::frame_tick);
+  status_timer.setInterval(STATUS_MSEC);
+  connect(
+    &status_timer, &QTimer::timeout,
+    this, &LiveFeedDialog::status_tick);
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addStretch(1);
+  bottom_buttons_hbox->addWidget(close_button);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(port_hbox);
+  top_vbox->addWidget(all_interfaces_checkbox);
+  top_vbox->addLayout(stale_hbox);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+  resize(450, 150);
+}
+
+LiveFeedDialog::~LiveFeedDialog()
+{
+}
+
+void LiveFeedDialog::closeEvent(QCloseEvent* event)
+{
+  frame_timer.stop();
+  status_timer.stop();
+  feed.close();
+  emit markers_changed(level_idx, std::vector<RobotMarkersItem::Marker>());
+  QDialog::closeEvent(event);
+}
+
+void LiveFeedDialog::listen_button_toggled(bool checked)
+{
+  robots.clear();
+  update_markers();
+
+  if (!checked)
+  {
+    frame_timer.stop();
+    status_timer.stop();
+    feed.close();
+    port_spin_box->setEnabled(true);
+    all_interfaces_checkbox->setEnabled(true);
+    listen_button->setText("Listen");
+    status_label->setText("Not listening");
+    return;
+  }
+
+  QString error;
+  const quint16 port = static_cast<quint16>(port_spin_box->value());
+  const bool all_interfaces = all_interfaces_checkbox->isChecked();
+  if (!feed.listen(port, all_interfaces, error))
+  {
+    QMessageBox::warning(
+      this,
+      "Live Robot Poses",
+      QString("Couldn't listen on UDP port %1: %2").arg(port).arg(error));
+    listen_button->setChecked(false);
+    return;
+  }
+
+  meters_to_level = building.meters_to_level(level_idx);
+  last_num_messages = feed.num_messages();
+  port_spin_box->setEnabled(false);
+  all_interfaces_checkbox->setEnabled(false);
+  listen_button->setText("Stop");
+  status_label->setText(
+    QString("Listening on UDP port %1 (%2)")
+    .arg(port)
+    .arg(all_interfaces ? "all interfaces" : "this machine only"));
+  frame_timer.start();
+  status_timer.start();
+}
+
+void LiveFeedDialog::frame_tick()
+{
+  feed.take_updates(updates);
+  bool changed = !updates.empty();
+  for (LiveFeed::Pose& pose : updates)
+  {
+    std::string key(pose.fleet);
+    key.push_back('\0');
+    key.append(pose.robot);
+    robots[key] = std::move(pose);
+  }
+
+  const qint64 stale_msec =
+    static_cast<qint64>(stale_spin_box->value() * 1000.0);
+  const qint64 now = feed.now_msec();
+  for (auto it = robots.begin(); it != robots.end(); )
+  {
+    if (now - it->second.received_msec > stale_msec)
+    {
+      it = robots.erase(it);
+      changed = true;
+    }
+    else
+      ++it;
+  }
+
+  if (changed)
+    update_markers();
+}
+
+void LiveFeedDialog::update_markers()
+{
+  if (level_idx >= static_cast<int>(building.levels.size()))
+    return;
+  const Level& level = building.levels[level_idx];
+
+  const double mpp = level.drawing_meters_per_pixel;
+  const double radius = MARKER_RADIUS_METERS / (mpp > 0.0 ? mpp : 1.0);
+  std::vector<RobotMarkersItem::Marker> markers;
+  markers.reserve(robots.size());
+  for (const auto& it : robots)
+  {
+    const LiveFeed::Pose& pose = it.second;
+    if (!pose.level.empty() && pose.level != level.name)
+      continue;
+    const std::string& color_name =
+      pose.fleet.empty() ? pose.robot : pose.fleet;
+    auto color_it = fleet_colors.find(color_name);
+    if (color_it == fleet_colors.end())
+      color_it = fleet_colors.emplace(
+        color_name,
+        RobotMarkersItem::color_for(color_name)).first;
+    markers.push_back(
+      RobotMarkersItem::marker_at(
+        meters_to_level,
+        pose.x,
+        pose.y,
+        pose.yaw,
+        radius,
+        color_it->second));
+  }
+  emit markers_changed(level_idx, markers);
+}
+
+void LiveFeedDialog::status_tick()
+{
+  const quint64 num_messages = feed.num_messages();
+  const double rate =
+    (num_messages - last_num_messages) * 1000.0 / STATUS_MSEC;
+  last_num_messages = num_messages;
+
+  QString status = QString("Listening on UDP port %1: %2 robots, %3 poses/s")
+    .arg(port_spin_box->value())
+    .arg(robots.size())
+    .arg(rate, 0, 'f', 0);
+  const quint64 num_bad = feed.num_bad_datagrams();
+  if (num_bad > 0)
+    status += QString(", %1 malformed datagrams").arg(num_bad);
+  status_label->setText(status);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef LIVE_FEED_DIALOG_H
+#define LIVE_FEED_DIALOG_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QDialog>
+#include <QObject>
+#include <QTimer>
+#include <QTransform>
+
+#include "building.h"
+#include "live_feed.h"
+#include "robot_markers_item.h"
+class QCheckBox;
+class QDoubleSpinBox;
+class QLabel;
+class QSpinBox;
+
+
+class LiveFeedDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  LiveFeedDialog(
+    QWidget* parent,
+    Building& building,
+    const int level_idx);
+  ~LiveFeedDialog();  // stops listening
+
+protected:
+  void closeEvent(QCloseEvent* event) override;
+
+private:
+  Building& building;
+  int level_idx = 0;
+
+  LiveFeed feed;
+  QTransform meters_to_level;
+  std::map<std::string, LiveFeed::Pose> robots;  // by fleet\0robot
+  std::vector<LiveFeed::Pose> updates;
+  std::map<std::string, QColor> fleet_colors;
+
+  // however fast poses arrive, the markers are redrawn once per frame
+  QTimer frame_timer;
+  QTimer status_timer;
+  quint64 last_num_messages = 0;
+
+  QSpinBox* port_spin_box;
+  QPushButton* listen_button;
+  QCheckBox* all_interfaces_checkbox;
+  QDoubleSpinBox* stale_spin_box;
+  QLabel* status_label;
+  QPushButton* close_button;
+
+  void update_markers();
+
+private slots:
+  void listen_button_toggled(bool checked);
+  void frame_tick();
+  void status_tick();
+
+signals:
+  void markers_changed(
+    const int level_idx,
+    const std::vector<RobotMarkersItem::Marker>& markers);
+};
+
+#endif
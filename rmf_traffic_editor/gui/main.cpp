@@ -15,6 +15,8 @@
  *
 */
 
+#include <cstring>
+#include <memory>
 #include <string>
 
 #include <QSettings>
@@ -22,24 +24,72 @@
 
 #include "glog/logging.h"
 
+#include "building_diff.h"
 #include "editor.h"
 #include "preferences_keys.h"
 
 
+// Prints the differences between two revisions of a building, and returns
+// 0 if there aren't any, 1 if there are, or 2 if they couldn't be loaded.
+static int print_building_diff(
+  const QString& before_filename,
+  const QString& after_filename)
+{
+  // loading changes the working directory, so resolve both paths first
+  const std::string before_path =
+    QFileInfo(before_filename).absoluteFilePath().toStdString();
+  const std::string after_path =
+    QFileInfo(after_filename).absoluteFilePath().toStdString();
+
+  Building before, after;
+  if (!before.load(before_path, false) || !after.load(after_path, false))
+    return 2;
+
+  BuildingDiff diff;
+  diff.compute(before, after);
+  diff.print(stdout);
+  return diff.identical() ? 0 : 1;
+}
+
 int main(int argc, char* argv[])
 {
   google::InitGoogleLogging(argv[0]);  // used later by Ceres
 
-  QApplication app(argc, argv);
-  app.setOrganizationName("open-robotics");
-  app.setOrganizationDomain("openrobotics.org");
-  app.setApplicationName("traffic-editor");
+  // comparing revisions doesn't open a window, so it mustn't need a display
+  bool headless = false;
+  for (int i = 1; i < argc; i++)
+    if (!strncmp(argv[i], "--diff", 6))
+      headless = true;
+  std::unique_ptr<QCoreApplication> app(
+    headless ?
+    new QCoreApplication(argc, argv) :
+    new QApplication(argc, argv));
+  app->setOrganizationName("open-robotics");
+  app->setOrganizationDomain("openrobotics.org");
+  app->setApplicationName("traffic-editor");
 
   QCommandLineParser parser;
   parser.addHelpOption();
   parser.addPositionalArgument("[building]", "Building YAML file to open");
+  parser.addOption(
+    QCommandLineOption(
+      "diff",
+      "Print how [building] differs from an earlier revision, and exit.",
+      "earlier building"));
   parser.process(QCoreApplication::arguments());
 
+  if (parser.isSet("diff"))
+  {
+    if (parser.positionalArguments().isEmpty())
+    {
+      printf("--diff needs a building to compare with the earlier one\n");
+      return 2;
+    }
+    return print_building_diff(
+      parser.value("diff"),
+      parser.positionalArguments().at(0));
+  }
+
   Editor editor;
   QSettings settings;
 
@@ -58,5 +108,5 @@ int main(int argc, char* argv[])
   // after the editor.show() is called
   editor.restore_previous_viewport();
 
-  return app.exec();
+  return app->exec();
 }
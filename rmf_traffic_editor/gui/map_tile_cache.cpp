@@ -17,16 +17,24 @@
 
 #include <QDir>
 #include <QDirIterator>
-#include <QSaveFile>
+#include <QFile>
 #include <QStandardPaths>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
 #include "map_tile_cache.h"
 
-MapTileCache::MapTileCache()
+// how long the writer waits after the first tile of a batch is queued,
+// so that the rest of a burst of tiles goes out in the same batch
+static const int BATCH_DELAY_MS = 250;
+
+MapTileCache::MapTileCache(const QString& subdirectory)
 {
   tile_cache_root =
     QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
     + QDir::separator()
     + QString("tiles");
+  if (!subdirectory.isEmpty())
+    tile_cache_root += QDir::separator() + subdirectory;
   printf("tile_cache_root: %s\n", tile_cache_root.toStdString().c_str());
   QDir tile_cache_dir(tile_cache_root);
   if (!tile_cache_dir.exists())
@@ -35,11 +43,15 @@ MapTileCache::MapTileCache()
       tile_cache_root.toStdString().c_str());
     QDir::root().mkpath(tile_cache_root);
   }
+  writer_pool.setMaxThreadCount(1);
   getSize();
 }
 
 MapTileCache::~MapTileCache()
 {
+  // finish any scheduled batch, then write whatever is still queued
+  writer_pool.waitForDone();
+  flush();
 }
 
 std::optional<const QByteArray> MapTileCache::get(
@@ -48,6 +60,13 @@ std::optional<const QByteArray> MapTileCache::get(
   const int y) const
 {
   QString path = tile_path(zoom, x, y);
+  {
+    QMutexLocker locker(&pending_mutex);
+    auto it = pending.constFind(path);
+    if (it != pending.constEnd())
+      return {it->bytes};
+  }
+
   QFile file(path);
   if (!file.open(QIODevice::ReadOnly))
   {
@@ -64,14 +83,24 @@ void MapTileCache::set(
   const int y,
   const QByteArray& bytes)
 {
-  QString path = tile_path(zoom, x, y);
-  printf("cache write to %s\n", path.toStdString().c_str());
-  QSaveFile save_file(path);
-  save_file.open(QIODevice::WriteOnly);
-  save_file.write(bytes);
-  save_file.commit();
+  const QString path = tile_path(zoom, x, y);
+
+  QMutexLocker locker(&pending_mutex);
+  PendingWrite& entry = pending[path];  // replaces any queued bytes
+  entry.bytes = bytes;
+  entry.generation = next_generation++;
 
-  modified_since_last_size_check = true;
+  if (!flush_scheduled)
+  {
+    flush_scheduled = true;
+    QtConcurrent::run(
+      &writer_pool,
+      [this]()
+      {
+        QThread::msleep(BATCH_DELAY_MS);
+        flush();
+      });
+  }
   /*
   for (auto it = cache.begin(); it != cache.end(); ++it)
   {
@@ -103,6 +132,68 @@ void MapTileCache::set(
   */
 }
 
+std::size_t MapTileCache::pending_bytes() const
+{
+  QMutexLocker locker(&pending_mutex);
+  std::size_t bytes = 0;
+  for (auto it = pending.constBegin(); it != pending.constEnd(); ++it)
+    bytes += it->bytes.size();
+  return bytes;
+}
+
+void MapTileCache::flush()
+{
+  QHash<QString, PendingWrite> batch;
+  {
+    QMutexLocker locker(&pending_mutex);
+    batch = pending;  // implicitly shared, so this doesn't copy the tiles
+    flush_scheduled = false;
+  }
+  if (batch.isEmpty())
+    return;
+
+  // Write to a temporary file and rename it into place, so a reader never
+  // sees a partial tile. Unlike QSaveFile this doesn't fsync every tile:
+  // it's only a cache, and if a crash loses a tile it'll be fetched again.
+  int num_written = 0;
+  for (auto it = batch.constBegin(); it != batch.constEnd(); ++it)
+  {
+    const QString temp_path = it.key() + QString(".part");
+    QFile file(temp_path);
+    if (!file.open(QIODevice::WriteOnly) ||
+      file.write(it->bytes) != it->bytes.size())
+    {
+      printf("couldn't write tile cache file %s\n",
+        temp_path.toStdString().c_str());
+      file.remove();
+      continue;
+    }
+    file.close();
+    QFile::remove(it.key());
+    if (!QFile::rename(temp_path, it.key()))
+    {
+      QFile::remove(temp_path);
+      continue;
+    }
+    num_written++;
+  }
+
+  {
+    // only forget tiles which weren't set again while we were writing
+    QMutexLocker locker(&pending_mutex);
+    for (auto it = batch.constBegin(); it != batch.constEnd(); ++it)
+    {
+      auto pending_it = pending.find(it.key());
+      if (pending_it != pending.end() &&
+        pending_it->generation == it->generation)
+        pending.erase(pending_it);
+    }
+  }
+
+  if (num_written > 0)
+    modified_since_last_size_check = true;
+}
+
 QString MapTileCache::tile_path(int zoom, int x, int y) const
 {
   // sanitize the input...
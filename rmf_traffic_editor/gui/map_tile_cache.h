@@ -18,15 +18,29 @@
 #ifndef TRAFFIC_EDITOR_MAP_TILE_CACHE_H
 #define TRAFFIC_EDITOR_MAP_TILE_CACHE_H
 
+#include <atomic>
 #include <deque>
 #include <optional>
 
+#include <QHash>
+#include <QMutex>
 #include <QPixmap>
+#include <QThreadPool>
+
+/*
+ * On-disk cache of map tiles. Writes are queued and done in batches by a
+ * background thread, so that a burst of arriving tiles (e.g. a fast zoom
+ * out) doesn't stall the GUI thread on disk I/O. Queued tiles are served
+ * from memory until they have been written, and a tile which is set again
+ * before its batch is written is only written once.
+ */
 
 class MapTileCache
 {
 public:
-  MapTileCache();
+  // tiles from sources other than the default tile server (e.g. tiles
+  // rendered from vector tiles) are kept in a subdirectory of the cache
+  MapTileCache(const QString& subdirectory = QString());
   ~MapTileCache();
 
   std::optional<const QByteArray> get(
@@ -48,6 +62,8 @@ public:
 
   CacheSize getSize();
 
+  std::size_t pending_bytes() const;  // queued but not yet written
+
 private:
   /*
   struct MapTileCacheElement
@@ -69,8 +85,25 @@ private:
     int x,
     int y) const;
 
-  bool modified_since_last_size_check = true;  // for an initial size check
+  // for an initial size check
+  std::atomic<bool> modified_since_last_size_check {true};
   CacheSize last_size = {0, 0};
+
+  // tiles waiting to be written, by path. The generation distinguishes a
+  // tile which was set again while its previous bytes were being written.
+  struct PendingWrite
+  {
+    QByteArray bytes;
+    quint64 generation = 0;
+  };
+  QHash<QString, PendingWrite> pending;
+  quint64 next_generation = 0;
+  bool flush_scheduled = false;
+  mutable QMutex pending_mutex;
+
+  QThreadPool writer_pool;  // a single thread, so batches never overlap
+
+  void flush();
 };
 
 #endif
@@ -20,22 +20,16 @@
 #include <QGraphicsColorizeEffect>
 #include <QLabel>
 #include <QScrollBar>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
+#include <QSettings>
 #include "map_view.h"
-
-using std::string;
+#include "preferences_keys.h"
 
 MapView::MapView(QWidget* parent, const Building& building_)
 : QGraphicsView(parent),
   building(building_)
 {
-  network = new QNetworkAccessManager(this);
-  connect(
-    network,
-    &QNetworkAccessManager::finished,
-    this,
-    &MapView::request_finished);
+  QSettings settings;
+  set_tile_source(settings.value(preferences_keys::tile_source).toString());
 
   setMouseTracking(true);
   viewport()->setMouseTracking(true);
@@ -171,6 +165,23 @@ void MapView::mouseMoveEvent(QMouseEvent* e)
   e->ignore();
 }
 
+void MapView::keyPressEvent(QKeyEvent* e)
+{
+  // the editor nudges the selection with the arrow keys (or scrolls, if
+  // nothing is selected), so don't let the scroll area take them
+  switch (e->key())
+  {
+    case Qt::Key_Left:
+    case Qt::Key_Right:
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+      e->ignore();
+      return;
+    default:
+      QGraphicsView::keyPressEvent(e);
+  }
+}
+
 void MapView::resizeEvent(QResizeEvent*)
 {
   draw_tiles();
@@ -240,7 +251,7 @@ void MapView::draw_tiles()
   // printf("  zoom_exact: %.3f\n", zoom_exact);
 
   int zoom = static_cast<int>(ceil(zoom_exact));
-  const int MAX_ZOOM = 20;
+  const int MAX_ZOOM = tile_provider->max_zoom();
   if (zoom < 0)
     zoom = 0;
   if (zoom > MAX_ZOOM)
@@ -327,82 +338,25 @@ void MapView::draw_tiles()
       if (found)
         continue;
 
-      // printf("creating tile item zoom=%d, x=%d, y=%d)\n", zoom, x, y);
-      std::optional<const QByteArray> p = tile_cache.get(zoom, x, y);
-      if (p.has_value())
-      {
-        //printf("  HOORAY found the pixmap\n");
-        QImage image;
-        bool parse_ok = image.loadFromData(p.value());
-        if (parse_ok)
-        {
-          QPixmap pixmap(QPixmap::fromImage(image.convertToFormat(
-              QImage::Format_Grayscale8)));
+      // create a dummy image while waiting for the tile provider
+      QImage image(256, 256, QImage::Format_RGB888);
+      image.fill(qRgb(255, 255, 0));
 
-          render_tile(zoom, x, y, pixmap, MapTilePixmapItem::State::COMPLETED);
-        }
-        else
-        {
-          printf("oh no! couldn't parse image file in cache\n");
-        }
-      }
-      else
-      {
-        // create a dummy image while waiting for the server
-        QImage image(256, 256, QImage::Format_RGB888);
-        image.fill(qRgb(255, 255, 0));
-
-        QPainter painter;
-        painter.begin(&image);
-        painter.setPen(QPen(Qt::red));
-        QString label;
-        label.sprintf("%d (%d,%d)", zoom, x, y);
-        painter.drawText(10, 10, 245, 100, Qt::AlignLeft, label);
-        painter.end();
-        QPixmap pixmap(QPixmap::fromImage(image));
-
-        render_tile(zoom, x, y, pixmap, MapTilePixmapItem::State::QUEUED);
-      }
+      QPainter painter;
+      painter.begin(&image);
+      painter.setPen(QPen(Qt::red));
+      QString label;
+      label.sprintf("%d (%d,%d)", zoom, x, y);
+      painter.drawText(10, 10, 245, 100, Qt::AlignLeft, label);
+      painter.end();
+      QPixmap pixmap(QPixmap::fromImage(image));
+
+      render_tile(zoom, x, y, pixmap, MapTilePixmapItem::State::QUEUED);
     }
   }
   process_request_queue();
 }
 
-void MapView::request_tile(const int zoom, const int x, const int y)
-{
-  static int s_num_requests = 0;
-
-  s_num_requests++;
-
-  if (s_num_requests <= 2000)
-  {
-    printf("  requesting tile %d: zoom=%d, x=%d, y=%d\n",
-      s_num_requests,
-      zoom,
-      x,
-      y);
-
-    QString request_url;
-    request_url.sprintf(
-      "https://tiles.sandbox.open-rmf.org/tile/%d/%d/%d.png",
-      zoom,
-      x,
-      y);
-    QNetworkRequest request;
-    request.setUrl(QUrl(request_url));
-    request.setRawHeader(
-      "User-Agent",
-      "TrafficEditor/1.4 (http://open-rmf.org)");
-    network->get(request);
-  }
-  else
-  {
-    printf("past max number of requests this run (%d)..."
-      "in case this is a wild bug, I'm stopping now!\n",
-      s_num_requests);
-  }
-}
-
 void MapView::render_tile(
   const int zoom,
   const int tile_x,
@@ -449,75 +403,71 @@ void MapView::render_tile(
   tile_pixmap_items.push_back(item);
 }
 
-void MapView::request_finished(QNetworkReply* reply)
+void MapView::set_tile_source(const QString& source)
 {
-  /*
-  printf("mapview::request_finished()\n");
-  printf("  request url: %s\n",
-    reply->request().url().path().toStdString().c_str());
-  */
-  const string url(reply->request().url().path().toStdString());
-  if (url.size() < 10)
-    return;
-  const size_t zoom_start = 6;
-  const size_t zoom_end = url.find('/', zoom_start);
-  if (zoom_end == string::npos)
-    return;
-  const string zoom_str = url.substr(zoom_start, zoom_end - zoom_start);
+  for (auto& item : tile_pixmap_items)
+  {
+    if (item.item->scene())
+      item.item->scene()->removeItem(item.item);
+    delete item.item;
+  }
+  tile_pixmap_items.clear();
 
-  const size_t x_start = zoom_end + 1;
-  if (x_start >= url.size())
-    return;
-  const size_t x_end = url.find('/', x_start);
-  const string x_str = url.substr(x_start, x_end - x_start);
+  delete tile_provider;
+  tile_provider = TileProvider::create(source, tile_cache, this);
+  printf("tile source: %s\n",
+    tile_provider->description().toStdString().c_str());
 
-  const size_t y_start = x_end + 1;
-  if (y_start >= url.size())
-    return;
-  const size_t y_end = url.find('.', y_start);
-  const string y_str = url.substr(y_start, y_end - y_start);
-
-  const int zoom = std::stoi(zoom_str);
-  const int x = std::stoi(x_str);
-  const int y = std::stoi(y_str);
-
-  QByteArray bytes = reply->readAll();
-  printf("received %d-byte tile: zoom=%d x=%d y=%d\n",
-    bytes.length(),
-    zoom,
-    x,
-    y);
-
-  QImage image;
-  bool parse_ok = image.loadFromData(bytes);
-  if (parse_ok)
+  // queue the results even if a provider answers right away, so the
+  // request queue is never modified while it's being processed
+  connect(
+    tile_provider,
+    &TileProvider::tile_ready,
+    this,
+    &MapView::tile_ready,
+    Qt::QueuedConnection);
+  connect(
+    tile_provider,
+    &TileProvider::tile_failed,
+    this,
+    &MapView::tile_failed,
+    Qt::QueuedConnection);
+
+  if (scene())
+    draw_tiles();
+}
+
+void MapView::tile_ready(int zoom, int x, int y, QImage image)
+{
+  // find the placeholder pixmapitem and update its pixmap
+  for (auto& item : tile_pixmap_items)
   {
-    QPixmap pixmap(QPixmap::fromImage(image.convertToFormat(
-        QImage::Format_Grayscale8)));
-    tile_cache.set(zoom, x, y, bytes);
-    // find the placeholder pixmapitem and update its pixmap
-    for (auto& item : tile_pixmap_items)
+    if (item.x == x && item.y == y && item.zoom == zoom)
     {
-      if (item.x == x && item.y == y && item.zoom == zoom)
-      {
-        item.item->setPixmap(pixmap);
-        item.item->setGraphicsEffect(nullptr);
-        item.state = MapTilePixmapItem::State::COMPLETED;
-        break;
-      }
+      item.item->setPixmap(QPixmap::fromImage(image));
+      item.item->setGraphicsEffect(nullptr);
+      item.state = MapTilePixmapItem::State::COMPLETED;
+      break;
     }
   }
-  else
-  {
-    printf("  unable to parse\n");
-  }
 
   // Now that this request is completed, we can issue the next request
   // in the queue.
   process_request_queue();
+}
 
-  // schedule this reply object for deletion (eventually)
-  reply->deleteLater();
+void MapView::tile_failed(int zoom, int x, int y)
+{
+  // leave the placeholder up, but stop waiting for it
+  for (auto& item : tile_pixmap_items)
+  {
+    if (item.x == x && item.y == y && item.zoom == zoom)
+    {
+      item.state = MapTilePixmapItem::State::COMPLETED;
+      break;
+    }
+  }
+  process_request_queue();
 }
 
 void MapView::clear()
@@ -537,6 +487,18 @@ void MapView::update_cache_size_label(QLabel* label)
     .arg(size.bytes / 1.0e6, 0, 'g', 3));
 }
 
+std::size_t MapView::tile_bytes() const
+{
+  std::size_t bytes = tile_cache.pending_bytes();
+  for (const auto& tile : tile_pixmap_items)
+  {
+    const QPixmap pixmap = tile.item->pixmap();
+    bytes += static_cast<std::size_t>(pixmap.width()) * pixmap.height() *
+      pixmap.depth() / 8;
+  }
+  return bytes;
+}
+
 void MapView::process_request_queue()
 {
   int n_requested = 0;
@@ -549,19 +511,14 @@ void MapView::process_request_queue()
 
   for (auto& tile : tile_pixmap_items)
   {
-    // todo: tune this, or allow it to be a user-configurable parameter.
-    // It seems to behave fairly nicely with a cap at just one
-    // request in flight, but that may vary depending on server load
-    // and latency.
-    const int MAX_REQUESTS = 1;
-    if (n_requested >= MAX_REQUESTS)
+    if (n_requested >= tile_provider->max_requests_in_flight())
       break;
 
     // since we have less than N requests outstanding, let's request
     // some more tiles
     if (tile.state == MapTilePixmapItem::State::QUEUED)
     {
-      request_tile(tile.zoom, tile.x, tile.y);
+      tile_provider->request(tile.zoom, tile.x, tile.y);
       tile.state = MapTilePixmapItem::State::REQUESTED;
 
       QGraphicsColorizeEffect* colorize = new QGraphicsColorizeEffect;
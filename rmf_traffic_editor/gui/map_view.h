@@ -26,9 +26,8 @@
 
 #include "building.h"
 #include "map_tile_cache.h"
+#include "tile_provider.h"
 
-class QNetworkAccessManager;
-class QNetworkReply;
 class QLabel;
 
 class MapView : public QGraphicsView
@@ -45,7 +44,10 @@ public:
   void draw_tiles();
   void clear();
   void update_cache_size_label(QLabel* label);
+  // of the tiles in the scene, and those waiting to be written to disk
+  std::size_t tile_bytes() const;
   QPointF get_center() { return last_center; }
+  void set_tile_source(const QString& source);
 
 protected:
   void wheelEvent(QWheelEvent* event);
@@ -53,6 +55,7 @@ protected:
   void mousePressEvent(QMouseEvent* e);
   void mouseReleaseEvent(QMouseEvent* e);
   void resizeEvent(QResizeEvent* e);
+  void keyPressEvent(QKeyEvent* e);
 
 private:
   bool is_panning = false;
@@ -63,6 +66,7 @@ private:
   bool show_tiles = false;  // ignore first few resize events during startup
 
   MapTileCache tile_cache;
+  TileProvider* tile_provider = nullptr;
 
   struct MapTilePixmapItem
   {
@@ -89,10 +93,6 @@ private:
   };
   std::vector<MapTileRequest> tile_requests;
 
-  QNetworkAccessManager* network = nullptr;
-
-  void request_tile(const int zoom, const int x, const int y);
-
   void render_tile(
     const int zoom,
     const int x,
@@ -100,7 +100,8 @@ private:
     const QPixmap& pixmap,
     const MapTilePixmapItem::State state);
 
-  void request_finished(QNetworkReply* reply);
+  void tile_ready(int zoom, int x, int y, QImage image);
+  void tile_failed(int zoom, int x, int y);
   QPointF last_center;
 
   void process_request_queue();
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <sqlite3.h>
+
+#include <QBuffer>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
+
+#include "mbtiles_tile_provider.h"
+
+
+MBTilesTileProvider::MBTilesTileProvider(
+  QObject* parent,
+  const QString& _filename)
+: TileProvider(parent),
+  filename(_filename)
+{
+  valid = read_metadata();
+  if (!valid || !is_vector)
+    return;
+
+  const QFileInfo info(filename);
+  const QString style_filename =
+    info.absolutePath() + "/" + info.completeBaseName() + ".style.yaml";
+  if (QFileInfo(style_filename).exists() &&
+    renderer.load_style(style_filename.toStdString()))
+    printf("  using tile style %s\n", style_filename.toStdString().c_str());
+
+  // keep tiles rendered with different styles apart
+  rendered_cache = std::make_unique<MapTileCache>(
+    QString("vector_%1_%2")
+    .arg(info.completeBaseName())
+    .arg(qHash(QString::fromStdString(renderer.style_text)), 8, 16,
+    QChar('0')));
+}
+
+MBTilesTileProvider::~MBTilesTileProvider()
+{
+  stop_workers();
+  for (Connection* connection : connections)
+  {
+    sqlite3_finalize(connection->statement);
+    sqlite3_close(connection->db);
+    delete connection;
+  }
+}
+
+QString MBTilesTileProvider::description() const
+{
+  return name.isEmpty() ? filename : name + " (" + filename + ")";
+}
+
+MBTilesTileProvider::Connection* MBTilesTileProvider::open_connection()
+{
+  // each connection is only ever used by one thread at a time
+  Connection* connection = new Connection;
+  const int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+  if (sqlite3_open_v2(
+      filename.toStdString().c_str(),
+      &connection->db,
+      flags,
+      nullptr) != SQLITE_OK ||
+    sqlite3_prepare_v2(
+      connection->db,
+      "SELECT tile_data FROM tiles "
+      "WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?",
+      -1,
+      &connection->statement,
+      nullptr) != SQLITE_OK)
+  {
+    printf("unable to open MBTiles file %s: %s\n",
+      filename.toStdString().c_str(),
+      sqlite3_errmsg(connection->db));
+    sqlite3_finalize(connection->statement);
+    sqlite3_close(connection->db);
+    delete connection;
+    return nullptr;
+  }
+  return connection;
+}
+
+MBTilesTileProvider::Connection* MBTilesTileProvider::acquire()
+{
+  QMutexLocker locker(&pool_mutex);
+  if (!idle_connections.empty())
+  {
+    Connection* connection = idle_connections.back();
+    idle_connections.pop_back();
+    return connection;
+  }
+
+  // there are never more busy connections than worker threads
+  Connection* connection = open_connection();
+  if (connection)
+    connections.push_back(connection);
+  return connection;
+}
+
+void MBTilesTileProvider::release(Connection* connection)
+{
+  QMutexLocker locker(&pool_mutex);
+  idle_connections.push_back(connection);
+}
+
+bool MBTilesTileProvider::read_metadata()
+{
+  Connection* connection = acquire();
+  if (!connection)
+    return false;
+
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(
+      connection->db,
+      "SELECT name, value FROM metadata",
+      -1,
+      &statement,
+      nullptr) == SQLITE_OK)
+  {
+    while (sqlite3_step(statement) == SQLITE_ROW)
+    {
+      const QString key = QString::fromUtf8(
+        reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+      const QString value = QString::fromUtf8(
+        reinterpret_cast<const char*>(sqlite3_column_text(statement, 1)));
+      if (key == "name")
+        name = value;
+      else if (key == "format")
+        format = value;
+      else if (key == "maxzoom")
+        metadata_max_zoom = value.toInt();
+    }
+  }
+  sqlite3_finalize(statement);
+  release(connection);
+
+  printf("MBTiles file %s: name [%s] format [%s] max zoom %d\n",
+    filename.toStdString().c_str(),
+    name.toStdString().c_str(),
+    format.toStdString().c_str(),
+    metadata_max_zoom);
+
+  is_vector = format == "pbf";
+  return true;
+}
+
+int MBTilesTileProvider::max_zoom() const
+{
+  // vector tiles can be rendered past the deepest level in the archive
+  return is_vector ? TileProvider::max_zoom() : metadata_max_zoom;
+}
+
+void MBTilesTileProvider::request(const int zoom, const int x, const int y)
+{
+  QtConcurrent::run(
+    &thread_pool,
+    [=]()
+    {
+      if (is_vector)
+        render_tile(zoom, x, y);
+      else
+        read_tile(zoom, x, y);
+    });
+}
+
+void MBTilesTileProvider::read_tile(const int zoom, const int x, const int y)
+{
+  Connection* connection = acquire();
+  if (!connection)
+  {
+    emit tile_failed(zoom, x, y);
+    return;
+  }
+
+  // MBTiles rows count up from the bottom (TMS), unlike slippy map tiles
+  sqlite3_stmt* statement = connection->statement;
+  sqlite3_bind_int(statement, 1, zoom);
+  sqlite3_bind_int(statement, 2, x);
+  sqlite3_bind_int(statement, 3, (1 << zoom) - 1 - y);
+  if (sqlite3_step(statement) == SQLITE_ROW)
+  {
+    // the blob is only valid until the statement is reset
+    const char* blob =
+      static_cast<const char*>(sqlite3_column_blob(statement, 0));
+    const int num_bytes = sqlite3_column_bytes(statement, 0);
+    decode(zoom, x, y, QByteArray::fromRawData(blob, num_bytes));
+  }
+  else
+    emit tile_failed(zoom, x, y);
+  sqlite3_reset(statement);
+
+  release(connection);
+}
+
+std::shared_ptr<const VectorTile> MBTilesTileProvider::vector_tile(
+  const int zoom,
+  const int x,
+  const int y)
+{
+  {
+    QMutexLocker locker(&parsed_mutex);
+    for (const ParsedTile& parsed : parsed_tiles)
+    {
+      if (parsed.zoom == zoom && parsed.x == x && parsed.y == y)
+        return parsed.tile;
+    }
+  }
+
+  Connection* connection = acquire();
+  if (!connection)
+    return nullptr;
+
+  std::shared_ptr<VectorTile> tile;
+  sqlite3_stmt* statement = connection->statement;
+  sqlite3_bind_int(statement, 1, zoom);
+  sqlite3_bind_int(statement, 2, x);
+  sqlite3_bind_int(statement, 3, (1 << zoom) - 1 - y);
+  if (sqlite3_step(statement) == SQLITE_ROW)
+  {
+    tile = std::make_shared<VectorTile>();
+    if (!tile->parse(
+        static_cast<const char*>(sqlite3_column_blob(statement, 0)),
+        sqlite3_column_bytes(statement, 0)))
+    {
+      printf("couldn't parse vector tile %d/%d/%d\n", zoom, x, y);
+      tile.reset();
+    }
+  }
+  sqlite3_reset(statement);
+  release(connection);
+
+  if (tile)
+  {
+    const std::size_t MAX_PARSED_TILES = 32;
+    QMutexLocker locker(&parsed_mutex);
+    ParsedTile parsed;
+    parsed.zoom = zoom;
+    parsed.x = x;
+    parsed.y = y;
+    parsed.tile = tile;
+    parsed_tiles.push_front(parsed);
+    if (parsed_tiles.size() > MAX_PARSED_TILES)
+      parsed_tiles.pop_back();
+  }
+  return tile;
+}
+
+void MBTilesTileProvider::render_tile(const int zoom, const int x, const int y)
+{
+  std::optional<const QByteArray> cached = rendered_cache->get(zoom, x, y);
+  if (cached.has_value())
+  {
+    decode(zoom, x, y, cached.value(), false);
+    return;
+  }
+
+  // past the deepest level of the archive, render part of an ancestor
+  const int dz = std::max(0, zoom - metadata_max_zoom);
+  const int source_x = x >> dz;
+  const int source_y = y >> dz;
+  std::shared_ptr<const VectorTile> tile =
+    vector_tile(zoom - dz, source_x, source_y);
+  if (!tile)
+  {
+    emit tile_failed(zoom, x, y);
+    return;
+  }
+
+  const QImage image = renderer.render(
+    *tile,
+    zoom,
+    dz,
+    x - (source_x << dz),
+    y - (source_y << dz));
+  emit tile_ready(zoom, x, y, image);
+
+  QByteArray bytes;
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::WriteOnly);
+  image.save(&buffer, "PNG");
+  rendered_cache->set(zoom, x, y, bytes);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MBTILES_TILE_PROVIDER_H
+#define MBTILES_TILE_PROVIDER_H
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <QMutex>
+
+#include "map_tile_cache.h"
+#include "tile_provider.h"
+#include "vector_tile.h"
+#include "vector_tile_renderer.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+/*
+ * Tiles from a local MBTiles file (an SQLite database).
+ *
+ * Every worker thread needs its own prepared statement, so connections
+ * (each with its tile query already prepared) are kept in a small pool
+ * that grows up to the size of the thread pool. Tile blobs are decoded
+ * straight out of SQLite's buffer, without copying them.
+ *
+ * Archives of vector tiles (format "pbf") are rendered with
+ * VectorTileRenderer, using the style file next to the archive
+ * (foo.style.yaml for foo.mbtiles) if there is one. Past the archive's
+ * maximum zoom, the deepest vector tile is rendered scaled up, so there
+ * is detail at any zoom. Rendered tiles go in their own tile cache.
+ */
+
+class MBTilesTileProvider : public TileProvider
+{
+  Q_OBJECT
+
+public:
+  MBTilesTileProvider(QObject* parent, const QString& filename);
+  ~MBTilesTileProvider();
+
+  bool is_valid() const { return valid; }
+
+  QString description() const override;
+  void request(const int zoom, const int x, const int y) override;
+  int max_zoom() const override;
+
+private:
+  QString filename;
+  QString name;
+  QString format;
+  int metadata_max_zoom = 20;
+  bool valid = false;
+  bool is_vector = false;
+
+  struct Connection
+  {
+    sqlite3* db = nullptr;
+    sqlite3_stmt* statement = nullptr;
+  };
+
+  QMutex pool_mutex;
+  std::vector<Connection*> connections;  // all of them
+  std::vector<Connection*> idle_connections;
+
+  Connection* open_connection();
+  Connection* acquire();
+  void release(Connection* connection);
+
+  VectorTileRenderer renderer;
+  std::unique_ptr<MapTileCache> rendered_cache;
+
+  // the last few parsed vector tiles, since many rendered tiles can come
+  // from the same one when zoomed in past the archive
+  struct ParsedTile
+  {
+    int zoom = 0;
+    int x = 0;
+    int y = 0;
+    std::shared_ptr<const VectorTile> tile;
+  };
+  QMutex parsed_mutex;
+  std::deque<ParsedTile> parsed_tiles;
+
+  bool read_metadata();
+  void read_tile(const int zoom, const int x, const int y);
+  void render_tile(const int zoom, const int x, const int y);
+  std::shared_ptr<const VectorTile> vector_tile(
+    const int zoom,
+    const int x,
+    const int y);
+};
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "memory_budget.h"
+
+using std::size_t;
+using std::vector;
+
+
+MemoryBudget::MemoryBudget()
+{
+  // leave a quarter of the machine for everything else
+  resident_limit_bytes = physical_bytes() / 4 * 3;
+}
+
+double MemoryBudget::now()
+{
+  using std::chrono::steady_clock;
+  static const steady_clock::time_point start = steady_clock::now();
+  return std::chrono::duration<double>(steady_clock::now() - start).count();
+}
+
+int MemoryBudget::add(
+  const std::string& name,
+  const Priority priority,
+  SizeFunction size,
+  EvictFunction evict)
+{
+  Cache cache;
+  cache.id = next_id++;
+  cache.name = name;
+  cache.priority = priority;
+  cache.size = size;
+  cache.evict = evict;
+  cache.last_used = now();
+  caches.push_back(cache);
+  return cache.id;
+}
+
+void MemoryBudget::remove(const int id)
+{
+  caches.erase(
+    std::remove_if(
+      caches.begin(),
+      caches.end(),
+      [id](const Cache& cache) { return cache.id == id; }),
+    caches.end());
+}
+
+void MemoryBudget::touch(const int id)
+{
+  for (auto& cache : caches)
+  {
+    if (cache.id == id)
+    {
+      cache.last_used = now();
+      return;
+    }
+  }
+}
+
+vector<MemoryBudget::Usage> MemoryBudget::usage() const
+{
+  const double t = now();
+  vector<Usage> v;
+  for (const auto& cache : caches)
+  {
+    Usage u;
+    u.name = cache.name;
+    u.priority = cache.priority;
+    u.bytes = cache.size();
+    u.idle_seconds = t - cache.last_used;
+    u.evictable = static_cast<bool>(cache.evict);
+    v.push_back(u);
+  }
+  return v;
+}
+
+size_t MemoryBudget::total_bytes() const
+{
+  size_t total = 0;
+  for (const auto& cache : caches)
+    total += cache.size();
+  return total;
+}
+
+size_t MemoryBudget::enforce()
+{
+  size_t excess = 0;
+  const size_t total = total_bytes();
+  if (budget_bytes > 0 && total > budget_bytes)
+    excess = total - budget_bytes;
+  const size_t resident = resident_bytes();
+  if (resident_limit_bytes > 0 && resident > resident_limit_bytes)
+    excess = std::max(excess, resident - resident_limit_bytes);
+  if (excess == 0)
+    return 0;
+
+  vector<const Cache*> order;
+  for (const auto& cache : caches)
+  {
+    if (cache.evict)
+      order.push_back(&cache);
+  }
+  std::sort(
+    order.begin(),
+    order.end(),
+    [](const Cache* a, const Cache* b)
+    {
+      if (a->priority != b->priority)
+        return a->priority < b->priority;
+      return a->last_used < b->last_used;
+    });
+
+  size_t freed = 0;
+  for (const Cache* cache : order)
+  {
+    if (freed >= excess)
+      break;
+    const size_t cache_freed = cache->evict(excess - freed);
+    if (cache_freed > 0)
+    {
+      printf("memory budget: evicted %.1f MB from %s\n",
+        cache_freed / 1.0e6,
+        cache->name.c_str());
+      evictions++;
+    }
+    freed += cache_freed;
+  }
+  evicted_bytes += freed;
+  return freed;
+}
+
+size_t MemoryBudget::resident_bytes()
+{
+#ifdef __linux__
+  FILE* f = fopen("/proc/self/statm", "r");
+  if (!f)
+    return 0;
+  unsigned long size_pages = 0;
+  unsigned long resident_pages = 0;
+  const int n = fscanf(f, "%lu %lu", &size_pages, &resident_pages);
+  fclose(f);
+  if (n != 2)
+    return 0;
+  return static_cast<size_t>(resident_pages) * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+size_t MemoryBudget::physical_bytes()
+{
+#ifdef __linux__
+  const long pages = sysconf(_SC_PHYS_PAGES);
+  const long page_size = sysconf(_SC_PAGESIZE);
+  if (pages <= 0 || page_size <= 0)
+    return 0;
+  return static_cast<size_t>(pages) * static_cast<size_t>(page_size);
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * Accounts for the memory held by the editor's caches, and evicts from
+ * them when their total exceeds a configured budget, or when the resident
+ * size of the whole process exceeds a limit (by default, a fraction of the
+ * physical memory of the machine).
+ *
+ * Each cache registers a function reporting its current size and, if it
+ * can give memory back, a function which frees at least a requested number
+ * of bytes (least recently used first, within that cache) and returns how
+ * much it freed. Caches are asked in order of increasing priority and,
+ * within a priority, least recently touched first.
+ */
+
+class MemoryBudget
+{
+public:
+  MemoryBudget();
+
+  // lower priorities are evicted first
+  enum Priority
+  {
+    DERIVED = 0,  // can be regenerated from other data in memory
+    RELOADABLE,  // has to be reloaded from disk
+    HISTORY  // can't be regenerated at all
+  };
+
+  typedef std::function<std::size_t()> SizeFunction;
+  typedef std::function<std::size_t(const std::size_t bytes)> EvictFunction;
+
+  // returns an id for touch() and remove(). A cache without an eviction
+  // function is still accounted for.
+  int add(
+    const std::string& name,
+    const Priority priority,
+    SizeFunction size,
+    EvictFunction evict = nullptr);
+
+  void remove(const int id);
+
+  // note that a cache was just used, so it's evicted after idler ones
+  void touch(const int id);
+
+  std::size_t budget_bytes = 1024ul << 20;  // 0 for no cache budget
+  std::size_t resident_limit_bytes = 0;  // 0 for no limit
+
+  struct Usage
+  {
+    std::string name;
+    Priority priority = DERIVED;
+    std::size_t bytes = 0;
+    double idle_seconds = 0.0;
+    bool evictable = false;
+  };
+  std::vector<Usage> usage() const;
+
+  std::size_t total_bytes() const;
+
+  // evict until the cache total and the resident size are within limits;
+  // returns the number of bytes freed
+  std::size_t enforce();
+
+  std::size_t evictions = 0;  // number of eviction calls which freed memory
+  std::size_t evicted_bytes = 0;  // total bytes freed since startup
+
+  // these return 0 on platforms where they're unknown
+  static std::size_t resident_bytes();
+  static std::size_t physical_bytes();
+
+private:
+  struct Cache
+  {
+    int id = 0;
+    std::string name;
+    Priority priority = DERIVED;
+    SizeFunction size;
+    EvictFunction evict;
+    double last_used = 0.0;  // seconds since startup
+  };
+  std::vector<Cache> caches;
+  int next_id = 0;
+
+  static double now();
+};
+
+#endif
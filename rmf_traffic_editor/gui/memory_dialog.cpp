@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <QtWidgets>
+
+#include "memory_dialog.h"
+
+
+static QString megabytes(const std::size_t bytes)
+{
+  return QString::number(bytes / 1.0e6, 'f', 1);
+}
+
+static QString priority_name(const MemoryBudget::Priority priority)
+{
+  switch (priority)
+  {
+    case MemoryBudget::DERIVED: return "derived";
+    case MemoryBudget::RELOADABLE: return "reloadable";
+    case MemoryBudget::HISTORY: return "history";
+    default: return "?";
+  }
+}
+
+MemoryDialog::MemoryDialog(QWidget* parent, MemoryBudget& _memory_budget)
+: QDialog(parent),
+  memory_budget(_memory_budget)
+{
+  setWindowTitle("Memory Usage");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  close_button = new QPushButton("Close", this);  // first = [enter] button
+  trim_button = new QPushButton("Trim to budget", this);
+
+  cache_table = new QTableWidget(this);
+  cache_table->setColumnCount(4);
+  cache_table->setHorizontalHeaderLabels(
+    QStringList() << "Cache" << "Priority" << "Size (MB)" << "Idle (s)");
+  cache_table->verticalHeader()->setVisible(false);
+  cache_table->horizontalHeader()->setSectionResizeMode(
+    QHeaderView::Stretch);
+  cache_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+  status_label = new QLabel(this);
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(trim_button);
+  bottom_buttons_hbox->addWidget(close_button);
+  connect(
+    trim_button, &QAbstractButton::clicked,
+    this, &MemoryDialog::trim_button_clicked);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addWidget(cache_table, 1);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+  setLayout(top_vbox);
+  resize(500, 350);
+
+  refresh_timer = new QTimer(this);
+  connect(refresh_timer, &QTimer::timeout, this, &MemoryDialog::refresh);
+  refresh_timer->start(1000);
+  refresh();
+}
+
+MemoryDialog::~MemoryDialog()
+{
+}
+
+void MemoryDialog::refresh()
+{
+  const std::vector<MemoryBudget::Usage> usage = memory_budget.usage();
+  cache_table->setRowCount(static_cast<int>(usage.size()));
+  std::size_t total = 0;
+  for (std::size_t row = 0; row < usage.size(); row++)
+  {
+    const MemoryBudget::Usage& u = usage[row];
+    QString name = QString::fromStdString(u.name);
+    if (!u.evictable)
+      name += " (not evictable)";
+    cache_table->setItem(row, 0, new QTableWidgetItem(name));
+    cache_table->setItem(
+      row,
+      1,
+      new QTableWidgetItem(priority_name(u.priority)));
+    cache_table->setItem(row, 2, new QTableWidgetItem(megabytes(u.bytes)));
+    cache_table->setItem(
+      row,
+      3,
+      new QTableWidgetItem(QString::number(u.idle_seconds, 'f', 0)));
+    total += u.bytes;
+  }
+
+  QString status = QString("Caches: %1 MB").arg(megabytes(total));
+  if (memory_budget.budget_bytes > 0)
+    status += QString(" of %1 MB").arg(megabytes(memory_budget.budget_bytes));
+  const std::size_t resident = MemoryBudget::resident_bytes();
+  if (resident > 0)
+  {
+    status += QString("\nResident: %1 MB").arg(megabytes(resident));
+    if (memory_budget.resident_limit_bytes > 0)
+      status += QString(" of %1 MB").arg(
+        megabytes(memory_budget.resident_limit_bytes));
+  }
+  status += QString("\nEvicted: %1 MB in %2 evictions")
+    .arg(megabytes(memory_budget.evicted_bytes))
+    .arg(memory_budget.evictions);
+  status_label->setText(status);
+}
+
+void MemoryDialog::trim_button_clicked()
+{
+  if (memory_budget.enforce() > 0)
+    emit redraw();
+  refresh();
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef MEMORY_DIALOG_H
+#define MEMORY_DIALOG_H
+
+#include <QDialog>
+#include <QObject>
+
+#include "memory_budget.h"
+class QLabel;
+class QTableWidget;
+class QTimer;
+
+
+class MemoryDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  MemoryDialog(QWidget* parent, MemoryBudget& memory_budget);
+  ~MemoryDialog();
+
+private:
+  MemoryBudget& memory_budget;
+
+  QTableWidget* cache_table;
+  QLabel* status_label;
+  QPushButton* trim_button, * close_button;
+  QTimer* refresh_timer;
+
+  void refresh();
+
+private slots:
+  void trim_button_clicked();
+
+signals:
+  void redraw();
+};
+
+#endif
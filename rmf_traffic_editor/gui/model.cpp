@@ -184,10 +184,11 @@ void Model::set_param(const std::string& name, const std::string& value)
   }
 }
 
-void Model::draw(
+SelectionSet::Restyler Model::draw(
   QGraphicsScene* scene,
   std::vector<EditorModel>& editor_models,
-  const double drawing_meters_per_pixel)
+  const double drawing_meters_per_pixel,
+  const bool selected)
 {
   if (pixmap_item == nullptr)
   {
@@ -256,7 +257,7 @@ void Model::draw(
           printf("[ERROR] No thumbnail found: %s\n", model_name.c_str());
           error_printed = true;
         }
-        return;  // couldn't load the pixmap; ignore it.
+        return nullptr;  // couldn't load the pixmap; ignore it.
       }
     }
 
@@ -270,13 +271,22 @@ void Model::draw(
   pixmap_item->setRotation((-state.yaw + M_PI / 2.0) * 180.0 / M_PI);
 
   // make the model "glow" if it is selected
+  QGraphicsPixmapItem* item = pixmap_item;
+  SelectionSet::Restyler restyler = [item](const bool selected_now)
+    {
+      if (!selected_now)
+      {
+        item->setGraphicsEffect(nullptr);  // deletes the previous effect
+        return;
+      }
+      QGraphicsColorizeEffect* colorize = new QGraphicsColorizeEffect;
+      colorize->setColor(QColor::fromRgbF(1.0, 0.2, 0.0, 1.0));
+      colorize->setStrength(1.0);
+      item->setGraphicsEffect(colorize);
+    };
   if (selected)
-  {
-    QGraphicsColorizeEffect* colorize = new QGraphicsColorizeEffect;
-    colorize->setColor(QColor::fromRgbF(1.0, 0.2, 0.0, 1.0));
-    colorize->setStrength(1.0);
-    pixmap_item->setGraphicsEffect(colorize);
-  }
+    restyler(true);
+  return restyler;
 }
 
 void Model::clear_scene()
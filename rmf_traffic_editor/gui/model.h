@@ -28,6 +28,7 @@
 #include "coordinate_system.h"
 #include "editor_model.h"
 #include "model_state.h"
+#include "selection_set.h"
 
 #include <string>
 #include <algorithm>
@@ -46,7 +47,6 @@ public:
 
   std::string model_name;
   std::string instance_name;
-  bool selected = false;  // only for visualization, not saved to YAML
   bool is_static = true;
   bool is_dispensable = false;
   bool is_active = false;
@@ -65,10 +65,11 @@ public:
 
   void set_param(const std::string& name, const std::string& value);
 
-  void draw(
+  SelectionSet::Restyler draw(
     QGraphicsScene* scene,
     std::vector<EditorModel>& editor_models,
-    const double meters_per_pixel);
+    const double meters_per_pixel,
+    const bool selected);
 
   void clear_scene();
 };
@@ -0,0 +1,430 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+
+#include "planar_faces.h"
+
+using std::vector;
+
+
+PlanarFaces::PlanarFaces()
+{
+}
+
+PlanarFaces::~PlanarFaces()
+{
+}
+
+double PlanarFaces::signed_area(
+  const vector<Point>& points,
+  const vector<int>& ring)
+{
+  double a = 0.0;
+  for (std::size_t i = 0; i < ring.size(); i++)
+  {
+    const Point& p = points[ring[i]];
+    const Point& q = points[ring[(i + 1) % ring.size()]];
+    a += p.x * q.y - q.x * p.y;
+  }
+  return 0.5 * a;
+}
+
+bool PlanarFaces::point_in_ring(
+  const vector<Point>& points,
+  const vector<int>& ring,
+  const Point& p)
+{
+  bool inside = false;
+  for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+  {
+    const Point& a = points[ring[i]];
+    const Point& b = points[ring[j]];
+    if ((a.y > p.y) != (b.y > p.y) &&
+      p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+      inside = !inside;
+  }
+  return inside;
+}
+
+void PlanarFaces::find(
+  const vector<Point>& points,
+  const vector<std::pair<int, int>>& segments)
+{
+  vertices.clear();
+  source_point.clear();
+  faces.clear();
+
+  const double tol = std::max(tolerance, 1e-9);
+
+  // merge points closer than the tolerance, using a hash grid
+  auto key = [](const long long cx, const long long cy)
+    {
+      return (cx << 32) ^ (cy & 0xffffffffLL);
+    };
+  std::unordered_map<long long, vector<int>> vertex_grid;
+  auto add_vertex = [&](const Point& p, const int source)
+    {
+      const long long cx = static_cast<long long>(std::floor(p.x / tol));
+      const long long cy = static_cast<long long>(std::floor(p.y / tol));
+      for (long long dy = -1; dy <= 1; dy++)
+      {
+        for (long long dx = -1; dx <= 1; dx++)
+        {
+          auto it = vertex_grid.find(key(cx + dx, cy + dy));
+          if (it == vertex_grid.end())
+            continue;
+          for (const int v : it->second)
+          {
+            if (std::hypot(vertices[v].x - p.x, vertices[v].y - p.y) <= tol)
+              return v;
+          }
+        }
+      }
+      const int v = static_cast<int>(vertices.size());
+      vertices.push_back(p);
+      source_point.push_back(source);
+      vertex_grid[key(cx, cy)].push_back(v);
+      return v;
+    };
+
+  vector<int> point_vertex(points.size(), -1);
+  vector<std::pair<int, int>> segs;
+  for (const auto& s : segments)
+  {
+    int v[2];
+    const int ends[2] = {s.first, s.second};
+    for (int i = 0; i < 2; i++)
+    {
+      if (point_vertex[ends[i]] < 0)
+        point_vertex[ends[i]] = add_vertex(points[ends[i]], ends[i]);
+      v[i] = point_vertex[ends[i]];
+    }
+    if (v[0] != v[1])
+      segs.push_back(std::make_pair(v[0], v[1]));
+  }
+  if (segs.empty())
+    return;
+
+  // bin the segments into a uniform grid about as fine as the segments
+  double total_length = 0.0;
+  for (const auto& s : segs)
+  {
+    const Point& a = vertices[s.first];
+    const Point& b = vertices[s.second];
+    total_length += std::hypot(b.x - a.x, b.y - a.y);
+  }
+  const double cell = std::max(4.0 * tol, total_length / segs.size());
+  struct Box
+  {
+    double x0, y0, x1, y1;
+  };
+  vector<Box> boxes(segs.size());
+  std::unordered_map<long long, vector<int>> segment_grid;
+  for (std::size_t i = 0; i < segs.size(); i++)
+  {
+    const Point& a = vertices[segs[i].first];
+    const Point& b = vertices[segs[i].second];
+    Box& box = boxes[i];
+    box.x0 = std::min(a.x, b.x) - tol;
+    box.y0 = std::min(a.y, b.y) - tol;
+    box.x1 = std::max(a.x, b.x) + tol;
+    box.y1 = std::max(a.y, b.y) + tol;
+    const long long cx0 = static_cast<long long>(std::floor(box.x0 / cell));
+    const long long cy0 = static_cast<long long>(std::floor(box.y0 / cell));
+    const long long cx1 = static_cast<long long>(std::floor(box.x1 / cell));
+    const long long cy1 = static_cast<long long>(std::floor(box.y1 / cell));
+    for (long long cy = cy0; cy <= cy1; cy++)
+    {
+      for (long long cx = cx0; cx <= cx1; cx++)
+        segment_grid[key(cx, cy)].push_back(static_cast<int>(i));
+    }
+  }
+
+  // find where segments cross or touch each other
+  vector<vector<int>> splits(segs.size());
+  auto distance_to_interior = [&](const int s, const Point& p)
+    {
+      const Point& a = vertices[segs[s].first];
+      const Point& b = vertices[segs[s].second];
+      const double len = std::hypot(b.x - a.x, b.y - a.y);
+      const double t = ((p.x - a.x) * (b.x - a.x) + (p.y - a.y) * (b.y - a.y)) /
+        len;
+      if (t <= tol || t >= len - tol)
+        return 1e100;
+      return std::abs((p.x - a.x) * (b.y - a.y) - (p.y - a.y) * (b.x - a.x)) /
+        len;
+    };
+  auto test_pair = [&](const int s, const int t)
+    {
+      // endpoints of one segment which lie on the other
+      for (const int e : {segs[t].first, segs[t].second})
+      {
+        if (e != segs[s].first && e != segs[s].second &&
+          distance_to_interior(s, vertices[e]) <= tol)
+          splits[s].push_back(e);
+      }
+      for (const int e : {segs[s].first, segs[s].second})
+      {
+        if (e != segs[t].first && e != segs[t].second &&
+          distance_to_interior(t, vertices[e]) <= tol)
+          splits[t].push_back(e);
+      }
+
+      // proper crossings
+      const Point& a = vertices[segs[s].first];
+      const Point& b = vertices[segs[s].second];
+      const Point& c = vertices[segs[t].first];
+      const Point& d = vertices[segs[t].second];
+      const double rx = b.x - a.x, ry = b.y - a.y;
+      const double qx = d.x - c.x, qy = d.y - c.y;
+      const double denom = rx * qy - ry * qx;
+      const double lr = std::hypot(rx, ry), lq = std::hypot(qx, qy);
+      if (std::abs(denom) < 1e-12 * lr * lq)
+        return;  // parallel; overlaps were handled by the endpoint tests
+      const double u = ((c.x - a.x) * qy - (c.y - a.y) * qx) / denom;
+      const double w = ((c.x - a.x) * ry - (c.y - a.y) * rx) / denom;
+      if (u * lr <= tol || (1.0 - u) * lr <= tol ||
+        w * lq <= tol || (1.0 - w) * lq <= tol)
+        return;  // not a crossing, or near an endpoint (handled above)
+      const int v = add_vertex(Point(a.x + u * rx, a.y + u * ry), -1);
+      splits[s].push_back(v);
+      splits[t].push_back(v);
+    };
+
+  for (const auto& it : segment_grid)
+  {
+    const vector<int>& in_cell = it.second;
+    const long long cx = it.first >> 32;
+    const long long cy = static_cast<int32_t>(it.first & 0xffffffffLL);
+    for (std::size_t i = 0; i < in_cell.size(); i++)
+    {
+      for (std::size_t j = i + 1; j < in_cell.size(); j++)
+      {
+        const Box& a = boxes[in_cell[i]];
+        const Box& b = boxes[in_cell[j]];
+        const double x0 = std::max(a.x0, b.x0), y0 = std::max(a.y0, b.y0);
+        if (x0 > std::min(a.x1, b.x1) || y0 > std::min(a.y1, b.y1))
+          continue;
+        // only test each pair in the cell holding the corner of the
+        // overlap of their boxes
+        if (static_cast<long long>(std::floor(x0 / cell)) != cx ||
+          static_cast<long long>(std::floor(y0 / cell)) != cy)
+          continue;
+        test_pair(in_cell[i], in_cell[j]);
+      }
+    }
+  }
+
+  // cut the segments at the splits, and merge duplicates
+  std::set<std::pair<int, int>> edge_set;
+  for (std::size_t s = 0; s < segs.size(); s++)
+  {
+    const Point& a = vertices[segs[s].first];
+    const Point& b = vertices[segs[s].second];
+    vector<std::pair<double, int>> stops;
+    stops.push_back(std::make_pair(0.0, segs[s].first));
+    stops.push_back(std::make_pair(1e100, segs[s].second));
+    for (const int v : splits[s])
+    {
+      const Point& p = vertices[v];
+      stops.push_back(
+        std::make_pair(
+          (p.x - a.x) * (b.x - a.x) + (p.y - a.y) * (b.y - a.y),
+          v));
+    }
+    std::sort(stops.begin(), stops.end());
+    for (std::size_t i = 1; i < stops.size(); i++)
+    {
+      const int u = stops[i - 1].second;
+      const int v = stops[i].second;
+      if (u != v)
+        edge_set.insert(std::make_pair(std::min(u, v), std::max(u, v)));
+    }
+  }
+  vector<std::pair<int, int>> edges(edge_set.begin(), edge_set.end());
+
+  // prune dangling edges, which can't bound anything
+  const int num_vertices = static_cast<int>(vertices.size());
+  vector<vector<int>> incident(num_vertices);
+  for (std::size_t e = 0; e < edges.size(); e++)
+  {
+    incident[edges[e].first].push_back(static_cast<int>(e));
+    incident[edges[e].second].push_back(static_cast<int>(e));
+  }
+  vector<int> degree(num_vertices);
+  vector<int> stack;
+  for (int v = 0; v < num_vertices; v++)
+  {
+    degree[v] = static_cast<int>(incident[v].size());
+    if (degree[v] == 1)
+      stack.push_back(v);
+  }
+  vector<bool> alive(edges.size(), true);
+  while (!stack.empty())
+  {
+    const int v = stack.back();
+    stack.pop_back();
+    for (const int e : incident[v])
+    {
+      if (!alive[e])
+        continue;
+      alive[e] = false;
+      const int other = edges[e].first == v ? edges[e].second : edges[e].first;
+      degree[v]--;
+      if (--degree[other] == 1)
+        stack.push_back(other);
+    }
+  }
+
+  // half-edges 2k and 2k+1 run each way along edge k; sort the outgoing
+  // half-edges of every vertex by angle
+  vector<int> origin(2 * edges.size());
+  vector<vector<int>> outgoing(num_vertices);
+  for (std::size_t e = 0; e < edges.size(); e++)
+  {
+    if (!alive[e])
+      continue;
+    origin[2 * e] = edges[e].first;
+    origin[2 * e + 1] = edges[e].second;
+    outgoing[edges[e].first].push_back(static_cast<int>(2 * e));
+    outgoing[edges[e].second].push_back(static_cast<int>(2 * e + 1));
+  }
+  vector<int> position(2 * edges.size(), -1);
+  for (int v = 0; v < num_vertices; v++)
+  {
+    vector<std::pair<double, int>> by_angle;
+    for (const int h : outgoing[v])
+    {
+      const Point& p = vertices[v];
+      const Point& q = vertices[origin[h ^ 1]];
+      by_angle.push_back(std::make_pair(std::atan2(q.y - p.y, q.x - p.x), h));
+    }
+    std::sort(by_angle.begin(), by_angle.end());
+    for (std::size_t i = 0; i < by_angle.size(); i++)
+    {
+      outgoing[v][i] = by_angle[i].second;
+      position[by_angle[i].second] = static_cast<int>(i);
+    }
+  }
+
+  // walk every face, keeping it on the left; bounded faces come out
+  // counterclockwise (positive area) and the outside of each connected
+  // component clockwise
+  vector<int> parent(num_vertices);
+  for (int v = 0; v < num_vertices; v++)
+    parent[v] = v;
+  auto find_root = [&parent](int v)
+    {
+      while (parent[v] != v)
+      {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+      }
+      return v;
+    };
+  for (std::size_t e = 0; e < edges.size(); e++)
+  {
+    if (alive[e])
+      parent[find_root(edges[e].first)] = find_root(edges[e].second);
+  }
+
+  struct Cycle
+  {
+    vector<int> ring;
+    double area;
+    int component;
+  };
+  vector<Cycle> cycles;
+  vector<bool> walked(2 * edges.size(), false);
+  for (std::size_t start = 0; start < 2 * edges.size(); start++)
+  {
+    if (!alive[start / 2] || walked[start])
+      continue;
+    Cycle cycle;
+    int h = static_cast<int>(start);
+    while (!walked[h])
+    {
+      walked[h] = true;
+      cycle.ring.push_back(origin[h]);
+      const int v = origin[h ^ 1];
+      const int n = static_cast<int>(outgoing[v].size());
+      h = outgoing[v][(position[h ^ 1] + n - 1) % n];
+    }
+    cycle.area = signed_area(vertices, cycle.ring);
+    cycle.component = find_root(cycle.ring[0]);
+    cycles.push_back(cycle);
+  }
+
+  // the outside of a component is its most negative cycle
+  std::unordered_map<int, int> outside;
+  for (std::size_t c = 0; c < cycles.size(); c++)
+  {
+    auto it = outside.find(cycles[c].component);
+    if (it == outside.end() || cycles[c].area < cycles[it->second].area)
+      outside[cycles[c].component] = static_cast<int>(c);
+  }
+
+  vector<int> face_of_cycle(cycles.size(), -1);
+  for (std::size_t c = 0; c < cycles.size(); c++)
+  {
+    if (outside[cycles[c].component] == static_cast<int>(c) ||
+      cycles[c].area <= 0.0)
+      continue;
+    Face face;
+    face.outer = cycles[c].ring;
+    face.area = cycles[c].area;
+    face_of_cycle[c] = static_cast<int>(faces.size());
+    faces.push_back(face);
+  }
+
+  // components inside a face of another component are holes in the
+  // smallest such face
+  for (const auto& it : outside)
+  {
+    const Cycle& boundary = cycles[it.second];
+    const Point& p = vertices[boundary.ring[0]];
+    int best = -1;
+    for (std::size_t c = 0; c < cycles.size(); c++)
+    {
+      const int f = face_of_cycle[c];
+      if (f < 0 || cycles[c].component == it.first)
+        continue;
+      if ((best < 0 || faces[f].area < faces[best].area) &&
+        point_in_ring(vertices, faces[f].outer, p))
+        best = f;
+    }
+    if (best < 0)
+      continue;
+    faces[best].holes.push_back(boundary.ring);
+    for (std::size_t c = 0; c < cycles.size(); c++)
+    {
+      if (face_of_cycle[c] >= 0 && cycles[c].component == it.first)
+        faces[face_of_cycle[c]].nested = true;
+    }
+  }
+
+  for (Face& face : faces)
+  {
+    for (const auto& hole : face.holes)
+      face.area -= std::abs(signed_area(vertices, hole));
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef PLANAR_FACES_H
+#define PLANAR_FACES_H
+
+#include <utility>
+#include <vector>
+
+/*
+ * Finds the enclosed regions (faces) of a set of line segments, such as
+ * the walls and doors of a level.
+ *
+ * Segments are first split wherever they cross or touch each other, with
+ * points closer than a tolerance merged, so drawings which are "almost"
+ * connected still close up. Candidate pairs come from a uniform grid, so
+ * this is close to linear for building-like drawings. Dangling segments
+ * are pruned, and the faces are then walked in a half-edge structure whose
+ * outgoing edges are sorted by angle around every vertex, which is
+ * O(E log E). Finally every connected component of the drawing which is
+ * nested inside a face of another component (e.g. a pillar in a room)
+ * becomes a hole of the smallest such face.
+ */
+
+class PlanarFaces
+{
+public:
+  PlanarFaces();
+  ~PlanarFaces();
+
+  double tolerance = 1.0;  // points closer than this are merged
+
+  struct Point
+  {
+    double x = 0.0;
+    double y = 0.0;
+
+    Point() {}
+    Point(const double _x, const double _y) : x(_x), y(_y) {}
+  };
+
+  struct Face
+  {
+    std::vector<int> outer;  // vertex indices, counterclockwise
+    std::vector<std::vector<int>> holes;
+    double area = 0.0;  // not counting the holes
+    bool nested = false;  // inside a face of another component
+  };
+
+  // after find(): the vertices used by the faces. Vertices which came from
+  // an input point have its index in source_point, new ones (made by
+  // splitting crossing segments) have -1.
+  std::vector<Point> vertices;
+  std::vector<int> source_point;
+
+  std::vector<Face> faces;
+
+  void find(
+    const std::vector<Point>& points,
+    const std::vector<std::pair<int, int>>& segments);
+
+  static double signed_area(
+    const std::vector<Point>& vertices,
+    const std::vector<int>& ring);
+
+  static bool point_in_ring(
+    const std::vector<Point>& vertices,
+    const std::vector<int>& ring,
+    const Point& p);
+};
+
+#endif
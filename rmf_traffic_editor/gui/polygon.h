@@ -26,13 +26,13 @@
 #include <QPolygonF>
 
 #include "param.h"
+#include "triangulation.h"
 
 
 class Polygon
 {
 public:
   std::vector<int> vertices;
-  bool selected = false;
 
   std::map<std::string, Param> params;
 
@@ -53,6 +53,13 @@ public:
 
   void remove_vertex(const int vertex_idx);
 
+  // Cached triangulation of this polygon, with any overlapping HOLE
+  // polygons subtracted if this is a FLOOR. It is owned by the polygon but
+  // only (re)computed by Level::polygon_triangulation(), which compares
+  // the vertex coordinates it was built from against the current ones.
+  mutable Triangulation triangulation;
+  mutable std::vector<double> triangulation_inputs;
+
   struct EdgeDragPolygon
   {
     QPolygonF polygon;
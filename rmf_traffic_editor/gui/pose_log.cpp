@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+#include <cstring>
+
+#include "pose_log.h"
+
+using std::string;
+using std::vector;
+
+// the index has the first timestamp of every block of this many bytes
+static const std::size_t BLOCK_SIZE = 64 << 10;
+
+
+static const char* next_line(const char* p, const char* end)
+{
+  const char* newline = static_cast<const char*>(
+    std::memchr(p, '\n', end - p));
+  return newline ? newline + 1 : end;
+}
+
+static const char* line_end(const char* p, const char* end)
+{
+  const char* newline = static_cast<const char*>(
+    std::memchr(p, '\n', end - p));
+  return newline ? newline : end;
+}
+
+PoseLog::PoseLog()
+{
+}
+
+PoseLog::~PoseLog()
+{
+}
+
+bool PoseLog::open(const string& filename)
+{
+  file.setFileName(QString::fromStdString(filename));
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    error = "couldn't open " + filename;
+    return false;
+  }
+  if (file.size() == 0)
+  {
+    error = filename + " is empty";
+    return false;
+  }
+  data = reinterpret_cast<const char*>(file.map(0, file.size()));
+  if (!data)
+  {
+    error = "couldn't map " + filename;
+    return false;
+  }
+  data_end = data + file.size();
+  return true;
+}
+
+bool PoseLog::parse_header(std::size_t& data_offset)
+{
+  const auto fields =
+    csv_utils::split_line(data, line_end(data, data_end));
+
+  if (!csv_utils::is_header(fields))
+  {
+    const int n = static_cast<int>(fields.size());
+    columns.yaw = n > 3 ? 3 : -1;
+    columns.robot = n > 4 ? 4 : -1;
+    columns.fleet = n > 5 ? 5 : -1;
+    data_offset = 0;
+  }
+  else
+  {
+    columns.t =
+      csv_utils::find_column(fields, {"t", "time", "timestamp", "stamp"});
+    columns.x = csv_utils::find_column(fields, {"x"});
+    columns.y = csv_utils::find_column(fields, {"y"});
+    columns.yaw = csv_utils::find_column(fields, {"yaw", "theta"});
+    columns.robot =
+      csv_utils::find_column(fields, {"robot", "robot_name", "name"});
+    columns.fleet = csv_utils::find_column(fields, {"fleet", "fleet_name"});
+    columns.level =
+      csv_utils::find_column(fields, {"level", "level_name", "map_name"});
+    if (columns.t < 0 || columns.x < 0 || columns.y < 0)
+    {
+      error = "the header has no t, x and y columns";
+      return false;
+    }
+    data_offset = next_line(data, data_end) - data;
+  }
+
+  columns.last = std::max(
+    {
+      columns.t, columns.x, columns.y, columns.yaw,
+      columns.robot, columns.fleet, columns.level
+    });
+  return true;
+}
+
+bool PoseLog::parse_line(
+  const char* p,
+  const char* end,
+  const string* level_name,
+  Line& line) const
+{
+  bool have_t = false, have_x = false, have_y = false;
+  line.yaw = 0.0;
+  line.robot = line.fleet = csv_utils::Field(p, p);
+  line.on_level = true;
+
+  int field = 0;
+  while (true)
+  {
+    const char* field_end = static_cast<const char*>(
+      std::memchr(p, ',', end - p));
+    if (!field_end)
+      field_end = end;
+
+    if (field == columns.t)
+      have_t = csv_utils::parse_number(p, field_end, line.t);
+    else if (field == columns.x)
+      have_x = csv_utils::parse_number(p, field_end, line.x);
+    else if (field == columns.y)
+      have_y = csv_utils::parse_number(p, field_end, line.y);
+    else if (field == columns.yaw)
+      csv_utils::parse_number(p, field_end, line.yaw);
+    else if (field == columns.robot)
+      line.robot = csv_utils::Field(p, field_end);
+    else if (field == columns.fleet)
+      line.fleet = csv_utils::Field(p, field_end);
+    else if (field == columns.level && level_name)
+      line.on_level = csv_utils::field_equals(p, field_end, *level_name);
+
+    if (field_end == end || field == columns.last)
+      break;
+    p = field_end + 1;
+    field++;
+  }
+  return have_t && have_x && have_y;
+}
+
+bool PoseLog::build_index(JobContext* job)
+{
+  blocks.clear();
+  std::size_t data_offset = 0;
+  if (!data || !parse_header(data_offset))
+    return false;
+
+  const std::size_t size = static_cast<std::size_t>(data_end - data);
+  const std::size_t num_blocks = (size - data_offset) / BLOCK_SIZE + 1;
+  Line line;
+  for (std::size_t offset = data_offset; offset < size; offset += BLOCK_SIZE)
+  {
+    const char* p = data + offset;
+    if (offset > data_offset)
+      p = next_line(p - 1, data_end);  // the first line starting in it
+
+    // skip anything unparseable, like blank lines
+    while (p < data_end &&
+      !parse_line(p, line_end(p, data_end), nullptr, line))
+      p = next_line(p, data_end);
+    if (p >= data_end)
+      break;
+
+    const std::size_t line_offset = static_cast<std::size_t>(p - data);
+    if (!blocks.empty() && blocks.back().offset == line_offset)
+      continue;  // a line longer than a block
+    if (!blocks.empty() && line.t < blocks.back().t)
+      _sorted = false;
+
+    Block block;
+    block.t = line.t;
+    block.offset = line_offset;
+    blocks.push_back(block);
+
+    if (job && blocks.size() % 1024 == 0)
+    {
+      if (job->cancelled())
+        return false;
+      job->set_progress(
+        static_cast<double>(blocks.size()) / num_blocks);
+    }
+  }
+
+  if (blocks.empty())
+  {
+    error = "there are no poses in the log";
+    return false;
+  }
+
+  _start_time = blocks.front().t;
+  _end_time = blocks.back().t;
+  for (const char* p = data + blocks.back().offset; p < data_end;
+    p = next_line(p, data_end))
+  {
+    if (parse_line(p, line_end(p, data_end), nullptr, line))
+      _end_time = std::max(_end_time, line.t);
+  }
+
+  if (!_sorted)
+  {
+    // the best that can be done without reading the whole log
+    for (const Block& block : blocks)
+    {
+      _start_time = std::min(_start_time, block.t);
+      _end_time = std::max(_end_time, block.t);
+    }
+    printf("pose log isn't in time order; replay will skip poses\n");
+  }
+
+  printf("indexed pose log: %d blocks, t = %.3f to %.3f\n",
+    static_cast<int>(blocks.size()),
+    _start_time,
+    _end_time);
+  return true;
+}
+
+int PoseLog::robot_id(
+  const csv_utils::Field& robot,
+  const csv_utils::Field& fleet)
+{
+  const char* robot_begin = robot.first;
+  const char* robot_end = robot.second;
+  const char* fleet_begin = fleet.first;
+  const char* fleet_end = fleet.second;
+  csv_utils::trim(robot_begin, robot_end);
+  csv_utils::trim(fleet_begin, fleet_end);
+
+  robot_key.assign(fleet_begin, fleet_end);
+  robot_key.push_back('\0');
+  robot_key.append(robot_begin, robot_end);
+
+  const auto it = robot_ids.find(robot_key);
+  if (it != robot_ids.end())
+    return it->second;
+
+  Robot r;
+  r.name.assign(robot_begin, robot_end);
+  r.fleet.assign(fleet_begin, fleet_end);
+  const int id = static_cast<int>(_robots.size());
+  _robots.push_back(r);
+  robot_ids[robot_key] = id;
+  return id;
+}
+
+void PoseLog::poses_at(
+  const double t,
+  const double window,
+  const string& level_name,
+  vector<Pose>& poses)
+{
+  poses.clear();
+  if (blocks.empty())
+    return;
+
+  // start at the last block which begins before the window does; every
+  // line before it is older still
+  const double t0 = t - window;
+  auto it = std::lower_bound(
+    blocks.begin(),
+    blocks.end(),
+    t0,
+    [](const Block& block, const double value) { return block.t < value; });
+  if (it != blocks.begin())
+    --it;
+
+  // in an unsorted log, look a little further, in case of jitter
+  const double t_stop = _sorted ? t : t + window;
+
+  latest_pose.assign(_robots.size(), -1);
+  Line line;
+  for (const char* p = data + it->offset; p < data_end;
+    p = next_line(p, data_end))
+  {
+    if (!parse_line(p, line_end(p, data_end), &level_name, line))
+      continue;
+    if (line.t > t_stop)
+      break;
+    if (line.t < t0 || line.t > t || !line.on_level)
+      continue;
+
+    const int id = robot_id(line.robot, line.fleet);
+    if (id >= static_cast<int>(latest_pose.size()))
+      latest_pose.resize(id + 1, -1);
+
+    Pose pose;
+    pose.robot = id;
+    pose.t = line.t;
+    pose.x = line.x;
+    pose.y = line.y;
+    pose.yaw = line.yaw;
+    if (latest_pose[id] < 0)
+    {
+      latest_pose[id] = static_cast<int>(poses.size());
+      poses.push_back(pose);
+    }
+    else if (poses[latest_pose[id]].t <= pose.t)
+      poses[latest_pose[id]] = pose;
+  }
+}
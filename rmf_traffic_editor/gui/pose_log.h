@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef POSE_LOG_H
+#define POSE_LOG_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QFile>
+
+#include "csv_utils.h"
+#include "job_scheduler.h"
+
+/*
+ * A memory-mapped CSV log of timestamped robot poses, which can be
+ * queried for where every robot was at any instant.
+ *
+ * The columns are found by name if the first line is a header: "t" (or
+ * "time", "timestamp", "stamp") in seconds, "x" and "y" in meters, and
+ * optionally "yaw" (or "theta"), "robot" (or "robot_name", "name"),
+ * "fleet" (or "fleet_name") and "level" (or "level_name", "map_name").
+ * Without a header, the columns are t, x, y, yaw, robot, fleet.
+ *
+ * The log is expected to be in time order, as recorders write it. The
+ * index is then just the timestamp of the first line of every block of
+ * the file, so building it only touches one page per block, and finding
+ * an instant is a binary search followed by a scan of the few blocks
+ * leading up to it.
+ */
+
+class PoseLog
+{
+public:
+  PoseLog();
+  ~PoseLog();
+
+  struct Robot
+  {
+    std::string name;
+    std::string fleet;
+  };
+
+  struct Pose
+  {
+    int robot = -1;  // index into robots()
+    double t = 0.0;
+    double x = 0.0;
+    double y = 0.0;
+    double yaw = 0.0;
+  };
+
+  // maps the file; the QFile belongs to the thread this is called on
+  bool open(const std::string& filename);
+
+  // only reads the mapped file, so it can run on a worker thread
+  bool build_index(JobContext* job = nullptr);
+
+  double start_time() const { return _start_time; }
+  double end_time() const { return _end_time; }
+  bool sorted() const { return _sorted; }
+  const std::vector<Robot>& robots() const { return _robots; }
+  std::string error;
+
+  // the latest pose of each robot between t - window and t, only counting
+  // those on the given level if the log has a level column
+  void poses_at(
+    const double t,
+    const double window,
+    const std::string& level_name,
+    std::vector<Pose>& poses);
+
+private:
+  QFile file;
+  const char* data = nullptr;
+  const char* data_end = nullptr;
+
+  struct Columns
+  {
+    int t = 0;
+    int x = 1;
+    int y = 2;
+    int yaw = -1;
+    int robot = -1;
+    int fleet = -1;
+    int level = -1;
+    int last = 2;  // the rest of the line doesn't need to be looked at
+  };
+  Columns columns;
+
+  struct Block
+  {
+    double t = 0.0;  // of the first line which starts in it
+    std::size_t offset = 0;  // of that line
+  };
+  std::vector<Block> blocks;
+
+  double _start_time = 0.0;
+  double _end_time = 0.0;
+  bool _sorted = true;
+
+  std::vector<Robot> _robots;
+  std::unordered_map<std::string, int> robot_ids;
+  std::string robot_key;  // reused, so looking robots up doesn't allocate
+  std::vector<int> latest_pose;  // per robot, reused by poses_at()
+
+  struct Line
+  {
+    double t = 0.0;
+    double x = 0.0;
+    double y = 0.0;
+    double yaw = 0.0;
+    csv_utils::Field robot;
+    csv_utils::Field fleet;
+    bool on_level = true;
+  };
+
+  bool parse_header(std::size_t& data_offset);
+  bool parse_line(
+    const char* begin,
+    const char* end,
+    const std::string* level_name,
+    Line& line) const;
+  int robot_id(const csv_utils::Field& robot, const csv_utils::Field& fleet);
+};
+
+#endif
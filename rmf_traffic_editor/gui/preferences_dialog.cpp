@@ -41,6 +41,50 @@ PreferencesDialog::PreferencesDialog(QWidget* parent)
     thumbnail_path_button, &QAbstractButton::clicked,
     this, &PreferencesDialog::thumbnail_path_button_clicked);
 
+  QHBoxLayout* tile_source_layout = new QHBoxLayout;
+  tile_source_line_edit = new QLineEdit(
+    settings.value(preferences_keys::tile_source).toString(), this);
+  tile_source_line_edit->setPlaceholderText(
+    "default tile server; or a URL, .mbtiles file, or z/x/y directory");
+  tile_source_button = new QPushButton("Find...", this);
+  tile_source_layout->addWidget(new QLabel("map tile source:"));
+  tile_source_layout->addWidget(tile_source_line_edit);
+  tile_source_layout->addWidget(tile_source_button);
+  connect(
+    tile_source_button, &QAbstractButton::clicked,
+    this, &PreferencesDialog::tile_source_button_clicked);
+
+  QHBoxLayout* memory_budget_layout = new QHBoxLayout;
+  memory_budget_spin_box = new QSpinBox(this);
+  memory_budget_spin_box->setRange(0, 1 << 20);
+  memory_budget_spin_box->setSingleStep(256);
+  memory_budget_spin_box->setSuffix(" MB");
+  memory_budget_spin_box->setSpecialValueText("unlimited");
+  memory_budget_spin_box->setValue(
+    settings.value(preferences_keys::memory_budget_mb, 1024).toInt());
+  memory_budget_layout->addWidget(new QLabel("image cache budget:"));
+  memory_budget_layout->addWidget(memory_budget_spin_box);
+
+  QHBoxLayout* nudge_layout = new QHBoxLayout;
+  nudge_step_spin_box = new QDoubleSpinBox(this);
+  nudge_step_spin_box->setRange(0.001, 10.0);
+  nudge_step_spin_box->setDecimals(3);
+  nudge_step_spin_box->setSingleStep(0.005);
+  nudge_step_spin_box->setSuffix(" m");
+  nudge_step_spin_box->setValue(
+    settings.value(preferences_keys::nudge_step, 0.01).toDouble());
+  nudge_large_step_spin_box = new QDoubleSpinBox(this);
+  nudge_large_step_spin_box->setRange(0.001, 100.0);
+  nudge_large_step_spin_box->setDecimals(3);
+  nudge_large_step_spin_box->setSingleStep(0.05);
+  nudge_large_step_spin_box->setSuffix(" m");
+  nudge_large_step_spin_box->setValue(
+    settings.value(preferences_keys::nudge_large_step, 0.1).toDouble());
+  nudge_layout->addWidget(new QLabel("arrow key nudge:"));
+  nudge_layout->addWidget(nudge_step_spin_box);
+  nudge_layout->addWidget(new QLabel("with shift:"));
+  nudge_layout->addWidget(nudge_large_step_spin_box);
+
   QHBoxLayout* bottom_buttons_layout = new QHBoxLayout;
   bottom_buttons_layout->addWidget(cancel_button);
   bottom_buttons_layout->addWidget(ok_button);
@@ -59,6 +103,9 @@ PreferencesDialog::PreferencesDialog(QWidget* parent)
   QVBoxLayout* vbox_layout = new QVBoxLayout;
   vbox_layout->addWidget(open_previous_building_checkbox);
   vbox_layout->addLayout(thumbnail_path_layout);
+  vbox_layout->addLayout(tile_source_layout);
+  vbox_layout->addLayout(memory_budget_layout);
+  vbox_layout->addLayout(nudge_layout);
   // todo: some sort of separator (?)
   vbox_layout->addLayout(bottom_buttons_layout);
 
@@ -89,6 +136,17 @@ void PreferencesDialog::thumbnail_path_button_clicked()
   thumbnail_path_line_edit->setText(path);
 }
 
+void PreferencesDialog::tile_source_button_clicked()
+{
+  QFileDialog file_dialog(this, "Find Map Tile Source");
+  file_dialog.setFileMode(QFileDialog::ExistingFile);
+  file_dialog.setNameFilter("MBTiles (*.mbtiles)");
+  if (file_dialog.exec() != QDialog::Accepted)
+    return;// user clicked 'cancel'
+
+  tile_source_line_edit->setText(file_dialog.selectedFiles().first());
+}
+
 void PreferencesDialog::ok_button_clicked()
 {
   if (!thumbnail_path_line_edit->text().isEmpty())
@@ -110,6 +168,22 @@ void PreferencesDialog::ok_button_clicked()
     preferences_keys::thumbnail_path,
     thumbnail_path_line_edit->text());
 
+  settings.setValue(
+    preferences_keys::tile_source,
+    tile_source_line_edit->text().trimmed());
+
+  settings.setValue(
+    preferences_keys::memory_budget_mb,
+    memory_budget_spin_box->value());
+
+  settings.setValue(
+    preferences_keys::nudge_step,
+    nudge_step_spin_box->value());
+
+  settings.setValue(
+    preferences_keys::nudge_large_step,
+    nudge_large_step_spin_box->value());
+
   settings.setValue(
     preferences_keys::open_previous_building,
     open_previous_building_checkbox->isChecked());
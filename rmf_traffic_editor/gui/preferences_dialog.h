@@ -21,6 +21,8 @@
 #include <QDialog>
 class QLineEdit;
 class QCheckBox;
+class QDoubleSpinBox;
+class QSpinBox;
 
 
 class PreferencesDialog : public QDialog
@@ -32,11 +34,17 @@ public:
 private:
   QLineEdit* thumbnail_path_line_edit;
   QPushButton* thumbnail_path_button;
+  QLineEdit* tile_source_line_edit;
+  QPushButton* tile_source_button;
   QCheckBox* open_previous_building_checkbox;
+  QSpinBox* memory_budget_spin_box;
+  QDoubleSpinBox* nudge_step_spin_box;
+  QDoubleSpinBox* nudge_large_step_spin_box;
   QPushButton* ok_button, * cancel_button;
 
 private slots:
   void thumbnail_path_button_clicked();
+  void tile_source_button_clicked();
   void ok_button_clicked();
 };
 
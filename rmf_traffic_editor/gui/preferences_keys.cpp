@@ -18,3 +18,7 @@ const QString preferences_keys::viewport_center_x("editor/viewport_center_x");
 const QString preferences_keys::viewport_center_y("editor/viewport_center_y");
 const QString preferences_keys::viewport_scale("editor/viewport_scale");
 const QString preferences_keys::level_name("editor/level_name");
+const QString preferences_keys::tile_source("editor/tile_source");
+const QString preferences_keys::memory_budget_mb("editor/memory_budget_mb");
+const QString preferences_keys::nudge_step("editor/nudge_step");
+const QString preferences_keys::nudge_large_step("editor/nudge_large_step");
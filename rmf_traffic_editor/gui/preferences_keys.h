@@ -16,6 +16,10 @@ extern const QString viewport_center_x;
 extern const QString viewport_center_y;
 extern const QString viewport_scale;
 extern const QString level_name;
+extern const QString tile_source;
+extern const QString memory_budget_mb;
+extern const QString nudge_step;
+extern const QString nudge_large_step;
 }
 
 #endif
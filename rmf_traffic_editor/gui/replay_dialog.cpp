@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <cmath>
+
+#include <QtWidgets>
+
+#include "replay_dialog.h"
+
+// positions of the time slider; the spin box has the exact time
+static const int SLIDER_STEPS = 100000;
+
+static const int FRAME_MSEC = 16;
+
+// robot markers are drawn this big
+static const double MARKER_RADIUS_METERS = 0.35;
+
+
+ReplayDialog::ReplayDialog(
+  QWidget* parent,
+  Building& _building,
+  JobScheduler& _jobs,
+  const int _level_idx)
+: QDialog(parent),
+  building(_building),
+  jobs(_jobs),
+  level_idx(_level_idx)
+{
+  setWindowTitle("Trajectory Replay");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  load_button = new QPushButton("Load", this);  // first = [enter] button
+  close_button = new QPushButton("Close", this);
+
+  QHBoxLayout* log_hbox = new QHBoxLayout;
+  log_hbox->addWidget(new QLabel("Pose log:"));
+  log_line_edit = new QLineEdit(this);
+  log_hbox->addWidget(log_line_edit, 1);
+  QPushButton* browse_button = new QPushButton("Browse...", this);
+  log_hbox->addWidget(browse_button);
+  log_hbox->addWidget(load_button);
+  connect(
+    browse_button, &QAbstractButton::clicked,
+    this, &ReplayDialog::browse_button_clicked);
+  connect(
+    load_button, &QAbstractButton::clicked,
+    this, &ReplayDialog::load_button_clicked);
+
+  time_slider = new QSlider(Qt::Horizontal, this);
+  time_slider->setRange(0, SLIDER_STEPS);
+  connect(
+    time_slider, &QSlider::valueChanged,
+    this, &ReplayDialog::time_slider_moved);
+
+  QHBoxLayout* time_hbox = new QHBoxLayout;
+  play_button = new QPushButton("Play", this);
+  play_button->setCheckable(true);
+  connect(
+    play_button, &QAbstractButton::toggled,
+    this, &ReplayDialog::play_button_toggled);
+  time_hbox->addWidget(play_button);
+
+  speed_combo_box = new QComboBox(this);
+  for (const int speed : {1, 10, 60, 600, 3600})
+    speed_combo_box->addItem(QString("%1x").arg(speed), speed);
+  time_hbox->addWidget(speed_combo_box);
+
+  time_hbox->addWidget(new QLabel("t (s):"));
+  time_spin_box = new QDoubleSpinBox(this);
+  time_spin_box->setDecimals(2);
+  time_spin_box->setRange(0.0, 0.0);
+  time_spin_box->setKeyboardTracking(false);
+  connect(
+    time_spin_box,
+    QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+    this,
+    &ReplayDialog::time_spin_box_changed);
+  time_hbox->addWidget(time_spin_box, 1);
+
+  QHBoxLayout* window_hbox = new QHBoxLayout;
+  window_hbox->addWidget(new QLabel("Hide robots not seen for (s):"));
+  window_spin_box = new QDoubleSpinBox(this);
+  window_spin_box->setDecimals(1);
+  window_spin_box->setRange(0.1, 600.0);
+  window_spin_box->setValue(5.0);
+  connect(
+    window_spin_box,
+    QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+    this,
+    [this](double) { scrub(); });
+  window_hbox->addWidget(window_spin_box);
+
+  time_label = new QLabel(this);
+  status_label = new QLabel("No log loaded", this);
+  status_label->setWordWrap(true);
+
+  scrub_timer.setSingleShot(true);
+  scrub_timer.setInterval(FRAME_MSEC);
+  connect(&scrub_timer, &QTimer::timeout, this, &ReplayDialog::scrub);
+  play_timer.setInterval(FRAME_MSEC);
+  connect(&play_timer, &QTimer::timeout, this, &ReplayDialog::play_tick);
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addStretch(1);
+  bottom_buttons_hbox->addWidget(close_button);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(log_hbox);
+  top_vbox->addWidget(time_slider);
+  top_vbox->addLayout(time_hbox);
+  top_vbox->addLayout(window_hbox);
+  top_vbox->addWidget(time_label);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+  set_controls_enabled(false);
+  resize(600, 250);
+}
+
+ReplayDialog::~ReplayDialog()
+{
+  jobs.cancel(job_id);
+}
+
+void ReplayDialog::closeEvent(QCloseEvent* event)
+{
+  play_timer.stop();
+  scrub_timer.stop();
+  emit markers_changed(level_idx, std::vector<RobotMarkersItem::Marker>());
+  QDialog::closeEvent(event);
+}
+
+void ReplayDialog::set_controls_enabled(const bool enabled)
+{
+  time_slider->setEnabled(enabled);
+  time_spin_box->setEnabled(enabled);
+  play_button->setEnabled(enabled);
+}
+
+void ReplayDialog::browse_button_clicked()
+{
+  const QString filename = QFileDialog::getOpenFileName(
+    this,
+    "Open Pose Log",
+    QFileInfo(log_line_edit->text()).path(),
+    "Pose logs (*.csv);;All files (*)");
+  if (filename.isEmpty())
+    return;
+  log_line_edit->setText(filename);
+  load_button_clicked();
+}
+
+void ReplayDialog::load_button_clicked()
+{
+  play_button->setChecked(false);
+  jobs.cancel(job_id);
+
+  // mapping the file is quick, but indexing it means paging through it
+  auto new_log = std::make_shared<PoseLog>();
+  if (!new_log->open(log_line_edit->text().toStdString()))
+  {
+    QMessageBox::warning(
+      this,
+      "Trajectory Replay",
+      QString::fromStdString(new_log->error));
+    return;
+  }
+
+  log.reset();
+  robot_colors.clear();
+  meters_to_level = building.meters_to_level(level_idx);
+  set_controls_enabled(false);
+  load_button->setEnabled(false);
+  status_label->setText("Indexing...");
+  emit markers_changed(level_idx, std::vector<RobotMarkersItem::Marker>());
+
+  QPointer<ReplayDialog> dialog(this);
+  job_id = jobs.submit(
+    "Replay indexing",
+    JobScheduler::INTERACTIVE,
+    [new_log](JobContext& context)
+    {
+      return new_log->build_index(&context);
+    },
+    [dialog, new_log](const JobScheduler::Outcome outcome)
+    {
+      if (!dialog)
+        return;
+      dialog->load_button->setEnabled(true);
+      if (outcome != JobScheduler::SUCCEEDED)
+      {
+        dialog->status_label->setText("No log loaded");
+        if (outcome == JobScheduler::FAILED)
+          QMessageBox::warning(
+            dialog,
+            "Trajectory Replay",
+            QString("Unable to index the log: %1.")
+            .arg(QString::fromStdString(new_log->error)));
+        return;
+      }
+
+      dialog->log = new_log;
+      dialog->time_spin_box->blockSignals(true);
+      dialog->time_spin_box->setRange(
+        new_log->start_time(),
+        new_log->end_time());
+      dialog->time_spin_box->blockSignals(false);
+      dialog->set_controls_enabled(true);
+      dialog->set_time(new_log->start_time());
+      dialog->scrub();
+    });
+}
+
+void ReplayDialog::set_time(const double t)
+{
+  // move both controls without either of them scrubbing again
+  time = t;
+  if (!log)
+    return;
+  const double duration = log->end_time() - log->start_time();
+  const int step = duration > 0.0 ?
+    static_cast<int>(
+    std::round(SLIDER_STEPS * (t - log->start_time()) / duration)) :
+    0;
+  time_slider->blockSignals(true);
+  time_slider->setValue(step);
+  time_slider->blockSignals(false);
+  time_spin_box->blockSignals(true);
+  time_spin_box->setValue(t);
+  time_spin_box->blockSignals(false);
+}
+
+void ReplayDialog::time_slider_moved(int value)
+{
+  if (!log)
+    return;
+  const double duration = log->end_time() - log->start_time();
+  set_time(log->start_time() + duration * value / SLIDER_STEPS);
+  if (!scrub_timer.isActive())
+    scrub_timer.start();
+}
+
+void ReplayDialog::time_spin_box_changed(double value)
+{
+  set_time(value);
+  if (!scrub_timer.isActive())
+    scrub_timer.start();
+}
+
+void ReplayDialog::play_button_toggled(bool checked)
+{
+  if (checked && log)
+  {
+    if (time >= log->end_time())
+      set_time(log->start_time());
+    play_button->setText("Pause");
+    play_clock.start();
+    play_timer.start();
+  }
+  else
+  {
+    play_button->setText("Play");
+    play_timer.stop();
+  }
+}
+
+void ReplayDialog::play_tick()
+{
+  if (!log)
+    return;
+  const double speed = speed_combo_box->currentData().toDouble();
+  const double t = time + speed * play_clock.restart() / 1000.0;
+  if (t >= log->end_time())
+  {
+    set_time(log->end_time());
+    play_button->setChecked(false);
+  }
+  else
+    set_time(t);
+  scrub();
+}
+
+void ReplayDialog::scrub()
+{
+  if (!log || level_idx >= static_cast<int>(building.levels.size()))
+    return;
+
+  log->poses_at(
+    time,
+    window_spin_box->value(),
+    building.levels[level_idx].name,
+    poses);
+
+  // one color per fleet (or per robot, if there are no fleets)
+  const auto& robots = log->robots();
+  while (robot_colors.size() < robots.size())
+  {
+    const PoseLog::Robot& robot = robots[robot_colors.size()];
+    robot_colors.push_back(
+      RobotMarkersItem::color_for(
+        robot.fleet.empty() ? robot.name : robot.fleet));
+  }
+
+  const double mpp = building.levels[level_idx].drawing_meters_per_pixel;
+  const double radius = MARKER_RADIUS_METERS / (mpp > 0.0 ? mpp : 1.0);
+  std::vector<RobotMarkersItem::Marker> markers;
+  markers.reserve(poses.size());
+  for (const PoseLog::Pose& pose : poses)
+    markers.push_back(
+      RobotMarkersItem::marker_at(
+        meters_to_level,
+        pose.x,
+        pose.y,
+        pose.yaw,
+        radius,
+        robot_colors[pose.robot]));
+  emit markers_changed(level_idx, markers);
+
+  // timestamps which look like seconds since the epoch are shown as dates
+  if (time > 1e9)
+    time_label->setText(
+      QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(time * 1000.0))
+      .toString("yyyy-MM-dd hh:mm:ss.zzz"));
+  else
+    time_label->setText(QString("%1 s").arg(time, 0, 'f', 2));
+  status_label->setText(
+    QString("%1 robots shown, %2 seen so far%3")
+    .arg(poses.size())
+    .arg(robots.size())
+    .arg(log->sorted() ? "" : " (the log isn't in time order)"));
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef REPLAY_DIALOG_H
+#define REPLAY_DIALOG_H
+
+#include <memory>
+#include <vector>
+
+#include <QColor>
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QTransform>
+
+#include "building.h"
+#include "job_scheduler.h"
+#include "pose_log.h"
+#include "robot_markers_item.h"
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QLineEdit;
+class QSlider;
+
+
+class ReplayDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  ReplayDialog(
+    QWidget* parent,
+    Building& building,
+    JobScheduler& jobs,
+    const int level_idx);
+  ~ReplayDialog();  // cancels the indexing, if it's still running
+
+protected:
+  void closeEvent(QCloseEvent* event) override;
+
+private:
+  Building& building;
+  JobScheduler& jobs;
+  JobScheduler::JobId job_id = 0;
+  int level_idx = 0;
+
+  std::shared_ptr<PoseLog> log;
+  QTransform meters_to_level;
+  double time = 0.0;  // currently shown
+  std::vector<PoseLog::Pose> poses;
+  std::vector<QColor> robot_colors;  // by robot index
+
+  QLineEdit* log_line_edit;
+  QPushButton* load_button;
+  QSlider* time_slider;
+  QDoubleSpinBox* time_spin_box;
+  QPushButton* play_button;
+  QComboBox* speed_combo_box;
+  QDoubleSpinBox* window_spin_box;
+  QLabel* time_label;
+  QLabel* status_label;
+  QPushButton* close_button;
+
+  // scrubbing is redrawn at most once per frame, however often it moves
+  QTimer scrub_timer;
+  QTimer play_timer;
+  QElapsedTimer play_clock;
+
+  void set_time(const double t);
+  void scrub();
+  void set_controls_enabled(const bool enabled);
+
+private slots:
+  void browse_button_clicked();
+  void load_button_clicked();
+  void time_slider_moved(int value);
+  void time_spin_box_changed(double value);
+  void play_button_toggled(bool checked);
+  void play_tick();
+
+signals:
+  void markers_changed(
+    const int level_idx,
+    const std::vector<RobotMarkersItem::Marker>& markers);
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <cmath>
+#include <functional>
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include "robot_markers_item.h"
+
+
+RobotMarkersItem::RobotMarkersItem()
+{
+  // needed to get the exposed area in paint()
+  setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+  setZValue(250.0);  // above the level, below the mouse motion items
+}
+
+RobotMarkersItem::~RobotMarkersItem()
+{
+}
+
+void RobotMarkersItem::set_markers(const std::vector<Marker>& _markers)
+{
+  QRectF new_bounds;
+  for (const Marker& marker : _markers)
+  {
+    // the heading line sticks out past the circle
+    const double r = 1.6 * marker.radius;
+    new_bounds |= QRectF(
+      marker.position.x() - r,
+      marker.position.y() - r,
+      2 * r,
+      2 * r);
+  }
+  if (new_bounds != bounds)
+  {
+    prepareGeometryChange();
+    bounds = new_bounds;
+  }
+  markers = _markers;
+  update();
+}
+
+RobotMarkersItem::Marker RobotMarkersItem::marker_at(
+  const QTransform& meters_to_level,
+  const double x,
+  const double y,
+  const double yaw,
+  const double radius,
+  const QColor& color)
+{
+  Marker marker;
+  marker.position = meters_to_level.map(QPointF(x, y));
+  QPointF heading = meters_to_level.map(
+    QPointF(x + std::cos(yaw), y + std::sin(yaw))) - marker.position;
+  const double length = std::hypot(heading.x(), heading.y());
+  if (length > 0.0)
+    heading /= length;
+  marker.heading = heading;
+  marker.radius = radius;
+  marker.color = color;
+  return marker;
+}
+
+QColor RobotMarkersItem::color_for(const std::string& name)
+{
+  const std::size_t hash = std::hash<std::string>()(name);
+  return QColor::fromHsv(static_cast<int>(hash % 360), 200, 240);
+}
+
+QRectF RobotMarkersItem::boundingRect() const
+{
+  return bounds;
+}
+
+void RobotMarkersItem::paint(
+  QPainter* painter,
+  const QStyleOptionGraphicsItem* option,
+  QWidget*)
+{
+  painter->setRenderHint(QPainter::Antialiasing);
+  const QRectF& exposed = option->exposedRect;
+  QPen pen(Qt::black);
+  pen.setCosmetic(true);
+  pen.setWidthF(1.5);
+  for (const Marker& marker : markers)
+  {
+    const double r = marker.radius;
+    const QRectF rect(
+      marker.position.x() - r,
+      marker.position.y() - r,
+      2 * r,
+      2 * r);
+    if (!exposed.intersects(rect.adjusted(-r, -r, r, r)))
+      continue;
+
+    pen.setColor(marker.color.darker(200));
+    painter->setPen(pen);
+    painter->setBrush(marker.color);
+    painter->drawEllipse(rect);
+    painter->drawLine(
+      marker.position,
+      marker.position + 1.6 * r * marker.heading);
+  }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef ROBOT_MARKERS_ITEM_H
+#define ROBOT_MARKERS_ITEM_H
+
+#include <string>
+#include <vector>
+
+#include <QColor>
+#include <QGraphicsItem>
+#include <QPointF>
+#include <QRectF>
+#include <QTransform>
+
+/*
+ * Draws robots on a level, for the trajectory replay and the live feed.
+ * All of them are painted by this one item, rather than an item each, so
+ * moving them is just a repaint of this item and never touches the rest
+ * of the scene.
+ */
+
+class RobotMarkersItem : public QGraphicsItem
+{
+public:
+  struct Marker
+  {
+    QPointF position;  // level coordinates
+    QPointF heading;  // unit vector, in level coordinates
+    double radius = 1.0;  // level units
+    QColor color;
+  };
+
+  RobotMarkersItem();
+  ~RobotMarkersItem();
+
+  void set_markers(const std::vector<Marker>& markers);
+
+  // a marker for a pose in meters (see Building::meters_to_level)
+  static Marker marker_at(
+    const QTransform& meters_to_level,
+    const double x,
+    const double y,
+    const double yaw,
+    const double radius,
+    const QColor& color);
+
+  // the same color for the same fleet (or robot) name, every time
+  static QColor color_for(const std::string& name);
+
+  QRectF boundingRect() const override;
+
+  void paint(
+    QPainter* painter,
+    const QStyleOptionGraphicsItem* option,
+    QWidget* widget) override;
+
+private:
+  std::vector<Marker> markers;
+  QRectF bounds;
+};
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+
+#include "selection_set.h"
+
+using std::vector;
+
+
+std::size_t SelectionSet::ItemHash::operator()(const Item& item) const
+{
+  std::size_t h = static_cast<std::size_t>(item.type);
+  h = h * 1000003u ^ static_cast<std::size_t>(item.layer_idx);
+  h = h * 1000003u ^ static_cast<std::size_t>(item.idx);
+  return h;
+}
+
+bool SelectionSet::contains(const Item& item) const
+{
+  return _positions.find(item) != _positions.end();
+}
+
+bool SelectionSet::insert(const Item& item)
+{
+  if (!_positions.emplace(item, _items.size()).second)
+    return false;
+  _items.push_back(item);
+  return true;
+}
+
+bool SelectionSet::erase(const Item& item)
+{
+  auto it = _positions.find(item);
+  if (it == _positions.end())
+    return false;
+
+  // move the last item into the hole, so erasing is O(1) too
+  const std::size_t pos = it->second;
+  _positions.erase(it);
+  if (pos + 1 != _items.size())
+  {
+    _items[pos] = _items.back();
+    _positions[_items[pos]] = pos;
+  }
+  _items.pop_back();
+  return true;
+}
+
+void SelectionSet::clear()
+{
+  _items.clear();
+  _positions.clear();
+}
+
+void SelectionSet::erase_type(const Type type)
+{
+  erase_if([type](const Item& item) { return item.type == type; });
+}
+
+void SelectionSet::erase_index(
+  const Type type,
+  const int idx,
+  const int layer_idx)
+{
+  bool changed = false;
+  vector<Item> items;
+  items.reserve(_items.size());
+  for (const Item& item : _items)
+  {
+    if (item.type != type || item.layer_idx != layer_idx || item.idx < idx)
+    {
+      items.push_back(item);
+      continue;
+    }
+    changed = true;
+    if (item.idx > idx)
+      items.push_back(Item(type, item.idx - 1, layer_idx));
+  }
+  if (changed)
+    rebuild(items);
+}
+
+int SelectionSet::first(const Type type, const int layer_idx) const
+{
+  int min_idx = -1;
+  for (const Item& item : _items)
+  {
+    if (item.type == type &&
+      item.layer_idx == layer_idx &&
+      (min_idx < 0 || item.idx < min_idx))
+      min_idx = item.idx;
+  }
+  return min_idx;
+}
+
+vector<int> SelectionSet::indices(const Type type, const int layer_idx) const
+{
+  vector<int> result;
+  for (const Item& item : _items)
+  {
+    if (item.type == type && item.layer_idx == layer_idx)
+      result.push_back(item.idx);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void SelectionSet::rebuild(const vector<Item>& items)
+{
+  clear();
+  for (const Item& item : items)
+    insert(item);
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef SELECTION_SET_H
+#define SELECTION_SET_H
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * The selected elements of a level. Membership tests are O(1) and
+ * iteration only visits what is actually selected, so neither clearing the
+ * selection nor finding "the selected vertex" has to scan every element of
+ * a large map.
+ *
+ * Elements are identified by their index in the level's containers, so
+ * anything which erases elements has to update (or clear) the selection.
+ */
+
+class SelectionSet
+{
+public:
+  // in the order Level::get_selected_items() has always reported them
+  enum Type
+  {
+    EDGE = 0,
+    MODEL,
+    VERTEX,
+    FIDUCIAL,
+    POLYGON,
+    FEATURE,
+    CONSTRAINT
+  };
+
+  struct Item
+  {
+    Type type = VERTEX;
+    int idx = -1;
+    int layer_idx = 0;  // features only: 0 = floorplan, n = layers[n-1]
+
+    Item() {}
+    Item(const Type _type, const int _idx, const int _layer_idx = 0)
+    : type(_type), idx(_idx), layer_idx(_layer_idx) {}
+
+    bool operator==(const Item& other) const
+    {
+      return type == other.type &&
+        idx == other.idx &&
+        layer_idx == other.layer_idx;
+    }
+  };
+
+  struct ItemHash
+  {
+    std::size_t operator()(const Item& item) const;
+  };
+
+  // Re-applies the selected or unselected style to the graphics items
+  // which were drawn for one element.
+  typedef std::function<void(const bool selected)> Restyler;
+
+  bool contains(const Item& item) const;
+  bool contains(const Type type, const int idx, const int layer_idx = 0) const
+  {
+    return contains(Item(type, idx, layer_idx));
+  }
+
+  // these return true if the selection actually changed
+  bool insert(const Item& item);
+  bool erase(const Item& item);
+
+  void clear();
+
+  // forget all items of one type, such as after erasing all of them
+  void erase_type(const Type type);
+
+  // forget one item and shift the higher indices of the same type (and
+  // layer) down by one, to follow an erase() from the element container
+  void erase_index(const Type type, const int idx, const int layer_idx = 0);
+
+  template<typename Predicate>
+  void erase_if(Predicate predicate)
+  {
+    std::vector<Item> keep;
+    for (const Item& item : _items)
+    {
+      if (!predicate(item))
+        keep.push_back(item);
+    }
+    if (keep.size() != _items.size())
+      rebuild(keep);
+  }
+
+  // lowest selected index of a type (and layer), or -1 if there isn't one
+  int first(const Type type, const int layer_idx = 0) const;
+
+  // all selected indices of a type (and layer), in ascending order
+  std::vector<int> indices(const Type type, const int layer_idx = 0) const;
+
+  bool empty() const { return _items.empty(); }
+  std::size_t size() const { return _items.size(); }
+  const std::vector<Item>& items() const { return _items; }
+
+private:
+  std::vector<Item> _items;
+  std::unordered_map<Item, std::size_t, ItemHash> _positions;
+
+  void rebuild(const std::vector<Item>& items);
+};
+
+#endif
@@ -0,0 +1,535 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <unordered_map>
+
+#include <QtConcurrent/QtConcurrent>
+
+#include "skeleton.h"
+
+using std::vector;
+
+// number of rows handed to a worker thread at a time
+static const int BAND_SIZE = 64;
+
+// offsets of the 8 neighbors, in the bit order of the neighborhood code:
+// N, NE, E, SE, S, SW, W, NW
+static const int DX[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int DY[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+
+Skeleton::Skeleton()
+{
+}
+
+Skeleton::~Skeleton()
+{
+}
+
+int Skeleton::neighborhood(
+  const uint8_t* above,
+  const uint8_t* row,
+  const uint8_t* below,
+  const int x)
+{
+  // only bit 0 of each pixel is the image, thin() uses the others as flags
+  return (above[x] & 1) |
+    (above[x + 1] & 1) << 1 |
+    (row[x + 1] & 1) << 2 |
+    (below[x + 1] & 1) << 3 |
+    (below[x] & 1) << 4 |
+    (below[x - 1] & 1) << 5 |
+    (row[x - 1] & 1) << 6 |
+    (above[x - 1] & 1) << 7;
+}
+
+void Skeleton::thin(vector<uint8_t>& image, const int width, const int height)
+{
+  if (width < 3 || height < 3)
+  {
+    std::fill(image.begin(), image.end(), 0);
+    return;
+  }
+
+  // deletion tables for the two subiterations, indexed by neighborhood code
+  uint8_t lut[2][256];
+  for (int code = 0; code < 256; code++)
+  {
+    const bool p2 = code & 1, p3 = code & 2, p4 = code & 4, p5 = code & 8;
+    const bool p6 = code & 16, p7 = code & 32, p8 = code & 64, p9 = code & 128;
+    const int c = (!p2 && (p3 || p4)) + (!p4 && (p5 || p6)) +
+      (!p6 && (p7 || p8)) + (!p8 && (p9 || p2));
+    const int n1 = (p9 || p2) + (p3 || p4) + (p5 || p6) + (p7 || p8);
+    const int n2 = (p2 || p3) + (p4 || p5) + (p6 || p7) + (p8 || p9);
+    const int n = std::min(n1, n2);
+    const bool m0 = (p6 || p7 || !p9) && p8;
+    const bool m1 = (p2 || p3 || !p5) && p4;
+    const bool candidate = c == 1 && n >= 2 && n <= 3;
+    lut[0][code] = candidate && !m0;
+    lut[1][code] = candidate && !m1;
+  }
+
+  // normalize to 0/1, with an empty one-pixel border so that every pixel
+  // we look at has a full neighborhood
+  for (auto& p : image)
+    p = p ? 1 : 0;
+  std::fill(image.begin(), image.begin() + width, 0);
+  std::fill(image.end() - width, image.end(), 0);
+  for (int y = 0; y < height; y++)
+  {
+    image[static_cast<std::size_t>(y) * width] = 0;
+    image[static_cast<std::size_t>(y) * width + width - 1] = 0;
+  }
+
+  // only pixels on the boundary can ever be deleted, so the thinning works
+  // on a list of candidates: initially the boundary, then the neighbors of
+  // whatever was deleted. Candidates are flagged in bit 1 of the image so
+  // that they're only queued once.
+  struct Band
+  {
+    int row_begin = 0;
+    int row_end = 0;
+    vector<std::size_t> boundary;
+  };
+  vector<Band> bands;
+  for (int y = 1; y < height - 1; y += BAND_SIZE)
+  {
+    Band band;
+    band.row_begin = y;
+    band.row_end = std::min(y + BAND_SIZE, height - 1);
+    bands.push_back(band);
+  }
+  QtConcurrent::blockingMap(
+    bands,
+    [&](Band& band)
+    {
+      for (int y = band.row_begin; y < band.row_end; y++)
+      {
+        const uint8_t* row = &image[static_cast<std::size_t>(y) * width];
+        for (int x = 1; x < width - 1; x++)
+        {
+          // skip empty runs a word at a time
+          uint64_t word;
+          while (x + 8 < width)
+          {
+            std::memcpy(&word, row + x, sizeof(word));
+            if (word)
+              break;
+            x += 8;
+          }
+          if (row[x] && neighborhood(row - width, row, row + width, x) != 255)
+            band.boundary.push_back(static_cast<std::size_t>(y) * width + x);
+        }
+      }
+    });
+
+  vector<std::size_t> candidates;
+  for (const Band& band : bands)
+    candidates.insert(
+      candidates.end(),
+      band.boundary.begin(),
+      band.boundary.end());
+  for (const std::size_t i : candidates)
+    image[i] |= 2;
+
+  std::ptrdiff_t offsets[8];
+  for (int j = 0; j < 8; j++)
+    offsets[j] = static_cast<std::ptrdiff_t>(DY[j]) * width + DX[j];
+
+  const std::size_t chunk_size = 16384;
+  vector<uint8_t> deleted;
+  vector<std::size_t> next;
+  int quiet_subiterations = 0;
+  for (int k = 0; quiet_subiterations < 2 && !candidates.empty(); k = 1 - k)
+  {
+    // decide every deletion of this subiteration, reading only
+    deleted.assign(candidates.size(), 0);
+    vector<std::size_t> chunks;
+    for (std::size_t i = 0; i < candidates.size(); i += chunk_size)
+      chunks.push_back(i);
+    QtConcurrent::blockingMap(
+      chunks,
+      [&](const std::size_t chunk_begin)
+      {
+        const std::size_t chunk_end =
+          std::min(chunk_begin + chunk_size, candidates.size());
+        for (std::size_t i = chunk_begin; i < chunk_end; i++)
+        {
+          const uint8_t* p = &image[candidates[i]];
+          deleted[i] = lut[k][neighborhood(p - width, p, p + width, 0)];
+        }
+      });
+
+    // then apply them all at once, and queue up the neighbors
+    next.clear();
+    std::size_t num_deleted = 0;
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+      if (deleted[i])
+      {
+        image[candidates[i]] = 0;
+        num_deleted++;
+      }
+      else
+        next.push_back(candidates[i]);
+    }
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+      if (!deleted[i])
+        continue;
+      for (int j = 0; j < 8; j++)
+      {
+        const std::size_t n = candidates[i] + offsets[j];
+        if (image[n] == 1)
+        {
+          image[n] = 3;
+          next.push_back(n);
+        }
+      }
+    }
+    candidates.swap(next);
+    quiet_subiterations = num_deleted ? 0 : quiet_subiterations + 1;
+  }
+
+  for (auto& p : image)
+    p &= 1;
+}
+
+void Skeleton::simplify(
+  const vector<Point>& points,
+  const std::size_t first,
+  const std::size_t last,
+  const double tolerance,
+  vector<bool>& keep)
+{
+  // Douglas-Peucker
+  if (last <= first + 1)
+    return;
+  const Point& a = points[first];
+  const Point& b = points[last];
+  const double dx = b.x - a.x;
+  const double dy = b.y - a.y;
+  const double len = std::hypot(dx, dy);
+
+  double max_dist = -1.0;
+  std::size_t max_idx = first;
+  for (std::size_t i = first + 1; i < last; i++)
+  {
+    const Point& p = points[i];
+    const double dist = len > 1e-9 ?
+      std::abs(dx * (a.y - p.y) - dy * (a.x - p.x)) / len :
+      std::hypot(p.x - a.x, p.y - a.y);
+    if (dist > max_dist)
+    {
+      max_dist = dist;
+      max_idx = i;
+    }
+  }
+
+  // closed loops always keep their farthest point, so they stay loops
+  if (max_dist <= tolerance && len > 1e-9)
+    return;
+  keep[max_idx] = true;
+  simplify(points, first, max_idx, tolerance, keep);
+  simplify(points, max_idx, last, tolerance, keep);
+}
+
+void Skeleton::extract_graph(
+  const vector<uint8_t>& skeleton,
+  const int width,
+  const int height)
+{
+  nodes.clear();
+  edges.clear();
+
+  // 0 = background, 1 = untraced skeleton, 2 = traced
+  vector<uint8_t> sk(skeleton.size());
+  for (std::size_t i = 0; i < skeleton.size(); i++)
+    sk[i] = skeleton[i] ? 1 : 0;
+
+  auto is_set = [&](const int x, const int y)
+    {
+      return x >= 0 && y >= 0 && x < width && y < height &&
+        sk[static_cast<std::size_t>(y) * width + x] != 0;
+    };
+  auto degree = [&](const int x, const int y)
+    {
+      int d = 0;
+      for (int i = 0; i < 8; i++)
+        d += is_set(x + DX[i], y + DY[i]);
+      return d;
+    };
+
+  // every skeleton pixel which isn't simply part of a curve is a node
+  // pixel; touching node pixels (e.g. around a junction) form one node
+  std::unordered_map<std::size_t, int> node_of_pixel;
+  vector<Point> node_pos;
+  auto add_node = [&](const int x0, const int y0)
+    {
+      const int id = static_cast<int>(node_pos.size());
+      vector<std::pair<int, int>> stack(1, std::make_pair(x0, y0));
+      node_of_pixel[static_cast<std::size_t>(y0) * width + x0] = id;
+      double sx = 0.0, sy = 0.0;
+      int count = 0;
+      while (!stack.empty())
+      {
+        const int x = stack.back().first;
+        const int y = stack.back().second;
+        stack.pop_back();
+        sx += x;
+        sy += y;
+        count++;
+        for (int i = 0; i < 8; i++)
+        {
+          const int nx = x + DX[i];
+          const int ny = y + DY[i];
+          if (!is_set(nx, ny) || degree(nx, ny) == 2)
+            continue;
+          const std::size_t ni = static_cast<std::size_t>(ny) * width + nx;
+          if (node_of_pixel.count(ni))
+            continue;
+          node_of_pixel[ni] = id;
+          stack.push_back(std::make_pair(nx, ny));
+        }
+      }
+      node_pos.push_back(Point(sx / count + 0.5, sy / count + 0.5));
+    };
+
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      const std::size_t i = static_cast<std::size_t>(y) * width + x;
+      if (sk[i] && degree(x, y) != 2 && !node_of_pixel.count(i))
+        add_node(x, y);
+    }
+  }
+
+  // walk from every node pixel along each curve leaving it
+  vector<Path> paths;
+  auto trace = [&](const int x0, const int y0)
+    {
+      const int start = node_of_pixel[static_cast<std::size_t>(y0) * width +
+        x0];
+      for (int i = 0; i < 8; i++)
+      {
+        int x = x0 + DX[i];
+        int y = y0 + DY[i];
+        std::size_t idx = static_cast<std::size_t>(y) * width + x;
+        if (!is_set(x, y) || sk[idx] != 1 || node_of_pixel.count(idx))
+          continue;
+
+        Path path;
+        path.start = start;
+        path.points.push_back(node_pos[start]);
+        int px = x0, py = y0;
+        while (true)
+        {
+          sk[idx] = 2;
+          path.points.push_back(Point(x + 0.5, y + 0.5));
+
+          int next_x = -1, next_y = -1;
+          for (int j = 0; j < 8 && path.end < 0; j++)
+          {
+            const int nx = x + DX[j];
+            const int ny = y + DY[j];
+            if ((nx == px && ny == py) || !is_set(nx, ny))
+              continue;
+            const std::size_t ni = static_cast<std::size_t>(ny) * width + nx;
+            auto it = node_of_pixel.find(ni);
+            if (it != node_of_pixel.end())
+              path.end = it->second;
+            else if (sk[ni] == 1 && next_x < 0)
+            {
+              next_x = nx;
+              next_y = ny;
+            }
+          }
+          if (path.end >= 0)
+            break;
+          if (next_x < 0)
+          {
+            // ran into an already-traced pixel; end the path here
+            path.end = static_cast<int>(node_pos.size());
+            node_pos.push_back(path.points.back());
+            path.points.pop_back();
+            break;
+          }
+          px = x;
+          py = y;
+          x = next_x;
+          y = next_y;
+          idx = static_cast<std::size_t>(y) * width + x;
+        }
+        path.points.push_back(node_pos[path.end]);
+        paths.push_back(path);
+      }
+    };
+
+  vector<std::size_t> node_pixels;
+  for (const auto& it : node_of_pixel)
+    node_pixels.push_back(it.first);
+  std::sort(node_pixels.begin(), node_pixels.end());
+  for (const std::size_t i : node_pixels)
+    trace(static_cast<int>(i % width), static_cast<int>(i / width));
+
+  // whatever is left are closed loops without any node; cut each one open
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      const std::size_t i = static_cast<std::size_t>(y) * width + x;
+      if (sk[i] != 1)
+        continue;
+      node_of_pixel[i] = static_cast<int>(node_pos.size());
+      node_pos.push_back(Point(x + 0.5, y + 0.5));
+      trace(x, y);
+    }
+  }
+
+  // prune short spurs which end in a dead end
+  vector<int> node_degree(node_pos.size(), 0);
+  for (const Path& path : paths)
+  {
+    node_degree[path.start]++;
+    node_degree[path.end]++;
+  }
+  auto length = [](const Path& path)
+    {
+      double len = 0.0;
+      for (std::size_t i = 1; i < path.points.size(); i++)
+        len += std::hypot(
+          path.points[i].x - path.points[i - 1].x,
+          path.points[i].y - path.points[i - 1].y);
+      return len;
+    };
+  for (int pass = 0; pass < 2; pass++)
+  {
+    vector<int> pruned;
+    for (std::size_t i = 0; i < paths.size(); i++)
+    {
+      Path& path = paths[i];
+      if (!path.alive)
+        continue;
+      if ((node_degree[path.start] == 1 || node_degree[path.end] == 1) &&
+        length(path) < min_branch_length)
+        pruned.push_back(static_cast<int>(i));
+    }
+    for (const int i : pruned)
+    {
+      paths[i].alive = false;
+      node_degree[paths[i].start]--;
+      node_degree[paths[i].end]--;
+    }
+  }
+
+  // join the two paths meeting at nodes which pruning left with degree 2
+  vector<vector<int>> incident(node_pos.size());
+  for (std::size_t i = 0; i < paths.size(); i++)
+  {
+    if (!paths[i].alive)
+      continue;
+    incident[paths[i].start].push_back(static_cast<int>(i));
+    incident[paths[i].end].push_back(static_cast<int>(i));
+  }
+  for (std::size_t n = 0; n < node_pos.size(); n++)
+  {
+    vector<int> live;
+    for (const int i : incident[n])
+    {
+      if (paths[i].alive)
+        live.push_back(i);
+    }
+    if (live.size() != 2 || live[0] == live[1])
+      continue;
+
+    Path a = paths[live[0]];
+    Path b = paths[live[1]];
+    if (a.end != static_cast<int>(n))
+    {
+      std::reverse(a.points.begin(), a.points.end());
+      std::swap(a.start, a.end);
+    }
+    if (b.start != static_cast<int>(n))
+    {
+      std::reverse(b.points.begin(), b.points.end());
+      std::swap(b.start, b.end);
+    }
+    Path joined;
+    joined.start = a.start;
+    joined.end = b.end;
+    joined.points = a.points;
+    joined.points.insert(
+      joined.points.end(),
+      b.points.begin() + 1,
+      b.points.end());
+    paths[live[0]].alive = false;
+    paths[live[1]].alive = false;
+    paths.push_back(joined);
+    incident[joined.start].push_back(static_cast<int>(paths.size()) - 1);
+    incident[joined.end].push_back(static_cast<int>(paths.size()) - 1);
+  }
+
+  // simplify every remaining path into straight edges
+  vector<int> output_node(node_pos.size(), -1);
+  auto node_index = [&](const int n)
+    {
+      if (output_node[n] < 0)
+      {
+        output_node[n] = static_cast<int>(nodes.size());
+        nodes.push_back(node_pos[n]);
+      }
+      return output_node[n];
+    };
+  std::set<std::pair<int, int>> edge_set;
+  for (const Path& path : paths)
+  {
+    if (!path.alive || path.points.size() < 2)
+      continue;
+    vector<bool> keep(path.points.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+    simplify(path.points, 0, path.points.size() - 1, simplify_tolerance, keep);
+
+    int prev = node_index(path.start);
+    for (std::size_t i = 1; i < path.points.size(); i++)
+    {
+      if (!keep[i])
+        continue;
+      int cur;
+      if (i == path.points.size() - 1)
+        cur = node_index(path.end);
+      else
+      {
+        cur = static_cast<int>(nodes.size());
+        nodes.push_back(path.points[i]);
+      }
+      if (cur != prev)
+      {
+        const auto key =
+          std::make_pair(std::min(prev, cur), std::max(prev, cur));
+        if (edge_set.insert(key).second)
+          edges.push_back(std::make_pair(prev, cur));
+      }
+      prev = cur;
+    }
+  }
+}
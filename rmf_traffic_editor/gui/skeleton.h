@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SKELETON_H
+#define SKELETON_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ * Thins a binary image down to its one-pixel-wide 8-connected skeleton,
+ * and turns that skeleton into a graph of nodes joined by straight edges.
+ *
+ * Thinning uses the two-subiteration algorithm of Guo and Hall. Only
+ * boundary pixels can be deleted, so each subiteration just examines the
+ * current boundary (initially found by a row-parallel scan, afterwards the
+ * neighbors of the last deletions). Every deletion of a subiteration is
+ * decided in parallel, reading only, and then applied at once. The test
+ * itself is a lookup on the 8-bit neighborhood code of the pixel, so the
+ * total work is about proportional to the foreground area even on very
+ * large images.
+ */
+
+class Skeleton
+{
+public:
+  Skeleton();
+  ~Skeleton();
+
+  // spurs ending in a dead end shorter than this (pixels) are pruned
+  double min_branch_length = 10.0;
+
+  // maximum deviation (pixels) of a simplified edge from the skeleton
+  double simplify_tolerance = 1.5;
+
+  struct Point
+  {
+    double x = 0.0;
+    double y = 0.0;
+
+    Point() {}
+    Point(const double _x, const double _y) : x(_x), y(_y) {}
+  };
+
+  // graph found by extract_graph(), in pixel coordinates (pixel centers)
+  std::vector<Point> nodes;
+  std::vector<std::pair<int, int>> edges;
+
+  // thin a row-major image in place; nonzero pixels are the foreground.
+  // On return, skeleton pixels are 1 and everything else is 0.
+  static void thin(std::vector<uint8_t>& image, const int width,
+    const int height);
+
+  void extract_graph(
+    const std::vector<uint8_t>& skeleton,
+    const int width,
+    const int height);
+
+private:
+  struct Path
+  {
+    int start = -1;
+    int end = -1;
+    std::vector<Point> points;  // including both ends
+    bool alive = true;
+  };
+
+  static int neighborhood(
+    const uint8_t* above,
+    const uint8_t* row,
+    const uint8_t* below,
+    const int x);
+
+  static void simplify(
+    const std::vector<Point>& points,
+    const std::size_t first,
+    const std::size_t last,
+    const double tolerance,
+    std::vector<bool>& keep);
+};
+
+#endif
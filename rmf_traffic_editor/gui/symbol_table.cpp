@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include "symbol_table.h"
+
+using std::string;
+using std::vector;
+
+
+template<typename Key>
+static int lookup(
+  const std::unordered_map<Key, int>& map,
+  const Key& key)
+{
+  const auto it = map.find(key);
+  if (it == map.end())
+    return -1;
+  return it->second;
+}
+
+void SymbolTable::rebuild(
+  const vector<Level>& _levels,
+  const vector<Lift>& _lifts,
+  const vector<Graph>& _graphs)
+{
+  clear();
+
+  // if names are duplicated, the first one wins, as the old scans did
+  levels.reserve(_levels.size());
+  for (std::size_t i = 0; i < _levels.size(); i++)
+    levels.emplace(_levels[i].name, static_cast<int>(i));
+
+  lifts.reserve(_lifts.size());
+  for (std::size_t i = 0; i < _lifts.size(); i++)
+    lifts.emplace(_lifts[i].name, static_cast<int>(i));
+
+  graphs.reserve(_graphs.size());
+  for (std::size_t i = 0; i < _graphs.size(); i++)
+    graphs.emplace(_graphs[i].idx, static_cast<int>(i));
+
+  // lifts key their doors by level name, so levels sharing a name share
+  // doors, as they did when the lists were searched directly
+  lift_doors.resize(_lifts.size());
+  for (std::size_t i = 0; i < _lifts.size(); i++)
+  {
+    const Lift::LevelDoorMap& level_doors = _lifts[i].level_doors;
+    lift_doors[i].resize(_levels.size());
+    for (std::size_t j = 0; j < _levels.size(); j++)
+    {
+      const auto it = level_doors.find(_levels[j].name);
+      if (it != level_doors.end())
+        lift_doors[i][j].insert(it->second.begin(), it->second.end());
+    }
+  }
+}
+
+void SymbolTable::clear()
+{
+  levels.clear();
+  lifts.clear();
+  graphs.clear();
+  lift_doors.clear();
+}
+
+int SymbolTable::level(const string& name) const
+{
+  return lookup(levels, name);
+}
+
+int SymbolTable::lift(const string& name) const
+{
+  return lookup(lifts, name);
+}
+
+int SymbolTable::graph(const int graph_idx) const
+{
+  return lookup(graphs, graph_idx);
+}
+
+bool SymbolTable::lift_door_opens(
+  const int lift_idx,
+  const int level_idx,
+  const string& door_name) const
+{
+  if (lift_idx < 0 || lift_idx >= static_cast<int>(lift_doors.size()))
+    return false;
+  const auto& level_doors = lift_doors[lift_idx];
+  if (level_idx < 0 || level_idx >= static_cast<int>(level_doors.size()))
+    return false;
+  return level_doors[level_idx].count(door_name) > 0;
+}
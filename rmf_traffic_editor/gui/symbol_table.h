@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "graph.h"
+#include "level.h"
+#include "lift.h"
+
+/*
+ * Maps the names of a building's levels and lifts, and the indices of its
+ * graphs, to their positions in the building's vectors, so that resolving
+ * a name is O(1) rather than a scan of every level. It also indexes the
+ * names of the lift doors which open on each level, per lift.
+ *
+ * The table has to be rebuilt whenever one of those vectors is added to,
+ * erased from or reordered, an element is renamed, or a lift's level doors
+ * are edited. Building rebuilds it when the vectors have changed size, and
+ * re-checks every name hit against the vector. Misses and door lookups are
+ * trusted, though, so renames and door edits must rebuild it explicitly.
+ */
+
+class SymbolTable
+{
+public:
+  void rebuild(
+    const std::vector<Level>& levels,
+    const std::vector<Lift>& lifts,
+    const std::vector<Graph>& graphs);
+
+  void clear();
+
+  // these return -1 if the name (or graph index) is unknown
+  int level(const std::string& name) const;
+  int lift(const std::string& name) const;
+  int graph(const int graph_idx) const;
+
+  // whether the lift has a door of that name which opens on the level
+  bool lift_door_opens(
+    const int lift_idx,
+    const int level_idx,
+    const std::string& door_name) const;
+
+private:
+  std::unordered_map<std::string, int> levels;
+  std::unordered_map<std::string, int> lifts;
+  std::unordered_map<int, int> graphs;
+
+  // door names, by lift index and then level index
+  std::vector<std::vector<std::unordered_set<std::string>>> lift_doors;
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <QFileInfo>
+
+#include "directory_tile_provider.h"
+#include "http_tile_provider.h"
+#include "mbtiles_tile_provider.h"
+#include "tile_provider.h"
+
+const QString TileProvider::default_url_template(
+  "https://tiles.sandbox.open-rmf.org/tile/{z}/{x}/{y}.png");
+
+
+TileProvider::TileProvider(QObject* parent)
+: QObject(parent)
+{
+}
+
+TileProvider::~TileProvider()
+{
+  stop_workers();
+}
+
+int TileProvider::max_requests_in_flight() const
+{
+  return 2 * thread_pool.maxThreadCount();
+}
+
+void TileProvider::decode(
+  const int zoom,
+  const int x,
+  const int y,
+  const QByteArray& bytes,
+  const bool grayscale)
+{
+  QImage image;
+  if (bytes.isEmpty() || !image.loadFromData(bytes))
+  {
+    emit tile_failed(zoom, x, y);
+    return;
+  }
+  if (grayscale)
+    image = image.convertToFormat(QImage::Format_Grayscale8);
+  emit tile_ready(zoom, x, y, image);
+}
+
+void TileProvider::stop_workers()
+{
+  thread_pool.clear();
+  thread_pool.waitForDone();
+}
+
+TileProvider* TileProvider::create(
+  const QString& source,
+  MapTileCache& cache,
+  QObject* parent)
+{
+  if (source.isEmpty())
+    return new HttpTileProvider(parent, default_url_template, cache);
+
+  if (source.startsWith("http://") || source.startsWith("https://"))
+    return new HttpTileProvider(parent, source, cache);
+
+  const QFileInfo info(source);
+  if (info.isDir())
+    return new DirectoryTileProvider(parent, source);
+
+  if (info.isFile())
+  {
+    MBTilesTileProvider* mbtiles = new MBTilesTileProvider(parent, source);
+    if (mbtiles->is_valid())
+      return mbtiles;
+    delete mbtiles;
+  }
+
+  printf("unable to use tile source [%s]; using the default tile server\n",
+    source.toStdString().c_str());
+  return new HttpTileProvider(parent, default_url_template, cache);
+}
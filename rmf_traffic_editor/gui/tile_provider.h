@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef TILE_PROVIDER_H
+#define TILE_PROVIDER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+class MapTileCache;
+
+/*
+ * A source of basemap tiles in the usual z/x/y "slippy map" scheme.
+ *
+ * Requests are asynchronous: every request ends with either tile_ready()
+ * or tile_failed(). Tiles are read and decoded on the provider's own
+ * thread pool, so the signals may be emitted from a worker thread; they
+ * reach receivers on the GUI thread as queued connections.
+ */
+
+class TileProvider : public QObject
+{
+  Q_OBJECT
+
+public:
+  TileProvider(QObject* parent);
+  virtual ~TileProvider();
+
+  virtual QString description() const = 0;
+
+  virtual void request(const int zoom, const int x, const int y) = 0;
+
+  // remote sources are throttled to avoid overloading the server
+  virtual int max_requests_in_flight() const;
+
+  virtual int max_zoom() const { return 20; }
+
+  // The source is either empty (the default tile server), an http(s) URL
+  // template containing {z}, {x} and {y}, a raster or vector .mbtiles
+  // file, or the root of a z/x/y directory tree.
+  static TileProvider* create(
+    const QString& source,
+    MapTileCache& cache,
+    QObject* parent);
+
+  static const QString default_url_template;
+
+signals:
+  void tile_ready(int zoom, int x, int y, QImage image);
+  void tile_failed(int zoom, int x, int y);
+
+protected:
+  QThreadPool thread_pool;
+
+  // decode a tile on the calling (worker) thread and emit the result
+  void decode(
+    const int zoom,
+    const int x,
+    const int y,
+    const QByteArray& bytes,
+    const bool grayscale = true);
+
+  // derived classes must call this in their destructor, before the
+  // resources used by their workers are released
+  void stop_workers();
+};
+
+#endif
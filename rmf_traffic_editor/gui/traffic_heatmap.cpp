@@ -0,0 +1,578 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsScene>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+
+#include "csv_utils.h"
+#include "traffic_heatmap.h"
+
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+static const char BINARY_MAGIC[] = "POSELOG1";
+static const std::size_t BINARY_MAGIC_SIZE = 8;
+static const std::size_t BINARY_RECORD_SIZE = 2 * sizeof(float);
+
+// bytes of the log handed to a worker thread at a time
+static const std::size_t PIECE_SIZE = 8 << 20;
+
+// every worker has its own copy of the grid, so the grid is coarsened if
+// needed to stay within this many cells a side, and the number of workers
+// is limited so that all of their grids together stay within this size
+static const int MAX_GRID_SIZE = 2048;
+static const std::size_t MAX_PARTIAL_BYTES = 256 << 20;
+
+// the grid reaches this far beyond the drawing and the vertices
+static const double MARGIN_METERS = 2.0;
+
+
+namespace {
+
+// where a pose lands, in grid cells: the mapping from meters to level
+// coordinates and then to cells, folded into one affine transform
+struct Grid
+{
+  int width = 0;
+  int height = 0;
+  double a11 = 1.0, a12 = 0.0, a21 = 0.0, a22 = 1.0, b1 = 0.0, b2 = 0.0;
+  vector<int> nearest_lane;  // per cell, or -1 if no lane is close enough
+
+  // returns the cell index, or -1 if it's off the grid (or not a number)
+  inline int cell(const double x, const double y) const
+  {
+    const double gx = a11 * x + a21 * y + b1;
+    const double gy = a12 * x + a22 * y + b2;
+    if (!(gx >= 0.0 && gx < width && gy >= 0.0 && gy < height))
+      return -1;
+    return static_cast<int>(gy) * width + static_cast<int>(gx);
+  }
+};
+
+// what one worker thread has accumulated
+struct Partial
+{
+  vector<uint32_t> counts;  // per cell
+  vector<uint64_t> lane_counts;
+  uint64_t num_poses = 0;
+  uint64_t num_lane_poses = 0;
+  uint64_t num_skipped = 0;
+
+  inline void add(const Grid& grid, const double x, const double y)
+  {
+    const int c = grid.cell(x, y);
+    if (c < 0)
+    {
+      num_skipped++;
+      return;
+    }
+    counts[c]++;
+    num_poses++;
+    const int lane = grid.nearest_lane[c];
+    if (lane >= 0)
+    {
+      lane_counts[lane]++;
+      num_lane_poses++;
+    }
+  }
+};
+
+struct CsvColumns
+{
+  int x = 1;
+  int y = 2;
+  int level = -1;
+  int last = 2;  // the rest of the line doesn't need to be looked at
+};
+
+// looks at the first line to see which columns to use, and returns where
+// the data starts, or nullptr if there are no x and y columns
+const char* parse_csv_header(
+  const char* data,
+  const char* end,
+  CsvColumns& columns)
+{
+  const char* newline = static_cast<const char*>(
+    std::memchr(data, '\n', end - data));
+  const char* line_end = newline ? newline : end;
+  const auto fields = csv_utils::split_line(data, line_end);
+
+  if (!csv_utils::is_header(fields))
+  {
+    if (fields.size() == 2)
+    {
+      columns.x = 0;
+      columns.y = 1;
+    }
+    columns.last = std::max(columns.x, columns.y);
+    return data;
+  }
+
+  columns.x = csv_utils::find_column(fields, {"x"});
+  columns.y = csv_utils::find_column(fields, {"y"});
+  columns.level =
+    csv_utils::find_column(fields, {"level", "level_name", "map_name"});
+  if (columns.x < 0 || columns.y < 0)
+    return nullptr;
+  columns.last = std::max({columns.x, columns.y, columns.level});
+  return newline ? newline + 1 : end;
+}
+
+// counts the lines which start in [begin, end); the last one may run on
+// past the end, up to the end of the data
+void bin_csv_piece(
+  const char* data,
+  const char* data_end,
+  const char* begin,
+  const char* end,
+  const CsvColumns& columns,
+  const string& level_name,
+  const Grid& grid,
+  Partial& partial)
+{
+  const char* p = begin;
+  if (p > data && p[-1] != '\n')
+  {
+    // the previous piece has the line this starts in the middle of
+    p = static_cast<const char*>(std::memchr(p, '\n', data_end - p));
+    if (!p)
+      return;
+    p++;
+  }
+
+  while (p < end)
+  {
+    const char* newline = static_cast<const char*>(
+      std::memchr(p, '\n', data_end - p));
+    const char* line_end = newline ? newline : data_end;
+
+    double x = 0.0, y = 0.0;
+    bool have_x = false, have_y = false;
+    bool on_level = columns.level < 0;
+    bool blank = true;
+    int field = 0;
+    const char* f = p;
+    while (true)
+    {
+      const char* field_end = static_cast<const char*>(
+        std::memchr(f, ',', line_end - f));
+      if (!field_end)
+        field_end = line_end;
+      if (field_end != f && !(field_end - f == 1 && *f == '\r'))
+        blank = false;
+
+      if (field == columns.x)
+        have_x = csv_utils::parse_number(f, field_end, x);
+      else if (field == columns.y)
+        have_y = csv_utils::parse_number(f, field_end, y);
+      else if (field == columns.level)
+        on_level = csv_utils::field_equals(f, field_end, level_name);
+
+      if (field_end == line_end || field == columns.last)
+        break;
+      f = field_end + 1;
+      field++;
+    }
+
+    if (have_x && have_y && on_level)
+      partial.add(grid, x, y);
+    else if (!blank)
+      partial.num_skipped++;
+
+    p = newline ? newline + 1 : data_end;
+  }
+}
+
+void bin_binary_piece(
+  const char* begin,
+  const char* end,
+  const Grid& grid,
+  Partial& partial)
+{
+  for (const char* p = begin; p + BINARY_RECORD_SIZE <= end;
+    p += BINARY_RECORD_SIZE)
+  {
+    float xy[2];
+    std::memcpy(xy, p, sizeof(xy));  // may not be aligned
+    partial.add(grid, xy[0], xy[1]);
+  }
+}
+
+double distance_to_segment(
+  const double px,
+  const double py,
+  const QPointF& a,
+  const QPointF& b)
+{
+  const double dx = b.x() - a.x();
+  const double dy = b.y() - a.y();
+  const double len_sq = dx * dx + dy * dy;
+  double t = 0.0;
+  if (len_sq > 0.0)
+    t = std::clamp(((px - a.x()) * dx + (py - a.y()) * dy) / len_sq, 0.0, 1.0);
+  return std::hypot(px - (a.x() + t * dx), py - (a.y() + t * dy));
+}
+
+}  // namespace
+
+
+TrafficHeatmap::TrafficHeatmap()
+{
+}
+
+TrafficHeatmap::~TrafficHeatmap()
+{
+}
+
+void TrafficHeatmap::clear()
+{
+  lanes.clear();
+  level_idx = -1;
+  num_poses = 0;
+  num_lane_poses = 0;
+  num_skipped = 0;
+  elapsed_seconds = 0.0;
+  error.clear();
+  overlay_image = QImage();
+  overlay_pixmap = QPixmap();
+}
+
+bool TrafficHeatmap::run(
+  const Level& level,
+  const int _level_idx,
+  const QTransform& meters_to_level,
+  JobContext* job)
+{
+  clear();
+
+  const double mpp = level.drawing_meters_per_pixel;
+  if (mpp <= 0.0 || resolution <= 0.0)
+  {
+    error = "the level scale isn't set";
+    return false;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QFile file(QString::fromStdString(log_filename));
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    error = "couldn't open " + log_filename;
+    return false;
+  }
+  const std::size_t size = static_cast<std::size_t>(file.size());
+  const char* data = nullptr;
+  if (size > 0)
+  {
+    // the OS pages it in (and drops it again) as it's read, so memory use
+    // doesn't grow with the size of the log
+    data = reinterpret_cast<const char*>(file.map(0, file.size()));
+    if (!data)
+    {
+      error = "couldn't map " + log_filename;
+      return false;
+    }
+  }
+  const char* data_end = data + size;
+
+  // the grid covers the drawing and all the vertices, with a margin
+  double min_x = 1e100, min_y = 1e100, max_x = -1e100, max_y = -1e100;
+  if (level.drawing_width > 0 && level.drawing_height > 0)
+  {
+    min_x = min_y = 0.0;
+    max_x = level.drawing_width;
+    max_y = level.drawing_height;
+  }
+  for (const Vertex& v : level.vertices)
+  {
+    min_x = std::min(min_x, v.x);
+    min_y = std::min(min_y, v.y);
+    max_x = std::max(max_x, v.x);
+    max_y = std::max(max_y, v.y);
+  }
+  if (min_x > max_x)
+  {
+    error = "the level is empty";
+    return false;
+  }
+  const double margin = (MARGIN_METERS + lane_radius) / mpp;
+  min_x -= margin;
+  min_y -= margin;
+  max_x += margin;
+  max_y += margin;
+
+  double cell = resolution / mpp;  // level units per cell
+  cell = std::max(
+    {
+      cell,
+      (max_x - min_x) / MAX_GRID_SIZE,
+      (max_y - min_y) / MAX_GRID_SIZE
+    });
+  const QPointF origin(min_x, min_y);
+
+  Grid grid;
+  grid.width = std::max(1, static_cast<int>(std::ceil((max_x - min_x) / cell)));
+  grid.height =
+    std::max(1, static_cast<int>(std::ceil((max_y - min_y) / cell)));
+  grid.a11 = meters_to_level.m11() / cell;
+  grid.a12 = meters_to_level.m12() / cell;
+  grid.a21 = meters_to_level.m21() / cell;
+  grid.a22 = meters_to_level.m22() / cell;
+  grid.b1 = (meters_to_level.dx() - origin.x()) / cell;
+  grid.b2 = (meters_to_level.dy() - origin.y()) / cell;
+  const std::size_t num_cells =
+    static_cast<std::size_t>(grid.width) * grid.height;
+
+  // find the nearest lane to each cell ahead of time, so that looking it
+  // up for a pose is just an array access
+  const int num_vertices = static_cast<int>(level.vertices.size());
+  for (std::size_t i = 0; i < level.edges.size(); i++)
+  {
+    const Edge& edge = level.edges[i];
+    if (edge.type != Edge::LANE ||
+      edge.start_idx < 0 || edge.start_idx >= num_vertices ||
+      edge.end_idx < 0 || edge.end_idx >= num_vertices)
+      continue;
+    LaneUsage lane;
+    lane.edge_idx = static_cast<int>(i);
+    const Vertex& v0 = level.vertices[edge.start_idx];
+    const Vertex& v1 = level.vertices[edge.end_idx];
+    lane.start = QPointF(v0.x, v0.y);
+    lane.end = QPointF(v1.x, v1.y);
+    lanes.push_back(lane);
+  }
+
+  grid.nearest_lane.assign(num_cells, -1);
+  {
+    vector<float> nearest_distance(num_cells, 1e30f);
+    const double r = lane_radius / mpp / cell;  // in cells
+    for (std::size_t i = 0; i < lanes.size(); i++)
+    {
+      const QPointF a = (lanes[i].start - origin) / cell;
+      const QPointF b = (lanes[i].end - origin) / cell;
+      const int x0 = std::max(
+        0, static_cast<int>(std::floor(std::min(a.x(), b.x()) - r)));
+      const int y0 = std::max(
+        0, static_cast<int>(std::floor(std::min(a.y(), b.y()) - r)));
+      const int x1 = std::min(
+        grid.width - 1,
+        static_cast<int>(std::ceil(std::max(a.x(), b.x()) + r)));
+      const int y1 = std::min(
+        grid.height - 1,
+        static_cast<int>(std::ceil(std::max(a.y(), b.y()) + r)));
+      for (int y = y0; y <= y1; y++)
+      {
+        for (int x = x0; x <= x1; x++)
+        {
+          const double d = distance_to_segment(x + 0.5, y + 0.5, a, b);
+          const std::size_t c = static_cast<std::size_t>(y) * grid.width + x;
+          if (d <= r && d < nearest_distance[c])
+          {
+            nearest_distance[c] = static_cast<float>(d);
+            grid.nearest_lane[c] = static_cast<int>(i);
+          }
+        }
+      }
+    }
+  }
+
+  // figure out the format, and split the rest into pieces
+  const bool binary = size >= BINARY_MAGIC_SIZE &&
+    std::memcmp(data, BINARY_MAGIC, BINARY_MAGIC_SIZE) == 0;
+  CsvColumns columns;
+  const char* begin = data;
+  std::size_t piece_size = PIECE_SIZE;
+  if (binary)
+  {
+    begin = data + BINARY_MAGIC_SIZE;
+    piece_size -= piece_size % BINARY_RECORD_SIZE;
+  }
+  else if (size > 0)
+  {
+    begin = parse_csv_header(data, data_end, columns);
+    if (!begin)
+    {
+      error = "the header has no x and y columns";
+      return false;
+    }
+  }
+  const std::size_t data_size = static_cast<std::size_t>(data_end - begin);
+  const int num_pieces =
+    static_cast<int>((data_size + piece_size - 1) / piece_size);
+
+  const int max_workers = std::max(
+    1,
+    static_cast<int>(MAX_PARTIAL_BYTES / (num_cells * sizeof(uint32_t))));
+  const int num_workers = std::max(
+    1,
+    std::min({QThread::idealThreadCount(), num_pieces, max_workers}));
+  vector<Partial> partials(num_workers);
+
+  std::atomic<int> next_piece {0};
+  std::atomic<int> num_pieces_done {0};
+  const string& level_name = level.name;
+  QtConcurrent::blockingMap(
+    partials,
+    [&](Partial& partial)
+    {
+      partial.counts.assign(num_cells, 0);
+      partial.lane_counts.assign(lanes.size(), 0);
+      int piece;
+      while ((piece = next_piece++) < num_pieces)
+      {
+        if (job && job->cancelled())
+          return;
+        const char* piece_begin = begin + piece * piece_size;
+        const char* piece_end =
+          begin + std::min(data_size, (piece + 1) * piece_size);
+        if (binary)
+          bin_binary_piece(piece_begin, piece_end, grid, partial);
+        else
+          bin_csv_piece(
+            data,
+            data_end,
+            piece_begin,
+            piece_end,
+            columns,
+            level_name,
+            grid,
+            partial);
+        if (job)
+          job->set_progress(
+            static_cast<double>(++num_pieces_done) / num_pieces);
+      }
+    });
+
+  if (job && job->cancelled())
+  {
+    clear();
+    return false;
+  }
+
+  // sum up what the workers found
+  vector<uint64_t> counts(num_cells, 0);
+  for (const Partial& partial : partials)
+  {
+    for (std::size_t c = 0; c < num_cells; c++)
+      counts[c] += partial.counts[c];
+    for (std::size_t i = 0; i < lanes.size(); i++)
+      lanes[i].poses += partial.lane_counts[i];
+    num_poses += partial.num_poses;
+    num_lane_poses += partial.num_lane_poses;
+    num_skipped += partial.num_skipped;
+  }
+  partials.clear();
+
+  std::stable_sort(
+    lanes.begin(),
+    lanes.end(),
+    [](const LaneUsage& a, const LaneUsage& b) { return a.poses > b.poses; });
+
+  // logarithmic color scale, since a robot parked somewhere for hours
+  // would otherwise wash out everything else
+  const uint64_t max_count = *std::max_element(counts.begin(), counts.end());
+  if (max_count > 0)
+  {
+    overlay_image = QImage(grid.width, grid.height, QImage::Format_ARGB32);
+    const double log_max = std::log1p(static_cast<double>(max_count));
+    for (int y = 0; y < grid.height; y++)
+    {
+      QRgb* row = reinterpret_cast<QRgb*>(overlay_image.scanLine(y));
+      const uint64_t* count_row =
+        counts.data() + static_cast<std::size_t>(y) * grid.width;
+      for (int x = 0; x < grid.width; x++)
+      {
+        if (count_row[x] == 0)
+        {
+          row[x] = qRgba(0, 0, 0, 0);
+          continue;
+        }
+        // blue, through green, to red
+        const double t = std::log1p(static_cast<double>(count_row[x])) /
+          log_max;
+        const int alpha = static_cast<int>(80 + 140 * t);
+        if (t < 0.5)
+          row[x] = qRgba(0, static_cast<int>(510 * t),
+              static_cast<int>(255 - 510 * t), alpha);
+        else
+          row[x] = qRgba(static_cast<int>(510 * t - 255),
+              static_cast<int>(510 - 510 * t), 0, alpha);
+      }
+    }
+    overlay_origin = origin;
+    overlay_pixel_size = cell;
+  }
+
+  level_idx = _level_idx;
+  elapsed_seconds = static_cast<double>(timer.elapsed()) / 1000.0;
+
+  printf("traffic heatmap: %s, %llu poses (%llu near lanes, %llu skipped), "
+    "%dx%d cells, %d threads, %.3f seconds\n",
+    binary ? "binary" : "csv",
+    static_cast<unsigned long long>(num_poses),
+    static_cast<unsigned long long>(num_lane_poses),
+    static_cast<unsigned long long>(num_skipped),
+    grid.width,
+    grid.height,
+    num_workers,
+    elapsed_seconds);
+
+  return true;
+}
+
+void TrafficHeatmap::draw(QGraphicsScene* scene, const Level& level) const
+{
+  if (!overlay_image.isNull())
+  {
+    if (overlay_pixmap.isNull())
+      overlay_pixmap = QPixmap::fromImage(overlay_image);
+
+    QGraphicsPixmapItem* item = scene->addPixmap(overlay_pixmap);
+    item->setPos(overlay_origin);
+    item->setScale(overlay_pixel_size);
+    item->setTransformationMode(Qt::FastTransformation);
+  }
+
+  if (lanes.empty() || lanes.front().poses == 0)
+    return;
+
+  // the busiest lane is drawn 1 meter wide, and the rest in proportion
+  const double mpp = level.drawing_meters_per_pixel;
+  const double max_poses = static_cast<double>(lanes.front().poses);
+  QPen pen(QColor::fromRgbF(1.0, 0.5, 0.0, 0.7));
+  pen.setCapStyle(Qt::RoundCap);
+  for (const LaneUsage& lane : lanes)
+  {
+    if (lane.poses == 0)
+      break;
+    pen.setWidthF((0.05 + 0.95 * lane.poses / max_poses) / mpp);
+    scene->addLine(QLineF(lane.start, lane.end), pen);
+  }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef TRAFFIC_HEATMAP_H
+#define TRAFFIC_HEATMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QImage>
+#include <QPixmap>
+#include <QPointF>
+#include <QTransform>
+
+#include "job_scheduler.h"
+#include "level.h"
+
+class QGraphicsScene;
+
+/*
+ * Shows where robots actually drove on a level, from a log of their poses:
+ * a heatmap of how many poses fell in each grid cell, plus every lane
+ * drawn with a thickness proportional to how many poses were on it.
+ *
+ * The log is memory-mapped rather than read, and split into pieces which
+ * are binned in parallel. Each worker thread accumulates into its own
+ * grid and lane counters, which are summed at the end, so memory use
+ * depends on the grid size and the number of threads, not on the size of
+ * the log. Two formats are recognized:
+ *
+ *   - CSV, one pose per line. If the first line is a header, the columns
+ *     named "x" and "y" are used, and if there is a "level" (or
+ *     "level_name" or "map_name") column, only the rows on this level
+ *     are counted. Without a header, lines of two fields are "x,y", and
+ *     longer ones are "t,x,y,...".
+ *
+ *   - binary: the 8 bytes "POSELOG1", then one little-endian float32 x
+ *     and float32 y per pose, all on this level.
+ *
+ * Poses are in meters, in the same frame the editor shows vertex
+ * coordinates in; the caller provides the mapping to level coordinates.
+ * A pose counts towards the nearest lane within lane_radius of it.
+ */
+
+class TrafficHeatmap
+{
+public:
+  TrafficHeatmap();
+  ~TrafficHeatmap();
+
+  std::string log_filename;
+  double resolution = 0.25;  // meters per heatmap cell
+  double lane_radius = 0.5;  // meters; poses further from lanes don't count
+
+  struct LaneUsage
+  {
+    int edge_idx = -1;
+    QPointF start, end;  // level coordinates, as of the last run
+    std::uint64_t poses = 0;
+  };
+
+  std::vector<LaneUsage> lanes;  // busiest first
+
+  int level_idx = -1;  // level of the last run, or -1 if there isn't one
+  std::uint64_t num_poses = 0;  // on this level, inside the heatmap
+  std::uint64_t num_lane_poses = 0;  // of those, near a lane
+  std::uint64_t num_skipped = 0;  // unparseable, elsewhere, or off the map
+  double elapsed_seconds = 0.0;
+  std::string error;  // why the last run failed, if it did
+
+  // doesn't touch any pixmaps, so it can run on a worker thread; if a job
+  // is given, it reports progress to it and stops early if it's cancelled
+  bool run(
+    const Level& level,
+    const int level_idx,
+    const QTransform& meters_to_level,
+    JobContext* job = nullptr);
+
+  void clear();
+
+  void draw(QGraphicsScene* scene, const Level& level) const;
+
+private:
+  QImage overlay_image;
+  mutable QPixmap overlay_pixmap;  // made from the image on the first draw
+  QPointF overlay_origin;  // level coordinates
+  double overlay_pixel_size = 1.0;  // level units per overlay pixel
+};
+
+#endif
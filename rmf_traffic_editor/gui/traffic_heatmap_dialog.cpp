@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#include <QtWidgets>
+
+#include "traffic_heatmap_dialog.h"
+
+
+TrafficHeatmapDialog::TrafficHeatmapDialog(
+  QWidget* parent,
+  Building& _building,
+  TrafficHeatmap& _heatmap,
+  JobScheduler& _jobs,
+  const int _level_idx)
+: QDialog(parent),
+  building(_building),
+  heatmap(_heatmap),
+  jobs(_jobs),
+  level_idx(_level_idx)
+{
+  setWindowTitle("Traffic Heatmap");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  run_button = new QPushButton("Run", this);  // first button = [enter] button
+  close_button = new QPushButton("Close", this);
+
+  QHBoxLayout* log_hbox = new QHBoxLayout;
+  log_hbox->addWidget(new QLabel("Pose log:"));
+  log_line_edit = new QLineEdit(
+    QString::fromStdString(heatmap.log_filename),
+    this);
+  log_hbox->addWidget(log_line_edit, 1);
+  QPushButton* browse_button = new QPushButton("Browse...", this);
+  log_hbox->addWidget(browse_button);
+  connect(
+    browse_button, &QAbstractButton::clicked,
+    this, &TrafficHeatmapDialog::browse_button_clicked);
+
+  QHBoxLayout* resolution_hbox = new QHBoxLayout;
+  resolution_hbox->addWidget(new QLabel("Heatmap resolution (m):"));
+  resolution_spin_box = new QDoubleSpinBox(this);
+  resolution_spin_box->setDecimals(2);
+  resolution_spin_box->setRange(0.05, 5.0);
+  resolution_spin_box->setSingleStep(0.05);
+  resolution_spin_box->setValue(heatmap.resolution);
+  resolution_hbox->addWidget(resolution_spin_box);
+
+  QHBoxLayout* lane_radius_hbox = new QHBoxLayout;
+  lane_radius_hbox->addWidget(new QLabel("Lane radius (m):"));
+  lane_radius_spin_box = new QDoubleSpinBox(this);
+  lane_radius_spin_box->setDecimals(2);
+  lane_radius_spin_box->setRange(0.05, 5.0);
+  lane_radius_spin_box->setSingleStep(0.05);
+  lane_radius_spin_box->setValue(heatmap.lane_radius);
+  lane_radius_hbox->addWidget(lane_radius_spin_box);
+
+  lane_table = new QTableWidget(this);
+  lane_table->setColumnCount(3);
+  lane_table->setHorizontalHeaderLabels(
+    QStringList() << "Edge" << "Poses" << "Share (%)");
+  lane_table->verticalHeader()->setVisible(false);
+  lane_table->horizontalHeader()->setSectionResizeMode(
+    QHeaderView::Stretch);
+  lane_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  lane_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  connect(
+    lane_table, &QTableWidget::cellClicked,
+    this, &TrafficHeatmapDialog::lane_cell_clicked);
+
+  status_label = new QLabel(this);
+  status_label->setWordWrap(true);
+  populate_lane_table();
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(close_button);
+  bottom_buttons_hbox->addWidget(run_button);
+  connect(
+    run_button, &QAbstractButton::clicked,
+    this, &TrafficHeatmapDialog::run_button_clicked);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(log_hbox);
+  top_vbox->addLayout(resolution_hbox);
+  top_vbox->addLayout(lane_radius_hbox);
+  top_vbox->addWidget(new QLabel("Busiest lanes:"));
+  top_vbox->addWidget(lane_table, 1);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+  resize(500, 600);
+}
+
+TrafficHeatmapDialog::~TrafficHeatmapDialog()
+{
+  jobs.cancel(job_id);
+}
+
+void TrafficHeatmapDialog::browse_button_clicked()
+{
+  const QString filename = QFileDialog::getOpenFileName(
+    this,
+    "Open Pose Log",
+    QFileInfo(log_line_edit->text()).path(),
+    "Pose logs (*.csv *.poses);;All files (*)");
+  if (!filename.isEmpty())
+    log_line_edit->setText(filename);
+}
+
+void TrafficHeatmapDialog::populate_lane_table()
+{
+  const bool current = heatmap.level_idx == level_idx;
+  const int num_rows =
+    current ? static_cast<int>(heatmap.lanes.size()) : 0;
+  lane_table->setRowCount(num_rows);
+  for (int row = 0; row < num_rows; row++)
+  {
+    const TrafficHeatmap::LaneUsage& lane = heatmap.lanes[row];
+    const double share = heatmap.num_lane_poses ?
+      100.0 * lane.poses / heatmap.num_lane_poses : 0.0;
+    lane_table->setItem(
+      row, 0, new QTableWidgetItem(QString::number(lane.edge_idx)));
+    lane_table->setItem(
+      row, 1, new QTableWidgetItem(QString::number(lane.poses)));
+    lane_table->setItem(
+      row, 2, new QTableWidgetItem(QString::number(share, 'f', 1)));
+  }
+
+  if (!current)
+    status_label->setText("Not run yet");
+  else
+    status_label->setText(
+      QString("%1 poses on this level, %2 near lanes, %3 skipped "
+      "(%4 seconds)")
+      .arg(heatmap.num_poses)
+      .arg(heatmap.num_lane_poses)
+      .arg(heatmap.num_skipped)
+      .arg(heatmap.elapsed_seconds, 0, 'f', 2));
+}
+
+void TrafficHeatmapDialog::run_button_clicked()
+{
+  heatmap.log_filename = log_line_edit->text().toStdString();
+  heatmap.resolution = resolution_spin_box->value();
+  heatmap.lane_radius = lane_radius_spin_box->value();
+  if (heatmap.log_filename.empty())
+  {
+    browse_button_clicked();
+    heatmap.log_filename = log_line_edit->text().toStdString();
+    if (heatmap.log_filename.empty())
+      return;
+  }
+
+  // run on copies, and only replace the results shown once it's done
+  auto result = std::make_shared<TrafficHeatmap>();
+  result->log_filename = heatmap.log_filename;
+  result->resolution = heatmap.resolution;
+  result->lane_radius = heatmap.lane_radius;
+  auto level =
+    std::make_shared<Level>(building.levels[level_idx].snapshot());
+  const QTransform transform = building.meters_to_level(level_idx);
+  const int result_level_idx = level_idx;
+
+  run_button->setEnabled(false);
+  status_label->setText("Running...");
+
+  QPointer<TrafficHeatmapDialog> dialog(this);
+  job_id = jobs.submit(
+    "Traffic heatmap",
+    JobScheduler::INTERACTIVE,
+    [result, level, transform, result_level_idx](JobContext& context)
+    {
+      return result->run(*level, result_level_idx, transform, &context);
+    },
+    [dialog, result](const JobScheduler::Outcome outcome)
+    {
+      if (!dialog)
+        return;
+      dialog->run_button->setEnabled(true);
+      if (outcome == JobScheduler::SUCCEEDED)
+        dialog->heatmap = *result;
+      else if (outcome == JobScheduler::FAILED)
+        QMessageBox::warning(
+          dialog,
+          "Traffic Heatmap",
+          QString("Unable to build the heatmap: %1.")
+          .arg(QString::fromStdString(result->error)));
+
+      dialog->populate_lane_table();
+      emit dialog->redraw();
+    });
+}
+
+void TrafficHeatmapDialog::lane_cell_clicked(int row, int /*column*/)
+{
+  if (heatmap.level_idx != level_idx ||
+    row < 0 || row >= static_cast<int>(heatmap.lanes.size()))
+    return;
+  const TrafficHeatmap::LaneUsage& lane = heatmap.lanes[row];
+  emit center_on((lane.start + lane.end) / 2.0);
+}
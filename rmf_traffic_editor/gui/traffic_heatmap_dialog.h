@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+
+#ifndef TRAFFIC_HEATMAP_DIALOG_H
+#define TRAFFIC_HEATMAP_DIALOG_H
+
+#include <QDialog>
+#include <QObject>
+#include <QPointF>
+
+#include "building.h"
+#include "job_scheduler.h"
+#include "traffic_heatmap.h"
+class QDoubleSpinBox;
+class QLabel;
+class QLineEdit;
+class QTableWidget;
+
+
+class TrafficHeatmapDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  TrafficHeatmapDialog(
+    QWidget* parent,
+    Building& building,
+    TrafficHeatmap& heatmap,
+    JobScheduler& jobs,
+    const int level_idx);
+  ~TrafficHeatmapDialog();  // cancels the aggregation, if it's still running
+
+private:
+  Building& building;
+  TrafficHeatmap& heatmap;
+  JobScheduler& jobs;
+  JobScheduler::JobId job_id = 0;
+  int level_idx = 0;
+
+  QLineEdit* log_line_edit;
+  QDoubleSpinBox* resolution_spin_box;
+  QDoubleSpinBox* lane_radius_spin_box;
+  QTableWidget* lane_table;
+  QLabel* status_label;
+  QPushButton* run_button, * close_button;
+
+  void populate_lane_table();
+
+private slots:
+  void browse_button_clicked();
+  void run_button_clicked();
+  void lane_cell_clicked(int row, int column);
+
+signals:
+  void redraw();
+  void center_on(const QPointF& p);
+};
+
+#endif
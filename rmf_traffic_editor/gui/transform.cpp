@@ -26,6 +26,88 @@ Transform::Transform()
 {
 }
 
+void Transform::setYaw(const double next_yaw)
+{
+  _yaw = next_yaw;
+  update_matrices();
+}
+
+void Transform::setScale(const double next_scale)
+{
+  _scale = next_scale;
+  update_matrices();
+}
+
+void Transform::setTranslation(const QPointF& next_translation)
+{
+  _translation = next_translation;
+  update_matrices();
+}
+
+void Transform::update_matrices()
+{
+  const double c = cos(_yaw);
+  const double s = sin(_yaw);
+
+  // forwards: rotate by -yaw, then scale, then translate
+  _forwards.a = c * _scale;
+  _forwards.b = s * _scale;
+  _forwards.c = -s * _scale;
+  _forwards.d = c * _scale;
+  _forwards.tx = _translation.x();
+  _forwards.ty = _translation.y();
+
+  // backwards: translate back, scale back, then rotate by +yaw
+  _backwards.a = c / _scale;
+  _backwards.b = -s / _scale;
+  _backwards.c = s / _scale;
+  _backwards.d = c / _scale;
+  _backwards.tx =
+    -(_backwards.a * _translation.x() + _backwards.b * _translation.y());
+  _backwards.ty =
+    -(_backwards.c * _translation.x() + _backwards.d * _translation.y());
+}
+
+void Transform::apply(
+  const Matrix& m,
+  const QPointF* in,
+  QPointF* out,
+  const std::size_t n)
+{
+  // Copy the coefficients to locals and read both coordinates before
+  // writing either, so there is no aliasing to worry about and the compiler
+  // is free to vectorize the loop.
+  const double a = m.a;
+  const double b = m.b;
+  const double c = m.c;
+  const double d = m.d;
+  const double tx = m.tx;
+  const double ty = m.ty;
+  for (std::size_t i = 0; i < n; i++)
+  {
+    const double x = in[i].x();
+    const double y = in[i].y();
+    out[i].setX(a * x + b * y + tx);
+    out[i].setY(c * x + d * y + ty);
+  }
+}
+
+void Transform::forwards(
+  const QPointF* in,
+  QPointF* out,
+  const std::size_t n) const
+{
+  apply(_forwards, in, out, n);
+}
+
+void Transform::backwards(
+  const QPointF* in,
+  QPointF* out,
+  const std::size_t n) const
+{
+  apply(_backwards, in, out, n);
+}
+
 bool Transform::from_yaml(
   const YAML::Node& data,
   const CoordinateSystem& coordinate_system)
@@ -54,6 +136,7 @@ bool Transform::from_yaml(
   if (data["scale"])
     _scale = data["scale"].as<double>();
 
+  update_matrices();
   return true;
 }
 
@@ -78,29 +161,6 @@ YAML::Node Transform::to_yaml(const CoordinateSystem& coordinate_system) const
   return y;
 }
 
-QPointF Transform::forwards(const QPointF& p) const
-{
-  const double qx =
-    ( cos(_yaw) * p.x() + sin(_yaw) * p.y()) * _scale + _translation.x();
-
-  const double qy =
-    (-sin(_yaw) * p.x() + cos(_yaw) * p.y()) * _scale + _translation.y();
-
-  return QPointF(qx, qy);
-}
-
-QPointF Transform::backwards(const QPointF& p) const
-{
-  // translate back and scale
-  const double tsx = (p.x() - _translation.x()) / _scale;
-  const double tsy = (p.y() - _translation.y()) / _scale;
-
-  // rotate back
-  const double rx = cos(-_yaw) * tsx + sin(-_yaw) * tsy;
-  const double ry = -sin(-_yaw) * tsx + cos(-_yaw) * tsy;
-  return QPointF(rx, ry);
-}
-
 Transform Transform::inverse() const
 {
   Transform inv;
@@ -18,6 +18,7 @@
 #ifndef TRAFFIC_EDITOR__TRANSFORM_HPP
 #define TRAFFIC_EDITOR__TRANSFORM_HPP
 
+#include <cstddef>
 #include <string>
 
 #include <yaml-cpp/yaml.h>
@@ -29,29 +30,38 @@
 //=============================================================================
 /// A transform from one space to another. For now this will be linear,
 /// but in the future we expect to use various types of nonlinear transforms.
+///
+/// The 2x3 affine matrices of the forwards and backwards directions are
+/// cached whenever yaw, scale or translation change, so applying the
+/// transform doesn't evaluate any trigonometry.
 class Transform
 {
 public:
   Transform();
 
-  double _yaw = 0.0;
-  double _scale = 1.0;
-  QPointF _translation;
-
   double yaw() const { return _yaw; }
-  void setYaw(const double next_yaw) { _yaw = next_yaw; }
+  void setYaw(const double next_yaw);
 
   double scale() const { return _scale; }
-  void setScale(const double next_scale) { _scale = next_scale; }
+  void setScale(const double next_scale);
 
   QPointF translation() const { return _translation; }
-  void setTranslation(const QPointF& next_translation)
+  void setTranslation(const QPointF& next_translation);
+
+  QPointF forwards(const QPointF& p) const
   {
-    _translation = next_translation;
+    return apply(_forwards, p);
   }
 
-  QPointF forwards(const QPointF& p) const;
-  QPointF backwards(const QPointF& p) const;
+  QPointF backwards(const QPointF& p) const
+  {
+    return apply(_backwards, p);
+  }
+
+  /// Batch versions, for transforming many points at once. The input and
+  /// output arrays may be the same array.
+  void forwards(const QPointF* in, QPointF* out, const std::size_t n) const;
+  void backwards(const QPointF* in, QPointF* out, const std::size_t n) const;
 
   bool from_yaml(
     const YAML::Node& data,
@@ -62,6 +72,39 @@ public:
   Transform inverse() const;
 
   std::string to_string() const;
+
+private:
+  double _yaw = 0.0;
+  double _scale = 1.0;
+  QPointF _translation;
+
+  // row-major [a b tx; c d ty]
+  struct Matrix
+  {
+    double a = 1.0;
+    double b = 0.0;
+    double tx = 0.0;
+    double c = 0.0;
+    double d = 1.0;
+    double ty = 0.0;
+  };
+  Matrix _forwards;
+  Matrix _backwards;
+
+  void update_matrices();
+
+  static QPointF apply(const Matrix& m, const QPointF& p)
+  {
+    return QPointF(
+      m.a * p.x() + m.b * p.y() + m.tx,
+      m.c * p.x() + m.d * p.y() + m.ty);
+  }
+
+  static void apply(
+    const Matrix& m,
+    const QPointF* in,
+    QPointF* out,
+    const std::size_t n);
 };
 
 #endif  // TRAFFIC_EDITOR__TRANSFORM_HPP
@@ -0,0 +1,650 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "triangulation.h"
+
+using std::vector;
+
+typedef Triangulation::Point Point;
+typedef Triangulation::Ring Ring;
+
+static double cross(const Point& a, const Point& b, const Point& c)
+{
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+static bool same_point(const Point& a, const Point& b)
+{
+  return a.x == b.x && a.y == b.y;
+}
+
+// inclusive test; the triangle (a, b, c) must be counter-clockwise
+static bool point_in_triangle(
+  const Point& p,
+  const Point& a,
+  const Point& b,
+  const Point& c)
+{
+  return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+}
+
+// inclusive test: true if the segments cross or merely touch
+static bool segments_meet(
+  const Point& a,
+  const Point& b,
+  const Point& c,
+  const Point& d)
+{
+  const double d1 = cross(c, d, a);
+  const double d2 = cross(c, d, b);
+  const double d3 = cross(a, b, c);
+  const double d4 = cross(a, b, d);
+  if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+    ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+    return true;
+
+  // collinear cases: an endpoint lying on the other segment
+  auto on_segment = [](const Point& p, const Point& q, const Point& r)
+    {
+      return std::min(p.x, q.x) <= r.x && r.x <= std::max(p.x, q.x) &&
+        std::min(p.y, q.y) <= r.y && r.y <= std::max(p.y, q.y);
+    };
+  return (d1 == 0 && on_segment(c, d, a)) ||
+    (d2 == 0 && on_segment(c, d, b)) ||
+    (d3 == 0 && on_segment(a, b, c)) ||
+    (d4 == 0 && on_segment(a, b, d));
+}
+
+static bool rings_meet(const Ring& a, const Ring& b)
+{
+  for (std::size_t i = 0; i < a.size(); i++)
+  {
+    const Point& a0 = a[i];
+    const Point& a1 = a[(i + 1) % a.size()];
+    for (std::size_t j = 0; j < b.size(); j++)
+    {
+      if (segments_meet(a0, a1, b[j], b[(j + 1) % b.size()]))
+        return true;
+    }
+  }
+  return false;
+}
+
+// does the segment (p, q) pass through the interior of the convex,
+// counter-clockwise polygon?
+static bool segment_enters(const Ring& piece, const Point& p, const Point& q)
+{
+  double t0 = 0.0;
+  double t1 = 1.0;
+  for (std::size_t i = 0; i < piece.size(); i++)
+  {
+    const Point& a = piece[i];
+    const Point& b = piece[(i + 1) % piece.size()];
+    const double fp = cross(a, b, p);
+    const double fq = cross(a, b, q);
+    if (fp <= 0 && fq <= 0)
+      return false;
+    if (fp < 0)
+      t0 = std::max(t0, fp / (fp - fq));
+    else if (fq < 0)
+      t1 = std::min(t1, fp / (fp - fq));
+    if (t0 >= t1)
+      return false;
+  }
+  return true;
+}
+
+// splits a convex, counter-clockwise polygon by the line through (p, q)
+// into the parts to its left and to its right. Either may come out empty.
+static void split_piece(
+  const Ring& piece,
+  const Point& p,
+  const Point& q,
+  Ring& left,
+  Ring& right)
+{
+  // vertices this close to the line (in coordinate units) are on it
+  const double SNAP = 1e-9;
+  const double len = std::hypot(q.x - p.x, q.y - p.y);
+
+  left.clear();
+  right.clear();
+  vector<double> dist(piece.size());
+  for (std::size_t i = 0; i < piece.size(); i++)
+  {
+    dist[i] = cross(p, q, piece[i]) / len;
+    if (std::abs(dist[i]) < SNAP)
+      dist[i] = 0.0;
+  }
+
+  for (std::size_t i = 0; i < piece.size(); i++)
+  {
+    const std::size_t j = (i + 1) % piece.size();
+    if (dist[i] >= 0)
+      left.push_back(piece[i]);
+    if (dist[i] <= 0)
+      right.push_back(piece[i]);
+    if ((dist[i] > 0 && dist[j] < 0) || (dist[i] < 0 && dist[j] > 0))
+    {
+      // interpolate from the lesser endpoint, so that the two triangles
+      // which share this edge compute exactly the same point
+      std::size_t from = i, to = j;
+      const Point& a = piece[i];
+      const Point& b = piece[j];
+      if (b.x < a.x || (b.x == a.x && b.y < a.y))
+        std::swap(from, to);
+      const double t = dist[from] / (dist[from] - dist[to]);
+      const Point& f = piece[from];
+      const Point& g = piece[to];
+      const Point x(f.x + t * (g.x - f.x), f.y + t * (g.y - f.y));
+      left.push_back(x);
+      right.push_back(x);
+    }
+  }
+}
+
+// remove repeated consecutive points, including an explicit closing point
+static Ring clean_ring(const Ring& ring)
+{
+  Ring cleaned;
+  cleaned.reserve(ring.size());
+  for (const Point& p : ring)
+  {
+    if (cleaned.empty() || !same_point(cleaned.back(), p))
+      cleaned.push_back(p);
+  }
+  while (cleaned.size() > 1 && same_point(cleaned.front(), cleaned.back()))
+    cleaned.pop_back();
+  return cleaned;
+}
+
+Triangulation::Triangulation()
+{
+}
+
+Triangulation::~Triangulation()
+{
+}
+
+void Triangulation::clear()
+{
+  points.clear();
+  triangles.clear();
+}
+
+double Triangulation::signed_area(const Ring& ring)
+{
+  double sum = 0.0;
+  for (std::size_t i = 0; i < ring.size(); i++)
+  {
+    const Point& a = ring[i];
+    const Point& b = ring[(i + 1) % ring.size()];
+    sum += a.x * b.y - b.x * a.y;
+  }
+  return sum / 2.0;
+}
+
+bool Triangulation::point_in_ring(const Point& p, const Ring& ring)
+{
+  // even-odd rule
+  bool inside = false;
+  for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+  {
+    const Point& a = ring[i];
+    const Point& b = ring[j];
+    if (((a.y > p.y) != (b.y > p.y)) &&
+      (p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x))
+      inside = !inside;
+  }
+  return inside;
+}
+
+double Triangulation::area() const
+{
+  double sum = 0.0;
+  for (std::size_t i = 0; i + 2 < triangles.size(); i += 3)
+  {
+    sum += cross(
+      points[triangles[i]],
+      points[triangles[i + 1]],
+      points[triangles[i + 2]]) / 2.0;
+  }
+  return sum;
+}
+
+bool Triangulation::triangulate(const Ring& _outer, const vector<Ring>& _holes)
+{
+  clear();
+
+  Ring outer = clean_ring(_outer);
+  if (outer.size() < 3)
+    return false;
+  const double outer_area = signed_area(outer);
+  if (outer_area == 0.0)
+    return false;
+  if (outer_area < 0)
+    std::reverse(outer.begin(), outer.end());
+
+  double outer_min_x = outer[0].x, outer_min_y = outer[0].y;
+  double outer_max_x = outer_min_x, outer_max_y = outer_min_y;
+  for (const Point& p : outer)
+  {
+    outer_min_x = std::min(outer_min_x, p.x);
+    outer_min_y = std::min(outer_min_y, p.y);
+    outer_max_x = std::max(outer_max_x, p.x);
+    outer_max_y = std::max(outer_max_y, p.y);
+  }
+
+  // sort out the holes: fully-contained ones get bridged into the outer
+  // ring (clockwise), ones which cross or touch it get subtracted later.
+  vector<Ring> contained_holes;
+  vector<Ring> overlapping_holes;
+  for (const Ring& _hole : _holes)
+  {
+    Ring hole = clean_ring(_hole);
+    if (hole.size() < 3 || signed_area(hole) == 0.0)
+      continue;
+    if (signed_area(hole) > 0)
+      std::reverse(hole.begin(), hole.end());
+
+    double hole_min_x = hole[0].x, hole_min_y = hole[0].y;
+    double hole_max_x = hole_min_x, hole_max_y = hole_min_y;
+    for (const Point& p : hole)
+    {
+      hole_min_x = std::min(hole_min_x, p.x);
+      hole_min_y = std::min(hole_min_y, p.y);
+      hole_max_x = std::max(hole_max_x, p.x);
+      hole_max_y = std::max(hole_max_y, p.y);
+    }
+    if (hole_max_x < outer_min_x || hole_min_x > outer_max_x ||
+      hole_max_y < outer_min_y || hole_min_y > outer_max_y)
+      continue;
+
+    // bridging needs holes which are strictly inside the outer ring and
+    // clear of each other; anything else is subtracted
+    bool contained = !rings_meet(outer, hole) && point_in_ring(hole[0], outer);
+    for (std::size_t i = 0; contained && i < contained_holes.size(); i++)
+    {
+      const Ring& other = contained_holes[i];
+      if (rings_meet(other, hole) ||
+        point_in_ring(hole[0], other) ||
+        point_in_ring(other[0], hole))
+        contained = false;
+    }
+    if (contained)
+      contained_holes.push_back(hole);
+    else
+      overlapping_holes.push_back(hole);
+  }
+
+  // bridge the holes from right to left, so that later bridges can't
+  // cross earlier ones.
+  auto max_x = [](const Ring& ring)
+    {
+      double x = -std::numeric_limits<double>::max();
+      for (const Point& p : ring)
+        x = std::max(x, p.x);
+      return x;
+    };
+  std::sort(
+    contained_holes.begin(),
+    contained_holes.end(),
+    [&max_x](const Ring& a, const Ring& b)
+    {
+      return max_x(a) > max_x(b);
+    });
+
+  Ring ring = outer;
+  for (const Ring& hole : contained_holes)
+    bridge_hole(ring, hole);
+
+  clip_ears(ring);
+
+  if (!overlapping_holes.empty())
+    subtract_holes(overlapping_holes);
+
+  return !triangles.empty();
+}
+
+void Triangulation::subtract_holes(const vector<Ring>& holes)
+{
+  struct Bounds
+  {
+    double min_x, min_y, max_x, max_y;
+  };
+  auto bounds_of = [](const Ring& ring)
+    {
+      Bounds b {ring[0].x, ring[0].y, ring[0].x, ring[0].y};
+      for (const Point& p : ring)
+      {
+        b.min_x = std::min(b.min_x, p.x);
+        b.min_y = std::min(b.min_y, p.y);
+        b.max_x = std::max(b.max_x, p.x);
+        b.max_y = std::max(b.max_y, p.y);
+      }
+      return b;
+    };
+  auto overlap = [](const Bounds& a, const Bounds& b)
+    {
+      return a.max_x > b.min_x && a.min_x < b.max_x &&
+        a.max_y > b.min_y && a.min_y < b.max_y;
+    };
+
+  vector<Bounds> hole_bounds;
+  hole_bounds.reserve(holes.size());
+  for (const Ring& hole : holes)
+    hole_bounds.push_back(bounds_of(hole));
+
+  vector<int> kept;
+  kept.reserve(triangles.size());
+  vector<Ring> pieces, split;
+  Ring left, right;
+  for (std::size_t i = 0; i + 2 < triangles.size(); i += 3)
+  {
+    const Ring triangle = {
+      points[triangles[i]],
+      points[triangles[i + 1]],
+      points[triangles[i + 2]]};
+    const Bounds triangle_bounds = bounds_of(triangle);
+
+    // most triangles are nowhere near a hole and are kept as they are
+    bool near_hole = false;
+    for (const Bounds& b : hole_bounds)
+    {
+      if (overlap(triangle_bounds, b))
+      {
+        near_hole = true;
+        break;
+      }
+    }
+    if (!near_hole)
+    {
+      kept.insert(kept.end(), triangles.begin() + i, triangles.begin() + i + 3);
+      continue;
+    }
+
+    // slivers this much smaller than the triangle are rounding noise
+    const double min_area = 1e-12 * std::abs(signed_area(triangle));
+
+    // split the triangle along each edge of each hole which passes through
+    // it. The convex pieces which result each lie either entirely inside
+    // or entirely outside the hole, so testing one interior point of each
+    // is enough to know which to keep.
+    pieces.assign(1, triangle);
+    for (std::size_t h = 0; h < holes.size() && !pieces.empty(); h++)
+    {
+      if (!overlap(triangle_bounds, hole_bounds[h]))
+        continue;
+      const Ring& hole = holes[h];
+      for (std::size_t j = 0; j < hole.size(); j++)
+      {
+        const Point& p = hole[j];
+        const Point& q = hole[(j + 1) % hole.size()];
+        split.clear();
+        for (Ring& piece : pieces)
+        {
+          if (!segment_enters(piece, p, q))
+          {
+            split.push_back(std::move(piece));
+            continue;
+          }
+          split_piece(piece, p, q, left, right);
+          if (left.size() >= 3 && signed_area(left) > min_area)
+            split.push_back(left);
+          if (right.size() >= 3 && signed_area(right) > min_area)
+            split.push_back(right);
+        }
+        pieces.swap(split);
+      }
+
+      split.clear();
+      for (Ring& piece : pieces)
+      {
+        Point inside(0.0, 0.0);
+        for (const Point& p : piece)
+        {
+          inside.x += p.x / piece.size();
+          inside.y += p.y / piece.size();
+        }
+        if (!point_in_ring(inside, hole))
+          split.push_back(std::move(piece));
+      }
+      pieces.swap(split);
+    }
+
+    // the pieces are convex, so fan out from their first vertex
+    for (const Ring& piece : pieces)
+    {
+      const int first = static_cast<int>(points.size());
+      points.insert(points.end(), piece.begin(), piece.end());
+      for (std::size_t j = 1; j + 1 < piece.size(); j++)
+      {
+        if (cross(piece[0], piece[j], piece[j + 1]) <= 0)
+          continue;  // collinear with the first vertex
+        kept.push_back(first);
+        kept.push_back(first + static_cast<int>(j));
+        kept.push_back(first + static_cast<int>(j + 1));
+      }
+    }
+  }
+  triangles.swap(kept);
+}
+
+void Triangulation::bridge_hole(Ring& ring, const Ring& hole) const
+{
+  // find the hole vertex with the largest x coordinate
+  std::size_t m = 0;
+  for (std::size_t i = 1; i < hole.size(); i++)
+  {
+    if (hole[i].x > hole[m].x)
+      m = i;
+  }
+  const Point& mp = hole[m];
+
+  // cast a ray in the +x direction and find the closest ring edge it hits
+  double best_x = std::numeric_limits<double>::max();
+  int best_edge = -1;
+  for (std::size_t i = 0; i < ring.size(); i++)
+  {
+    const Point& a = ring[i];
+    const Point& b = ring[(i + 1) % ring.size()];
+    if (a.y == b.y)
+      continue;
+    if ((a.y > mp.y && b.y > mp.y) || (a.y < mp.y && b.y < mp.y))
+      continue;
+    const double x = a.x + (mp.y - a.y) * (b.x - a.x) / (b.y - a.y);
+    if (x >= mp.x && x < best_x)
+    {
+      best_x = x;
+      best_edge = static_cast<int>(i);
+    }
+  }
+
+  std::size_t k = 0;
+  if (best_edge < 0)
+  {
+    // shouldn't happen for a contained hole, but just use the nearest vertex
+    double best_dist = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i < ring.size(); i++)
+    {
+      const double dx = ring[i].x - mp.x;
+      const double dy = ring[i].y - mp.y;
+      if (dx * dx + dy * dy < best_dist)
+      {
+        best_dist = dx * dx + dy * dy;
+        k = i;
+      }
+    }
+  }
+  else
+  {
+    const std::size_t i0 = static_cast<std::size_t>(best_edge);
+    const std::size_t i1 = (i0 + 1) % ring.size();
+    k = ring[i0].x > ring[i1].x ? i0 : i1;
+
+    // if another ring vertex lies inside the triangle (M, I, P), the
+    // endpoint P might not be visible from M. In that case, connect to the
+    // vertex inside that triangle with the smallest angle to the ray.
+    const Point ip(best_x, mp.y);
+    const Point pp = ring[k];
+    if (!same_point(ip, pp))
+    {
+      Point a = mp, b = ip, c = pp;
+      if (cross(a, b, c) < 0)
+        std::swap(b, c);
+      double best_angle = std::numeric_limits<double>::max();
+      double best_dist = std::numeric_limits<double>::max();
+      for (std::size_t i = 0; i < ring.size(); i++)
+      {
+        if (i == k || !point_in_triangle(ring[i], a, b, c))
+          continue;
+        const double dx = ring[i].x - mp.x;
+        const double dy = ring[i].y - mp.y;
+        if (dx <= 0)
+          continue;
+        const double angle = std::atan2(std::abs(dy), dx);
+        const double dist = dx * dx + dy * dy;
+        if (angle < best_angle || (angle == best_angle && dist < best_dist))
+        {
+          best_angle = angle;
+          best_dist = dist;
+          k = i;
+        }
+      }
+    }
+  }
+
+  // splice: ... ring[k], hole[m], hole[m+1], ..., hole[m], ring[k], ...
+  Ring spliced;
+  spliced.reserve(ring.size() + hole.size() + 2);
+  spliced.insert(spliced.end(), ring.begin(), ring.begin() + k + 1);
+  for (std::size_t i = 0; i <= hole.size(); i++)
+    spliced.push_back(hole[(m + i) % hole.size()]);
+  spliced.insert(spliced.end(), ring.begin() + k, ring.end());
+  ring.swap(spliced);
+}
+
+void Triangulation::clip_ears(const Ring& ring)
+{
+  points = ring;
+  const int n = static_cast<int>(points.size());
+  if (n < 3)
+    return;
+
+  triangles.reserve(3 * (n - 2));
+
+  vector<int> prev(n), next(n);
+  for (int i = 0; i < n; i++)
+  {
+    prev[i] = (i + n - 1) % n;
+    next[i] = (i + 1) % n;
+  }
+
+  auto is_ear = [&](const int i)
+    {
+      const Point& a = points[prev[i]];
+      const Point& b = points[i];
+      const Point& c = points[next[i]];
+      if (cross(a, b, c) <= 0)
+        return false;
+
+      // only reflex vertices can be inside a convex corner's triangle
+      for (int j = next[next[i]]; j != prev[i]; j = next[j])
+      {
+        const Point& p = points[j];
+        if (same_point(p, a) || same_point(p, b) || same_point(p, c))
+          continue;
+        if (cross(points[prev[j]], p, points[next[j]]) > 0)
+          continue;
+        if (point_in_triangle(p, a, b, c))
+          return false;
+      }
+      return true;
+    };
+
+  auto remove = [&](const int i)
+    {
+      next[prev[i]] = next[i];
+      prev[next[i]] = prev[i];
+    };
+
+  int remaining = n;
+  int i = 0;
+  int stall = 0;
+  while (remaining > 3)
+  {
+    if (is_ear(i))
+    {
+      triangles.push_back(prev[i]);
+      triangles.push_back(i);
+      triangles.push_back(next[i]);
+      remove(i);
+      remaining--;
+      i = next[i];
+      stall = 0;
+      continue;
+    }
+
+    i = next[i];
+    if (++stall < remaining)
+      continue;
+
+    // a full loop without finding an ear. The ring is either
+    // self-intersecting or has collinear runs; drop a degenerate vertex
+    // if there is one, otherwise force-clip a convex corner.
+    int victim = -1;
+    for (int j = 0, k = i; j < remaining; j++, k = next[k])
+    {
+      if (cross(points[prev[k]], points[k], points[next[k]]) == 0)
+      {
+        victim = k;
+        break;
+      }
+    }
+    if (victim < 0)
+    {
+      for (int j = 0, k = i; j < remaining; j++, k = next[k])
+      {
+        if (cross(points[prev[k]], points[k], points[next[k]]) > 0)
+        {
+          victim = k;
+          triangles.push_back(prev[k]);
+          triangles.push_back(k);
+          triangles.push_back(next[k]);
+          break;
+        }
+      }
+    }
+    if (victim < 0)
+      victim = i;
+    remove(victim);
+    remaining--;
+    i = next[victim];
+    stall = 0;
+  }
+
+  if (cross(points[prev[i]], points[i], points[next[i]]) > 0)
+  {
+    triangles.push_back(prev[i]);
+    triangles.push_back(i);
+    triangles.push_back(next[i]);
+  }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef TRIANGULATION_H
+#define TRIANGULATION_H
+
+#include <vector>
+
+/*
+ * Ear-clipping triangulation of a simple polygon with optional holes.
+ *
+ * Holes which lie entirely inside the outer ring are stitched into it
+ * with a zero-width "bridge" edge before clipping. Holes which cross or
+ * touch the outer ring are subtracted afterwards: each triangle they
+ * overlap is split along the hole's edges into convex pieces, and the
+ * pieces inside the hole are discarded. Either way, the resulting
+ * triangles exactly cover (outer - holes).
+ */
+
+class Triangulation
+{
+public:
+  struct Point
+  {
+    double x = 0.0;
+    double y = 0.0;
+
+    Point() {}
+    Point(const double _x, const double _y) : x(_x), y(_y) {}
+  };
+
+  typedef std::vector<Point> Ring;
+
+  // output: every 3 consecutive entries of `triangles` index into `points`
+  // and describe one counter-clockwise triangle.
+  std::vector<Point> points;
+  std::vector<int> triangles;
+
+  Triangulation();
+  ~Triangulation();
+
+  bool triangulate(
+    const Ring& outer,
+    const std::vector<Ring>& holes = std::vector<Ring>());
+
+  void clear();
+  bool empty() const { return triangles.empty(); }
+  std::size_t num_triangles() const { return triangles.size() / 3; }
+
+  double area() const;
+
+  static double signed_area(const Ring& ring);
+  static bool point_in_ring(const Point& p, const Ring& ring);
+
+private:
+  void bridge_hole(Ring& ring, const Ring& hole) const;
+  void clip_ears(const Ring& ring);
+  void subtract_holes(const std::vector<Ring>& holes);
+};
+
+#endif
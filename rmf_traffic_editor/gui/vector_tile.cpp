@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstring>
+#include <sstream>
+
+#include <zlib.h>
+
+#include "vector_tile.h"
+
+using std::string;
+using std::vector;
+
+
+// a bounds-checked cursor over protobuf wire-format bytes
+class VectorTile::Reader
+{
+public:
+  Reader(const char* _data, const std::size_t size)
+  : data(reinterpret_cast<const uint8_t*>(_data)),
+    end(data + size)
+  {
+  }
+
+  bool ok = true;
+
+  bool at_end() const { return !ok || data >= end; }
+
+  uint64_t varint()
+  {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+      if (data >= end)
+        break;
+      const uint8_t byte = *data++;
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+    ok = false;
+    return 0;
+  }
+
+  // read a field key; returns false at the end of the message
+  bool next(int& field, int& wire_type)
+  {
+    if (at_end())
+      return false;
+    const uint64_t key = varint();
+    field = static_cast<int>(key >> 3);
+    wire_type = static_cast<int>(key & 7);
+    return ok;
+  }
+
+  Reader message()
+  {
+    const uint64_t size = varint();
+    if (!ok || size > static_cast<uint64_t>(end - data))
+    {
+      ok = false;
+      return Reader(nullptr, 0);
+    }
+    Reader sub(reinterpret_cast<const char*>(data), size);
+    data += size;
+    return sub;
+  }
+
+  string bytes()
+  {
+    Reader sub = message();
+    return string(reinterpret_cast<const char*>(sub.data), sub.end - sub.data);
+  }
+
+  template<typename T>
+  T fixed()
+  {
+    T value;
+    if (end - data < static_cast<std::ptrdiff_t>(sizeof(T)))
+    {
+      ok = false;
+      return T();
+    }
+    std::memcpy(&value, data, sizeof(T));  // protobuf is little-endian
+    data += sizeof(T);
+    return value;
+  }
+
+  void skip(const int wire_type)
+  {
+    switch (wire_type)
+    {
+      case 0: varint(); break;
+      case 1: fixed<uint64_t>(); break;
+      case 2: message(); break;
+      case 5: fixed<uint32_t>(); break;
+      default: ok = false; break;
+    }
+  }
+
+private:
+  const uint8_t* data;
+  const uint8_t* end;
+};
+
+static int64_t zigzag(const uint64_t n)
+{
+  return static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1);
+}
+
+const string* VectorTile::Layer::tag(
+  const Feature& feature,
+  const string& key) const
+{
+  for (const auto& t : feature.tags)
+  {
+    if (t.first < static_cast<int>(keys.size()) &&
+      t.second < static_cast<int>(values.size()) &&
+      keys[t.first] == key)
+      return &values[t.second];
+  }
+  return nullptr;
+}
+
+const VectorTile::Layer* VectorTile::layer(const string& name) const
+{
+  for (const auto& l : layers)
+  {
+    if (l.name == name)
+      return &l;
+  }
+  return nullptr;
+}
+
+bool VectorTile::inflate(
+  const char* data,
+  const std::size_t size,
+  string& inflated)
+{
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  // 15 + 32: accept either a zlib or a gzip header
+  if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    return false;
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  stream.avail_in = static_cast<uInt>(size);
+
+  inflated.clear();
+  char buffer[16384];
+  int result = Z_OK;
+  while (result == Z_OK)
+  {
+    stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = sizeof(buffer);
+    result = ::inflate(&stream, Z_NO_FLUSH);
+    if (result != Z_OK && result != Z_STREAM_END)
+      break;
+    inflated.append(buffer, sizeof(buffer) - stream.avail_out);
+  }
+  inflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
+bool VectorTile::parse(const char* data, const std::size_t size)
+{
+  layers.clear();
+
+  // compressed tiles start with a gzip or zlib header
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  if (size >= 2 &&
+    ((bytes[0] == 0x1f && bytes[1] == 0x8b) ||
+    (bytes[0] == 0x78 && (bytes[0] * 256 + bytes[1]) % 31 == 0)))
+  {
+    string inflated;
+    if (!inflate(data, size, inflated))
+      return false;
+    return parse(inflated.data(), inflated.size());
+  }
+
+  Reader reader(data, size);
+  int field = 0, wire_type = 0;
+  while (reader.next(field, wire_type))
+  {
+    if (field == 3 && wire_type == 2)
+    {
+      Reader layer_reader = reader.message();
+      Layer layer;
+      if (!parse_layer(layer_reader, layer))
+        return false;
+      layers.push_back(std::move(layer));
+    }
+    else
+      reader.skip(wire_type);
+  }
+  return reader.ok;
+}
+
+bool VectorTile::parse_layer(Reader& reader, Layer& layer)
+{
+  int field = 0, wire_type = 0;
+  while (reader.next(field, wire_type))
+  {
+    if (field == 1 && wire_type == 2)
+      layer.name = reader.bytes();
+    else if (field == 2 && wire_type == 2)
+    {
+      Reader feature_reader = reader.message();
+      Feature feature;
+      if (!parse_feature(feature_reader, feature))
+        return false;
+      layer.features.push_back(std::move(feature));
+    }
+    else if (field == 3 && wire_type == 2)
+      layer.keys.push_back(reader.bytes());
+    else if (field == 4 && wire_type == 2)
+    {
+      Reader value_reader = reader.message();
+      string value;
+      if (!parse_value(value_reader, value))
+        return false;
+      layer.values.push_back(value);
+    }
+    else if (field == 5 && wire_type == 0)
+      layer.extent = static_cast<int>(reader.varint());
+    else
+      reader.skip(wire_type);
+  }
+  if (layer.extent <= 0)
+    layer.extent = 4096;
+  return reader.ok;
+}
+
+bool VectorTile::parse_value(Reader& reader, string& value)
+{
+  std::ostringstream text;
+  int field = 0, wire_type = 0;
+  while (reader.next(field, wire_type))
+  {
+    switch (field)
+    {
+      case 1: value = reader.bytes(); continue;
+      case 2: text << reader.fixed<float>(); break;
+      case 3: text << reader.fixed<double>(); break;
+      case 4: text << static_cast<int64_t>(reader.varint()); break;
+      case 5: text << reader.varint(); break;
+      case 6: text << zigzag(reader.varint()); break;
+      case 7: text << (reader.varint() ? "true" : "false"); break;
+      default: reader.skip(wire_type); continue;
+    }
+    value = text.str();
+  }
+  return reader.ok;
+}
+
+bool VectorTile::parse_feature(Reader& reader, Feature& feature)
+{
+  vector<uint32_t> geometry;
+  int field = 0, wire_type = 0;
+  while (reader.next(field, wire_type))
+  {
+    if (field == 2 && wire_type == 2)
+    {
+      Reader packed = reader.message();
+      while (!packed.at_end())
+      {
+        const int key = static_cast<int>(packed.varint());
+        const int value = static_cast<int>(packed.varint());
+        feature.tags.push_back(std::make_pair(key, value));
+      }
+      if (!packed.ok)
+        return false;
+    }
+    else if (field == 3 && wire_type == 0)
+    {
+      const uint64_t type = reader.varint();
+      feature.type = type <= 3 ? static_cast<Feature::Type>(type) :
+        Feature::UNKNOWN;
+    }
+    else if (field == 4 && wire_type == 2)
+    {
+      Reader packed = reader.message();
+      while (!packed.at_end())
+        geometry.push_back(static_cast<uint32_t>(packed.varint()));
+      if (!packed.ok)
+        return false;
+    }
+    else
+      reader.skip(wire_type);
+  }
+
+  // run the geometry commands: MoveTo (1), LineTo (2) and ClosePath (7),
+  // each with a repeat count; coordinates are zigzag-encoded deltas
+  int x = 0, y = 0;
+  std::size_t i = 0;
+  while (i < geometry.size())
+  {
+    const uint32_t command = geometry[i] & 7;
+    const uint32_t count = geometry[i] >> 3;
+    i++;
+    if (command == 7)
+    {
+      if (!feature.parts.empty() && !feature.parts.back().empty())
+        feature.parts.back().push_back(feature.parts.back().front());
+      continue;
+    }
+    if (command != 1 && command != 2)
+      return false;
+    for (uint32_t j = 0; j < count; j++)
+    {
+      if (i + 1 >= geometry.size())
+        return false;
+      x += static_cast<int>(zigzag(geometry[i]));
+      y += static_cast<int>(zigzag(geometry[i + 1]));
+      i += 2;
+      if (command == 1 && feature.type != Feature::POINT)
+        feature.parts.push_back({});
+      else if (feature.parts.empty())
+        feature.parts.push_back({});
+      feature.parts.back().push_back(std::make_pair(x, y));
+    }
+  }
+  return reader.ok;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef VECTOR_TILE_H
+#define VECTOR_TILE_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Decodes a Mapbox Vector Tile (MVT): a protocol buffer holding layers of
+ * features, each with its geometry in tile coordinates (0..extent) and a
+ * set of key/value tags. The protobuf wire format is read directly, since
+ * only this one small message type is needed. Tiles stored gzip- or
+ * zlib-compressed, as they usually are in MBTiles files, are inflated
+ * first.
+ */
+
+class VectorTile
+{
+public:
+  struct Feature
+  {
+    enum Type
+    {
+      UNKNOWN = 0,
+      POINT = 1,
+      LINESTRING = 2,
+      POLYGON = 3
+    } type = UNKNOWN;
+
+    // points, lines, or polygon rings, in tile coordinates
+    std::vector<std::vector<std::pair<int, int>>> parts;
+
+    // indices into the layer's keys and values
+    std::vector<std::pair<int, int>> tags;
+  };
+
+  struct Layer
+  {
+    std::string name;
+    int extent = 4096;
+    std::vector<std::string> keys;
+    std::vector<std::string> values;  // every value type, as text
+    std::vector<Feature> features;
+
+    // the value of a feature's tag, or nullptr if it doesn't have it
+    const std::string* tag(const Feature& feature, const std::string& key)
+    const;
+  };
+
+  std::vector<Layer> layers;
+
+  bool parse(const char* data, const std::size_t size);
+
+  const Layer* layer(const std::string& name) const;
+
+  static bool inflate(
+    const char* data,
+    const std::size_t size,
+    std::string& inflated);
+
+private:
+  class Reader;
+  static bool parse_layer(Reader& reader, Layer& layer);
+  static bool parse_feature(Reader& reader, Feature& feature);
+  static bool parse_value(Reader& reader, std::string& value);
+};
+
+#endif
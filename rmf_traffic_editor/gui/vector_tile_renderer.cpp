@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <QPainter>
+#include <QPainterPath>
+
+#include "vector_tile_renderer.h"
+
+using std::string;
+
+static const char* DEFAULT_STYLE =
+  "background: \"#f2f2f0\"\n"
+  "rules:\n"
+  "  - {layer: landcover, fill: \"#e4e8e0\"}\n"
+  "  - {layer: landuse, fill: \"#e8e6e2\"}\n"
+  "  - {layer: park, fill: \"#dfe6da\"}\n"
+  "  - {layer: water, fill: \"#c8d4dc\"}\n"
+  "  - {layer: waterway, stroke: \"#c8d4dc\", width: 1.5}\n"
+  "  - {layer: aeroway, fill: \"#e0e0e0\", stroke: \"#d0d0d0\"}\n"
+  "  - layer: transportation\n"
+  "    filter: {class: [path, track, service, minor]}\n"
+  "    stroke: \"#ffffff\"\n"
+  "    width: 1.5\n"
+  "    min_zoom: 14\n"
+  "  - layer: transportation\n"
+  "    filter: {class: [tertiary, secondary, primary, trunk, motorway]}\n"
+  "    stroke: \"#ffffff\"\n"
+  "    width: 3\n"
+  "  - layer: transportation\n"
+  "    filter: {class: [rail, transit]}\n"
+  "    stroke: \"#b8b8b8\"\n"
+  "    width: 1\n"
+  "  - layer: building\n"
+  "    fill: \"#d8d4d0\"\n"
+  "    stroke: \"#c4c0bc\"\n"
+  "    min_zoom: 13\n";
+
+
+VectorTileRenderer::VectorTileRenderer()
+{
+  load_default_style();
+}
+
+VectorTileRenderer::~VectorTileRenderer()
+{
+}
+
+void VectorTileRenderer::load_default_style()
+{
+  style_text = DEFAULT_STYLE;
+  parse_style(YAML::Load(style_text));
+}
+
+bool VectorTileRenderer::load_style(const string& filename)
+{
+  std::ifstream file(filename);
+  if (!file)
+    return false;
+  std::stringstream text;
+  text << file.rdbuf();
+
+  try
+  {
+    if (!parse_style(YAML::Load(text.str())))
+      return false;
+  }
+  catch (const std::exception& e)
+  {
+    printf("couldn't parse tile style %s: %s\n", filename.c_str(), e.what());
+    load_default_style();
+    return false;
+  }
+  style_text = text.str();
+  return true;
+}
+
+bool VectorTileRenderer::parse_style(const YAML::Node& style)
+{
+  if (!style.IsMap() || !style["rules"] || !style["rules"].IsSequence())
+  {
+    printf("tile style needs a list of rules\n");
+    return false;
+  }
+
+  background = style["background"] ?
+    QColor(QString::fromStdString(style["background"].as<string>())) :
+    QColor(Qt::white);
+
+  rules.clear();
+  for (const YAML::Node& r : style["rules"])
+  {
+    Rule rule;
+    rule.layer = r["layer"].as<string>();
+    if (r["filter"] && r["filter"].IsMap())
+    {
+      for (YAML::const_iterator it = r["filter"].begin();
+        it != r["filter"].end(); ++it)
+      {
+        rule.filter_key = it->first.as<string>();
+        if (it->second.IsSequence())
+        {
+          for (const YAML::Node& value : it->second)
+            rule.filter_values.push_back(value.as<string>());
+        }
+        else
+          rule.filter_values.push_back(it->second.as<string>());
+      }
+    }
+    if (r["fill"])
+      rule.fill = QColor(QString::fromStdString(r["fill"].as<string>()));
+    if (r["stroke"])
+      rule.stroke = QColor(QString::fromStdString(r["stroke"].as<string>()));
+    if (r["width"])
+      rule.width = r["width"].as<double>();
+    if (r["min_zoom"])
+      rule.min_zoom = r["min_zoom"].as<int>();
+    if (r["max_zoom"])
+      rule.max_zoom = r["max_zoom"].as<int>();
+    rules.push_back(rule);
+  }
+  return true;
+}
+
+QImage VectorTileRenderer::render(
+  const VectorTile& tile,
+  const int zoom,
+  const int dz,
+  const int sub_x,
+  const int sub_y,
+  const int size) const
+{
+  QImage image(size, size, QImage::Format_RGB32);
+  image.fill(background);
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+
+  for (const Rule& rule : rules)
+  {
+    if (zoom < rule.min_zoom || zoom > rule.max_zoom)
+      continue;
+    const VectorTile::Layer* layer = tile.layer(rule.layer);
+    if (!layer)
+      continue;
+
+    // tile coordinates to pixels of the requested (sub-)tile
+    const double scale = static_cast<double>(size << dz) / layer->extent;
+    const double x_offset = -static_cast<double>(sub_x) * size;
+    const double y_offset = -static_cast<double>(sub_y) * size;
+
+    QPainterPath area_path, line_path;
+    area_path.setFillRule(Qt::OddEvenFill);
+    for (const auto& feature : layer->features)
+    {
+      if (!rule.filter_key.empty())
+      {
+        const string* value = layer->tag(feature, rule.filter_key);
+        if (!value ||
+          std::find(
+            rule.filter_values.begin(),
+            rule.filter_values.end(),
+            *value) == rule.filter_values.end())
+          continue;
+      }
+
+      QPainterPath& path =
+        feature.type == VectorTile::Feature::LINESTRING ?
+        line_path : area_path;
+      for (const auto& part : feature.parts)
+      {
+        if (feature.type == VectorTile::Feature::POINT)
+        {
+          for (const auto& p : part)
+          {
+            path.addEllipse(
+              QPointF(p.first * scale + x_offset, p.second * scale + y_offset),
+              rule.width,
+              rule.width);
+          }
+          continue;
+        }
+        for (std::size_t i = 0; i < part.size(); i++)
+        {
+          const QPointF p(
+            part[i].first * scale + x_offset,
+            part[i].second * scale + y_offset);
+          if (i == 0)
+            path.moveTo(p);
+          else
+            path.lineTo(p);
+        }
+      }
+    }
+
+    QPen pen(Qt::NoPen);
+    if (rule.stroke.isValid())
+    {
+      pen = QPen(rule.stroke, rule.width);
+      pen.setCapStyle(Qt::RoundCap);
+      pen.setJoinStyle(Qt::RoundJoin);
+    }
+    painter.setPen(pen);
+    if (!area_path.isEmpty())
+    {
+      painter.setBrush(rule.fill.isValid() ? QBrush(rule.fill) : QBrush());
+      painter.drawPath(area_path);
+    }
+    if (!line_path.isEmpty())
+    {
+      painter.setBrush(Qt::NoBrush);
+      painter.drawPath(line_path);
+    }
+  }
+  painter.end();
+  return image;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef VECTOR_TILE_RENDERER_H
+#define VECTOR_TILE_RENDERER_H
+
+#include <string>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+
+#include <yaml-cpp/yaml.h>
+
+#include "vector_tile.h"
+
+/*
+ * Renders vector tiles to raster tiles with QPainter, following a style
+ * which lists drawing rules in painting order. A style file looks like:
+ *
+ *   background: "#f0f0f0"
+ *   rules:
+ *     - layer: water
+ *       fill: "#c8d7e0"
+ *     - layer: transportation
+ *       filter: {class: [motorway, trunk, primary]}
+ *       stroke: "#ffffff"
+ *       width: 3
+ *       min_zoom: 10
+ *
+ * Layer names and tags depend on the tile schema; the default style is
+ * written for OpenMapTiles. render() is const and can be called from
+ * several threads at once.
+ */
+
+class VectorTileRenderer
+{
+public:
+  VectorTileRenderer();
+  ~VectorTileRenderer();
+
+  struct Rule
+  {
+    std::string layer;
+    std::string filter_key;  // only features with one of these values
+    std::vector<std::string> filter_values;
+    QColor fill;  // invalid = no fill
+    QColor stroke;  // invalid = no stroke
+    double width = 1.0;  // pixels
+    int min_zoom = 0;
+    int max_zoom = 99;
+  };
+
+  QColor background;
+  std::vector<Rule> rules;
+
+  // the style text, to tell tiles rendered with different styles apart
+  std::string style_text;
+
+  bool load_style(const std::string& filename);
+  void load_default_style();
+
+  // Render a tile at the given zoom. If the vector tile comes from dz zoom
+  // levels above (because the archive stops at a lower zoom), the
+  // (sub_x, sub_y) sub-tile of it is rendered, scaled up.
+  QImage render(
+    const VectorTile& tile,
+    const int zoom,
+    const int dz = 0,
+    const int sub_x = 0,
+    const int sub_y = 0,
+    const int size = 256) const;
+
+private:
+  bool parse_style(const YAML::Node& style);
+};
+
+#endif
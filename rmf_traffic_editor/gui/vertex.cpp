@@ -43,13 +43,13 @@ const vector<pair<string, Param::Type>> Vertex::allowed_params
 
 
 Vertex::Vertex()
-: x(0), y(0), selected(false)
+: x(0), y(0)
 {
   uuid = QUuid::createUuid();
 }
 
 Vertex::Vertex(double _x, double _y, const string& _name)
-: x(_x), y(_y), name(_name), selected(false)
+: x(_x), y(_y), name(_name)
 {
   uuid = QUuid::createUuid();
 }
@@ -128,11 +128,12 @@ YAML::Node Vertex::to_yaml(const CoordinateSystem& coordinate_system) const
   return vertex_node;
 }
 
-void Vertex::draw(
+SelectionSet::Restyler Vertex::draw(
   QGraphicsScene* scene,
   const double radius,
   const QFont& font,
-  const CoordinateSystem& coordinate_system) const
+  const CoordinateSystem& coordinate_system,
+  const bool selected) const
 {
   QPen vertex_pen(Qt::black);
   vertex_pen.setWidthF(radius / 2.0);
@@ -276,9 +277,10 @@ void Vertex::draw(
     pixmap_item->setToolTip(("Vertex is " + icon_name).c_str());
   }
 
+  QGraphicsSimpleTextItem* text_item = nullptr;
   if (!name.empty())
   {
-    QGraphicsSimpleTextItem* text_item = scene->addSimpleText(
+    text_item = scene->addSimpleText(
       QString::fromStdString(name),
       font);
     text_item->setBrush(selected ? selected_color : vertex_color);
@@ -302,6 +304,14 @@ void Vertex::draw(
         y - 3.5 * radius + 0.05 * bb.height());
     }
   }
+
+  return [=](const bool selected_now)
+    {
+      ellipse_item->setBrush(
+        selected_now ? QBrush(selected_color) : QBrush(nonselected_color));
+      if (text_item)
+        text_item->setBrush(selected_now ? selected_color : vertex_color);
+    };
 }
 
 void Vertex::set_param(const std::string& param_name, const std::string& value)
@@ -28,6 +28,7 @@
 
 #include "coordinate_system.h"
 #include "param.h"
+#include "selection_set.h"
 
 class QGraphicsScene;
 
@@ -39,8 +40,6 @@ public:
   double y;
   std::string name;
 
-  bool selected;
-
   QUuid uuid;
   std::map<std::string, Param> params;
 
@@ -55,11 +54,12 @@ public:
 
   void set_param(const std::string& name, const std::string& value);
 
-  void draw(
+  SelectionSet::Restyler draw(
     QGraphicsScene* scene,
     const double radius,
     const QFont& font,
-    const CoordinateSystem& coordinate_system) const;
+    const CoordinateSystem& coordinate_system,
+    const bool selected) const;
 
   bool is_parking_point() const;
   bool is_holding_point() const;
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdint>
+
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+#include <QtConcurrent/QtConcurrent>
+
+#include "line_detector.h"
+#include "wall_proposal.h"
+
+using std::vector;
+
+
+WallProposal::WallProposal()
+{
+}
+
+WallProposal::~WallProposal()
+{
+}
+
+void WallProposal::clear()
+{
+  vertices.clear();
+  walls.clear();
+  level_idx = -1;
+}
+
+bool WallProposal::run(const Level& level, const int _level_idx)
+{
+  clear();
+
+  const double mpp = level.drawing_meters_per_pixel;
+  if (mpp <= 0.0)
+    return false;
+  if (layer_idx < 0 || layer_idx >= static_cast<int>(level.layers.size()))
+    return false;
+  const Layer& layer = level.layers[layer_idx];
+  const QImage& image = layer.image;
+  const double layer_mpp = layer.transform.scale();  // meters per pixel
+  if (image.isNull() || layer_mpp <= 0.0)
+    return false;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  const int width = image.width();
+  const int height = image.height();
+  vector<uint8_t> occupied(static_cast<std::size_t>(width) * height);
+  vector<int> rows(height);
+  for (int y = 0; y < height; y++)
+    rows[y] = y;
+  QtConcurrent::blockingMap(
+    rows,
+    [&](const int y)
+    {
+      const uchar* in = image.constScanLine(y);
+      uint8_t* out = &occupied[static_cast<std::size_t>(y) * width];
+      for (int x = 0; x < width; x++)
+        out[x] = in[x] < occupied_threshold;
+    });
+
+  LineDetector detector;
+  detector.min_length = min_length / layer_mpp;
+  detector.merge_distance = max_thickness / layer_mpp + 2.0;
+  detector.snap_distance = snap_distance / layer_mpp;
+  detector.detect(occupied, width, height);
+
+  // only keep the vertices which some wall actually uses
+  vector<int> vertex_map(detector.vertices.size(), -1);
+  for (const auto& edge : detector.edges)
+  {
+    for (const int v : {edge.first, edge.second})
+    {
+      if (vertex_map[v] >= 0)
+        continue;
+      vertex_map[v] = static_cast<int>(vertices.size());
+      const LineDetector::Point& p = detector.vertices[v];
+      vertices.push_back(layer.transform.forwards(QPointF(p.x, p.y)) / mpp);
+    }
+    walls.push_back(
+      std::make_pair(vertex_map[edge.first], vertex_map[edge.second]));
+  }
+  level_idx = _level_idx;
+
+  printf("proposed %d walls from a %dx%d layer in %.3f s\n",
+    static_cast<int>(walls.size()),
+    width,
+    height,
+    timer.elapsed() / 1000.0);
+  return true;
+}
+
+void WallProposal::draw(
+  QGraphicsScene* scene,
+  const double meters_per_pixel) const
+{
+  QPen pen(QColor::fromRgbF(1.0, 0.0, 1.0, 0.8));
+  pen.setWidthF(0.1 / meters_per_pixel);
+  pen.setStyle(Qt::DashLine);
+  pen.setCapStyle(Qt::RoundCap);
+
+  for (const auto& wall : walls)
+  {
+    const QPointF& a = vertices[wall.first];
+    const QPointF& b = vertices[wall.second];
+    scene->addLine(a.x(), a.y(), b.x(), b.y(), pen);
+  }
+
+  const double r = 0.1 / meters_per_pixel;
+  const QBrush brush(QColor::fromRgbF(1.0, 0.0, 1.0, 0.8));
+  for (const QPointF& v : vertices)
+    scene->addEllipse(v.x() - r, v.y() - r, 2 * r, 2 * r, Qt::NoPen, brush);
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef WALL_PROPOSAL_H
+#define WALL_PROPOSAL_H
+
+#include <utility>
+#include <vector>
+
+#include <QPointF>
+
+#include "level.h"
+
+class QGraphicsScene;
+
+/*
+ * Proposes walls from the occupied pixels of a layer image, using
+ * LineDetector. The proposal is only drawn on top of the level (so it can
+ * be reviewed) until it is explicitly added to the level.
+ */
+
+class WallProposal
+{
+public:
+  WallProposal();
+  ~WallProposal();
+
+  int layer_idx = 0;
+  int occupied_threshold = 100;  // layer pixels darker than this are occupied
+  double min_length = 0.5;  // meters
+  double max_thickness = 0.3;  // meters; both sides of thinner walls merge
+  double snap_distance = 0.3;  // meters
+
+  // proposed walls, in level coordinates
+  std::vector<QPointF> vertices;
+  std::vector<std::pair<int, int>> walls;
+
+  int level_idx = -1;  // level of the proposal, or -1 if there isn't one
+
+  bool run(const Level& level, const int level_idx);
+
+  void clear();
+
+  void draw(QGraphicsScene* scene, const double meters_per_pixel) const;
+};
+
+#endif
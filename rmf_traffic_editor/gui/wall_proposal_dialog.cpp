@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <QtWidgets>
+
+#include "wall_proposal_dialog.h"
+
+
+WallProposalDialog::WallProposalDialog(
+  QWidget* parent,
+  Building& _building,
+  WallProposal& _proposal,
+  JobScheduler& _jobs,
+  const int _level_idx)
+: QDialog(parent),
+  building(_building),
+  proposal(_proposal),
+  jobs(_jobs),
+  level_idx(_level_idx)
+{
+  setWindowTitle("Propose Walls");
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  const Level& level = building.levels[level_idx];
+
+  // first button = [enter] button
+  detect_button = new QPushButton("Detect", this);
+  add_button = new QPushButton("Add walls", this);
+  close_button = new QPushButton("Close", this);
+  add_button->setEnabled(false);
+
+  QHBoxLayout* layer_hbox = new QHBoxLayout;
+  layer_hbox->addWidget(new QLabel("Occupancy layer:"));
+  layer_combo_box = new QComboBox(this);
+  for (const auto& layer : level.layers)
+    layer_combo_box->addItem(QString::fromStdString(layer.name));
+  if (proposal.layer_idx >= 0 &&
+    proposal.layer_idx < static_cast<int>(level.layers.size()))
+    layer_combo_box->setCurrentIndex(proposal.layer_idx);
+  layer_hbox->addWidget(layer_combo_box);
+
+  QHBoxLayout* threshold_hbox = new QHBoxLayout;
+  threshold_hbox->addWidget(new QLabel("Occupied threshold:"));
+  threshold_spin_box = new QSpinBox(this);
+  threshold_spin_box->setRange(1, 255);
+  threshold_spin_box->setValue(proposal.occupied_threshold);
+  threshold_hbox->addWidget(threshold_spin_box);
+
+  QHBoxLayout* min_length_hbox = new QHBoxLayout;
+  min_length_hbox->addWidget(new QLabel("Minimum wall length (m):"));
+  min_length_spin_box = new QDoubleSpinBox(this);
+  min_length_spin_box->setDecimals(2);
+  min_length_spin_box->setRange(0.05, 100.0);
+  min_length_spin_box->setSingleStep(0.1);
+  min_length_spin_box->setValue(proposal.min_length);
+  min_length_hbox->addWidget(min_length_spin_box);
+
+  QHBoxLayout* thickness_hbox = new QHBoxLayout;
+  thickness_hbox->addWidget(new QLabel("Maximum wall thickness (m):"));
+  thickness_spin_box = new QDoubleSpinBox(this);
+  thickness_spin_box->setDecimals(2);
+  thickness_spin_box->setRange(0.0, 5.0);
+  thickness_spin_box->setSingleStep(0.05);
+  thickness_spin_box->setValue(proposal.max_thickness);
+  thickness_hbox->addWidget(thickness_spin_box);
+
+  QHBoxLayout* snap_hbox = new QHBoxLayout;
+  snap_hbox->addWidget(new QLabel("Snap distance (m):"));
+  snap_spin_box = new QDoubleSpinBox(this);
+  snap_spin_box->setDecimals(2);
+  snap_spin_box->setRange(0.0, 5.0);
+  snap_spin_box->setSingleStep(0.05);
+  snap_spin_box->setValue(proposal.snap_distance);
+  snap_hbox->addWidget(snap_spin_box);
+
+  status_label = new QLabel("Not run yet", this);
+
+  QHBoxLayout* bottom_buttons_hbox = new QHBoxLayout;
+  bottom_buttons_hbox->addWidget(close_button);
+  bottom_buttons_hbox->addWidget(add_button);
+  bottom_buttons_hbox->addWidget(detect_button);
+  connect(
+    detect_button, &QAbstractButton::clicked,
+    this, &WallProposalDialog::detect_button_clicked);
+  connect(
+    add_button, &QAbstractButton::clicked,
+    this, &WallProposalDialog::add_button_clicked);
+  connect(
+    close_button, &QAbstractButton::clicked,
+    this, &QDialog::close);
+
+  QVBoxLayout* top_vbox = new QVBoxLayout;
+  top_vbox->addLayout(layer_hbox);
+  top_vbox->addLayout(threshold_hbox);
+  top_vbox->addLayout(min_length_hbox);
+  top_vbox->addLayout(thickness_hbox);
+  top_vbox->addLayout(snap_hbox);
+  top_vbox->addWidget(status_label);
+  top_vbox->addLayout(bottom_buttons_hbox);
+
+  setLayout(top_vbox);
+}
+
+WallProposalDialog::~WallProposalDialog()
+{
+  jobs.cancel(job_id);
+}
+
+void WallProposalDialog::detect_button_clicked()
+{
+  proposal.layer_idx = layer_combo_box->currentIndex();
+  proposal.occupied_threshold = threshold_spin_box->value();
+  proposal.min_length = min_length_spin_box->value();
+  proposal.max_thickness = thickness_spin_box->value();
+  proposal.snap_distance = snap_spin_box->value();
+
+  // run on copies, and only replace the proposal shown once it's done
+  auto result = std::make_shared<WallProposal>(proposal);
+  auto level =
+    std::make_shared<Level>(building.levels[level_idx].snapshot());
+  const int result_level_idx = level_idx;
+
+  detect_button->setEnabled(false);
+  add_button->setEnabled(false);
+  status_label->setText("Detecting walls...");
+
+  QPointer<WallProposalDialog> dialog(this);
+  job_id = jobs.submit(
+    "Proposing walls",
+    JobScheduler::INTERACTIVE,
+    [result, level, result_level_idx](JobContext&)
+    {
+      return result->run(*level, result_level_idx);
+    },
+    [dialog, result](const JobScheduler::Outcome outcome)
+    {
+      if (!dialog)
+        return;
+      dialog->detect_button->setEnabled(true);
+      if (outcome == JobScheduler::SUCCEEDED)
+      {
+        dialog->proposal = *result;
+        dialog->status_label->setText(
+          QString("%1 walls proposed (dashed). Review, then add them.")
+          .arg(dialog->proposal.walls.size()));
+      }
+      else if (outcome == JobScheduler::FAILED)
+        dialog->status_label->setText(
+          "Unable to run. Is the layer image loaded?");
+      else
+        dialog->status_label->setText("Cancelled");
+      dialog->add_button->setEnabled(!dialog->proposal.walls.empty());
+      emit dialog->redraw();
+    });
+}
+
+void WallProposalDialog::add_button_clicked()
+{
+  emit add_walls();
+  close();
+}
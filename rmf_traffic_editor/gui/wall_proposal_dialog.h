@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef WALL_PROPOSAL_DIALOG_H
+#define WALL_PROPOSAL_DIALOG_H
+
+#include <QDialog>
+#include <QObject>
+
+#include "building.h"
+#include "job_scheduler.h"
+#include "wall_proposal.h"
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QSpinBox;
+
+
+class WallProposalDialog : public QDialog
+{
+  Q_OBJECT
+
+public:
+  WallProposalDialog(
+    QWidget* parent,
+    Building& building,
+    WallProposal& proposal,
+    JobScheduler& jobs,
+    const int level_idx);
+  ~WallProposalDialog();  // cancels the detection, if it's still running
+
+private:
+  Building& building;
+  WallProposal& proposal;
+  JobScheduler& jobs;
+  JobScheduler::JobId job_id = 0;
+  int level_idx = 0;
+
+  QComboBox* layer_combo_box;
+  QSpinBox* threshold_spin_box;
+  QDoubleSpinBox* min_length_spin_box;
+  QDoubleSpinBox* thickness_spin_box;
+  QDoubleSpinBox* snap_spin_box;
+  QLabel* status_label;
+  QPushButton* detect_button, * add_button, * close_button;
+
+private slots:
+  void detect_button_clicked();
+  void add_button_clicked();
+
+signals:
+  void redraw();
+  void add_walls();
+};
+
+#endif
@@ -73,3 +73,29 @@ void yaml_utils::write_node(
       break;
   }
 }
+
+string yaml_utils::write_entry(const string& key, const YAML::Node& value)
+{
+  YAML::Node map(YAML::NodeType::Map);
+  map[key] = value;
+  YAML::Emitter emitter;
+  write_node(map, emitter);
+  return emitter.c_str();
+}
+
+string yaml_utils::write_nested_entry(
+  const string& key,
+  const string& child_key,
+  const YAML::Node& value)
+{
+  YAML::Node child(YAML::NodeType::Map);
+  child[child_key] = value;
+  const string text = write_entry(key, child);
+
+  // strip the "key:" line, leaving the entry indented as it would be
+  // within the whole map
+  const string header = key + ":\n";
+  if (text.compare(0, header.size(), header) != 0)
+    return string();
+  return text.substr(header.size());
+}
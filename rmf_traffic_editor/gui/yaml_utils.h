@@ -18,6 +18,7 @@
 #ifndef YAML_UTILS_H
 #define YAML_UTILS_H
 
+#include <string>
 #include <yaml-cpp/yaml.h>
 
 namespace yaml_utils {
@@ -25,6 +26,21 @@ namespace yaml_utils {
 // Recursive function to write YAML ordered maps. Credit: Dave Hershberger
 void write_node(const YAML::Node& node, YAML::Emitter& emitter);
 
+// The entries of a block map are emitted independently of each other, so
+// the text of a whole map is the text of its entries, in sorted key order,
+// joined by newlines. These emit single entries, so that big maps can be
+// emitted in pieces (and in parallel) and then stitched together.
+
+// text of "key: value", as write_node emits it at the top level
+std::string write_entry(const std::string& key, const YAML::Node& value);
+
+// text of "child_key: value", as write_node emits it inside the map under
+// key, or an empty string if that map wouldn't be emitted in block style
+std::string write_nested_entry(
+  const std::string& key,
+  const std::string& child_key,
+  const YAML::Node& value);
+
 }
 
 #endif
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+
+# Copyright 2021 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Publishes made-up robots driving in circles, in the datagram format
+# which the editor's "Live robot poses from UDP" tool listens for
+# (see gui/live_feed.h), to try it out without a fleet.
+
+import argparse
+import math
+import socket
+import struct
+import sys
+import time
+
+MAGIC = b'RPOS'
+
+# keep datagrams small enough to not be fragmented
+MAX_DATAGRAM_SIZE = 1400
+
+
+def pack_pose(x, y, yaw, robot, fleet, level):
+    robot = robot.encode('utf-8')[:255]
+    fleet = fleet.encode('utf-8')[:255]
+    level = level.encode('utf-8')[:255]
+    return struct.pack(
+        '<fffBBB', x, y, yaw, len(robot), len(fleet), len(level)) + \
+        robot + fleet + level
+
+
+def pack_datagrams(messages):
+    datagrams = []
+    datagram = MAGIC
+    for message in messages:
+        if len(datagram) > len(MAGIC) and \
+                len(datagram) + len(message) > MAX_DATAGRAM_SIZE:
+            datagrams.append(datagram)
+            datagram = MAGIC
+        datagram += message
+    if len(datagram) > len(MAGIC):
+        datagrams.append(datagram)
+    return datagrams
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--host', default='127.0.0.1')
+    parser.add_argument('--port', type=int, default=47474)
+    parser.add_argument('--robots', type=int, default=200)
+    parser.add_argument('--fleets', type=int, default=4)
+    parser.add_argument('--rate', type=float, default=50.0, help='Hz')
+    parser.add_argument(
+        '--center', type=float, nargs=2, default=[10.0, -10.0],
+        help='center of the circles, in meters')
+    parser.add_argument(
+        '--radius', type=float, default=8.0,
+        help='radius of the largest circle, in meters')
+    parser.add_argument(
+        '--level', default='',
+        help='level name to send; by default the robots are on any level')
+    args = parser.parse_args(sys.argv[1:])
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    address = (args.host, args.port)
+    period = 1.0 / args.rate
+    print(f'publishing {args.robots} robots at {args.rate} Hz '
+          f'to {args.host}:{args.port}')
+
+    start = time.monotonic()
+    next_time = start
+    while True:
+        t = time.monotonic() - start
+        messages = []
+        for i in range(args.robots):
+            r = args.radius * (i + 1) / args.robots
+            speed = 1.0  # m/s
+            phase = 2.0 * math.pi * i / args.robots
+            angle = phase + speed * t / r
+            x = args.center[0] + r * math.cos(angle)
+            y = args.center[1] + r * math.sin(angle)
+            yaw = angle + math.pi / 2
+            fleet = f'fleet_{i % args.fleets}'
+            messages.append(pack_pose(x, y, yaw, f'robot_{i}', fleet,
+                                      args.level))
+        for datagram in pack_datagrams(messages):
+            sock.sendto(datagram, address)
+
+        next_time += period
+        delay = next_time - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        else:
+            next_time = time.monotonic()
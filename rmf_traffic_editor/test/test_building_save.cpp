@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <string>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "../gui/building.h"
+
+// Building::save emits levels and lifts in concurrent chunks and stitches
+// them together; the file has to come out the same as a serial save.
+class TestBuildingSave : public QObject
+{
+  Q_OBJECT
+
+private:
+  QTemporaryDir dir;
+
+  static void populate(Building& building, const int num_levels)
+  {
+    building.name = "test building";
+    for (int i = 0; i < num_levels; i++)
+    {
+      Level level;
+      // names which need quoting, or sort differently than they're added
+      level.name = i == 0 ? "ground: floor" : "L" + std::to_string(i * 7 % 11);
+      level.elevation = 3.5 * i;
+      for (int v = 0; v < 50; v++)
+      {
+        Vertex vertex(
+          v * 1.25,
+          -v * 0.5 + i,
+          v % 5 ? "" : "v" + std::to_string(v));
+        if (v % 7 == 0)
+          vertex.params["is_charger"] = Param(true);
+        level.vertices.push_back(vertex);
+      }
+      for (int e = 0; e + 1 < 50; e++)
+      {
+        Edge edge(e, e + 1, e % 3 ? Edge::LANE : Edge::WALL);
+        edge.create_required_parameters();
+        level.edges.push_back(edge);
+      }
+      Polygon floor;
+      floor.type = Polygon::FLOOR;
+      floor.vertices = {0, 10, 20, 30};
+      floor.create_required_parameters();
+      level.polygons.push_back(floor);
+      Model model;
+      model.model_name = "OpenRobotics/Chair";
+      model.instance_name = "chair \"" + std::to_string(i) + "\"";
+      model.state.x = 2.0 * i;
+      model.state.yaw = 0.5;
+      level.models.push_back(model);
+      building.levels.push_back(level);
+    }
+    for (int i = 0; i < num_levels / 2; i++)
+    {
+      Lift lift;
+      lift.name = "lift " + std::to_string(num_levels - i);
+      lift.reference_floor_name = building.levels[0].name;
+      lift.x = 10.0 * i;
+      building.lifts.push_back(lift);
+    }
+    building.params["generate_crowd"] = Param(false);
+  }
+
+  QByteArray save(Building& building, const bool parallel)
+  {
+    const QString filename = dir.filePath(
+      parallel ? "parallel.building.yaml" : "serial.building.yaml");
+    if (!building.set_filename(filename.toStdString()) ||
+      !building.save(parallel))
+      return QByteArray();
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+      return QByteArray();
+    return file.readAll();
+  }
+
+private slots:
+  void parallelSaveMatchesSerialSave_data()
+  {
+    QTest::addColumn<int>("num_levels");
+    QTest::newRow("empty") << 0;
+    QTest::newRow("one level") << 1;
+    QTest::newRow("many levels") << 12;
+  }
+
+  void parallelSaveMatchesSerialSave()
+  {
+    QFETCH(int, num_levels);
+    QVERIFY(dir.isValid());
+
+    Building building;
+    populate(building, num_levels);
+    const QByteArray serial = save(building, false);
+    const QByteArray parallel = save(building, true);
+    QVERIFY(!serial.isEmpty());
+    QCOMPARE(parallel, serial);
+  }
+
+  // the editor saves a snapshot on a worker thread while editing goes on
+  void snapshotSavesTheSame()
+  {
+    QVERIFY(dir.isValid());
+
+    Building building;
+    populate(building, 5);
+    const QByteArray original = save(building, false);
+    std::shared_ptr<Building> snapshot = building.snapshot();
+    building.clear();
+    QVERIFY(!original.isEmpty());
+    QCOMPARE(save(*snapshot, true), original);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestBuildingSave)
+#include "test_building_save.moc"
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QTest>
+
+#include "../gui/job_scheduler.h"
+
+// A job chained after others only runs once they have all succeeded,
+// whether they're still running when it's submitted or already finished.
+class TestJobScheduler : public QObject
+{
+  Q_OBJECT
+
+private:
+  struct Record
+  {
+    std::atomic<int> runs {0};
+    int done_calls = 0;
+    JobScheduler::Outcome outcome = JobScheduler::SUCCEEDED;
+  };
+
+  static JobScheduler::JobId submit(
+    JobScheduler& jobs,
+    const std::shared_ptr<Record>& record,
+    const bool succeed,
+    const std::vector<JobScheduler::JobId>& after =
+    std::vector<JobScheduler::JobId>())
+  {
+    return jobs.submit(
+      "test",
+      JobScheduler::BACKGROUND,
+      [record, succeed](JobContext&)
+      {
+        record->runs++;
+        return succeed;
+      },
+      [record](const JobScheduler::Outcome outcome)
+      {
+        record->done_calls++;
+        record->outcome = outcome;
+      },
+      after);
+  }
+
+private slots:
+  void chainedAfterRunningJob_data()
+  {
+    QTest::addColumn<bool>("first_succeeds");
+    QTest::newRow("succeeds") << true;
+    QTest::newRow("fails") << false;
+  }
+
+  void chainedAfterRunningJob()
+  {
+    QFETCH(bool, first_succeeds);
+    JobScheduler jobs;
+    auto first = std::make_shared<Record>();
+    auto second = std::make_shared<Record>();
+
+    const JobScheduler::JobId first_id = submit(jobs, first, first_succeeds);
+    const JobScheduler::JobId second_id =
+      submit(jobs, second, true, {first_id});
+    QVERIFY(jobs.pending(second_id));
+
+    const JobScheduler::Outcome expected =
+      first_succeeds ? JobScheduler::SUCCEEDED : JobScheduler::CANCELLED;
+    QCOMPARE(jobs.wait(second_id), expected);
+    QCOMPARE(second->runs.load(), first_succeeds ? 1 : 0);
+    QCOMPARE(second->done_calls, 1);
+    QCOMPARE(second->outcome, expected);
+    QVERIFY(!jobs.busy());
+  }
+
+  void chainedAfterFinishedJob_data()
+  {
+    QTest::addColumn<bool>("first_succeeds");
+    QTest::newRow("succeeded") << true;
+    QTest::newRow("failed") << false;
+  }
+
+  void chainedAfterFinishedJob()
+  {
+    QFETCH(bool, first_succeeds);
+    JobScheduler jobs;
+    auto first = std::make_shared<Record>();
+    auto second = std::make_shared<Record>();
+
+    const JobScheduler::JobId first_id = submit(jobs, first, first_succeeds);
+    QCOMPARE(
+      jobs.wait(first_id),
+      first_succeeds ? JobScheduler::SUCCEEDED : JobScheduler::FAILED);
+    QCOMPARE(jobs.outcome(first_id), jobs.wait(first_id));
+
+    const JobScheduler::JobId second_id =
+      submit(jobs, second, true, {first_id});
+    QCOMPARE(second->done_calls, 0);  // not until the caller has the id
+
+    const JobScheduler::Outcome expected =
+      first_succeeds ? JobScheduler::SUCCEEDED : JobScheduler::CANCELLED;
+    QCOMPARE(jobs.wait(second_id), expected);
+    QCOMPARE(second->runs.load(), first_succeeds ? 1 : 0);
+    QCOMPARE(second->done_calls, 1);
+  }
+
+  void chainedAfterUnknownJob()
+  {
+    JobScheduler jobs;
+    auto record = std::make_shared<Record>();
+    const JobScheduler::JobId id = submit(jobs, record, true, {12345});
+    QCOMPARE(jobs.wait(id), JobScheduler::CANCELLED);
+    QCOMPARE(record->runs.load(), 0);
+    QCOMPARE(record->done_calls, 1);
+  }
+
+  void cancelledChainIsCancelled()
+  {
+    JobScheduler jobs;
+    auto first = std::make_shared<Record>();
+    auto second = std::make_shared<Record>();
+    auto third = std::make_shared<Record>();
+
+    const JobScheduler::JobId first_id = submit(jobs, first, true);
+    const JobScheduler::JobId second_id =
+      submit(jobs, second, true, {first_id});
+    const JobScheduler::JobId third_id =
+      submit(jobs, third, true, {second_id});
+    jobs.cancel(second_id);
+
+    QCOMPARE(jobs.wait(first_id), JobScheduler::SUCCEEDED);
+    QCOMPARE(jobs.outcome(second_id), JobScheduler::CANCELLED);
+    QCOMPARE(jobs.wait(third_id), JobScheduler::CANCELLED);
+    QCOMPARE(third->runs.load(), 0);
+    QCOMPARE(third->done_calls, 1);
+  }
+};
+
+QTEST_GUILESS_MAIN(TestJobScheduler)
+#include "test_job_scheduler.moc"
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <QTest>
+
+#include "../gui/level.h"
+#include "../gui/triangulation.h"
+
+typedef Triangulation::Point Point;
+typedef Triangulation::Ring Ring;
+
+// the triangles have to cover exactly (outer - holes), and all of them
+// have to be counter-clockwise, whatever the winding of the input rings.
+// Levels hold pixmaps, hence the (guiless) application.
+class TestTriangulation : public QObject
+{
+  Q_OBJECT
+
+private:
+  static Ring rectangle(
+    const double x0,
+    const double y0,
+    const double x1,
+    const double y1)
+  {
+    return {Point(x0, y0), Point(x1, y0), Point(x1, y1), Point(x0, y1)};
+  }
+
+  static Ring reversed(const Ring& ring)
+  {
+    return Ring(ring.rbegin(), ring.rend());
+  }
+
+  static void verify_counter_clockwise(const Triangulation& t)
+  {
+    for (std::size_t i = 0; i + 2 < t.triangles.size(); i += 3)
+    {
+      const Ring triangle = {
+        t.points[t.triangles[i]],
+        t.points[t.triangles[i + 1]],
+        t.points[t.triangles[i + 2]]};
+      QVERIFY(Triangulation::signed_area(triangle) > 0.0);
+    }
+  }
+
+private slots:
+  void testSquare()
+  {
+    Triangulation t;
+    QVERIFY(t.triangulate(rectangle(0, 0, 10, 10)));
+    QCOMPARE(t.num_triangles(), std::size_t(2));
+    QCOMPARE(t.area(), 100.0);
+    verify_counter_clockwise(t);
+  }
+
+  void testClockwiseInput()
+  {
+    Triangulation t;
+    QVERIFY(
+      t.triangulate(
+        reversed(rectangle(0, 0, 10, 10)),
+        {rectangle(4, 4, 6, 6)}));
+    QCOMPARE(t.area(), 96.0);
+    verify_counter_clockwise(t);
+
+    // holes may be wound either way too
+    QVERIFY(
+      t.triangulate(
+        rectangle(0, 0, 10, 10),
+        {reversed(rectangle(4, 4, 6, 6))}));
+    QCOMPARE(t.area(), 96.0);
+    verify_counter_clockwise(t);
+  }
+
+  void testContainedHoles()
+  {
+    Triangulation t;
+    QVERIFY(
+      t.triangulate(
+        rectangle(0, 0, 10, 10),
+        {rectangle(1, 1, 3, 3), rectangle(6, 6, 9, 9)}));
+    QCOMPARE(t.area(), 87.0);
+    verify_counter_clockwise(t);
+
+    // a hole inside another hole is no different to the outer one alone
+    QVERIFY(
+      t.triangulate(
+        rectangle(0, 0, 10, 10),
+        {rectangle(2, 2, 8, 8), rectangle(4, 4, 6, 6)}));
+    QCOMPARE(t.area(), 64.0);
+    verify_counter_clockwise(t);
+  }
+
+  void testPartialOverlap()
+  {
+    Triangulation t;
+
+    // over a corner
+    QVERIFY(
+      t.triangulate(rectangle(0, 0, 10, 10), {rectangle(-2, -2, 2, 2)}));
+    QCOMPARE(t.area(), 96.0);
+    verify_counter_clockwise(t);
+
+    // across the whole floor, without a vertex inside it
+    QVERIFY(
+      t.triangulate(rectangle(0, 0, 10, 10), {rectangle(-1, 4, 11, 6)}));
+    QCOMPARE(t.area(), 80.0);
+    verify_counter_clockwise(t);
+
+    // touching an edge from the inside
+    QVERIFY(
+      t.triangulate(rectangle(0, 0, 10, 10), {rectangle(8, 3, 10, 5)}));
+    QCOMPARE(t.area(), 96.0);
+    verify_counter_clockwise(t);
+
+    // two holes overlapping each other
+    QVERIFY(
+      t.triangulate(
+        rectangle(0, 0, 10, 10),
+        {rectangle(2, 2, 6, 6), rectangle(4, 4, 8, 8)}));
+    QCOMPARE(t.area(), 72.0);
+    verify_counter_clockwise(t);
+
+    // a concave floor, with a hole over its inner corner
+    const Ring l_shape = {
+      Point(0, 0), Point(10, 0), Point(10, 4),
+      Point(4, 4), Point(4, 10), Point(0, 10)};
+    QVERIFY(t.triangulate(l_shape, {rectangle(3, 3, 6, 6)}));
+    QCOMPARE(t.area(), 59.0);
+    verify_counter_clockwise(t);
+
+    // nothing is left if the hole covers the whole floor
+    QVERIFY(
+      !t.triangulate(rectangle(0, 0, 10, 10), {rectangle(-1, -1, 11, 11)}));
+    QVERIFY(t.empty());
+
+    // and nothing is taken if it's off to the side
+    QVERIFY(
+      t.triangulate(rectangle(0, 0, 10, 10), {rectangle(20, 0, 30, 10)}));
+    QCOMPARE(t.area(), 100.0);
+  }
+
+  void testCollinearRuns()
+  {
+    const Ring outer = {
+      Point(0, 0), Point(2.5, 0), Point(5, 0), Point(10, 0),
+      Point(10, 5), Point(10, 10), Point(5, 10), Point(0, 10),
+      Point(0, 5), Point(0, 0)};  // explicitly closed, too
+
+    Triangulation t;
+    QVERIFY(t.triangulate(outer));
+    QCOMPARE(t.area(), 100.0);
+    verify_counter_clockwise(t);
+
+    QVERIFY(t.triangulate(outer, {rectangle(-2, -2, 2, 2)}));
+    QCOMPARE(t.area(), 96.0);
+    verify_counter_clockwise(t);
+  }
+
+  void testFloorAroundLiftShafts()
+  {
+    // the world generator cuts lift shafts out of the floors this way;
+    // a lift on an outer wall has its shaft straddling the floor outline
+    Level level;
+    level.drawing_meters_per_pixel = 0.05;
+    for (const Point& p : rectangle(0, 0, 200, 200))
+      level.vertices.push_back(Vertex(p.x, p.y));
+    Polygon floor;
+    floor.type = Polygon::FLOOR;
+    floor.vertices = {0, 1, 2, 3};
+    level.polygons.push_back(floor);
+    QCOMPARE(level.polygon_area(0), 100.0);
+
+    const std::vector<Level::HoleRing> hole_rings = level.hole_rings();
+    const Triangulation& on_edge = level.polygon_triangulation(
+      0,
+      hole_rings,
+      {rectangle(180, 60, 240, 100)});
+    QCOMPARE(on_edge.area() * 0.05 * 0.05, 98.0);
+    verify_counter_clockwise(on_edge);
+
+    const Triangulation& inside = level.polygon_triangulation(
+      0,
+      hole_rings,
+      {rectangle(100, 60, 140, 100)});
+    QCOMPARE(inside.area() * 0.05 * 0.05, 96.0);
+    verify_counter_clockwise(inside);
+  }
+
+  void testDegenerateInput()
+  {
+    Triangulation t;
+    QVERIFY(!t.triangulate({Point(0, 0), Point(1, 1)}));
+    QVERIFY(!t.triangulate({Point(0, 0), Point(1, 1), Point(2, 2)}));
+    QVERIFY(t.empty());
+  }
+};
+
+QTEST_GUILESS_MAIN(TestTriangulation)
+#include "test_triangulation.moc"